@@ -426,11 +426,24 @@ void WriteLineToLog(FILE *LogFile, const char *outline)
 
 extern bool gameisdead;
 
+static thread_local FString *PrintCapture;
+
+void C_SetPrintCapture(FString *buffer)
+{
+	PrintCapture = buffer;
+}
+
 int PrintString (int iprintlevel, const char *outline)
 {
 	if (gameisdead)
 		return 0;
 
+	if (PrintCapture != nullptr)
+	{
+		if ((iprintlevel & PRINT_TYPES) != PRINT_LOG) *PrintCapture += outline;
+		return (int)strlen(outline);
+	}
+
 	if (!conbuffer) return 0;	// when called too early
 	int printlevel = iprintlevel & PRINT_TYPES;
 	if (printlevel < msglevel || *outline == '\0')
@@ -87,6 +87,11 @@ int Printf (int printlevel, const char *format, ...) ATTRIBUTE((format(printf,2,
 int Printf (const char *format, ...) ATTRIBUTE((format(printf,1,2)));
 int DPrintf (int level, const char *format, ...) ATTRIBUTE((format(printf,2,3)));
 
+// While a thread has a capture buffer set, its output is appended to it instead of being printed.
+// This is for worker threads which must not access the console. The buffer gets printed later by the main thread.
+class FString;
+void C_SetPrintCapture(FString *buffer);
+
 void I_DebugPrint(const char* cp);
 void debugprintf(const char* f, ...);	// Prints to the debugger's log.
 
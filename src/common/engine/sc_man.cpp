@@ -414,6 +414,32 @@ long long FScanner::mystrtoll(const char* p, char** endp, int base)
 	return strtoll(p, endp, base);
 }
 
+//==========================================================================
+//
+// FScanner :: GetScanPos
+//
+// Returns where the next token will be scanned from. Unlike SavePos this
+// takes a token that was put back with UnGet into account.
+//
+//==========================================================================
+
+const FScanner::SavedPos FScanner::GetScanPos () const
+{
+	SavedPos pos;
+
+	if (AlreadyGot)
+	{
+		pos.SavedScriptPtr = LastGotPtr;
+		pos.SavedScriptLine = LastGotLine;
+	}
+	else
+	{
+		pos.SavedScriptPtr = (!ScriptOpen || End || ScriptPtr >= ScriptEndPtr) ? nullptr : ScriptPtr;
+		pos.SavedScriptLine = Line;
+	}
+	return pos;
+}
+
 //==========================================================================
 //
 // FScanner :: isText
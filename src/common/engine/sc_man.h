@@ -88,6 +88,9 @@ public:
 	void DisableStateOptions();
 	const SavedPos SavePos();
 	void RestorePos(const SavedPos &pos);
+	// For specialized parsers that scan the buffer themselves and continue with RestorePos.
+	const SavedPos GetScanPos() const;
+	const char *GetScriptEnd() const { return ScriptEndPtr; }
 	void AddSymbol(const char* name, int64_t value);
 	void AddSymbol(const char* name, uint64_t value);
 	inline void AddSymbol(const char* name, int32_t value) { return AddSymbol(name, int64_t(value)); }
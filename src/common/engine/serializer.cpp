@@ -120,16 +120,164 @@ const char *UnicodeToString(const char *cc)
 //
 //==========================================================================
 
-bool FSerializer::OpenWriter(bool pretty)
+bool FSerializer::OpenWriter(bool pretty, bool binary)
 {
 	if (w != nullptr || r != nullptr) return false;
 
 	mErrors = 0;
-	w = new FWriter(pretty);
+	w = new FWriter(pretty, binary);
 	BeginObject(nullptr);
 	return true;
 }
 
+//==========================================================================
+//
+// ReadBinarySave
+//
+// Rebuilds the document from FBinarySaveWriter's output.
+//
+//==========================================================================
+
+bool ReadBinarySave(rapidjson::Document &doc, const char *buffer, size_t length)
+{
+	auto generator = [=](rapidjson::Document &handler) -> bool
+	{
+		const uint8_t *p = (const uint8_t *)buffer + BINARY_SAVE_MAGIC_LEN;
+		const uint8_t *end = (const uint8_t *)buffer + length;
+		TArray<std::string_view> keys, strings;
+		TArray<rapidjson::SizeType> counts;	// number of members or elements of all open objects and arrays
+		bool failed = false;
+
+		auto readvarint = [&]() -> uint64_t
+		{
+			uint64_t v = 0;
+			for (int shift = 0; shift < 64; shift += 7)
+			{
+				if (p >= end) break;
+				uint8_t b = *p++;
+				v |= uint64_t(b & 0x7f) << shift;
+				if (!(b & 0x80)) return v;
+			}
+			failed = true;
+			return 0;
+		};
+		auto readtext = [&]() -> std::string_view
+		{
+			uint64_t len = readvarint();
+			if (failed || len > uint64_t(end - p))
+			{
+				failed = true;
+				return {};
+			}
+			std::string_view view((const char *)p, (size_t)len);
+			p += len;
+			return view;
+		};
+		auto readref = [&](const TArray<std::string_view> &table) -> std::string_view
+		{
+			uint64_t index = readvarint();
+			if (index >= table.Size())
+			{
+				failed = true;
+				return {};
+			}
+			return table[(unsigned)index];
+		};
+
+		while (p < end && !failed)
+		{
+			uint8_t token = *p++;
+			std::string_view text;
+
+			// A key is not a value of its own. Everything else adds to the enclosing object or array.
+			if (token != BT_EndObject && token != BT_EndArray && token != BT_NewKey && token != BT_KeyRef && counts.Size() > 0)
+			{
+				counts.Last()++;
+			}
+
+			switch (token)
+			{
+			case BT_StartObject:
+				handler.StartObject();
+				counts.Push(0);
+				break;
+
+			case BT_StartArray:
+				handler.StartArray();
+				counts.Push(0);
+				break;
+
+			case BT_EndObject:
+			case BT_EndArray:
+				if (counts.Size() == 0) return false;
+				if (token == BT_EndObject) handler.EndObject(counts.Last());
+				else handler.EndArray(counts.Last());
+				counts.Pop();
+				if (counts.Size() == 0) return p == end;	// done with the root object.
+				break;
+
+			case BT_Null:	handler.Null(); break;
+			case BT_False:	handler.Bool(false); break;
+			case BT_True:	handler.Bool(true); break;
+
+			case BT_Int:
+			{
+				uint32_t v = (uint32_t)readvarint();
+				handler.Int(int32_t((v >> 1) ^ (0u - (v & 1))));
+				break;
+			}
+			case BT_Uint:
+				handler.Uint((uint32_t)readvarint());
+				break;
+
+			case BT_Int64:
+			{
+				uint64_t v = readvarint();
+				handler.Int64(int64_t((v >> 1) ^ (0ull - (v & 1))));
+				break;
+			}
+			case BT_Uint64:
+				handler.Uint64(readvarint());
+				break;
+
+			case BT_Double:
+			{
+				if (end - p < 8) return false;
+				uint64_t bits = 0;
+				for (int i = 0; i < 8; i++) bits |= uint64_t(p[i]) << (i * 8);
+				p += 8;
+				double d;
+				memcpy(&d, &bits, 8);
+				handler.Double(d);
+				break;
+			}
+
+			case BT_String:
+			case BT_NewString:
+			case BT_StringRef:
+				text = token == BT_StringRef ? readref(strings) : readtext();
+				if (token == BT_NewString) strings.Push(text);
+				if (!failed) handler.String(text.data(), (rapidjson::SizeType)text.length(), true);
+				break;
+
+			case BT_NewKey:
+			case BT_KeyRef:
+				text = token == BT_KeyRef ? readref(keys) : readtext();
+				if (token == BT_NewKey) keys.Push(text);
+				if (!failed) handler.Key(text.data(), (rapidjson::SizeType)text.length(), true);
+				break;
+
+			default:
+				return false;
+			}
+		}
+		return false;
+	};
+
+	doc.Populate(generator);
+	return doc.IsObject();
+}
+
 //==========================================================================
 //
 //
@@ -707,9 +855,9 @@ const char *FSerializer::GetOutput(unsigned *len)
 	EndObject();
 	if (len != nullptr)
 	{
-		*len = (unsigned)w->mOutString.GetSize();
+		*len = (unsigned)w->GetOutputSize();
 	}
-	return w->mOutString.GetString();
+	return w->GetOutput();
 }
 
 //==========================================================================
@@ -718,22 +866,14 @@ const char *FSerializer::GetOutput(unsigned *len)
 //
 //==========================================================================
 
-FCompressedBuffer FSerializer::GetCompressedOutput()
+static bool DeflateBuffer(const char *data, FCompressedBuffer &buff)
 {
-	if (isReading()) return{ 0,0,0,0,0,nullptr };
-	FCompressedBuffer buff;
-	WriteObjects();
-	EndObject();
-	buff.mSize = (unsigned)w->mOutString.GetSize();
-	buff.mZipFlags = 0;
-	buff.mCRC32 = crc32(0, (const Bytef*)w->mOutString.GetString(), buff.mSize);
-
 	uint8_t *compressbuf = new uint8_t[buff.mSize+1];
 
 	z_stream stream;
 	int err;
 
-	stream.next_in = (Bytef *)w->mOutString.GetString();
+	stream.next_in = (Bytef *)data;
 	stream.avail_in = buff.mSize;
 	stream.next_out = (Bytef*)compressbuf;
 	stream.avail_out = buff.mSize;
@@ -745,14 +885,16 @@ FCompressedBuffer FSerializer::GetCompressedOutput()
 	err = deflateInit2(&stream, 8, Z_DEFLATED, -15, 9, Z_DEFAULT_STRATEGY);
 	if (err != Z_OK)
 	{
-		goto error;
+		delete[] compressbuf;
+		return false;
 	}
 
 	err = deflate(&stream, Z_FINISH);
 	if (err != Z_STREAM_END) 
 	{
 		deflateEnd(&stream);
-		goto error;
+		delete[] compressbuf;
+		return false;
 	}
 	buff.mCompressedSize = stream.total_out;
 
@@ -763,16 +905,74 @@ FCompressedBuffer FSerializer::GetCompressedOutput()
 		buff.mMethod = METHOD_DEFLATE;
 		memcpy(buff.mBuffer, compressbuf, buff.mCompressedSize);
 		delete[] compressbuf;
-		return buff;
+		return true;
+	}
+	delete[] compressbuf;
+	return false;
+}
+
+FCompressedBuffer FSerializer::GetCompressedOutput()
+{
+	if (isReading()) return{ 0,0,0,0,0,nullptr };
+	FCompressedBuffer buff;
+	WriteObjects();
+	EndObject();
+	buff.mSize = (unsigned)w->GetOutputSize();
+	buff.mZipFlags = 0;
+	buff.mCRC32 = crc32(0, (const Bytef*)w->GetOutput(), buff.mSize);
+
+	if (!DeflateBuffer(w->GetOutput(), buff))
+	{
+		buff.mBuffer = new char[buff.mSize + 1];
+		memcpy(buff.mBuffer, w->GetOutput(), buff.mSize);	// binary output is not null terminated.
+		buff.mBuffer[buff.mSize] = 0;
+		buff.mCompressedSize = buff.mSize;
+		buff.mMethod = METHOD_STORED;
 	}
+	return buff;
+}
 
-error:
-	memcpy(compressbuf, w->mOutString.GetString(), buff.mSize + 1);
-	buff.mCompressedSize = buff.mSize;
+//==========================================================================
+//
+// Same as above but leaves the compression to a later call of
+// CompressStoredBuffer, which unlike the serializer can be run on
+// any thread.
+//
+//==========================================================================
+
+FCompressedBuffer FSerializer::GetStoredOutput()
+{
+	if (isReading()) return{ 0,0,0,0,0,nullptr };
+	FCompressedBuffer buff;
+	WriteObjects();
+	EndObject();
+	buff.mSize = buff.mCompressedSize = (unsigned)w->GetOutputSize();
+	buff.mZipFlags = 0;
 	buff.mMethod = METHOD_STORED;
+	buff.mCRC32 = crc32(0, (const Bytef*)w->GetOutput(), buff.mSize);
+	buff.mBuffer = new char[buff.mSize + 1];
+	memcpy(buff.mBuffer, w->GetOutput(), buff.mSize);
+	buff.mBuffer[buff.mSize] = 0;
 	return buff;
 }
 
+void CompressStoredBuffer(FCompressedBuffer &buff)
+{
+	if (buff.mMethod != METHOD_STORED || buff.mBuffer == nullptr) return;
+
+	char *stored = buff.mBuffer;
+	if (DeflateBuffer(stored, buff))
+	{
+		delete[] stored;
+	}
+	else
+	{
+		buff.mBuffer = stored;
+		buff.mCompressedSize = buff.mSize;
+		buff.mMethod = METHOD_STORED;
+	}
+}
+
 //==========================================================================
 //
 //
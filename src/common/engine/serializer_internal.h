@@ -1,6 +1,137 @@
+#include <string_view>
+#include <unordered_map>
+
 const char* UnicodeToString(const char* cc);
 const char* StringToUnicode(const char* cc, int size = -1);
 
+//==========================================================================
+//
+// Compact binary alternative to the JSON text. It stores the same sequence
+// of events the JSON writer gets, so that the reader can rebuild the exact
+// same document from it. Keys and short strings are only stored the first
+// time they occur and referenced by index afterward.
+//
+//==========================================================================
+
+#define BINARY_SAVE_MAGIC "GZDB\x01"
+#define BINARY_SAVE_MAGIC_LEN 5
+
+enum EBinarySaveToken : uint8_t
+{
+	BT_StartObject,
+	BT_EndObject,
+	BT_StartArray,
+	BT_EndArray,
+	BT_Null,
+	BT_False,
+	BT_True,
+	BT_Int,			// zigzag encoded varint
+	BT_Uint,		// varint
+	BT_Int64,		// zigzag encoded varint
+	BT_Uint64,		// varint
+	BT_Double,		// 8 bytes, little endian
+	BT_String,		// varint length + text, not added to the string table
+	BT_NewString,	// varint length + text, added to the string table
+	BT_StringRef,	// varint index into the string table
+	BT_NewKey,		// varint length + text, added to the key table
+	BT_KeyRef,		// varint index into the key table
+};
+
+class FBinarySaveWriter
+{
+	enum { MAX_SHARED_STRING = 64 };
+
+	TArray<uint8_t> mBuffer;
+	TArray<FString> mStrings;	// only owns the text for the views in the maps.
+	std::unordered_map<std::string_view, uint32_t> mKeyTable;
+	std::unordered_map<std::string_view, uint32_t> mStringTable;
+
+	void Byte(uint8_t b)
+	{
+		mBuffer.Push(b);
+	}
+
+	void VarInt(uint64_t v)
+	{
+		while (v >= 0x80)
+		{
+			mBuffer.Push(uint8_t(v | 0x80));
+			v >>= 7;
+		}
+		mBuffer.Push(uint8_t(v));
+	}
+
+	void Text(const char *k, size_t len)
+	{
+		VarInt(len);
+		unsigned pos = mBuffer.Reserve((unsigned)len);
+		memcpy(&mBuffer[pos], k, len);
+	}
+
+	void Shared(std::unordered_map<std::string_view, uint32_t> &table, const char *k, uint8_t newtoken, uint8_t reftoken)
+	{
+		std::string_view view(k);
+		auto it = table.find(view);
+		if (it != table.end())
+		{
+			Byte(reftoken);
+			VarInt(it->second);
+			return;
+		}
+		auto &stored = mStrings[mStrings.Push(FString(k, view.length()))];
+		table.emplace(std::string_view(stored.GetChars(), stored.Len()), (uint32_t)table.size());
+		Byte(newtoken);
+		Text(k, view.length());
+	}
+
+public:
+	FBinarySaveWriter()
+	{
+		unsigned pos = mBuffer.Reserve(BINARY_SAVE_MAGIC_LEN);
+		memcpy(&mBuffer[pos], BINARY_SAVE_MAGIC, BINARY_SAVE_MAGIC_LEN);
+	}
+
+	const char *GetString() const { return (const char *)mBuffer.Data(); }
+	size_t GetSize() const { return mBuffer.Size(); }
+
+	void StartObject() { Byte(BT_StartObject); }
+	void EndObject() { Byte(BT_EndObject); }
+	void StartArray() { Byte(BT_StartArray); }
+	void EndArray() { Byte(BT_EndArray); }
+	void Key(const char *k) { Shared(mKeyTable, k, BT_NewKey, BT_KeyRef); }
+	void Null() { Byte(BT_Null); }
+	void Bool(bool k) { Byte(k ? BT_True : BT_False); }
+	void Int(int32_t k) { Byte(BT_Int); VarInt((uint32_t(k) << 1) ^ uint32_t(k >> 31)); }
+	void Uint(uint32_t k) { Byte(BT_Uint); VarInt(k); }
+	void Int64(int64_t k) { Byte(BT_Int64); VarInt((uint64_t(k) << 1) ^ uint64_t(k >> 63)); }
+	void Uint64(uint64_t k) { Byte(BT_Uint64); VarInt(k); }
+
+	void Double(double k)
+	{
+		uint64_t bits;
+		memcpy(&bits, &k, 8);
+		Byte(BT_Double);
+		unsigned pos = mBuffer.Reserve(8);
+		for (int i = 0; i < 8; i++) mBuffer[pos + i] = uint8_t(bits >> (i * 8));
+	}
+
+	void String(const char *k)
+	{
+		size_t len = strlen(k);
+		if (len <= MAX_SHARED_STRING)
+		{
+			Shared(mStringTable, k, BT_NewString, BT_StringRef);
+		}
+		else
+		{
+			Byte(BT_String);
+			Text(k, len);
+		}
+	}
+};
+
+bool ReadBinarySave(rapidjson::Document &doc, const char *buffer, size_t length);
+
 //==========================================================================
 //
 //
@@ -38,21 +169,27 @@ struct FWriter
 
 	Writer *mWriter1;
 	PrettyWriter *mWriter2;
+	FBinarySaveWriter *mWriter3;
 	TArray<bool> mInObject;
 	rapidjson::StringBuffer mOutString;
 	TArray<DObject *> mDObjects;
 	TMap<DObject *, int> mObjectMap;
 	
-	FWriter(bool pretty)
+	FWriter(bool pretty, bool binary = false)
 	{
-		if (!pretty)
+		mWriter1 = nullptr;
+		mWriter2 = nullptr;
+		mWriter3 = nullptr;
+		if (binary)
+		{
+			mWriter3 = new FBinarySaveWriter;
+		}
+		else if (!pretty)
 		{
 			mWriter1 = new Writer(mOutString);
-			mWriter2 = nullptr;
 		}
 		else
 		{
-			mWriter1 = nullptr;
 			mWriter2 = new PrettyWriter(mOutString);
 		}
 	}
@@ -61,6 +198,17 @@ struct FWriter
 	{
 		if (mWriter1) delete mWriter1;
 		if (mWriter2) delete mWriter2;
+		if (mWriter3) delete mWriter3;
+	}
+
+	const char *GetOutput() const
+	{
+		return mWriter3 ? mWriter3->GetString() : mOutString.GetString();
+	}
+
+	size_t GetOutputSize() const
+	{
+		return mWriter3 ? mWriter3->GetSize() : mOutString.GetSize();
 	}
 
 
@@ -73,36 +221,42 @@ struct FWriter
 	{
 		if (mWriter1) mWriter1->StartObject();
 		else if (mWriter2) mWriter2->StartObject();
+		else if (mWriter3) mWriter3->StartObject();
 	}
 
 	void EndObject()
 	{
 		if (mWriter1) mWriter1->EndObject();
 		else if (mWriter2) mWriter2->EndObject();
+		else if (mWriter3) mWriter3->EndObject();
 	}
 
 	void StartArray()
 	{
 		if (mWriter1) mWriter1->StartArray();
 		else if (mWriter2) mWriter2->StartArray();
+		else if (mWriter3) mWriter3->StartArray();
 	}
 
 	void EndArray()
 	{
 		if (mWriter1) mWriter1->EndArray();
 		else if (mWriter2) mWriter2->EndArray();
+		else if (mWriter3) mWriter3->EndArray();
 	}
 
 	void Key(const char *k)
 	{
 		if (mWriter1) mWriter1->Key(k);
 		else if (mWriter2) mWriter2->Key(k);
+		else if (mWriter3) mWriter3->Key(k);
 	}
 
 	void Null()
 	{
 		if (mWriter1) mWriter1->Null();
 		else if (mWriter2) mWriter2->Null();
+		else if (mWriter3) mWriter3->Null();
 	}
 
 	void StringU(const char *k, bool encode)
@@ -110,6 +264,7 @@ struct FWriter
 		if (encode) k = StringToUnicode(k);
 		if (mWriter1) mWriter1->String(k);
 		else if (mWriter2) mWriter2->String(k);
+		else if (mWriter3) mWriter3->String(k);
 	}
 
 	void String(const char *k)
@@ -117,6 +272,7 @@ struct FWriter
 		k = StringToUnicode(k);
 		if (mWriter1) mWriter1->String(k);
 		else if (mWriter2) mWriter2->String(k);
+		else if (mWriter3) mWriter3->String(k);
 	}
 
 	void String(const char *k, int size)
@@ -124,36 +280,42 @@ struct FWriter
 		k = StringToUnicode(k, size);
 		if (mWriter1) mWriter1->String(k);
 		else if (mWriter2) mWriter2->String(k);
+		else if (mWriter3) mWriter3->String(k);
 	}
 
 	void Bool(bool k)
 	{
 		if (mWriter1) mWriter1->Bool(k);
 		else if (mWriter2) mWriter2->Bool(k);
+		else if (mWriter3) mWriter3->Bool(k);
 	}
 
 	void Int(int32_t k)
 	{
 		if (mWriter1) mWriter1->Int(k);
 		else if (mWriter2) mWriter2->Int(k);
+		else if (mWriter3) mWriter3->Int(k);
 	}
 
 	void Int64(int64_t k)
 	{
 		if (mWriter1) mWriter1->Int64(k);
 		else if (mWriter2) mWriter2->Int64(k);
+		else if (mWriter3) mWriter3->Int64(k);
 	}
 
 	void Uint(uint32_t k)
 	{
 		if (mWriter1) mWriter1->Uint(k);
 		else if (mWriter2) mWriter2->Uint(k);
+		else if (mWriter3) mWriter3->Uint(k);
 	}
 
 	void Uint64(int64_t k)
 	{
 		if (mWriter1) mWriter1->Uint64(k);
 		else if (mWriter2) mWriter2->Uint64(k);
+		else if (mWriter3) mWriter3->Uint64(k);
 	}
 
 	void Double(double k)
@@ -166,6 +328,10 @@ struct FWriter
 		{
 			mWriter2->Double(k);
 		}
+		else if (mWriter3)
+		{
+			mWriter3->Double(k);
+		}
 	}
 
 };
@@ -186,7 +352,14 @@ struct FReader
 
 	FReader(const char *buffer, size_t length)
 	{
-		mDoc.Parse(buffer, length);
+		if (length >= BINARY_SAVE_MAGIC_LEN && !memcmp(buffer, BINARY_SAVE_MAGIC, BINARY_SAVE_MAGIC_LEN))
+		{
+			if (!ReadBinarySave(mDoc, buffer, length)) mDoc.SetObject();
+		}
+		else
+		{
+			mDoc.Parse(buffer, length);
+		}
 		mObjects.Push(FJSONObject(&mDoc));
 	}
 
@@ -34,6 +34,7 @@
 */
 
 #include <ctype.h>
+#include <atomic>
 #include "resourcefile.h"
 #include "v_text.h"
 #include "filesystem.h"
@@ -404,7 +405,8 @@ void FWadFile::SetNamespace(const char *startmarker, const char *endmarker, name
 void FWadFile::SkinHack ()
 {
 	// this being static is not a problem. The only relevant thing is that each skin gets a different number.
-	static int namespc = ns_firstskin;
+	// It must be atomic though because WADs can be opened in parallel.
+	static std::atomic<int> namespc{ ns_firstskin };
 	bool skinned = false;
 	bool hasmap = false;
 	uint32_t i;
@@ -420,12 +422,12 @@ void FWadFile::SkinHack ()
 			{
 				skinned = true;
 				uint32_t j;
+				int skinns = namespc++;
 
 				for (j = 0; j < NumLumps; j++)
 				{
-					Lumps[j].Namespace = namespc;
+					Lumps[j].Namespace = skinns;
 				}
-				namespc++;
 			}
 		}
 		if ((lump->getName()[0] == 'M' &&
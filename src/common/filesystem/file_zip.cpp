@@ -41,9 +41,18 @@
 #include "w_zip.h"
 
 #include "ancientzip.h"
+#include "c_cvars.h"
+#include "c_dispatch.h"
+#include "i_specialpaths.h"
+#include "md5.h"
 
 #define BUFREADCOMMENT (0x400)
 
+CVAR(Bool, fs_dircache, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+// Must be bumped whenever the layout of the cache files changes.
+static const uint32_t DIRCACHE_VERSION = 1;
+
 //==========================================================================
 //
 // Decompression subroutine
@@ -170,7 +179,256 @@ FZipFile::FZipFile(const char * filename, FileReader &file)
 	Lumps = NULL;
 }
 
+//==========================================================================
+//
+// Directory cache
+//
+// Reading the central directory of a large zip means lots of small reads
+// scattered over the end of the file, which is slow on network drives.
+// The finished lump list (after prefix stripping and filtering) gets stored
+// in the cache folder, keyed by the archive's path, size and modification
+// time plus the filter settings, so that unchanged archives can skip it.
+// Only the game's own file system asks for this with useDirCache. Savegames
+// and the temporary file systems for checking files would only fill the
+// cache with entries that never get used again.
+//
+//==========================================================================
+
+struct FDirCacheKey
+{
+	FString CacheName;
+	uint64_t FileSize;
+	int64_t FileTime;
+	uint8_t FilterHash[16];
+};
+
+static bool GetDirCacheKey(const char *filename, LumpFilterInfo *filter, FDirCacheKey &key)
+{
+	size_t size;
+	time_t time;
+
+	// Embedded archives have no file of their own so GetFileInfo fails for them.
+	if (!fs_dircache || filter == nullptr || !filter->useDirCache || !GetFileInfo(filename, &size, &time))
+		return false;
+
+	key.FileSize = size;
+	key.FileTime = time;
+
+	MD5Context md5;
+	auto addstring = [&](const FString &str) { md5.Update((const uint8_t *)str.GetChars(), (unsigned)str.Len() + 1); };
+	if (filter != nullptr)
+	{
+		for (auto &str : filter->gameTypeFilter) addstring(str);
+		addstring("|");
+		for (auto &str : filter->reservedFolders) addstring(str);
+		addstring("|");
+		for (auto &str : filter->requiredPrefixes) addstring(str);
+		addstring("|");
+		for (auto &str : filter->embeddings) addstring(str);
+		addstring("|");
+		addstring(filter->dotFilter);
+	}
+	md5.Final(key.FilterHash);
+
+	// The file name only needs to be unique, the full path gets validated when reading the file.
+	uint8_t namehash[16];
+	MD5Context namemd5;
+	namemd5.Update((const uint8_t *)filename, (unsigned)strlen(filename));
+	namemd5.Final(namehash);
+	key.CacheName = M_GetCachePath(false);
+	key.CacheName << "/dircache/";
+	for (auto c : namehash) key.CacheName.AppendFormat("%02x", c);
+	key.CacheName << ".zdc";
+	return true;
+}
+
+static void WriteBytes(TArray<uint8_t> &f, const void *data, size_t size)
+{
+	if (size == 0) return;
+	int v = f.Reserve((unsigned)size);
+	memcpy(&f[v], data, size);
+}
+
+static void WriteLong(TArray<uint8_t> &f, uint32_t b)
+{
+	uint8_t bytes[4] = { uint8_t(b), uint8_t(b >> 8), uint8_t(b >> 16), uint8_t(b >> 24) };
+	WriteBytes(f, bytes, 4);
+}
+
+static void WriteString(TArray<uint8_t> &f, const char *str)
+{
+	size_t len = strlen(str);
+	WriteLong(f, (uint32_t)len);
+	WriteBytes(f, str, len);
+}
+
+struct FDirCacheReader
+{
+	const uint8_t *Data;
+	size_t Size;
+	size_t Pos = 0;
+	bool Failed = false;
+
+	FDirCacheReader(const TArray<uint8_t> &data) : Data(data.Data()), Size(data.Size()) {}
+
+	void ReadBytes(void *dest, size_t size)
+	{
+		if (Failed || size > Size - Pos)
+		{
+			Failed = true;
+			memset(dest, 0, size);
+			return;
+		}
+		memcpy(dest, Data + Pos, size);
+		Pos += size;
+	}
+
+	uint32_t ReadLong()
+	{
+		uint8_t b[4];
+		ReadBytes(b, 4);
+		return b[0] | (b[1] << 8) | (b[2] << 16) | (uint32_t(b[3]) << 24);
+	}
+
+	FString ReadString()
+	{
+		uint32_t len = ReadLong();
+		if (Failed || len > Size - Pos)
+		{
+			Failed = true;
+			return "";
+		}
+		FString str((const char *)Data + Pos, len);
+		Pos += len;
+		return str;
+	}
+};
+
+bool FZipFile::ReadDirCache(const FDirCacheKey &key)
+{
+	FileReader fr;
+	if (!fr.OpenFile(key.CacheName))
+		return false;
+
+	TArray<uint8_t> data((unsigned)fr.GetLength(), true);
+	if (fr.Read(data.Data(), data.Size()) != (long)data.Size())
+		return false;
+
+	FDirCacheReader in(data);
+	char magic[4];
+	uint8_t filterhash[16];
+	in.ReadBytes(magic, 4);
+	if (memcmp(magic, "ZDC1", 4) || in.ReadLong() != DIRCACHE_VERSION)
+		return false;
+	if (in.ReadString().Compare(FileName) != 0)
+		return false;
+	uint64_t size = in.ReadLong();
+	size |= uint64_t(in.ReadLong()) << 32;
+	uint64_t time = in.ReadLong();
+	time |= uint64_t(in.ReadLong()) << 32;
+	in.ReadBytes(filterhash, 16);
+	if (in.Failed || size != key.FileSize || int64_t(time) != key.FileTime || memcmp(filterhash, key.FilterHash, 16))
+		return false;
+
+	FString hash = in.ReadString();
+	uint32_t numlumps = in.ReadLong();
+	// Each entry needs at least 24 bytes, this rejects garbage counts before allocating anything.
+	if (in.Failed || numlumps > (in.Size - in.Pos) / 24)
+		return false;
+
+	FZipLump *lumps = new FZipLump[numlumps];
+	for (uint32_t i = 0; i < numlumps && !in.Failed; i++)
+	{
+		FZipLump *lump_p = &lumps[i];
+		lump_p->LumpNameSetup(in.ReadString());
+		uint32_t flags = in.ReadLong();
+		lump_p->Owner = this;
+		lump_p->Flags = flags & 0xff;
+		lump_p->Method = uint8_t(flags >> 8);
+		lump_p->GPFlags = uint16_t(flags >> 16);
+		lump_p->NeedFileStart = true;
+		lump_p->LumpSize = in.ReadLong();
+		lump_p->CompressedSize = in.ReadLong();
+		lump_p->Position = in.ReadLong();
+		lump_p->CRC32 = in.ReadLong();
+	}
+	if (in.Failed)
+	{
+		delete[] lumps;
+		return false;
+	}
+	Lumps = lumps;
+	NumLumps = numlumps;
+	Hash = hash;
+	return true;
+}
+
+void FZipFile::WriteDirCache(const FDirCacheKey &key)
+{
+	TArray<uint8_t> out;
+	WriteBytes(out, "ZDC1", 4);
+	WriteLong(out, DIRCACHE_VERSION);
+	WriteString(out, FileName);
+	WriteLong(out, uint32_t(key.FileSize));
+	WriteLong(out, uint32_t(key.FileSize >> 32));
+	WriteLong(out, uint32_t(key.FileTime));
+	WriteLong(out, uint32_t(uint64_t(key.FileTime) >> 32));
+	WriteBytes(out, key.FilterHash, 16);
+	WriteString(out, Hash);
+	WriteLong(out, NumLumps);
+	for (uint32_t i = 0; i < NumLumps; i++)
+	{
+		FZipLump *lump_p = &Lumps[i];
+		WriteString(out, lump_p->getName());
+		WriteLong(out, (lump_p->Flags & 0xff) | (lump_p->Method << 8) | (lump_p->GPFlags << 16));
+		WriteLong(out, lump_p->LumpSize);
+		WriteLong(out, lump_p->CompressedSize);
+		WriteLong(out, lump_p->Position);
+		WriteLong(out, lump_p->CRC32);
+	}
+
+	// Archives get opened on several threads so each one writes to a temporary file
+	// and renames it afterward. This way a reader can never see a partially written file.
+	CreatePath(M_GetCachePath(true) + "/dircache");
+	FString tempname;
+	tempname.Format("%s.%p", key.CacheName.GetChars(), (void *)this);
+	auto fw = FileWriter::Open(tempname);
+	if (fw == nullptr)
+		return;
+	bool ok = fw->Write(out.Data(), out.Size()) == out.Size();
+	delete fw;
+	if (ok && rename(tempname, key.CacheName) != 0)
+	{
+		// rename does not replace existing files on Windows.
+		remove(key.CacheName);
+		ok = rename(tempname, key.CacheName) == 0;
+	}
+	if (!ok) remove(tempname);
+}
+
+//==========================================================================
+//
+// Zip file
+//
+//==========================================================================
+
 bool FZipFile::Open(bool quiet, LumpFilterInfo* filter)
+{
+	FDirCacheKey key;
+	bool usecache = GetDirCacheKey(FileName, filter, key);
+
+	if (usecache && ReadDirCache(key))
+		return true;
+
+	if (!ReadDirectory(quiet, filter))
+		return false;
+
+	if (usecache)
+		WriteDirCache(key);
+	return true;
+}
+
+bool FZipFile::ReadDirectory(bool quiet, LumpFilterInfo* filter)
 {
 	uint32_t centraldir = Zip_FindCentralDir(Reader);
 	FZipEndOfCentralDirectory info;
@@ -662,3 +920,34 @@ bool WriteZip(const char *filename, TArray<FString> &filenames, TArray<FCompress
 	}
 	return false;
 }
+
+//==========================================================================
+//
+// CCMD cleardircache
+//
+//==========================================================================
+
+UNSAFE_CCMD(cleardircache)
+{
+	TArray<FFileList> list;
+	FString path = M_GetCachePath(false);
+	path += "/dircache/";
+
+	if (!ScanDirectory(list, path))
+	{
+		Printf("Unable to scan directory cache %s\n", path.GetChars());
+		return;
+	}
+
+	for (int i = list.Size() - 1; i >= 0; i--)
+	{
+		if (list[i].isDirectory)
+		{
+			rmdir(list[i].Filename);
+		}
+		else
+		{
+			remove(list[i].Filename);
+		}
+	}
+}
@@ -20,6 +20,7 @@ struct FZipLump : public FResourceLump
 
 	virtual FileReader *GetReader();
 	virtual int FillCache();
+	virtual bool HasRawData() const { return Method != METHOD_STORED; }
 
 private:
 	void SetLumpAddress();
@@ -34,10 +35,16 @@ private:
 //
 //==========================================================================
 
+struct FDirCacheKey;
+
 class FZipFile : public FResourceFile
 {
 	FZipLump *Lumps;
 
+	bool ReadDirectory(bool quiet, LumpFilterInfo* filter);
+	bool ReadDirCache(const FDirCacheKey &key);
+	void WriteDirCache(const FDirCacheKey &key);
+
 public:
 	FZipFile(const char * filename, FileReader &file);
 	virtual ~FZipFile();
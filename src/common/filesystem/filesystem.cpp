@@ -39,6 +39,9 @@
 #include <stdlib.h>
 #include <ctype.h>
 #include <string.h>
+#include <exception>
+#include <vector>
+#include <memory>
 
 #include "m_argv.h"
 #include "cmdlib.h"
@@ -46,6 +49,9 @@
 #include "m_crc32.h"
 #include "printf.h"
 #include "md5.h"
+#include "jobsystem.h"
+#include "c_dispatch.h"
+#include "i_time.h"
 
 extern	FILE* hashfile;
 
@@ -150,11 +156,26 @@ struct FileSystem::LumpRecord
 	}
 };
 
+// A file opened by OpenResource that has yet to be added to the directory.
+struct FOpenedResource
+{
+	FileReader Reader;
+	FResourceFile *ResFile = nullptr;
+	FString Output;				// what got printed while opening the file on a worker thread.
+	std::exception_ptr Error;
+
+	~FOpenedResource()
+	{
+		delete ResFile;	// only set if the file never got added.
+	}
+};
+
 // PUBLIC FUNCTION PROTOTYPES ----------------------------------------------
 
 // PRIVATE FUNCTION PROTOTYPES ---------------------------------------------
 
 static void PrintLastError ();
+static void OpenResources(TArray<FString> &filenames, bool quiet, LumpFilterInfo *filter, std::vector<FOpenedResource> &opened);
 
 // PUBLIC DATA DEFINITIONS -------------------------------------------------
 
@@ -175,6 +196,11 @@ FileSystem::~FileSystem ()
 void FileSystem::DeleteAll ()
 {
 	Hashes.Clear();
+	ShortNameIndex.Clear();
+	FullNameIndex.Clear();
+	NoExtIndex.Clear();
+	FoldedNameData.Clear();
+	FoldedNames.Clear();
 	NumEntries = 0;
 
 	// explicitly delete all manually added lumps.
@@ -216,10 +242,14 @@ void FileSystem::InitMultipleFiles (TArray<FString> &filenames, bool quiet, Lump
 	DeleteAll();
 	numfiles = 0;
 
+	// Reading the archives' directories is what takes time here, so do that for all files at once.
+	// They still get added in order so that the lump order is the same as when loading them one by one.
+	std::vector<FOpenedResource> opened(filenames.Size());
+	OpenResources(filenames, quiet, filter, opened);
+
 	for(unsigned i=0;i<filenames.Size(); i++)
 	{
-		int baselump = NumEntries;
-		AddFile (filenames[i], nullptr, quiet, filter);
+		AddResource (filenames[i], opened[i], quiet, filter);
 		
 		if (i == (unsigned)MaxIwadIndex) MoveLumpsInFolder("after_iwad/");
 		FStringf path("filter/%s", Files.Last()->GetHash().GetChars());
@@ -287,19 +317,17 @@ int FileSystem::AddFromBuffer(const char* name, const char* type, char* data, in
  
 //==========================================================================
 //
-// AddFile
+// OpenResource
 //
-// Files with a .wad extension are wadlink files with multiple lumps,
-// other files are single lumps with the base filename for the lump name.
+// Opens a file or directory and reads its directory. This does not touch
+// the file system's state, so InitMultipleFiles can run it for all files
+// at once on the job system.
 //
-// [RH] Removed reload hack
 //==========================================================================
 
-void FileSystem::AddFile (const char *filename, FileReader *filer, bool quiet, LumpFilterInfo* filter)
+static void OpenResource(const char *filename, FileReader *filer, bool quiet, LumpFilterInfo *filter, FOpenedResource &res)
 {
-	int startlump;
 	bool isdir = false;
-	FileReader filereader;
 
 	if (filer == nullptr)
 	{
@@ -316,7 +344,8 @@ void FileSystem::AddFile (const char *filename, FileReader *filer, bool quiet, L
 
 		if (!isdir)
 		{
-			if (!filereader.OpenFile(filename))
+			// Map the file if possible so that uncompressed lumps can be used without copying them.
+			if ((Args->CheckParm("-nommap") || !res.Reader.OpenMappedFile(filename)) && !res.Reader.OpenFile(filename))
 			{ // Didn't find file
 				if (!quiet)
 				{
@@ -327,17 +356,93 @@ void FileSystem::AddFile (const char *filename, FileReader *filer, bool quiet, L
 			}
 		}
 	}
-	else filereader = std::move(*filer);
+	else res.Reader = std::move(*filer);
 
 	if (!batchrun && !quiet) Printf (" adding %s", filename);
-	startlump = NumEntries;
 
-	FResourceFile *resfile;
-	
 	if (!isdir)
-		resfile = FResourceFile::OpenResourceFile(filename, filereader, quiet, false, filter);
+		res.ResFile = FResourceFile::OpenResourceFile(filename, res.Reader, quiet, false, filter);
 	else
-		resfile = FResourceFile::OpenDirectory(filename, quiet, filter);
+		res.ResFile = FResourceFile::OpenDirectory(filename, quiet, filter);
+}
+
+//==========================================================================
+//
+// OpenResources
+//
+// Opens all files in parallel. FStrings are reference counted without
+// synchronization, so every job works on its own copy of the filter.
+//
+//==========================================================================
+
+static void CopyFilter(LumpFilterInfo &to, const LumpFilterInfo &from)
+{
+	auto copy = [](TArray<FString> &dest, const TArray<FString> &src)
+	{
+		for (auto &str : src) dest.Push(str.GetChars());
+	};
+	copy(to.gameTypeFilter, from.gameTypeFilter);
+	to.dotFilter = from.dotFilter.GetChars();
+	copy(to.reservedFolders, from.reservedFolders);
+	copy(to.requiredPrefixes, from.requiredPrefixes);
+	copy(to.embeddings, from.embeddings);
+	to.useDirCache = from.useDirCache;
+}
+
+static void OpenResources(TArray<FString> &filenames, bool quiet, LumpFilterInfo *filter, std::vector<FOpenedResource> &opened)
+{
+	JobParallelFor(0u, filenames.Size(), 1u, [&](unsigned i)
+	{
+		auto &res = opened[i];
+		C_SetPrintCapture(&res.Output);
+		try
+		{
+			LumpFilterInfo filtercopy;
+			if (filter) CopyFilter(filtercopy, *filter);
+			OpenResource(filenames[i].GetChars(), nullptr, quiet, filter ? &filtercopy : nullptr, res);
+		}
+		catch (...)
+		{
+			res.Error = std::current_exception();
+		}
+		C_SetPrintCapture(nullptr);
+	});
+}
+
+//==========================================================================
+//
+// AddFile
+//
+// Files with a .wad extension are wadlink files with multiple lumps,
+// other files are single lumps with the base filename for the lump name.
+//
+// [RH] Removed reload hack
+//==========================================================================
+
+void FileSystem::AddFile (const char *filename, FileReader *filer, bool quiet, LumpFilterInfo* filter)
+{
+	FOpenedResource res;
+	OpenResource(filename, filer, quiet, filter, res);
+	AddResource(filename, res, quiet, filter);
+}
+
+//==========================================================================
+//
+// AddResource
+//
+// Adds an opened file's lumps to the directory.
+//
+//==========================================================================
+
+void FileSystem::AddResource (const char *filename, FOpenedResource &res, bool quiet, LumpFilterInfo* filter)
+{
+	// Output from a worker thread gets printed in file order to keep the log readable.
+	if (res.Output.IsNotEmpty()) PrintString(PRINT_HIGH, res.Output);
+	if (res.Error) std::rethrow_exception(res.Error);
+
+	FileReader &filereader = res.Reader;
+	FResourceFile *resfile = res.ResFile;
+	res.ResFile = nullptr;
 
 	if (resfile != NULL)
 	{
@@ -487,24 +592,25 @@ int FileSystem::CheckNumForName (const char *name, int space)
 	}
 
 	uppercopy (uname, name);
-	i = FirstLumpIndex[LumpNameHash (uname) % NumEntries];
-
-	while (i != NULL_INDEX)
+	i = FindShortName(qname, space);
+
+	// If the lump is from one of the special namespaces exclusive to Zips
+	// the check has to be done differently:
+	// If we find a lump with this name in the global namespace that does not come
+	// from a Zip return that. WADs don't know these namespaces and single lumps must
+	// work as well.
+	if (space > ns_specialzipdirectory)
 	{
-
-		if (FileInfo[i].shortName.qword == qname)
+		// Both chains are sorted by descending lump number so only newer lumps need to be checked.
+		for (uint32_t g = FindShortName(qname, ns_global); g != NULL_INDEX && (i == NULL_INDEX || g > i); g = ShortNameIndex.Next(g))
 		{
-			auto &lump = FileInfo[i];
-			if (lump.Namespace == space) break;
-			// If the lump is from one of the special namespaces exclusive to Zips
-			// the check has to be done differently:
-			// If we find a lump with this name in the global namespace that does not come
-			// from a Zip return that. WADs don't know these namespaces and single lumps must
-			// work as well.
-			if (space > ns_specialzipdirectory && lump.Namespace == ns_global && 
-				!((lump.lump->Flags ^lump.flags) & LUMPF_FULLPATH)) break;
+			auto &lump = FileInfo[g];
+			if (!((lump.lump->Flags ^lump.flags) & LUMPF_FULLPATH))
+			{
+				i = g;
+				break;
+			}
 		}
-		i = NextLumpIndex[i];
 	}
 
 	return i != NULL_INDEX ? i : -1;
@@ -525,16 +631,15 @@ int FileSystem::CheckNumForName (const char *name, int space, int rfnum, bool ex
 	}
 
 	uppercopy (uname, name);
-	i = FirstLumpIndex[LumpNameHash (uname) % NumEntries];
+	i = FindShortName(qname, space);
 
 	// If exact is true if will only find lumps in the same WAD, otherwise
 	// also those in earlier WADs.
 
 	while (i != NULL_INDEX &&
-		(FileInfo[i].shortName.qword != qname || FileInfo[i].Namespace != space ||
-		 (exact? (FileInfo[i].rfnum != rfnum) : (FileInfo[i].rfnum > rfnum)) ))
+		 (exact? (FileInfo[i].rfnum != rfnum) : (FileInfo[i].rfnum > rfnum)))
 	{
-		i = NextLumpIndex[i];
+		i = ShortNameIndex.Next(i);
 	}
 
 	return i != NULL_INDEX ? i : -1;
@@ -580,21 +685,8 @@ int FileSystem::CheckNumForFullName (const char *name, bool trynormal, int names
 		return -1;
 	}
 	if (*name == '/') name++;	// ignore leading slashes in file names.
-	uint32_t *fli = ignoreext ? FirstLumpIndex_NoExt : FirstLumpIndex_FullName;
-	uint32_t *nli = ignoreext ? NextLumpIndex_NoExt : NextLumpIndex_FullName;
-	auto len = strlen(name);
-
-	for (i = fli[MakeKey(name) % NumEntries]; i != NULL_INDEX; i = nli[i])
-	{
-		if (strnicmp(name, FileInfo[i].longName, len)) continue;
-		if (FileInfo[i].longName[len] == 0) break;	// this is a full match
-		if (ignoreext && FileInfo[i].longName[len] == '.') 
-		{
-			// is this the last '.' in the last path element, indicating that the remaining part of the name is only an extension?
-			if (strpbrk(FileInfo[i].longName.GetChars() + len + 1, "./") == nullptr) break;	
-		}
-	}
 
+	i = FindFullName(name, ignoreext);
 	if (i != NULL_INDEX) return i;
 
 	if (trynormal && strlen(name) <= 8 && !strpbrk(name, "./"))
@@ -613,12 +705,11 @@ int FileSystem::CheckNumForFullName (const char *name, int rfnum)
 		return CheckNumForFullName (name);
 	}
 
-	i = FirstLumpIndex_FullName[MakeKey (name) % NumEntries];
+	i = FindFullName(name, false);
 
-	while (i != NULL_INDEX && 
-		(stricmp(name, FileInfo[i].longName) || FileInfo[i].rfnum != rfnum))
+	while (i != NULL_INDEX && FileInfo[i].rfnum != rfnum)
 	{
-		i = NextLumpIndex_FullName[i];
+		i = FullNameIndex.Next(i);
 	}
 
 	return i != NULL_INDEX ? i : -1;
@@ -661,19 +752,13 @@ int FileSystem::FindFileWithExtensions(const char* name, const char *const *exts
 		return -1;
 	}
 	if (*name == '/') name++;	// ignore leading slashes in file names.
-	uint32_t* fli = FirstLumpIndex_NoExt;
-	uint32_t* nli = NextLumpIndex_NoExt;
-	auto len = strlen(name);
 
-	for (i = fli[MakeKey(name) % NumEntries]; i != NULL_INDEX; i = nli[i])
+	for (i = FindFullName(name, true); i != NULL_INDEX; i = NoExtIndex.Next(i))
 	{
-		if (strnicmp(name, FileInfo[i].longName, len)) continue;
-		if (FileInfo[i].longName[len] != '.') continue;	// we are looking for extensions but this file doesn't have one.
-
-		auto cp = FileInfo[i].longName.GetChars() + len + 1;
-		// is this the last '.' in the last path element, indicating that the remaining part of the name is only an extension?
-		if (strpbrk(cp, "./") != nullptr) continue;	// No, so it cannot be a valid entry.
+		auto &folded = FoldedNames[i];
+		if (folded.Length == folded.NoExtLength) continue;	// we are looking for extensions but this file doesn't have one.
 
+		auto cp = FileInfo[i].longName.GetChars() + folded.NoExtLength + 1;
 		for (int j = 0; j < count; j++)
 		{
 			if (!stricmp(cp, exts[j])) return i;	// found a match
@@ -853,41 +938,62 @@ void FileSystem::InitHashChains (void)
 	unsigned int i, j;
 
 	NumEntries = FileInfo.Size();
-	Hashes.Resize(8 * NumEntries);
+	Hashes.Resize(2 * NumEntries);
 	// Mark all buckets as empty
 	memset(Hashes.Data(), -1, Hashes.Size() * sizeof(Hashes[0]));
-	FirstLumpIndex = &Hashes[0];
-	NextLumpIndex = &Hashes[NumEntries];
-	FirstLumpIndex_FullName = &Hashes[NumEntries * 2];
-	NextLumpIndex_FullName = &Hashes[NumEntries * 3];
-	FirstLumpIndex_NoExt = &Hashes[NumEntries * 4];
-	NextLumpIndex_NoExt = &Hashes[NumEntries * 5];
-	FirstLumpIndex_ResId = &Hashes[NumEntries * 6];
-	NextLumpIndex_ResId = &Hashes[NumEntries * 7];
+	FirstLumpIndex_ResId = &Hashes[0];
+	NextLumpIndex_ResId = &Hashes[NumEntries];
 
+	ShortNameIndex.Init(NumEntries);
+	FullNameIndex.Init(NumEntries);
+	NoExtIndex.Init(NumEntries);
 
-	// Now set up the chains
+	// Fold all full names to lower case once so that lookups only need to fold the name being searched for.
+	FoldedNames.Resize(NumEntries);
+	FoldedNameData.Clear();
 	for (i = 0; i < (unsigned)NumEntries; i++)
 	{
-		j = LumpNameHash (FileInfo[i].shortName.String) % NumEntries;
-		NextLumpIndex[i] = FirstLumpIndex[j];
-		FirstLumpIndex[j] = i;
+		auto &longName = FileInfo[i].longName;
+		auto &folded = FoldedNames[i];
+		folded.Offset = FoldedNameData.Reserve(longName.Len() + 1);
+		folded.Length = (uint32_t)longName.Len();
+		for (j = 0; j <= folded.Length; j++)
+		{
+			FoldedNameData[folded.Offset + j] = (char)tolower((unsigned char)longName[j]);
+		}
+
+		auto dot = longName.LastIndexOf('.');
+		auto slash = longName.LastIndexOf('/');
+		folded.NoExtLength = dot > slash ? (uint32_t)dot : folded.Length;
+	}
+
+	// Now set up the indices. Inserting in ascending order makes each lump the head of its key's list.
+	for (i = 0; i < (unsigned)NumEntries; i++)
+	{
+		auto qname = FileInfo[i].shortName.qword;
+		auto space = FileInfo[i].Namespace;
+		ShortNameIndex.Insert(ShortNameHash(qname, space), i, [&](uint32_t other)
+		{
+			return FileInfo[other].shortName.qword == qname && FileInfo[other].Namespace == space;
+		});
 
 		// Do the same for the full paths
 		if (FileInfo[i].longName.IsNotEmpty())
 		{
-			j = MakeKey(FileInfo[i].longName) % NumEntries;
-			NextLumpIndex_FullName[i] = FirstLumpIndex_FullName[j];
-			FirstLumpIndex_FullName[j] = i;
+			auto &folded = FoldedNames[i];
+			const char *name = &FoldedNameData[folded.Offset];
 
-			FString nameNoExt = FileInfo[i].longName;
-			auto dot = nameNoExt.LastIndexOf('.');
-			auto slash = nameNoExt.LastIndexOf('/');
-			if (dot > slash) nameNoExt.Truncate(dot);
+			FullNameIndex.Insert(SuperFastHash(name, folded.Length), i, [&](uint32_t other)
+			{
+				auto &o = FoldedNames[other];
+				return o.Length == folded.Length && !memcmp(&FoldedNameData[o.Offset], name, folded.Length);
+			});
 
-			j = MakeKey(nameNoExt) % NumEntries;
-			NextLumpIndex_NoExt[i] = FirstLumpIndex_NoExt[j];
-			FirstLumpIndex_NoExt[j] = i;
+			NoExtIndex.Insert(SuperFastHash(name, folded.NoExtLength), i, [&](uint32_t other)
+			{
+				auto &o = FoldedNames[other];
+				return o.NoExtLength == folded.NoExtLength && !memcmp(&FoldedNameData[o.Offset], name, folded.NoExtLength);
+			});
 
 			j = FileInfo[i].resourceId % NumEntries;
 			NextLumpIndex_ResId[i] = FirstLumpIndex_ResId[j];
@@ -899,6 +1005,51 @@ void FileSystem::InitHashChains (void)
 	Files.ShrinkToFit();
 }
 
+//==========================================================================
+//
+// Index lookups
+//
+//==========================================================================
+
+uint32_t FileSystem::ShortNameHash(uint64_t qname, int space)
+{
+	uint64_t hash = (qname ^ (uint64_t(uint32_t(space)) << 40)) * 0x9E3779B97F4A7C15ull;
+	return uint32_t(hash >> 32);
+}
+
+uint32_t FileSystem::FindShortName(uint64_t qname, int space) const
+{
+	return ShortNameIndex.Find(ShortNameHash(qname, space), [&](uint32_t lump)
+	{
+		return FileInfo[lump].shortName.qword == qname && FileInfo[lump].Namespace == space;
+	});
+}
+
+uint32_t FileSystem::FindFullName(const char *name, bool noext) const
+{
+	char buffer[256];
+	std::unique_ptr<char[]> longbuffer;
+	size_t len = strlen(name);
+	char *key = buffer;
+
+	if (len > sizeof(buffer))
+	{
+		longbuffer.reset(new char[len]);
+		key = longbuffer.get();
+	}
+	for (size_t i = 0; i < len; i++)
+	{
+		key[i] = (char)tolower((unsigned char)name[i]);
+	}
+
+	auto &index = noext ? NoExtIndex : FullNameIndex;
+	return index.Find(SuperFastHash(key, len), [&](uint32_t lump)
+	{
+		auto &folded = FoldedNames[lump];
+		return (noext ? folded.NoExtLength : folded.Length) == len && !memcmp(&FoldedNameData[folded.Offset], key, len);
+	});
+}
+
 //==========================================================================
 //
 // should only be called before the hash chains are set up.
@@ -1372,6 +1523,113 @@ FileData FileSystem::ReadFile (int lump)
 	return FileData(FString(ELumpNum(lump)));
 }
 
+//==========================================================================
+//
+// ReadFileView
+//
+// Like ReadFile but for uncompressed lumps in memory mapped archives the
+// returned data points directly into the mapping. Such data is not null
+// terminated and must not be written to, so this is only for binary
+// lumps that are parsed in place.
+//
+//==========================================================================
+
+FileData FileSystem::ReadFileView (int lump)
+{
+	if ((unsigned)lump >= (unsigned)FileInfo.Size())
+	{
+		I_Error("ReadFileView: %u >= NumEntries", lump);
+	}
+
+	auto rl = FileInfo[lump].lump;
+	auto rd = rl->GetReader();
+
+	if (rd != nullptr && rd->GetBuffer() != nullptr && !(rl->Flags & LUMPF_COMPRESSED))
+	{
+		auto mem = (const char *)rl->Lock();
+		if (rl->RefCount < 0)
+		{
+			// The cache points into the file's data and stays valid as long as the file is open.
+			return FileData(mem, rl->LumpSize);
+		}
+		rl->Unlock();
+	}
+	return ReadFile(lump);
+}
+
+//==========================================================================
+//
+// PrefetchFiles
+//
+// Caches a set of lumps, e.g. all scripts or all textures of a kind.
+// Compressed lumps are read from their archives on this thread but get
+// decompressed in parallel. They stay cached until the returned object
+// is destroyed.
+//
+//==========================================================================
+
+FPrefetchedFiles FileSystem::PrefetchFiles(const TArray<int> &lumps)
+{
+	struct FInflateJob
+	{
+		FResourceLump *Lump;
+		FCompressedBuffer Raw;
+		char *Data;
+		FString Output;
+	};
+
+	FPrefetchedFiles prefetched;
+	TArray<FInflateJob> jobs;
+	TMap<FResourceLump *, bool> seen;
+
+	for (int lumpnum : lumps)
+	{
+		if ((unsigned)lumpnum >= FileInfo.Size()) continue;
+		auto lump = FileInfo[lumpnum].lump;
+		if (lump->LumpSize <= 0 || seen.CheckKey(lump)) continue;
+		seen.Insert(lump, true);
+
+		if (lump->Cache == nullptr && lump->HasRawData())
+		{
+			jobs.Push({ lump, lump->GetRawData(), nullptr, FString() });
+		}
+		else
+		{
+			lump->Lock();
+			prefetched.Lumps.Push(lump);
+		}
+	}
+
+	JobParallelFor(0u, jobs.Size(), 1u, [&](unsigned i)
+	{
+		auto &job = jobs[i];
+		C_SetPrintCapture(&job.Output);
+		job.Data = new char[job.Raw.mSize];
+		job.Raw.Decompress(job.Data);
+		C_SetPrintCapture(nullptr);
+	});
+
+	// Everything gets finished in list order so that the output does not depend on timing.
+	for (auto &job : jobs)
+	{
+		if (job.Output.IsNotEmpty()) PrintString(PRINT_HIGH, job.Output);
+		job.Raw.Clean();
+		job.Lump->Cache = job.Data;
+		job.Lump->RefCount = 1;
+		prefetched.Lumps.Push(job.Lump);
+	}
+	return prefetched;
+}
+
+void FPrefetchedFiles::Release()
+{
+	for (auto lump : Lumps)
+	{
+		lump->Unlock();
+	}
+	Lumps.Clear();
+}
+
 //==========================================================================
 //
 // OpenFileReader
@@ -1391,7 +1649,8 @@ FileReader FileSystem::OpenFileReader(int lump)
 	auto rl = FileInfo[lump].lump;
 	auto rd = rl->GetReader();
 
-	if (rl->RefCount == 0 && rd != nullptr && !rd->GetBuffer() && !(rl->Flags & LUMPF_COMPRESSED))
+	// The file's reader cannot be shared by jobs that run in parallel so these always go through the cache.
+	if (rl->RefCount == 0 && rd != nullptr && !rd->GetBuffer() && !(rl->Flags & LUMPF_COMPRESSED) && !FJobSystem::InJob())
 	{
 		FileReader rdr;
 		rdr.OpenFilePart(*rd, rl->GetFileOffset(), rl->LumpSize);
@@ -1578,11 +1837,15 @@ FileData::FileData ()
 FileData::FileData (const FileData &copy)
 {
 	Block = copy.Block;
+	View = copy.View;
+	ViewSize = copy.ViewSize;
 }
 
 FileData &FileData::operator = (const FileData &copy)
 {
 	Block = copy.Block;
+	View = copy.View;
+	ViewSize = copy.ViewSize;
 	return *this;
 }
 
@@ -1591,6 +1854,11 @@ FileData::FileData (const FString &source)
 {
 }
 
+FileData::FileData (const char *view, size_t size)
+: View (view), ViewSize (size)
+{
+}
+
 FileData::~FileData ()
 {
 }
@@ -1669,3 +1937,92 @@ FResourceLump* FileSystem::GetFileAt(int no)
 	return FileInfo[no].lump;
 }
 
+//==========================================================================
+//
+// CCMD benchlumplookup
+//
+// Looks up every full name of the current lump set, once with the lump
+// indices and once with the separately chained hash tables and case
+// insensitive compares they replaced, and prints the throughput of both.
+//
+//==========================================================================
+
+CCMD(benchlumplookup)
+{
+	int passes = argv.argc() > 1 ? std::max(1, atoi(argv[1])) : 20;
+	uint32_t numlumps = fileSystem.GetNumEntries();
+	if (numlumps == 0) return;
+
+	TArray<const char *> names;
+	TArray<FString> noextnames;
+	for (uint32_t i = 0; i < numlumps; i++)
+	{
+		auto name = fileSystem.GetFileFullName(i, false);
+		if (name == nullptr) continue;
+		names.Push(name);
+		FString noext = name;
+		auto dot = noext.LastIndexOf('.');
+		if (dot > noext.LastIndexOf('/')) noext.Truncate(dot);
+		noextnames.Push(noext);
+	}
+	if (names.Size() == 0) return;
+
+	// Set up the old hash chains for comparison.
+	TArray<uint32_t> chains(numlumps * 4, true);
+	memset(chains.Data(), -1, chains.Size() * sizeof(uint32_t));
+	uint32_t *first = &chains[0], *next = &chains[numlumps];
+	uint32_t *firstNoExt = &chains[numlumps * 2], *nextNoExt = &chains[numlumps * 3];
+	for (uint32_t i = 0, n = 0; i < numlumps; i++)
+	{
+		if (fileSystem.GetFileFullName(i, false) == nullptr) continue;
+		uint32_t j = MakeKey(names[n]) % numlumps;
+		next[i] = first[j];
+		first[j] = i;
+		j = MakeKey(noextnames[n]) % numlumps;
+		nextNoExt[i] = firstNoExt[j];
+		firstNoExt[j] = i;
+		n++;
+	}
+
+	auto chainlookup = [&](const char *name, bool ignoreext)
+	{
+		uint32_t *fli = ignoreext ? firstNoExt : first;
+		uint32_t *nli = ignoreext ? nextNoExt : next;
+		auto len = strlen(name);
+		uint32_t i;
+
+		for (i = fli[MakeKey(name) % numlumps]; i != NULL_INDEX; i = nli[i])
+		{
+			const char *longName = fileSystem.GetFileFullName(i, false);
+			if (strnicmp(name, longName, len)) continue;
+			if (longName[len] == 0) break;
+			if (ignoreext && longName[len] == '.' && strpbrk(longName + len + 1, "./") == nullptr) break;
+		}
+		return i != NULL_INDEX ? (int)i : -1;
+	};
+
+	for (int ignoreext = 0; ignoreext < 2; ignoreext++)
+	{
+		int64_t checksum[2] = {};
+		uint64_t time[2];
+
+		for (int method = 0; method < 2; method++)
+		{
+			uint64_t start = I_nsTime();
+			for (int pass = 0; pass < passes; pass++)
+			{
+				for (unsigned i = 0; i < names.Size(); i++)
+				{
+					const char *name = ignoreext ? noextnames[i].GetChars() : names[i];
+					checksum[method] += method == 0 ? chainlookup(name, !!ignoreext) : fileSystem.CheckNumForFullName(name, false, ns_global, !!ignoreext);
+				}
+			}
+			time[method] = std::max<uint64_t>(I_nsTime() - start, 1);
+		}
+		double lookups = double(names.Size()) * passes;
+		Printf("%s: %u names, hash chains %.2f Mlookups/s, index %.2f Mlookups/s (%.2fx)%s\n",
+			ignoreext ? "Without extension" : "Full name", names.Size(),
+			lookups * 1e3 / time[0], lookups * 1e3 / time[1], double(time[0]) / time[1],
+			checksum[0] != checksum[1] ? TEXTCOLOR_RED " - results differ!" : "");
+	}
+}
@@ -36,18 +36,119 @@ public:
 	FileData (const FileData &copy);
 	FileData &operator= (const FileData &copy);
 	~FileData ();
-	void *GetMem () { return Block.Len() == 0 ? NULL : (void *)Block.GetChars(); }
-	size_t GetSize () { return Block.Len(); }
-	const FString &GetString () const { return Block; }
+	void *GetMem () { return View != nullptr ? (void *)View : Block.Len() == 0 ? NULL : (void *)Block.GetChars(); }
+	size_t GetSize () { return View != nullptr ? ViewSize : Block.Len(); }
+	FString GetString () const { return View != nullptr ? FString(View, ViewSize) : Block; }
 
 private:
 	FileData (const FString &source);
+	FileData (const char *view, size_t size);
 
 	FString Block;
+	const char *View = nullptr;	// points into a memory mapped archive, see ReadFileView.
+	size_t ViewSize = 0;
 
 	friend class FileSystem;
 };
 
+struct FOpenedResource;
+
+// Keeps the lumps read by FileSystem::PrefetchFiles in the cache.
+class FPrefetchedFiles
+{
+public:
+	FPrefetchedFiles() = default;
+	FPrefetchedFiles(FPrefetchedFiles &&other) = default;
+	FPrefetchedFiles &operator=(FPrefetchedFiles &&other)
+	{
+		Release();
+		Lumps = std::move(other.Lumps);
+		return *this;
+	}
+	~FPrefetchedFiles() { Release(); }
+	void Release();
+
+private:
+	TArray<FResourceLump *> Lumps;
+
+	friend class FileSystem;
+};
+
+// Open addressing hash table for lump lookups. Every distinct key occupies
+// one slot holding the newest lump with that key, older lumps with the same
+// key are chained through Next(), so there is only a single key comparison
+// per lookup unless two keys have the same hash.
+class FLumpIndex
+{
+public:
+	static const uint32_t Empty = 0xffffffff;
+
+	void Init(unsigned numlumps)
+	{
+		unsigned size = 16;
+		while (size < numlumps * 2) size <<= 1;
+		Slots.Resize(size);
+		for (auto &slot : Slots) slot = { 0, Empty };
+		NextLump.Resize(numlumps);
+		for (auto &next : NextLump) next = Empty;
+		Mask = size - 1;
+	}
+
+	void Clear()
+	{
+		Slots.Reset();
+		NextLump.Reset();
+		Mask = 0;
+	}
+
+	// 'equal' compares the key of the given lump with the one being inserted.
+	template<class Equal> void Insert(uint32_t hash, uint32_t lump, Equal equal)
+	{
+		for (uint32_t i = hash & Mask; ; i = (i + 1) & Mask)
+		{
+			auto &slot = Slots[i];
+			if (slot.Lump == Empty)
+			{
+				slot = { hash, lump };
+				return;
+			}
+			if (slot.Hash == hash && equal(slot.Lump))
+			{
+				NextLump[lump] = slot.Lump;
+				slot.Lump = lump;
+				return;
+			}
+		}
+	}
+
+	// Returns the newest lump with a matching key or Empty.
+	template<class Equal> uint32_t Find(uint32_t hash, Equal equal) const
+	{
+		if (Slots.Size() == 0) return Empty;
+		for (uint32_t i = hash & Mask; ; i = (i + 1) & Mask)
+		{
+			auto &slot = Slots[i];
+			if (slot.Lump == Empty) return Empty;
+			if (slot.Hash == hash && equal(slot.Lump)) return slot.Lump;
+		}
+	}
+
+	uint32_t Next(uint32_t lump) const
+	{
+		return NextLump[lump];
+	}
+
+private:
+	struct Slot
+	{
+		uint32_t Hash;
+		uint32_t Lump;
+	};
+	TArray<Slot> Slots;
+	TArray<uint32_t> NextLump;
+	uint32_t Mask = 0;
+};
+
 struct FolderEntry
 {
 	const char *name;
@@ -133,6 +234,7 @@ public:
 	TArray<uint8_t> GetFileData(int lump, int pad = 0);	// reads lump into a writable buffer and optionally adds some padding at the end. (FileData isn't writable!)
 	FileData ReadFile (int lump);
 	FileData ReadFile (const char *name) { return ReadFile (GetNumForName (name)); }
+	FileData ReadFileView (int lump);	// same as ReadFile but avoids the copy where possible. The result is not null terminated!
 
 	inline TArray<uint8_t> LoadFile(const char* name, int padding = 0)
 	{
@@ -141,6 +243,8 @@ public:
 		return GetFileData(lump, padding);
 	}
 
+	FPrefetchedFiles PrefetchFiles(const TArray<int> &lumps);	// caches the lumps, decompressing them in parallel.
+
 	FileReader OpenFileReader(int lump);		// opens a reader that redirects to the containing file's one.
 	FileReader ReopenFileReader(int lump, bool alwayscache = false);		// opens an independent reader.
 	FileReader OpenFileReader(const char* name);
@@ -198,17 +302,22 @@ protected:
 	TArray<LumpRecord> FileInfo;
 
 	TArray<uint32_t> Hashes;	// one allocation for all hash lists.
-	uint32_t *FirstLumpIndex;	// [RH] Hashing stuff moved out of lumpinfo structure
-	uint32_t *NextLumpIndex;
-
-	uint32_t *FirstLumpIndex_FullName;	// The same information for fully qualified paths from .zips
-	uint32_t *NextLumpIndex_FullName;
+	uint32_t* FirstLumpIndex_ResId;	// [RH] Hashing stuff moved out of lumpinfo structure
+	uint32_t* NextLumpIndex_ResId;
 
-	uint32_t *FirstLumpIndex_NoExt;	// The same information for fully qualified paths from .zips
-	uint32_t *NextLumpIndex_NoExt;
+	FLumpIndex ShortNameIndex;	// keyed by short name and namespace
+	FLumpIndex FullNameIndex;	// keyed by the lower case full path
+	FLumpIndex NoExtIndex;		// keyed by the lower case full path without extension
 
-	uint32_t* FirstLumpIndex_ResId;	// The same information for fully qualified paths from .zips
-	uint32_t* NextLumpIndex_ResId;
+	// Lower case copies of all full paths, so that lookups can compare them with memcmp.
+	struct FoldedName
+	{
+		uint32_t Offset;
+		uint32_t Length;
+		uint32_t NoExtLength;
+	};
+	TArray<char> FoldedNameData;
+	TArray<FoldedName> FoldedNames;
 
 	uint32_t NumEntries = 0;					// Not necessarily the same as FileInfo.Size()
 	uint32_t NumWads;
@@ -217,8 +326,12 @@ protected:
 	int MaxIwadIndex = -1;
 
 private:
+	void AddResource(const char *filename, FOpenedResource &res, bool quiet, LumpFilterInfo *filter);
 	void DeleteAll();
 	void MoveLumpsInFolder(const char *);
+	static uint32_t ShortNameHash(uint64_t qname, int space);
+	uint32_t FindShortName(uint64_t qname, int space) const;
+	uint32_t FindFullName(const char *name, bool noext) const;
 
 };
 
@@ -35,10 +35,14 @@
 */
 
 #include <zlib.h>
+#include <mutex>
 #include "resourcefile.h"
 #include "cmdlib.h"
 #include "md5.h"
 
+// Lumps may be read from several threads, e.g. by the texture precacher.
+static std::recursive_mutex LumpCacheMutex;
+
 
 //==========================================================================
 //
@@ -187,6 +191,7 @@ FileReader FResourceLump::NewReader()
 
 void *FResourceLump::Lock()
 {
+	std::lock_guard<std::recursive_mutex> lock(LumpCacheMutex);
 	if (Cache != NULL)
 	{
 		if (RefCount > 0) RefCount++;
@@ -206,6 +211,7 @@ void *FResourceLump::Lock()
 
 int FResourceLump::Unlock()
 {
+	std::lock_guard<std::recursive_mutex> lock(LumpCacheMutex);
 	if (LumpSize > 0 && RefCount > 0)
 	{
 		if (--RefCount == 0)
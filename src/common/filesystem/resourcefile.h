@@ -17,6 +17,7 @@ struct LumpFilterInfo
 	TArray<FString> requiredPrefixes;
 	TArray<FString> embeddings;
 	std::function<void()> postprocessFunc;
+	bool useDirCache = false;	// store the directories of zip files in the cache folder
 };
 
 class FResourceFile;
@@ -114,6 +115,8 @@ public:
 	void LumpNameSetup(FString iname);
 	void CheckEmbedded(LumpFilterInfo* lfi);
 	virtual FCompressedBuffer GetRawData();
+	// If true, the data returned by GetRawData is compressed and can be decompressed on any thread.
+	virtual bool HasRawData() const { return false; }
 
 	void *Lock(); // validates the cache and increases the refcount.
 	int Unlock(); // decreases the refcount and frees the buffer
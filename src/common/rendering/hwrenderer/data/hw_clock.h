@@ -1,6 +1,7 @@
 #ifndef __GL_CLOCK_H
 #define __GL_CLOCK_H
 
+#include <atomic>
 #include "stats.h"
 #include "m_fixed.h"
 
@@ -14,8 +15,10 @@ extern glcycle_t Dirty;
 extern glcycle_t drawcalls, twoD, Flush3D;
 extern glcycle_t MTWait, WTTotal;
 
-extern int iter_dlightf, iter_dlight, draw_dlight, draw_dlightf;
-extern int rendered_lines,rendered_flats,rendered_sprites,rendered_decals,render_vertexsplit,render_texsplit;
+// these also get incremented by the BSP worker threads.
+extern std::atomic<int> iter_dlightf, iter_dlight, draw_dlight, draw_dlightf;
+extern std::atomic<int> rendered_lines, rendered_flats, render_texsplit;
+extern int rendered_sprites,rendered_decals,render_vertexsplit;
 extern int rendered_portals;
 
 extern int vertexcount, flatvertices, flatprimitives;
@@ -29,6 +29,8 @@
 #include "poly_thread.h"
 #include "screen_triangle.h"
 
+#include <thread>
+
 #ifndef NO_SSE
 #include <immintrin.h>
 #endif
@@ -44,6 +46,20 @@ void PolyTriangleThreadData::ClearDepth(float value)
 	int height = depthstencil->Height();
 	float *data = depthstencil->DepthValues();
 
+	if (tilebinning)
+	{
+		ForEachOwnedTile(0, 0, width, height, [&](int x0, int y0, int x1, int y1)
+		{
+			for (int y = y0; y < y1; y++)
+			{
+				float *line = data + (size_t)y * width;
+				for (int x = x0; x < x1; x++)
+					line[x] = value;
+			}
+		});
+		return;
+	}
+
 	int skip = skipped_by_thread(0);
 	int count = count_for_thread(0, height);
 
@@ -62,6 +78,16 @@ void PolyTriangleThreadData::ClearStencil(uint8_t value)
 	int height = depthstencil->Height();
 	uint8_t *data = depthstencil->StencilValues();
 
+	if (tilebinning)
+	{
+		ForEachOwnedTile(0, 0, width, height, [&](int x0, int y0, int x1, int y1)
+		{
+			for (int y = y0; y < y1; y++)
+				memset(data + (size_t)y * width + x0, value, x1 - x0);
+		});
+		return;
+	}
+
 	int skip = skipped_by_thread(0);
 	int count = count_for_thread(0, height);
 
@@ -253,13 +279,20 @@ void PolyTriangleThreadData::SetTexture(int unit, const void *pixels, int width,
 	textures[unit].bgra = bgra;
 }
 
-void PolyTriangleThreadData::DrawIndexed(int index, int vcount, PolyDrawMode drawmode)
+void PolyTriangleThreadData::DrawIndexed(int index, int vcount, PolyDrawMode drawmode, PolyTriangleBins *bins)
 {
 	if (vcount < 3)
 		return;
 
 	elements += index;
 
+	if (bins && tilebinning)
+	{
+		DrawBinned(bins, 0, drawmode, true);
+		elements += (drawmode == PolyDrawMode::Triangles) ? vcount / 3 * 3 : vcount;
+		return;
+	}
+
 	ShadedTriVertex vertbuffer[3];
 	ShadedTriVertex *vert[3] = { &vertbuffer[0], &vertbuffer[1], &vertbuffer[2] };
 	if (drawmode == PolyDrawMode::Triangles)
@@ -317,11 +350,17 @@ void PolyTriangleThreadData::DrawIndexed(int index, int vcount, PolyDrawMode dra
 	}
 }
 
-void PolyTriangleThreadData::Draw(int index, int vcount, PolyDrawMode drawmode)
+void PolyTriangleThreadData::Draw(int index, int vcount, PolyDrawMode drawmode, PolyTriangleBins *bins)
 {
 	if (vcount < 3)
 		return;
 
+	if (bins && tilebinning)
+	{
+		DrawBinned(bins, index, drawmode, false);
+		return;
+	}
+
 	int vinput = index;
 
 	ShadedTriVertex vertbuffer[3];
@@ -514,7 +553,7 @@ void PolyTriangleThreadData::DrawShadedLine(const ShadedTriVertex *const* vert)
 	{
 		int scrx = (int)x;
 		int scry = (int)y;
-		if (scrx >= clip.left && scrx < clip.right && scry >= clip.top && scry < clip.bottom && !line_skipped_by_thread(scry))
+		if (scrx >= clip.left && scrx < clip.right && scry >= clip.top && scry < clip.bottom && !pixel_skipped_by_thread(scrx, scry))
 		{
 			uint8_t *destpixel = dest + (scrx + scry * dest_width) * pixelsize;
 			if (pixelsize == 4)
@@ -644,7 +683,7 @@ void PolyTriangleThreadData::DrawShadedTriangle(const ShadedTriVertex *const* ve
 			args.v3 = &clippedvert[i - 2];
 			if (IsFrontfacing(&args) == ccw && args.CalculateGradients())
 			{
-				ScreenTriangle::Draw(&args, this);
+				DrawScreenTriangle(&args);
 			}
 		}
 	}
@@ -657,12 +696,162 @@ void PolyTriangleThreadData::DrawShadedTriangle(const ShadedTriVertex *const* ve
 			args.v3 = &clippedvert[i];
 			if (IsFrontfacing(&args) != ccw && args.CalculateGradients())
 			{
-				ScreenTriangle::Draw(&args, this);
+				DrawScreenTriangle(&args);
 			}
 		}
 	}
 }
 
+void PolyTriangleThreadData::DrawScreenTriangle(const TriDrawTriangleArgs *args)
+{
+	if (!binoutput)
+	{
+		ScreenTriangle::Draw(args, this);
+		return;
+	}
+
+	// Conservative bounding box of the pixels the triangle can touch
+	float minX = MIN(MIN(args->v1->x, args->v2->x), args->v3->x);
+	float maxX = MAX(MAX(args->v1->x, args->v2->x), args->v3->x);
+	float minY = MIN(MIN(args->v1->y, args->v2->y), args->v3->y);
+	float maxY = MAX(MAX(args->v1->y, args->v2->y), args->v3->y);
+	int x0 = MAX((int)floorf(minX), clip.left);
+	int x1 = MIN((int)ceilf(maxX) + 1, clip.right);
+	int y0 = MAX((int)(minY + 0.5f), clip.top);
+	int y1 = MIN((int)(maxY + 0.5f), clip.bottom);
+	if (x0 >= x1 || y0 >= y1)
+		return;
+
+	PolyBinnedTriangle tri;
+	tri.vertices[0] = *args->v1;
+	tri.vertices[1] = *args->v2;
+	tri.vertices[2] = *args->v3;
+	tri.gradientX = args->gradientX;
+	tri.gradientY = args->gradientY;
+	tri.worldNormal = mainVertexShader.vWorldNormal;
+	tri.tileLeft = x0 >> tile_shift;
+	tri.tileTop = y0 >> tile_shift;
+	tri.tileRight = (x1 - 1) >> tile_shift;
+	tri.tileBottom = (y1 - 1) >> tile_shift;
+
+	binoutput->tileLeft = MIN(binoutput->tileLeft, tri.tileLeft);
+	binoutput->tileTop = MIN(binoutput->tileTop, tri.tileTop);
+	binoutput->tileRight = MAX(binoutput->tileRight, tri.tileRight);
+	binoutput->tileBottom = MAX(binoutput->tileBottom, tri.tileBottom);
+	binoutput->triangles.push_back(tri);
+}
+
+void PolyTriangleThreadData::SetupBinnedChunk(PolyTriangleBins *bins, int chunk, int index, PolyDrawMode drawmode, bool indexed)
+{
+	int first = chunk * PolyTriangleBins::primitivesPerChunk;
+	int last = MIN(first + (int)PolyTriangleBins::primitivesPerChunk, bins->numPrimitives);
+	auto vertexIndex = [&](int i) { return indexed ? (int)elements[i] : index + i; };
+
+	binoutput = &bins->chunks[chunk];
+
+	ShadedTriVertex vertbuffer[3];
+	ShadedTriVertex *vert[3] = { &vertbuffer[0], &vertbuffer[1], &vertbuffer[2] };
+	if (drawmode == PolyDrawMode::Triangles)
+	{
+		for (int i = first; i < last; i++)
+		{
+			for (int j = 0; j < 3; j++)
+				*vert[j] = ShadeVertex(vertexIndex(i * 3 + j));
+			DrawShadedTriangle(vert, ccw);
+		}
+	}
+	else if (drawmode == PolyDrawMode::TriangleFan)
+	{
+		*vert[0] = ShadeVertex(vertexIndex(0));
+		*vert[1] = ShadeVertex(vertexIndex(first + 1));
+		for (int i = first; i < last; i++)
+		{
+			*vert[2] = ShadeVertex(vertexIndex(i + 2));
+			DrawShadedTriangle(vert, ccw);
+			std::swap(vert[1], vert[2]);
+		}
+	}
+	else if (drawmode == PolyDrawMode::TriangleStrip)
+	{
+		bool toggleccw = (first & 1) ? !ccw : ccw;
+		*vert[0] = ShadeVertex(vertexIndex(first));
+		*vert[1] = ShadeVertex(vertexIndex(first + 1));
+		for (int i = first; i < last; i++)
+		{
+			*vert[2] = ShadeVertex(vertexIndex(i + 2));
+			DrawShadedTriangle(vert, toggleccw);
+			ShadedTriVertex *vtmp = vert[0];
+			vert[0] = vert[1];
+			vert[1] = vert[2];
+			vert[2] = vtmp;
+			toggleccw = !toggleccw;
+		}
+	}
+
+	binoutput = nullptr;
+}
+
+void PolyTriangleThreadData::DrawBinned(PolyTriangleBins *bins, int index, PolyDrawMode drawmode, bool indexed)
+{
+	// Help setting up the triangles until all chunks have been claimed
+	int numchunks = (int)bins->chunks.size();
+	while (true)
+	{
+		int chunk = bins->nextChunk.fetch_add(1, std::memory_order_relaxed);
+		if (chunk >= numchunks)
+			break;
+		SetupBinnedChunk(bins, chunk, index, drawmode, indexed);
+		bins->doneChunks.fetch_add(1, std::memory_order_release);
+	}
+
+	// Wait for the chunks other slices are still working on
+	while (bins->doneChunks.load(std::memory_order_acquire) < numchunks)
+		std::this_thread::yield();
+
+	int tileLeft = INT_MAX, tileTop = INT_MAX, tileRight = INT_MIN, tileBottom = INT_MIN;
+	for (auto &chunk : bins->chunks)
+	{
+		tileLeft = MIN(tileLeft, chunk.tileLeft);
+		tileTop = MIN(tileTop, chunk.tileTop);
+		tileRight = MAX(tileRight, chunk.tileRight);
+		tileBottom = MAX(tileBottom, chunk.tileBottom);
+	}
+	if (tileLeft > tileRight || tileTop > tileBottom)
+		return;
+
+	int left = MAX(tileLeft << tile_shift, clip.left);
+	int top = MAX(tileTop << tile_shift, clip.top);
+	int right = MIN((tileRight + 1) << tile_shift, clip.right);
+	int bottom = MIN((tileBottom + 1) << tile_shift, clip.bottom);
+
+	// Rasterize one tile at a time so that its depth, stencil and color stay in the cache
+	TriDrawTriangleArgs args;
+	ForEachOwnedTile(left, top, right, bottom, [&](int x0, int y0, int x1, int y1)
+	{
+		int tx = x0 >> tile_shift;
+		int ty = y0 >> tile_shift;
+		for (auto &chunk : bins->chunks)
+		{
+			if (tx < chunk.tileLeft || tx > chunk.tileRight || ty < chunk.tileTop || ty > chunk.tileBottom)
+				continue;
+
+			for (auto &tri : chunk.triangles)
+			{
+				if (tx < tri.tileLeft || tx > tri.tileRight || ty < tri.tileTop || ty > tri.tileBottom)
+					continue;
+
+				args.v1 = &tri.vertices[0];
+				args.v2 = &tri.vertices[1];
+				args.v3 = &tri.vertices[2];
+				args.gradientX = tri.gradientX;
+				args.gradientY = tri.gradientY;
+				mainVertexShader.vWorldNormal = tri.worldNormal;
+				ScreenTriangle::DrawTile(&args, this, x0, y0, x1, y1);
+			}
+		}
+	});
+}
+
 int PolyTriangleThreadData::ClipEdge(const ShadedTriVertex *const* verts)
 {
 	// use barycentric weights for clipped vertices
@@ -819,6 +1008,15 @@ int PolyTriangleThreadData::ClipEdge(const ShadedTriVertex *const* verts)
 	return inputverts;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+
+PolyTriangleBins::PolyTriangleBins(int numPrimitives) : numPrimitives(numPrimitives)
+{
+	chunks.resize((numPrimitives + primitivesPerChunk - 1) / primitivesPerChunk);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
 PolyTriangleThreadData *PolyTriangleThreadData::Get(DrawerThread *thread)
 {
 	if (!thread->poly)
@@ -22,7 +22,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <climits>
 #include "poly_triangle.h"
+#include "screen_span.h"
 
 struct PolyLight
 {
@@ -31,6 +34,40 @@ struct PolyLight
 	float radius;
 };
 
+// Screen triangle that has been set up by one slice and is rasterized by all slices owning one of its tiles
+struct PolyBinnedTriangle
+{
+	ScreenTriVertex vertices[3];
+	ScreenTriangleStepVariables gradientX;
+	ScreenTriangleStepVariables gradientY;
+	FVector4 worldNormal;
+	int tileLeft, tileTop, tileRight, tileBottom; // inclusive tile range covered by the triangle
+};
+
+// The screen triangles of a single draw command in tile binning mode.
+//
+// Every slice executes the draw command, but the vertex shading, clipping and triangle setup
+// only happens once: each slice arriving at the command claims chunks of primitives until none
+// are left and then waits for the chunks that are still being worked on by other slices.
+class PolyTriangleBins
+{
+public:
+	enum { primitivesPerChunk = 32 };
+
+	PolyTriangleBins(int numPrimitives);
+
+	struct Chunk
+	{
+		std::vector<PolyBinnedTriangle> triangles;
+		int tileLeft = INT_MAX, tileTop = INT_MAX, tileRight = INT_MIN, tileBottom = INT_MIN;
+	};
+
+	int numPrimitives;
+	std::vector<Chunk> chunks;
+	std::atomic<int> nextChunk{ 0 };
+	std::atomic<int> doneChunks{ 0 };
+};
+
 class PolyTriangleThreadData
 {
 public:
@@ -67,8 +104,10 @@ public:
 	void PushStreamData(const StreamData &data, const PolyPushConstants &constants);
 	void PushMatrices(const VSMatrix &modelMatrix, const VSMatrix &normalModelMatrix, const VSMatrix &textureMatrix);
 
-	void DrawIndexed(int index, int count, PolyDrawMode mode);
-	void Draw(int index, int vcount, PolyDrawMode mode);
+	void DrawIndexed(int index, int count, PolyDrawMode mode, PolyTriangleBins *bins = nullptr);
+	void Draw(int index, int vcount, PolyDrawMode mode, PolyTriangleBins *bins = nullptr);
+
+	void SetTileBinning(bool on) { tilebinning = on; }
 
 	int32_t core;
 	int32_t num_cores;
@@ -97,6 +136,44 @@ public:
 		return MAX(c, 0);
 	}
 
+	// In tile binning mode the screen is split into square tiles instead of interleaved lines.
+	// Neighbouring tiles belong to different slices so that the load stays balanced.
+	enum { tile_shift = 6, tile_size = 1 << tile_shift };
+	bool tilebinning = false;
+
+	bool tile_skipped_by_thread(int tx, int ty)
+	{
+		return (tx + ty) % num_cores != core;
+	}
+
+	bool pixel_skipped_by_thread(int x, int y)
+	{
+		if (!tilebinning)
+			return line_skipped_by_thread(y);
+		return y < numa_start_y || y >= numa_end_y || tile_skipped_by_thread(x >> tile_shift, y >> tile_shift);
+	}
+
+	// Calls callback(x0, y0, x1, y1) for the part of each tile owned by this thread that is inside the rectangle
+	template<typename Callback>
+	void ForEachOwnedTile(int left, int top, int right, int bottom, const Callback &callback)
+	{
+		top = MAX(top, numa_start_y);
+		bottom = MIN(bottom, numa_end_y);
+		if (left >= right || top >= bottom)
+			return;
+
+		for (int ty = top >> tile_shift; ty <= (bottom - 1) >> tile_shift; ty++)
+		{
+			int y0 = MAX(ty << tile_shift, top);
+			int y1 = MIN((ty + 1) << tile_shift, bottom);
+			for (int tx = left >> tile_shift; tx <= (right - 1) >> tile_shift; tx++)
+			{
+				if (!tile_skipped_by_thread(tx, ty))
+					callback(MAX(tx << tile_shift, left), y0, MIN((tx + 1) << tile_shift, right), y1);
+			}
+		}
+	}
+
 	struct Scanline
 	{
 		float W[MAXWIDTH];
@@ -115,6 +192,9 @@ public:
 		uint8_t discard[MAXWIDTH];
 	} scanline;
 
+	// Span kernels for the instruction set of this CPU
+	const PolySpanKernels *span = GetPolySpanKernels();
+
 	static PolyTriangleThreadData *Get(DrawerThread *thread);
 
 	int dest_pitch = 0;
@@ -186,6 +266,9 @@ private:
 	void DrawShadedPoint(const ShadedTriVertex *const* vertex);
 	void DrawShadedLine(const ShadedTriVertex *const* vertices);
 	void DrawShadedTriangle(const ShadedTriVertex *const* vertices, bool ccw);
+	void DrawScreenTriangle(const TriDrawTriangleArgs *args);
+	void SetupBinnedChunk(PolyTriangleBins *bins, int chunk, int index, PolyDrawMode mode, bool indexed);
+	void DrawBinned(PolyTriangleBins *bins, int index, PolyDrawMode mode, bool indexed);
 	static bool IsDegenerate(const ShadedTriVertex *const* vertices);
 	static bool IsFrontfacing(TriDrawTriangleArgs *args);
 
@@ -201,4 +284,7 @@ private:
 	enum { max_additional_vertices = 16 };
 	float weightsbuffer[max_additional_vertices * 3 * 2];
 	float *weights = nullptr;
+
+	// Where DrawShadedTriangle puts its screen triangles while a chunk is set up for tile binning
+	PolyTriangleBins::Chunk *binoutput = nullptr;
 };
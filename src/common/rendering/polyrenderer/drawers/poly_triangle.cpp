@@ -30,6 +30,9 @@
 #include "poly_thread.h"
 #include "screen_triangle.h"
 
+// Set up triangles once per draw and rasterize them in screen tiles instead of having every thread process every triangle for its own lines
+CVAR(Bool, r_poly_tilebinning, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
+
 /////////////////////////////////////////////////////////////////////////////
 
 class PolyDrawerCommand : public DrawerCommand
@@ -301,28 +304,53 @@ private:
 	PolyPushConstants constants;
 };
 
+class PolySetTileBinningCommand : public PolyDrawerCommand
+{
+public:
+	PolySetTileBinningCommand(bool on) : on(on) { }
+	void Execute(DrawerThread* thread) override { PolyTriangleThreadData::Get(thread)->SetTileBinning(on); }
+
+private:
+	bool on;
+};
+
+// Lines and points are drawn directly by each thread, even in tile binning mode
+static int BinnedPrimitiveCount(int vcount, PolyDrawMode mode)
+{
+	if (vcount < 3)
+		return 0;
+	else if (mode == PolyDrawMode::Triangles)
+		return vcount / 3;
+	else if (mode == PolyDrawMode::TriangleFan || mode == PolyDrawMode::TriangleStrip)
+		return vcount - 2;
+	else
+		return 0;
+}
+
 class PolyDrawCommand : public PolyDrawerCommand
 {
 public:
-	PolyDrawCommand(int index, int count, PolyDrawMode mode) : index(index), count(count), mode(mode) { }
-	void Execute(DrawerThread* thread) override { PolyTriangleThreadData::Get(thread)->Draw(index, count, mode); }
+	PolyDrawCommand(int index, int count, PolyDrawMode mode, bool tilebinning) : index(index), count(count), mode(mode), bins(tilebinning ? BinnedPrimitiveCount(count, mode) : 0) { }
+	void Execute(DrawerThread* thread) override { PolyTriangleThreadData::Get(thread)->Draw(index, count, mode, bins.chunks.empty() ? nullptr : &bins); }
 
 private:
 	int index;
 	int count;
 	PolyDrawMode mode;
+	PolyTriangleBins bins;
 };
 
 class PolyDrawIndexedCommand : public PolyDrawerCommand
 {
 public:
-	PolyDrawIndexedCommand(int index, int count, PolyDrawMode mode) : index(index), count(count), mode(mode) { }
-	void Execute(DrawerThread* thread) override { PolyTriangleThreadData::Get(thread)->DrawIndexed(index, count, mode); }
+	PolyDrawIndexedCommand(int index, int count, PolyDrawMode mode, bool tilebinning) : index(index), count(count), mode(mode), bins(tilebinning ? BinnedPrimitiveCount(count, mode) : 0) { }
+	void Execute(DrawerThread* thread) override { PolyTriangleThreadData::Get(thread)->DrawIndexed(index, count, mode, bins.chunks.empty() ? nullptr : &bins); }
 
 private:
 	int index;
 	int count;
 	PolyDrawMode mode;
+	PolyTriangleBins bins;
 };
 
 /////////////////////////////////////////////////////////////////////////////
@@ -330,6 +358,12 @@ private:
 PolyCommandBuffer::PolyCommandBuffer(RenderMemory* frameMemory)
 {
 	mQueue = std::make_shared<DrawerCommandQueue>(frameMemory);
+
+	// The tiles are owned by other threads than the lines of the queues before and after this one.
+	mTileBinning = r_poly_tilebinning && r_multithreaded != 0;
+	if (mTileBinning)
+		mQueue->Push<GroupMemoryBarrierCommand>();
+	mQueue->Push<PolySetTileBinningCommand>(mTileBinning);
 }
 
 void PolyCommandBuffer::SetViewport(int x, int y, int width, int height, DCanvas *canvas, PolyDepthStencil *depthstencil, bool topdown)
@@ -455,15 +489,17 @@ void PolyCommandBuffer::ClearStencil(uint8_t value)
 
 void PolyCommandBuffer::Draw(int index, int vcount, PolyDrawMode mode)
 {
-	mQueue->Push<PolyDrawCommand>(index, vcount, mode);
+	mQueue->Push<PolyDrawCommand>(index, vcount, mode, mTileBinning);
 }
 
 void PolyCommandBuffer::DrawIndexed(int index, int count, PolyDrawMode mode)
 {
-	mQueue->Push<PolyDrawIndexedCommand>(index, count, mode);
+	mQueue->Push<PolyDrawIndexedCommand>(index, count, mode, mTileBinning);
 }
 
 void PolyCommandBuffer::Submit()
 {
+	if (mTileBinning)
+		mQueue->Push<GroupMemoryBarrierCommand>();
 	DrawerThreads::Execute(mQueue);
 }
@@ -77,6 +77,7 @@ public:
 
 private:
 	std::shared_ptr<DrawerCommandQueue> mQueue;
+	bool mTileBinning = false;
 };
 
 class PolyDepthStencil
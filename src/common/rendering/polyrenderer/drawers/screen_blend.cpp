@@ -215,312 +215,43 @@ void BlendColorOpaque(int y, int x0, int x1, PolyTriangleThreadData* thread)
 void BlendColorAdd_Src_InvSrc(int y, int x0, int x1, PolyTriangleThreadData* thread)
 {
 	uint32_t* line = (uint32_t*)thread->dest + y * (ptrdiff_t)thread->dest_pitch;
-	uint32_t* fragcolor = thread->scanline.FragColor;
-
-	int sseend = x0;
-
-#ifndef NO_SSE
-	int ssecount = ((x1 - x0) & ~1);
-	sseend = x0 + ssecount;
-	for (int x = x0; x < sseend; x += 2)
-	{
-		__m128i dst = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)&line[x]), _mm_setzero_si128());
-		__m128i src = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)&fragcolor[x]), _mm_setzero_si128());
-
-		__m128i srcscale = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
-		srcscale = _mm_add_epi16(srcscale, _mm_srli_epi16(srcscale, 7));
-		__m128i dstscale = _mm_sub_epi16(_mm_set1_epi16(256), srcscale);
-
-		__m128i out = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(src, srcscale), _mm_mullo_epi16(dst, dstscale)), _mm_set1_epi16(127)), 8);
-		_mm_storel_epi64((__m128i*)&line[x], _mm_packus_epi16(out, out));
-	}
-#endif
-
-	for (int x = sseend; x < x1; x++)
-	{
-		uint32_t dst = line[x];
-		uint32_t src = fragcolor[x];
-
-		uint32_t srcscale = APART(src);
-		srcscale += srcscale >> 7;
-		uint32_t dstscale = 256 - srcscale;
-
-		uint32_t a = ((APART(src) * srcscale + APART(dst) * dstscale) + 127) >> 8;
-		uint32_t r = ((RPART(src) * srcscale + RPART(dst) * dstscale) + 127) >> 8;
-		uint32_t g = ((GPART(src) * srcscale + GPART(dst) * dstscale) + 127) >> 8;
-		uint32_t b = ((BPART(src) * srcscale + BPART(dst) * dstscale) + 127) >> 8;
-
-		line[x] = MAKEARGB(a, r, g, b);
-	}
+	thread->span->BlendAdd_Src_InvSrc(line, thread->scanline.FragColor, x0, x1);
 }
 
 void BlendColorAdd_SrcCol_InvSrcCol(int y, int x0, int x1, PolyTriangleThreadData* thread)
 {
 	uint32_t* line = (uint32_t*)thread->dest + y * (ptrdiff_t)thread->dest_pitch;
-	uint32_t* fragcolor = thread->scanline.FragColor;
-
-	int sseend = x0;
-
-#ifndef NO_SSE
-	int ssecount = ((x1 - x0) & ~1);
-	sseend = x0 + ssecount;
-	for (int x = x0; x < sseend; x += 2)
-	{
-		__m128i dst = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & line[x]), _mm_setzero_si128());
-		__m128i src = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & fragcolor[x]), _mm_setzero_si128());
-
-		__m128i srcscale = src;
-		srcscale = _mm_add_epi16(srcscale, _mm_srli_epi16(srcscale, 7));
-		__m128i dstscale = _mm_sub_epi16(_mm_set1_epi16(256), srcscale);
-
-		__m128i out = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(src, srcscale), _mm_mullo_epi16(dst, dstscale)), _mm_set1_epi16(127)), 8);
-		_mm_storel_epi64((__m128i*) & line[x], _mm_packus_epi16(out, out));
-	}
-#endif
-
-	for (int x = sseend; x < x1; x++)
-	{
-		uint32_t dst = line[x];
-		uint32_t src = fragcolor[x];
-
-		uint32_t srcscale_a = APART(src);
-		uint32_t srcscale_r = RPART(src);
-		uint32_t srcscale_g = GPART(src);
-		uint32_t srcscale_b = BPART(src);
-		srcscale_a += srcscale_a >> 7;
-		srcscale_r += srcscale_r >> 7;
-		srcscale_g += srcscale_g >> 7;
-		srcscale_b += srcscale_b >> 7;
-		uint32_t dstscale_a = 256 - srcscale_a;
-		uint32_t dstscale_r = 256 - srcscale_r;
-		uint32_t dstscale_g = 256 - srcscale_g;
-		uint32_t dstscale_b = 256 - srcscale_b;
-
-		uint32_t a = ((APART(src) * srcscale_a + APART(dst) * dstscale_a) + 127) >> 8;
-		uint32_t r = ((RPART(src) * srcscale_r + RPART(dst) * dstscale_r) + 127) >> 8;
-		uint32_t g = ((GPART(src) * srcscale_g + GPART(dst) * dstscale_g) + 127) >> 8;
-		uint32_t b = ((BPART(src) * srcscale_b + BPART(dst) * dstscale_b) + 127) >> 8;
-
-		line[x] = MAKEARGB(a, r, g, b);
-	}
+	thread->span->BlendAdd_SrcCol_InvSrcCol(line, thread->scanline.FragColor, x0, x1);
 }
 
 void BlendColorAdd_Src_One(int y, int x0, int x1, PolyTriangleThreadData* thread)
 {
 	uint32_t* line = (uint32_t*)thread->dest + y * (ptrdiff_t)thread->dest_pitch;
-	uint32_t* fragcolor = thread->scanline.FragColor;
-
-	int sseend = x0;
-
-#ifndef NO_SSE
-	int ssecount = ((x1 - x0) & ~1);
-	sseend = x0 + ssecount;
-	for (int x = x0; x < sseend; x += 2)
-	{
-		__m128i dst = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & line[x]), _mm_setzero_si128());
-		__m128i src = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & fragcolor[x]), _mm_setzero_si128());
-
-		__m128i srcscale = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
-		srcscale = _mm_add_epi16(srcscale, _mm_srli_epi16(srcscale, 7));
-
-		__m128i out = _mm_add_epi16(_mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, srcscale), _mm_set1_epi16(127)), 8), dst);
-		_mm_storel_epi64((__m128i*) & line[x], _mm_packus_epi16(out, out));
-	}
-#endif
-
-	for (int x = sseend; x < x1; x++)
-	{
-		uint32_t dst = line[x];
-		uint32_t src = fragcolor[x];
-
-		uint32_t srcscale = APART(src);
-		srcscale += srcscale >> 7;
-
-		uint32_t a = MIN<int32_t>((((APART(src) * srcscale) + 127) >> 8) + APART(dst), 255);
-		uint32_t r = MIN<int32_t>((((RPART(src) * srcscale) + 127) >> 8) + RPART(dst), 255);
-		uint32_t g = MIN<int32_t>((((GPART(src) * srcscale) + 127) >> 8) + GPART(dst), 255);
-		uint32_t b = MIN<int32_t>((((BPART(src) * srcscale) + 127) >> 8) + BPART(dst), 255);
-
-		line[x] = MAKEARGB(a, r, g, b);
-	}
+	thread->span->BlendAdd_Src_One(line, thread->scanline.FragColor, x0, x1);
 }
 
 void BlendColorAdd_SrcCol_One(int y, int x0, int x1, PolyTriangleThreadData* thread)
 {
 	uint32_t* line = (uint32_t*)thread->dest + y * (ptrdiff_t)thread->dest_pitch;
-	uint32_t* fragcolor = thread->scanline.FragColor;
-
-	int sseend = x0;
-
-#ifndef NO_SSE
-	int ssecount = ((x1 - x0) & ~1);
-	sseend = x0 + ssecount;
-	for (int x = x0; x < sseend; x += 2)
-	{
-		__m128i dst = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & line[x]), _mm_setzero_si128());
-		__m128i src = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & fragcolor[x]), _mm_setzero_si128());
-
-		__m128i srcscale = src;
-		srcscale = _mm_add_epi16(srcscale, _mm_srli_epi16(srcscale, 7));
-
-		__m128i out = _mm_add_epi16(_mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, srcscale), _mm_set1_epi16(127)), 8), dst);
-		_mm_storel_epi64((__m128i*) & line[x], _mm_packus_epi16(out, out));
-	}
-#endif
-
-	for (int x = sseend; x < x1; x++)
-	{
-		uint32_t dst = line[x];
-		uint32_t src = fragcolor[x];
-
-		uint32_t srcscale_a = APART(src);
-		uint32_t srcscale_r = RPART(src);
-		uint32_t srcscale_g = GPART(src);
-		uint32_t srcscale_b = BPART(src);
-		srcscale_a += srcscale_a >> 7;
-		srcscale_r += srcscale_r >> 7;
-		srcscale_g += srcscale_g >> 7;
-		srcscale_b += srcscale_b >> 7;
-
-		uint32_t a = MIN<int32_t>((((APART(src) * srcscale_a) + 127) >> 8) + APART(dst), 255);
-		uint32_t r = MIN<int32_t>((((RPART(src) * srcscale_r) + 127) >> 8) + RPART(dst), 255);
-		uint32_t g = MIN<int32_t>((((GPART(src) * srcscale_g) + 127) >> 8) + GPART(dst), 255);
-		uint32_t b = MIN<int32_t>((((BPART(src) * srcscale_b) + 127) >> 8) + BPART(dst), 255);
-
-		line[x] = MAKEARGB(a, r, g, b);
-	}
+	thread->span->BlendAdd_SrcCol_One(line, thread->scanline.FragColor, x0, x1);
 }
 
 void BlendColorAdd_DstCol_Zero(int y, int x0, int x1, PolyTriangleThreadData* thread)
 {
 	uint32_t* line = (uint32_t*)thread->dest + y * (ptrdiff_t)thread->dest_pitch;
-	uint32_t* fragcolor = thread->scanline.FragColor;
-
-	int sseend = x0;
-
-#ifndef NO_SSE
-	int ssecount = ((x1 - x0) & ~1);
-	sseend = x0 + ssecount;
-	for (int x = x0; x < sseend; x += 2)
-	{
-		__m128i dst = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & line[x]), _mm_setzero_si128());
-		__m128i src = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & fragcolor[x]), _mm_setzero_si128());
-
-		__m128i srcscale = dst;
-		srcscale = _mm_add_epi16(srcscale, _mm_srli_epi16(srcscale, 7));
-
-		__m128i out = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, srcscale), _mm_set1_epi16(127)), 8);
-		_mm_storel_epi64((__m128i*) & line[x], _mm_packus_epi16(out, out));
-	}
-#endif
-
-	for (int x = sseend; x < x1; x++)
-	{
-		uint32_t dst = line[x];
-		uint32_t src = fragcolor[x];
-
-		uint32_t srcscale_a = APART(dst);
-		uint32_t srcscale_r = RPART(dst);
-		uint32_t srcscale_g = GPART(dst);
-		uint32_t srcscale_b = BPART(dst);
-		srcscale_a += srcscale_a >> 7;
-		srcscale_r += srcscale_r >> 7;
-		srcscale_g += srcscale_g >> 7;
-		srcscale_b += srcscale_b >> 7;
-
-		uint32_t a = (((APART(src) * srcscale_a) + 127) >> 8);
-		uint32_t r = (((RPART(src) * srcscale_r) + 127) >> 8);
-		uint32_t g = (((GPART(src) * srcscale_g) + 127) >> 8);
-		uint32_t b = (((BPART(src) * srcscale_b) + 127) >> 8);
-
-		line[x] = MAKEARGB(a, r, g, b);
-	}
+	thread->span->BlendAdd_DstCol_Zero(line, thread->scanline.FragColor, x0, x1);
 }
 
 void BlendColorAdd_InvDstCol_Zero(int y, int x0, int x1, PolyTriangleThreadData* thread)
 {
 	uint32_t* line = (uint32_t*)thread->dest + y * (ptrdiff_t)thread->dest_pitch;
-	uint32_t* fragcolor = thread->scanline.FragColor;
-
-	int sseend = x0;
-
-#ifndef NO_SSE
-	int ssecount = ((x1 - x0) & ~1);
-	sseend = x0 + ssecount;
-	for (int x = x0; x < sseend; x += 2)
-	{
-		__m128i dst = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & line[x]), _mm_setzero_si128());
-		__m128i src = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & fragcolor[x]), _mm_setzero_si128());
-
-		__m128i srcscale = _mm_sub_epi16(_mm_set1_epi16(255), dst);
-		srcscale = _mm_add_epi16(srcscale, _mm_srli_epi16(srcscale, 7));
-
-		__m128i out = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, srcscale), _mm_set1_epi16(127)), 8);
-		_mm_storel_epi64((__m128i*) & line[x], _mm_packus_epi16(out, out));
-	}
-#endif
-
-	for (int x = sseend; x < x1; x++)
-	{
-		uint32_t dst = line[x];
-		uint32_t src = fragcolor[x];
-
-		uint32_t srcscale_a = 255 - APART(dst);
-		uint32_t srcscale_r = 255 - RPART(dst);
-		uint32_t srcscale_g = 255 - GPART(dst);
-		uint32_t srcscale_b = 255 - BPART(dst);
-		srcscale_a += srcscale_a >> 7;
-		srcscale_r += srcscale_r >> 7;
-		srcscale_g += srcscale_g >> 7;
-		srcscale_b += srcscale_b >> 7;
-
-		uint32_t a = (((APART(src) * srcscale_a) + 127) >> 8);
-		uint32_t r = (((RPART(src) * srcscale_r) + 127) >> 8);
-		uint32_t g = (((GPART(src) * srcscale_g) + 127) >> 8);
-		uint32_t b = (((BPART(src) * srcscale_b) + 127) >> 8);
-
-		line[x] = MAKEARGB(a, r, g, b);
-	}
+	thread->span->BlendAdd_InvDstCol_Zero(line, thread->scanline.FragColor, x0, x1);
 }
 
 void BlendColorRevSub_Src_One(int y, int x0, int x1, PolyTriangleThreadData* thread)
 {
 	uint32_t* line = (uint32_t*)thread->dest + y * (ptrdiff_t)thread->dest_pitch;
-	uint32_t* fragcolor = thread->scanline.FragColor;
-
-	int sseend = x0;
-
-#ifndef NO_SSE
-	int ssecount = ((x1 - x0) & ~1);
-	sseend = x0 + ssecount;
-	for (int x = x0; x < sseend; x += 2)
-	{
-		__m128i dst = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & line[x]), _mm_setzero_si128());
-		__m128i src = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & fragcolor[x]), _mm_setzero_si128());
-
-		__m128i srcscale = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
-		srcscale = _mm_add_epi16(srcscale, _mm_srli_epi16(srcscale, 7));
-
-		__m128i out = _mm_sub_epi16(dst, _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, srcscale), _mm_set1_epi16(127)), 8));
-		_mm_storel_epi64((__m128i*) & line[x], _mm_packus_epi16(out, out));
-	}
-#endif
-
-	for (int x = sseend; x < x1; x++)
-	{
-		uint32_t dst = line[x];
-		uint32_t src = fragcolor[x];
-
-		uint32_t srcscale = APART(src);
-		srcscale += srcscale >> 7;
-
-		uint32_t a = MAX<int32_t>(APART(dst) - (((APART(src) * srcscale) + 127) >> 8), 0);
-		uint32_t r = MAX<int32_t>(RPART(dst) - (((RPART(src) * srcscale) + 127) >> 8), 0);
-		uint32_t g = MAX<int32_t>(GPART(dst) - (((GPART(src) * srcscale) + 127) >> 8), 0);
-		uint32_t b = MAX<int32_t>(BPART(dst) - (((BPART(src) * srcscale) + 127) >> 8), 0);
-
-		line[x] = MAKEARGB(a, r, g, b);
-	}
+	thread->span->BlendRevSub_Src_One(line, thread->scanline.FragColor, x0, x1);
 }
 
 void BlendColorColormap(int y, int x0, int x1, PolyTriangleThreadData* thread)
@@ -164,6 +164,12 @@ static void FuncNormal(int x0, int x1, PolyTriangleThreadData* thread)
 	uint16_t* u = thread->scanline.U;
 	uint16_t* v = thread->scanline.V;
 
+	if (texBgra)
+	{
+		thread->span->SampleBgra(fragcolor, u, v, static_cast<const uint32_t*>(texPixels), texWidth, texHeight, x0, x1);
+		return;
+	}
+
 	for (int x = x0; x < x1; x++)
 	{
 		uint32_t texel = SampleTexture(u[x], v[x], texPixels, texWidth, texHeight, texBgra);
@@ -357,13 +363,7 @@ static void FuncNormal_DesaturationFactor(int x0, int x1, PolyTriangleThreadData
 
 static void RunAlphaTest(int x0, int x1, PolyTriangleThreadData* thread)
 {
-	uint32_t alphaThreshold = thread->AlphaThreshold;
-	uint32_t* fragcolor = thread->scanline.FragColor;
-	uint8_t* discard = thread->scanline.discard;
-	for (int x = x0; x < x1; x++)
-	{
-		discard[x] = fragcolor[x] <= alphaThreshold;
-	}
+	thread->span->AlphaTest(thread->scanline.discard, thread->scanline.FragColor, thread->AlphaThreshold, x0, x1);
 }
 
 static void ProcessMaterial(int x0, int x1, PolyTriangleThreadData* thread)
@@ -429,27 +429,7 @@ static void GetLightColor(int x0, int x1, PolyTriangleThreadData* thread)
 
 	if (thread->PushConstants->uFogEnabled >= 0)
 	{
-		for (int x = x0; x < x1; x++)
-		{
-			uint32_t fg = fragcolor[x];
-			uint32_t lightshade = lightarray[x];
-
-			uint32_t mulA = APART(lightshade);
-			uint32_t mulR = RPART(lightshade);
-			uint32_t mulG = GPART(lightshade);
-			uint32_t mulB = BPART(lightshade);
-			mulA += mulA >> 7;
-			mulR += mulR >> 7;
-			mulG += mulG >> 7;
-			mulB += mulB >> 7;
-
-			uint32_t a = (APART(fg) * mulA + 127) >> 8;
-			uint32_t r = (RPART(fg) * mulR + 127) >> 8;
-			uint32_t g = (GPART(fg) * mulG + 127) >> 8;
-			uint32_t b = (BPART(fg) * mulB + 127) >> 8;
-
-			fragcolor[x] = MAKEARGB(a, r, g, b);
-		}
+		thread->span->ModulateLight(fragcolor, lightarray, x0, x1);
 	}
 	else
 	{
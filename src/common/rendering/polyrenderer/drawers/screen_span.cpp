@@ -0,0 +1,807 @@
+/*
+**  Polygon Doom software renderer
+**  Copyright (c) 2026 The GZDoom Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+*/
+
+#include <stddef.h>
+#include "templates.h"
+#include "poly_thread.h"
+#include "screen_span.h"
+#include "x86.h"
+#include "c_dispatch.h"
+#include "printf.h"
+#include "i_time.h"
+#include <string.h>
+#include <vector>
+
+#ifndef NO_SSE
+#include <immintrin.h>
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+// Scalar kernels
+
+static int ScalarDepthPassEnd(const float* zbuffer, const float* w, float depthbias, int x, int xend)
+{
+	while (x < xend && zbuffer[x] >= w[x] + depthbias)
+		x++;
+	return x;
+}
+
+static int ScalarDepthFailEnd(const float* zbuffer, const float* w, float depthbias, int x, int xend)
+{
+	while (x < xend && zbuffer[x] < w[x] + depthbias)
+		x++;
+	return x;
+}
+
+static int ScalarStencilPassEnd(const uint8_t* stencil, uint8_t value, int x, int xend)
+{
+	while (x < xend && stencil[x] == value)
+		x++;
+	return x;
+}
+
+static int ScalarStencilFailEnd(const uint8_t* stencil, uint8_t value, int x, int xend)
+{
+	while (x < xend && stencil[x] != value)
+		x++;
+	return x;
+}
+
+static void ScalarSampleBgra(uint32_t* fragcolor, const uint16_t* u, const uint16_t* v, const uint32_t* texels, int texWidth, int texHeight, int x0, int x1)
+{
+	for (int x = x0; x < x1; x++)
+	{
+		int texelX = (u[x] * (uint32_t)texWidth) >> 16;
+		int texelY = (v[x] * (uint32_t)texHeight) >> 16;
+		fragcolor[x] = texels[texelX + texelY * texWidth];
+	}
+}
+
+static void ScalarModulateLight(uint32_t* fragcolor, const uint32_t* lightarray, int x0, int x1)
+{
+	for (int x = x0; x < x1; x++)
+	{
+		uint32_t fg = fragcolor[x];
+		uint32_t lightshade = lightarray[x];
+
+		uint32_t mulA = APART(lightshade);
+		uint32_t mulR = RPART(lightshade);
+		uint32_t mulG = GPART(lightshade);
+		uint32_t mulB = BPART(lightshade);
+		mulA += mulA >> 7;
+		mulR += mulR >> 7;
+		mulG += mulG >> 7;
+		mulB += mulB >> 7;
+
+		uint32_t a = (APART(fg) * mulA + 127) >> 8;
+		uint32_t r = (RPART(fg) * mulR + 127) >> 8;
+		uint32_t g = (GPART(fg) * mulG + 127) >> 8;
+		uint32_t b = (BPART(fg) * mulB + 127) >> 8;
+
+		fragcolor[x] = MAKEARGB(a, r, g, b);
+	}
+}
+
+static void ScalarAlphaTest(uint8_t* discard, const uint32_t* fragcolor, uint32_t threshold, int x0, int x1)
+{
+	for (int x = x0; x < x1; x++)
+	{
+		discard[x] = fragcolor[x] <= threshold;
+	}
+}
+
+static void ScalarBlendAdd_Src_InvSrc(uint32_t* line, const uint32_t* fragcolor, int x0, int x1)
+{
+	for (int x = x0; x < x1; x++)
+	{
+		uint32_t dst = line[x];
+		uint32_t src = fragcolor[x];
+
+		uint32_t srcscale = APART(src);
+		srcscale += srcscale >> 7;
+		uint32_t dstscale = 256 - srcscale;
+
+		uint32_t a = ((APART(src) * srcscale + APART(dst) * dstscale) + 127) >> 8;
+		uint32_t r = ((RPART(src) * srcscale + RPART(dst) * dstscale) + 127) >> 8;
+		uint32_t g = ((GPART(src) * srcscale + GPART(dst) * dstscale) + 127) >> 8;
+		uint32_t b = ((BPART(src) * srcscale + BPART(dst) * dstscale) + 127) >> 8;
+
+		line[x] = MAKEARGB(a, r, g, b);
+	}
+}
+
+static void ScalarBlendAdd_SrcCol_InvSrcCol(uint32_t* line, const uint32_t* fragcolor, int x0, int x1)
+{
+	for (int x = x0; x < x1; x++)
+	{
+		uint32_t dst = line[x];
+		uint32_t src = fragcolor[x];
+
+		uint32_t srcscale_a = APART(src);
+		uint32_t srcscale_r = RPART(src);
+		uint32_t srcscale_g = GPART(src);
+		uint32_t srcscale_b = BPART(src);
+		srcscale_a += srcscale_a >> 7;
+		srcscale_r += srcscale_r >> 7;
+		srcscale_g += srcscale_g >> 7;
+		srcscale_b += srcscale_b >> 7;
+		uint32_t dstscale_a = 256 - srcscale_a;
+		uint32_t dstscale_r = 256 - srcscale_r;
+		uint32_t dstscale_g = 256 - srcscale_g;
+		uint32_t dstscale_b = 256 - srcscale_b;
+
+		uint32_t a = ((APART(src) * srcscale_a + APART(dst) * dstscale_a) + 127) >> 8;
+		uint32_t r = ((RPART(src) * srcscale_r + RPART(dst) * dstscale_r) + 127) >> 8;
+		uint32_t g = ((GPART(src) * srcscale_g + GPART(dst) * dstscale_g) + 127) >> 8;
+		uint32_t b = ((BPART(src) * srcscale_b + BPART(dst) * dstscale_b) + 127) >> 8;
+
+		line[x] = MAKEARGB(a, r, g, b);
+	}
+}
+
+static void ScalarBlendAdd_Src_One(uint32_t* line, const uint32_t* fragcolor, int x0, int x1)
+{
+	for (int x = x0; x < x1; x++)
+	{
+		uint32_t dst = line[x];
+		uint32_t src = fragcolor[x];
+
+		uint32_t srcscale = APART(src);
+		srcscale += srcscale >> 7;
+
+		uint32_t a = MIN<int32_t>((((APART(src) * srcscale) + 127) >> 8) + APART(dst), 255);
+		uint32_t r = MIN<int32_t>((((RPART(src) * srcscale) + 127) >> 8) + RPART(dst), 255);
+		uint32_t g = MIN<int32_t>((((GPART(src) * srcscale) + 127) >> 8) + GPART(dst), 255);
+		uint32_t b = MIN<int32_t>((((BPART(src) * srcscale) + 127) >> 8) + BPART(dst), 255);
+
+		line[x] = MAKEARGB(a, r, g, b);
+	}
+}
+
+static void ScalarBlendAdd_SrcCol_One(uint32_t* line, const uint32_t* fragcolor, int x0, int x1)
+{
+	for (int x = x0; x < x1; x++)
+	{
+		uint32_t dst = line[x];
+		uint32_t src = fragcolor[x];
+
+		uint32_t srcscale_a = APART(src);
+		uint32_t srcscale_r = RPART(src);
+		uint32_t srcscale_g = GPART(src);
+		uint32_t srcscale_b = BPART(src);
+		srcscale_a += srcscale_a >> 7;
+		srcscale_r += srcscale_r >> 7;
+		srcscale_g += srcscale_g >> 7;
+		srcscale_b += srcscale_b >> 7;
+
+		uint32_t a = MIN<int32_t>((((APART(src) * srcscale_a) + 127) >> 8) + APART(dst), 255);
+		uint32_t r = MIN<int32_t>((((RPART(src) * srcscale_r) + 127) >> 8) + RPART(dst), 255);
+		uint32_t g = MIN<int32_t>((((GPART(src) * srcscale_g) + 127) >> 8) + GPART(dst), 255);
+		uint32_t b = MIN<int32_t>((((BPART(src) * srcscale_b) + 127) >> 8) + BPART(dst), 255);
+
+		line[x] = MAKEARGB(a, r, g, b);
+	}
+}
+
+static void ScalarBlendAdd_DstCol_Zero(uint32_t* line, const uint32_t* fragcolor, int x0, int x1)
+{
+	for (int x = x0; x < x1; x++)
+	{
+		uint32_t dst = line[x];
+		uint32_t src = fragcolor[x];
+
+		uint32_t srcscale_a = APART(dst);
+		uint32_t srcscale_r = RPART(dst);
+		uint32_t srcscale_g = GPART(dst);
+		uint32_t srcscale_b = BPART(dst);
+		srcscale_a += srcscale_a >> 7;
+		srcscale_r += srcscale_r >> 7;
+		srcscale_g += srcscale_g >> 7;
+		srcscale_b += srcscale_b >> 7;
+
+		uint32_t a = (((APART(src) * srcscale_a) + 127) >> 8);
+		uint32_t r = (((RPART(src) * srcscale_r) + 127) >> 8);
+		uint32_t g = (((GPART(src) * srcscale_g) + 127) >> 8);
+		uint32_t b = (((BPART(src) * srcscale_b) + 127) >> 8);
+
+		line[x] = MAKEARGB(a, r, g, b);
+	}
+}
+
+static void ScalarBlendAdd_InvDstCol_Zero(uint32_t* line, const uint32_t* fragcolor, int x0, int x1)
+{
+	for (int x = x0; x < x1; x++)
+	{
+		uint32_t dst = line[x];
+		uint32_t src = fragcolor[x];
+
+		uint32_t srcscale_a = 255 - APART(dst);
+		uint32_t srcscale_r = 255 - RPART(dst);
+		uint32_t srcscale_g = 255 - GPART(dst);
+		uint32_t srcscale_b = 255 - BPART(dst);
+		srcscale_a += srcscale_a >> 7;
+		srcscale_r += srcscale_r >> 7;
+		srcscale_g += srcscale_g >> 7;
+		srcscale_b += srcscale_b >> 7;
+
+		uint32_t a = (((APART(src) * srcscale_a) + 127) >> 8);
+		uint32_t r = (((RPART(src) * srcscale_r) + 127) >> 8);
+		uint32_t g = (((GPART(src) * srcscale_g) + 127) >> 8);
+		uint32_t b = (((BPART(src) * srcscale_b) + 127) >> 8);
+
+		line[x] = MAKEARGB(a, r, g, b);
+	}
+}
+
+static void ScalarBlendRevSub_Src_One(uint32_t* line, const uint32_t* fragcolor, int x0, int x1)
+{
+	for (int x = x0; x < x1; x++)
+	{
+		uint32_t dst = line[x];
+		uint32_t src = fragcolor[x];
+
+		uint32_t srcscale = APART(src);
+		srcscale += srcscale >> 7;
+
+		uint32_t a = MAX<int32_t>(APART(dst) - (((APART(src) * srcscale) + 127) >> 8), 0);
+		uint32_t r = MAX<int32_t>(RPART(dst) - (((RPART(src) * srcscale) + 127) >> 8), 0);
+		uint32_t g = MAX<int32_t>(GPART(dst) - (((GPART(src) * srcscale) + 127) >> 8), 0);
+		uint32_t b = MAX<int32_t>(BPART(dst) - (((BPART(src) * srcscale) + 127) >> 8), 0);
+
+		line[x] = MAKEARGB(a, r, g, b);
+	}
+}
+
+const PolySpanKernels PolySpanScalar =
+{
+	"Scalar",
+	&ScalarDepthPassEnd,
+	&ScalarDepthFailEnd,
+	&ScalarStencilPassEnd,
+	&ScalarStencilFailEnd,
+	&ScalarSampleBgra,
+	&ScalarModulateLight,
+	&ScalarAlphaTest,
+	&ScalarBlendAdd_Src_InvSrc,
+	&ScalarBlendAdd_SrcCol_InvSrcCol,
+	&ScalarBlendAdd_Src_One,
+	&ScalarBlendAdd_SrcCol_One,
+	&ScalarBlendAdd_DstCol_Zero,
+	&ScalarBlendAdd_InvDstCol_Zero,
+	&ScalarBlendRevSub_Src_One
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// SSE2 kernels, 4 pixels at a time
+
+#ifndef NO_SSE
+
+static int SSE2DepthPassEnd(const float* zbuffer, const float* w, float depthbias, int x, int xend)
+{
+	__m128 mdepthbias = _mm_set1_ps(depthbias);
+	while (x + 4 <= xend)
+	{
+		int mask = _mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(zbuffer + x), _mm_add_ps(_mm_loadu_ps(w + x), mdepthbias)));
+		if (mask != 0xf)
+			return x + PolyFirstSetBit(~mask & 0xf);
+		x += 4;
+	}
+	return ScalarDepthPassEnd(zbuffer, w, depthbias, x, xend);
+}
+
+static int SSE2DepthFailEnd(const float* zbuffer, const float* w, float depthbias, int x, int xend)
+{
+	__m128 mdepthbias = _mm_set1_ps(depthbias);
+	while (x + 4 <= xend)
+	{
+		int mask = _mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(zbuffer + x), _mm_add_ps(_mm_loadu_ps(w + x), mdepthbias)));
+		if (mask != 0xf)
+			return x + PolyFirstSetBit(~mask & 0xf);
+		x += 4;
+	}
+	return ScalarDepthFailEnd(zbuffer, w, depthbias, x, xend);
+}
+
+static int SSE2StencilPassEnd(const uint8_t* stencil, uint8_t value, int x, int xend)
+{
+	__m128i mvalue = _mm_set1_epi8(value);
+	while (x + 16 <= xend)
+	{
+		int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(stencil + x)), mvalue));
+		if (mask != 0xffff)
+			return x + PolyFirstSetBit(~mask & 0xffff);
+		x += 16;
+	}
+	return ScalarStencilPassEnd(stencil, value, x, xend);
+}
+
+static int SSE2StencilFailEnd(const uint8_t* stencil, uint8_t value, int x, int xend)
+{
+	__m128i mvalue = _mm_set1_epi8(value);
+	while (x + 16 <= xend)
+	{
+		int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(stencil + x)), mvalue));
+		if (mask != 0)
+			return x + PolyFirstSetBit(mask);
+		x += 16;
+	}
+	return ScalarStencilFailEnd(stencil, value, x, xend);
+}
+
+static void SSE2ModulateLight(uint32_t* fragcolor, const uint32_t* lightarray, int x0, int x1)
+{
+	int sseend = x0 + ((x1 - x0) & ~3);
+	for (int x = x0; x < sseend; x += 4)
+	{
+		__m128i fg = _mm_loadu_si128((const __m128i*)&fragcolor[x]);
+		__m128i light = _mm_loadu_si128((const __m128i*)&lightarray[x]);
+
+		__m128i fglo = _mm_unpacklo_epi8(fg, _mm_setzero_si128());
+		__m128i fghi = _mm_unpackhi_epi8(fg, _mm_setzero_si128());
+		__m128i mullo = _mm_unpacklo_epi8(light, _mm_setzero_si128());
+		__m128i mulhi = _mm_unpackhi_epi8(light, _mm_setzero_si128());
+		mullo = _mm_add_epi16(mullo, _mm_srli_epi16(mullo, 7));
+		mulhi = _mm_add_epi16(mulhi, _mm_srli_epi16(mulhi, 7));
+
+		fglo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(fglo, mullo), _mm_set1_epi16(127)), 8);
+		fghi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(fghi, mulhi), _mm_set1_epi16(127)), 8);
+		_mm_storeu_si128((__m128i*)&fragcolor[x], _mm_packus_epi16(fglo, fghi));
+	}
+	ScalarModulateLight(fragcolor, lightarray, sseend, x1);
+}
+
+static void SSE2AlphaTest(uint8_t* discard, const uint32_t* fragcolor, uint32_t threshold, int x0, int x1)
+{
+	// SSE2 only has signed compares
+	__m128i signbit = _mm_set1_epi32(0x80000000);
+	__m128i mthreshold = _mm_xor_si128(_mm_set1_epi32(threshold), signbit);
+	int sseend = x0 + ((x1 - x0) & ~3);
+	for (int x = x0; x < sseend; x += 4)
+	{
+		__m128i fg = _mm_xor_si128(_mm_loadu_si128((const __m128i*)&fragcolor[x]), signbit);
+		__m128i keep = _mm_cmpgt_epi32(fg, mthreshold);
+		__m128i result = _mm_andnot_si128(keep, _mm_set1_epi32(1));
+		result = _mm_packs_epi32(result, result);
+		result = _mm_packus_epi16(result, result);
+		uint32_t bytes = _mm_cvtsi128_si32(result);
+		memcpy(discard + x, &bytes, 4);
+	}
+	ScalarAlphaTest(discard, fragcolor, threshold, sseend, x1);
+}
+
+// The blend operators work on two pixels with 16 bits per channel
+struct SSE2Blend_Src_InvSrc
+{
+	static __m128i Blend(__m128i src, __m128i dst)
+	{
+		__m128i srcscale = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		srcscale = _mm_add_epi16(srcscale, _mm_srli_epi16(srcscale, 7));
+		__m128i dstscale = _mm_sub_epi16(_mm_set1_epi16(256), srcscale);
+		return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(src, srcscale), _mm_mullo_epi16(dst, dstscale)), _mm_set1_epi16(127)), 8);
+	}
+};
+
+struct SSE2Blend_SrcCol_InvSrcCol
+{
+	static __m128i Blend(__m128i src, __m128i dst)
+	{
+		__m128i srcscale = _mm_add_epi16(src, _mm_srli_epi16(src, 7));
+		__m128i dstscale = _mm_sub_epi16(_mm_set1_epi16(256), srcscale);
+		return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(src, srcscale), _mm_mullo_epi16(dst, dstscale)), _mm_set1_epi16(127)), 8);
+	}
+};
+
+struct SSE2Blend_Src_One
+{
+	static __m128i Blend(__m128i src, __m128i dst)
+	{
+		__m128i srcscale = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		srcscale = _mm_add_epi16(srcscale, _mm_srli_epi16(srcscale, 7));
+		return _mm_add_epi16(_mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, srcscale), _mm_set1_epi16(127)), 8), dst);
+	}
+};
+
+struct SSE2Blend_SrcCol_One
+{
+	static __m128i Blend(__m128i src, __m128i dst)
+	{
+		__m128i srcscale = _mm_add_epi16(src, _mm_srli_epi16(src, 7));
+		return _mm_add_epi16(_mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, srcscale), _mm_set1_epi16(127)), 8), dst);
+	}
+};
+
+struct SSE2Blend_DstCol_Zero
+{
+	static __m128i Blend(__m128i src, __m128i dst)
+	{
+		__m128i srcscale = _mm_add_epi16(dst, _mm_srli_epi16(dst, 7));
+		return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, srcscale), _mm_set1_epi16(127)), 8);
+	}
+};
+
+struct SSE2Blend_InvDstCol_Zero
+{
+	static __m128i Blend(__m128i src, __m128i dst)
+	{
+		__m128i srcscale = _mm_sub_epi16(_mm_set1_epi16(255), dst);
+		srcscale = _mm_add_epi16(srcscale, _mm_srli_epi16(srcscale, 7));
+		return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, srcscale), _mm_set1_epi16(127)), 8);
+	}
+};
+
+struct SSE2Blend_RevSub_Src_One
+{
+	static __m128i Blend(__m128i src, __m128i dst)
+	{
+		__m128i srcscale = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		srcscale = _mm_add_epi16(srcscale, _mm_srli_epi16(srcscale, 7));
+		return _mm_sub_epi16(dst, _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, srcscale), _mm_set1_epi16(127)), 8));
+	}
+};
+
+template<typename OpT, void (*PolySpanKernels::*Tail)(uint32_t*, const uint32_t*, int, int)>
+static void SSE2Blend(uint32_t* line, const uint32_t* fragcolor, int x0, int x1)
+{
+	int sseend = x0 + ((x1 - x0) & ~3);
+	for (int x = x0; x < sseend; x += 4)
+	{
+		__m128i dst = _mm_loadu_si128((const __m128i*)&line[x]);
+		__m128i src = _mm_loadu_si128((const __m128i*)&fragcolor[x]);
+		__m128i lo = OpT::Blend(_mm_unpacklo_epi8(src, _mm_setzero_si128()), _mm_unpacklo_epi8(dst, _mm_setzero_si128()));
+		__m128i hi = OpT::Blend(_mm_unpackhi_epi8(src, _mm_setzero_si128()), _mm_unpackhi_epi8(dst, _mm_setzero_si128()));
+		_mm_storeu_si128((__m128i*)&line[x], _mm_packus_epi16(lo, hi));
+	}
+	(PolySpanScalar.*Tail)(line, fragcolor, sseend, x1);
+}
+
+static const PolySpanKernels PolySpanSSE2Kernels =
+{
+	"SSE2",
+	&SSE2DepthPassEnd,
+	&SSE2DepthFailEnd,
+	&SSE2StencilPassEnd,
+	&SSE2StencilFailEnd,
+	&ScalarSampleBgra, // no 32-bit multiply before SSE4.1
+	&SSE2ModulateLight,
+	&SSE2AlphaTest,
+	&SSE2Blend<SSE2Blend_Src_InvSrc, &PolySpanKernels::BlendAdd_Src_InvSrc>,
+	&SSE2Blend<SSE2Blend_SrcCol_InvSrcCol, &PolySpanKernels::BlendAdd_SrcCol_InvSrcCol>,
+	&SSE2Blend<SSE2Blend_Src_One, &PolySpanKernels::BlendAdd_Src_One>,
+	&SSE2Blend<SSE2Blend_SrcCol_One, &PolySpanKernels::BlendAdd_SrcCol_One>,
+	&SSE2Blend<SSE2Blend_DstCol_Zero, &PolySpanKernels::BlendAdd_DstCol_Zero>,
+	&SSE2Blend<SSE2Blend_InvDstCol_Zero, &PolySpanKernels::BlendAdd_InvDstCol_Zero>,
+	&SSE2Blend<SSE2Blend_RevSub_Src_One, &PolySpanKernels::BlendRevSub_Src_One>
+};
+
+const PolySpanKernels *PolySpanSSE2 = &PolySpanSSE2Kernels;
+
+#else
+
+const PolySpanKernels *PolySpanSSE2 = nullptr;
+
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+
+const PolySpanKernels *GetPolySpanKernels()
+{
+	static const PolySpanKernels *kernels = []() -> const PolySpanKernels *
+	{
+		if (PolySpanAVX2 && CPU.bAVX2Usable)
+			return PolySpanAVX2;
+		else if (PolySpanSSE2)
+			return PolySpanSSE2;
+		else
+			return &PolySpanScalar;
+	}();
+	return kernels;
+}
+
+//==========================================================================
+//
+// benchpolyspans [triangles] [passes]
+//
+// Runs every kernel table over the spans of a canned triangle stream and
+// reports the throughput of each kernel. The output of every table is
+// compared against the scalar kernels.
+//
+//==========================================================================
+
+namespace
+{
+	struct FBenchSpan
+	{
+		int y, x0, x1;
+	};
+
+	class FPolySpanBenchmark
+	{
+	public:
+		enum { Width = 1280, Height = 720, TexSize = 256 };
+
+		FPolySpanBenchmark(int numtriangles)
+		{
+			CreateSpans(numtriangles);
+			CreateBuffers();
+		}
+
+		void Run(int passes)
+		{
+			const PolySpanKernels *tables[] = { &PolySpanScalar, PolySpanSSE2, PolySpanAVX2 };
+			const PolySpanKernels *active = GetPolySpanKernels();
+
+			Printf("%u spans, %.1f Mpixels per pass, %d passes. Active: %s\n", (unsigned)Spans.size(), Pixels / 1e6, passes, active->Name);
+			FString header;
+			header.Format("%-24s", "kernel");
+			for (auto table : tables)
+				if (table) header.AppendFormat(" %12s", table->Name);
+			Printf("%s  (Mpixels/s)\n", header.GetChars());
+
+			bool allmatch = true;
+			for (int k = 0; k < NumKernels; k++)
+			{
+				FString row;
+				row.Format("%-24s", KernelNames[k]);
+				uint32_t reference = 0;
+				for (auto table : tables)
+				{
+					if (!table)
+						continue;
+
+					// One run from the canned state for the output check, then the timed passes.
+					Reset();
+					uint32_t checksum = RunKernel(*table, k);
+					if (table == &PolySpanScalar)
+						reference = checksum;
+
+					uint64_t start = I_nsTime();
+					for (int i = 0; i < passes; i++)
+						RunKernel(*table, k);
+					double seconds = (I_nsTime() - start) * 1e-9;
+
+					bool match = checksum == reference;
+					allmatch = allmatch && match;
+					row.AppendFormat(" %11.1f%s", seconds > 0.0 ? Pixels * passes / seconds / 1e6 : 0.0, match ? " " : "!");
+				}
+				Printf("%s\n", row.GetChars());
+			}
+
+			if (allmatch)
+				Printf("All kernels match the scalar output\n");
+			else
+				Printf(TEXTCOLOR_RED "Kernels marked with ! do not match the scalar output\n");
+		}
+
+	private:
+		enum
+		{
+			KernelDepth,
+			KernelStencil,
+			KernelSample,
+			KernelLight,
+			KernelAlphaTest,
+			KernelBlendFirst,
+			NumKernels = KernelBlendFirst + 7
+		};
+
+		static const char *const KernelNames[NumKernels];
+
+		uint32_t Random()
+		{
+			// xorshift32 so that the stream is the same on every machine
+			Seed ^= Seed << 13;
+			Seed ^= Seed >> 17;
+			Seed ^= Seed << 5;
+			return Seed;
+		}
+
+		float RandomFloat(float range)
+		{
+			return (Random() & 0xffffff) * (range / 0x1000000);
+		}
+
+		void CreateSpans(int numtriangles)
+		{
+			Pixels = 0;
+			for (int i = 0; i < numtriangles; i++)
+			{
+				// Mostly small triangles, like a typical scene, with the occasional large one.
+				float size = (i % 16 == 0) ? 400.0f : 48.0f;
+				float cx = RandomFloat((float)Width);
+				float cy = RandomFloat((float)Height);
+				float vx[3], vy[3];
+				for (int j = 0; j < 3; j++)
+				{
+					vx[j] = cx + RandomFloat(size) - size * 0.5f;
+					vy[j] = cy + RandomFloat(size) - size * 0.5f;
+				}
+
+				int top = MAX((int)(MIN(MIN(vy[0], vy[1]), vy[2]) + 0.5f), 0);
+				int bottom = MIN((int)(MAX(MAX(vy[0], vy[1]), vy[2]) + 0.5f), (int)Height);
+				for (int y = top; y < bottom; y++)
+				{
+					// Intersect the pixel center line with the three edges
+					float fy = y + 0.5f;
+					float left = (float)Width, right = 0.0f;
+					for (int j = 0; j < 3; j++)
+					{
+						int k = (j + 1) % 3;
+						if ((vy[j] <= fy && vy[k] > fy) || (vy[k] <= fy && vy[j] > fy))
+						{
+							float fx = vx[j] + (fy - vy[j]) * (vx[k] - vx[j]) / (vy[k] - vy[j]);
+							left = MIN(left, fx);
+							right = MAX(right, fx);
+						}
+					}
+					int x0 = clamp((int)(left + 0.5f), 0, (int)Width);
+					int x1 = clamp((int)(right + 0.5f), 0, (int)Width);
+					if (x0 < x1)
+					{
+						Spans.push_back({ y, x0, x1 });
+						Pixels += x1 - x0;
+					}
+				}
+			}
+		}
+
+		void CreateBuffers()
+		{
+			size_t count = (size_t)Width * Height;
+			CannedDest.resize(count);
+			CannedFrag.resize(count);
+			Depth.resize(count);
+			W.resize(count);
+			Stencil.resize(count);
+			U.resize(count);
+			V.resize(count);
+			Light.resize(count);
+			Texels.resize(TexSize * TexSize);
+
+			for (int y = 0; y < Height; y++)
+			{
+				for (int x = 0; x < Width; x++)
+				{
+					size_t i = x + (size_t)y * Width;
+					CannedDest[i] = Random();
+					CannedFrag[i] = Random();
+					Light[i] = Random() | 0xff000000;
+
+					// Periodic depth values give passing and failing runs of varying lengths
+					Depth[i] = 1.0f + ((x * 7 + y * 3) % 97) * (1.0f / 97.0f);
+					W[i] = 1.0f + ((x * 5 + y * 11) % 89) * (1.0f / 89.0f);
+					Stencil[i] = ((x >> 4) + (y >> 3)) & 1;
+					U[i] = (uint16_t)(x * 97);
+					V[i] = (uint16_t)(y * 131);
+				}
+			}
+			for (auto &texel : Texels)
+				texel = Random();
+		}
+
+		void Reset()
+		{
+			Dest = CannedDest;
+			Frag = CannedFrag;
+			Discard.assign(Dest.size(), 0);
+		}
+
+		template<typename T>
+		static uint32_t Hash(const std::vector<T> &data)
+		{
+			// FNV-1a
+			const uint8_t *bytes = (const uint8_t *)data.data();
+			size_t size = data.size() * sizeof(T);
+			uint32_t hash = 2166136261u;
+			for (size_t i = 0; i < size; i++)
+				hash = (hash ^ bytes[i]) * 16777619u;
+			return hash;
+		}
+
+		uint32_t RunKernel(const PolySpanKernels &kernels, int kernel)
+		{
+			uint32_t runs = 2166136261u;
+			for (const FBenchSpan &span : Spans)
+			{
+				size_t offset = (size_t)span.y * Width;
+				int x0 = span.x0;
+				int x1 = span.x1;
+				switch (kernel)
+				{
+				case KernelDepth:
+				{
+					int x = x0;
+					while (x < x1)
+					{
+						x = kernels.DepthPassEnd(&Depth[offset], &W[offset], 0.0f, x, x1);
+						runs = (runs ^ x) * 16777619u;
+						x = kernels.DepthFailEnd(&Depth[offset], &W[offset], 0.0f, x, x1);
+						runs = (runs ^ x) * 16777619u;
+					}
+					break;
+				}
+				case KernelStencil:
+				{
+					int x = x0;
+					while (x < x1)
+					{
+						x = kernels.StencilPassEnd(&Stencil[offset], 1, x, x1);
+						runs = (runs ^ x) * 16777619u;
+						x = kernels.StencilFailEnd(&Stencil[offset], 1, x, x1);
+						runs = (runs ^ x) * 16777619u;
+					}
+					break;
+				}
+				case KernelSample: kernels.SampleBgra(&Frag[offset], &U[offset], &V[offset], Texels.data(), TexSize, TexSize, x0, x1); break;
+				case KernelLight: kernels.ModulateLight(&Frag[offset], &Light[offset], x0, x1); break;
+				case KernelAlphaTest: kernels.AlphaTest(&Discard[offset], &Frag[offset], 0x7f000000, x0, x1); break;
+				case KernelBlendFirst + 0: kernels.BlendAdd_Src_InvSrc(&Dest[offset], &Frag[offset], x0, x1); break;
+				case KernelBlendFirst + 1: kernels.BlendAdd_SrcCol_InvSrcCol(&Dest[offset], &Frag[offset], x0, x1); break;
+				case KernelBlendFirst + 2: kernels.BlendAdd_Src_One(&Dest[offset], &Frag[offset], x0, x1); break;
+				case KernelBlendFirst + 3: kernels.BlendAdd_SrcCol_One(&Dest[offset], &Frag[offset], x0, x1); break;
+				case KernelBlendFirst + 4: kernels.BlendAdd_DstCol_Zero(&Dest[offset], &Frag[offset], x0, x1); break;
+				case KernelBlendFirst + 5: kernels.BlendAdd_InvDstCol_Zero(&Dest[offset], &Frag[offset], x0, x1); break;
+				case KernelBlendFirst + 6: kernels.BlendRevSub_Src_One(&Dest[offset], &Frag[offset], x0, x1); break;
+				}
+			}
+
+			switch (kernel)
+			{
+			case KernelDepth:
+			case KernelStencil: return runs;
+			case KernelSample:
+			case KernelLight: return Hash(Frag);
+			case KernelAlphaTest: return Hash(Discard);
+			default: return Hash(Dest);
+			}
+		}
+
+		uint32_t Seed = 0x1234567;
+		std::vector<FBenchSpan> Spans;
+		double Pixels = 0;
+
+		std::vector<uint32_t> CannedDest, CannedFrag, Dest, Frag, Light, Texels;
+		std::vector<float> Depth, W;
+		std::vector<uint8_t> Stencil, Discard;
+		std::vector<uint16_t> U, V;
+	};
+
+	const char *const FPolySpanBenchmark::KernelNames[NumKernels] =
+	{
+		"depth test", "stencil test", "sample bgra", "modulate light", "alpha test",
+		"add src invsrc", "add srccol invsrccol", "add src one", "add srccol one",
+		"add dstcol zero", "add invdstcol zero", "revsub src one"
+	};
+}
+
+CCMD(benchpolyspans)
+{
+	int numtriangles = argv.argc() > 1 ? atoi(argv[1]) : 20000;
+	int passes = argv.argc() > 2 ? atoi(argv[2]) : 20;
+	if (numtriangles <= 0 || passes <= 0)
+	{
+		Printf("Usage: benchpolyspans [triangles] [passes]\n");
+		return;
+	}
+
+	FPolySpanBenchmark benchmark(numtriangles);
+	benchmark.Run(passes);
+}
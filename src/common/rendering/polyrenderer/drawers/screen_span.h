@@ -0,0 +1,80 @@
+/*
+**  Polygon Doom software renderer
+**  Copyright (c) 2026 The GZDoom Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Per-pixel span loops of the fragment stage. Each instruction set gets its own table,
+// and all of them must produce exactly the same output as the scalar versions.
+struct PolySpanKernels
+{
+	const char *Name;
+
+	// First x in [x, xend) where the depth test result changes, or xend if it never does
+	int (*DepthPassEnd)(const float *zbuffer, const float *w, float depthbias, int x, int xend);
+	int (*DepthFailEnd)(const float *zbuffer, const float *w, float depthbias, int x, int xend);
+
+	// First x in [x, xend) where the stencil test result changes, or xend if it never does
+	int (*StencilPassEnd)(const uint8_t *stencil, uint8_t value, int x, int xend);
+	int (*StencilFailEnd)(const uint8_t *stencil, uint8_t value, int x, int xend);
+
+	// Nearest sampling of a BGRA texture
+	void (*SampleBgra)(uint32_t *fragcolor, const uint16_t *u, const uint16_t *v, const uint32_t *texels, int texWidth, int texHeight, int x0, int x1);
+
+	// Multiplies the fragment color by the light color
+	void (*ModulateLight)(uint32_t *fragcolor, const uint32_t *lightarray, int x0, int x1);
+
+	// Marks all fragments at or below the alpha threshold as discarded
+	void (*AlphaTest)(uint8_t *discard, const uint32_t *fragcolor, uint32_t threshold, int x0, int x1);
+
+	// Blends the fragment colors into a line of the destination
+	void (*BlendAdd_Src_InvSrc)(uint32_t *line, const uint32_t *fragcolor, int x0, int x1);
+	void (*BlendAdd_SrcCol_InvSrcCol)(uint32_t *line, const uint32_t *fragcolor, int x0, int x1);
+	void (*BlendAdd_Src_One)(uint32_t *line, const uint32_t *fragcolor, int x0, int x1);
+	void (*BlendAdd_SrcCol_One)(uint32_t *line, const uint32_t *fragcolor, int x0, int x1);
+	void (*BlendAdd_DstCol_Zero)(uint32_t *line, const uint32_t *fragcolor, int x0, int x1);
+	void (*BlendAdd_InvDstCol_Zero)(uint32_t *line, const uint32_t *fragcolor, int x0, int x1);
+	void (*BlendRevSub_Src_One)(uint32_t *line, const uint32_t *fragcolor, int x0, int x1);
+};
+
+extern const PolySpanKernels PolySpanScalar;
+extern const PolySpanKernels *PolySpanSSE2;	// nullptr if not compiled in
+extern const PolySpanKernels *PolySpanAVX2;	// nullptr if not compiled in
+
+// The fastest table supported by this CPU
+const PolySpanKernels *GetPolySpanKernels();
+
+inline int PolyFirstSetBit(uint32_t mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (int)index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
@@ -0,0 +1,276 @@
+/*
+**  Polygon Doom software renderer
+**  Copyright (c) 2026 The GZDoom Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+*/
+
+// Only the kernels below are compiled for AVX2, the inline functions from
+// screen_span.h keep the baseline instruction set. Nothing in the target
+// region may be called before GetPolySpanKernels has checked that the CPU
+// supports it.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "screen_span.h"
+
+#if !defined(NO_SSE) && (defined(__GNUC__) || defined(_MSC_VER)) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+static int AVX2DepthPassEnd(const float* zbuffer, const float* w, float depthbias, int x, int xend)
+{
+	__m256 mdepthbias = _mm256_set1_ps(depthbias);
+	while (x + 8 <= xend)
+	{
+		int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(zbuffer + x), _mm256_add_ps(_mm256_loadu_ps(w + x), mdepthbias), _CMP_GE_OQ));
+		if (mask != 0xff)
+			return x + PolyFirstSetBit(~mask & 0xff);
+		x += 8;
+	}
+	return PolySpanScalar.DepthPassEnd(zbuffer, w, depthbias, x, xend);
+}
+
+static int AVX2DepthFailEnd(const float* zbuffer, const float* w, float depthbias, int x, int xend)
+{
+	__m256 mdepthbias = _mm256_set1_ps(depthbias);
+	while (x + 8 <= xend)
+	{
+		int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(zbuffer + x), _mm256_add_ps(_mm256_loadu_ps(w + x), mdepthbias), _CMP_LT_OQ));
+		if (mask != 0xff)
+			return x + PolyFirstSetBit(~mask & 0xff);
+		x += 8;
+	}
+	return PolySpanScalar.DepthFailEnd(zbuffer, w, depthbias, x, xend);
+}
+
+static int AVX2StencilPassEnd(const uint8_t* stencil, uint8_t value, int x, int xend)
+{
+	__m256i mvalue = _mm256_set1_epi8(value);
+	while (x + 32 <= xend)
+	{
+		uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(stencil + x)), mvalue));
+		if (mask != 0xffffffff)
+			return x + PolyFirstSetBit(~mask);
+		x += 32;
+	}
+	return PolySpanScalar.StencilPassEnd(stencil, value, x, xend);
+}
+
+static int AVX2StencilFailEnd(const uint8_t* stencil, uint8_t value, int x, int xend)
+{
+	__m256i mvalue = _mm256_set1_epi8(value);
+	while (x + 32 <= xend)
+	{
+		uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(stencil + x)), mvalue));
+		if (mask != 0)
+			return x + PolyFirstSetBit(mask);
+		x += 32;
+	}
+	return PolySpanScalar.StencilFailEnd(stencil, value, x, xend);
+}
+
+static void AVX2SampleBgra(uint32_t* fragcolor, const uint16_t* u, const uint16_t* v, const uint32_t* texels, int texWidth, int texHeight, int x0, int x1)
+{
+	__m256i mwidth = _mm256_set1_epi32(texWidth);
+	__m256i mheight = _mm256_set1_epi32(texHeight);
+	int avxend = x0 + ((x1 - x0) & ~7);
+	for (int x = x0; x < avxend; x += 8)
+	{
+		__m256i mu = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(u + x)));
+		__m256i mv = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(v + x)));
+		__m256i texelX = _mm256_srli_epi32(_mm256_mullo_epi32(mu, mwidth), 16);
+		__m256i texelY = _mm256_srli_epi32(_mm256_mullo_epi32(mv, mheight), 16);
+		__m256i offset = _mm256_add_epi32(texelX, _mm256_mullo_epi32(texelY, mwidth));
+		_mm256_storeu_si256((__m256i*)(fragcolor + x), _mm256_i32gather_epi32((const int*)texels, offset, 4));
+	}
+	PolySpanScalar.SampleBgra(fragcolor, u, v, texels, texWidth, texHeight, avxend, x1);
+}
+
+static void AVX2ModulateLight(uint32_t* fragcolor, const uint32_t* lightarray, int x0, int x1)
+{
+	int avxend = x0 + ((x1 - x0) & ~7);
+	for (int x = x0; x < avxend; x += 8)
+	{
+		__m256i fg = _mm256_loadu_si256((const __m256i*)&fragcolor[x]);
+		__m256i light = _mm256_loadu_si256((const __m256i*)&lightarray[x]);
+
+		__m256i fglo = _mm256_unpacklo_epi8(fg, _mm256_setzero_si256());
+		__m256i fghi = _mm256_unpackhi_epi8(fg, _mm256_setzero_si256());
+		__m256i mullo = _mm256_unpacklo_epi8(light, _mm256_setzero_si256());
+		__m256i mulhi = _mm256_unpackhi_epi8(light, _mm256_setzero_si256());
+		mullo = _mm256_add_epi16(mullo, _mm256_srli_epi16(mullo, 7));
+		mulhi = _mm256_add_epi16(mulhi, _mm256_srli_epi16(mulhi, 7));
+
+		fglo = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(fglo, mullo), _mm256_set1_epi16(127)), 8);
+		fghi = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(fghi, mulhi), _mm256_set1_epi16(127)), 8);
+		_mm256_storeu_si256((__m256i*)&fragcolor[x], _mm256_packus_epi16(fglo, fghi));
+	}
+	PolySpanScalar.ModulateLight(fragcolor, lightarray, avxend, x1);
+}
+
+static void AVX2AlphaTest(uint8_t* discard, const uint32_t* fragcolor, uint32_t threshold, int x0, int x1)
+{
+	// There are only signed 32-bit compares
+	__m256i signbit = _mm256_set1_epi32(0x80000000);
+	__m256i mthreshold = _mm256_xor_si256(_mm256_set1_epi32(threshold), signbit);
+	int avxend = x0 + ((x1 - x0) & ~7);
+	for (int x = x0; x < avxend; x += 8)
+	{
+		__m256i fg = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)&fragcolor[x]), signbit);
+		__m256i result = _mm256_andnot_si256(_mm256_cmpgt_epi32(fg, mthreshold), _mm256_set1_epi32(1));
+
+		// The packs work per 128-bit lane, so the two halves have to be brought together first
+		result = _mm256_packs_epi32(result, result);
+		result = _mm256_permute4x64_epi64(result, _MM_SHUFFLE(3, 1, 2, 0));
+		__m128i bytes = _mm_packs_epi16(_mm256_castsi256_si128(result), _mm256_castsi256_si128(result));
+		_mm_storel_epi64((__m128i*)(discard + x), bytes);
+	}
+	PolySpanScalar.AlphaTest(discard, fragcolor, threshold, avxend, x1);
+}
+
+// The blend operators work on four pixels with 16 bits per channel
+static inline __m256i AVX2SplatAlpha(__m256i c)
+{
+	return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(c, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+struct AVX2Blend_Src_InvSrc
+{
+	static __m256i Blend(__m256i src, __m256i dst)
+	{
+		__m256i srcscale = AVX2SplatAlpha(src);
+		srcscale = _mm256_add_epi16(srcscale, _mm256_srli_epi16(srcscale, 7));
+		__m256i dstscale = _mm256_sub_epi16(_mm256_set1_epi16(256), srcscale);
+		return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(src, srcscale), _mm256_mullo_epi16(dst, dstscale)), _mm256_set1_epi16(127)), 8);
+	}
+};
+
+struct AVX2Blend_SrcCol_InvSrcCol
+{
+	static __m256i Blend(__m256i src, __m256i dst)
+	{
+		__m256i srcscale = _mm256_add_epi16(src, _mm256_srli_epi16(src, 7));
+		__m256i dstscale = _mm256_sub_epi16(_mm256_set1_epi16(256), srcscale);
+		return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(src, srcscale), _mm256_mullo_epi16(dst, dstscale)), _mm256_set1_epi16(127)), 8);
+	}
+};
+
+struct AVX2Blend_Src_One
+{
+	static __m256i Blend(__m256i src, __m256i dst)
+	{
+		__m256i srcscale = AVX2SplatAlpha(src);
+		srcscale = _mm256_add_epi16(srcscale, _mm256_srli_epi16(srcscale, 7));
+		return _mm256_add_epi16(_mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(src, srcscale), _mm256_set1_epi16(127)), 8), dst);
+	}
+};
+
+struct AVX2Blend_SrcCol_One
+{
+	static __m256i Blend(__m256i src, __m256i dst)
+	{
+		__m256i srcscale = _mm256_add_epi16(src, _mm256_srli_epi16(src, 7));
+		return _mm256_add_epi16(_mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(src, srcscale), _mm256_set1_epi16(127)), 8), dst);
+	}
+};
+
+struct AVX2Blend_DstCol_Zero
+{
+	static __m256i Blend(__m256i src, __m256i dst)
+	{
+		__m256i srcscale = _mm256_add_epi16(dst, _mm256_srli_epi16(dst, 7));
+		return _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(src, srcscale), _mm256_set1_epi16(127)), 8);
+	}
+};
+
+struct AVX2Blend_InvDstCol_Zero
+{
+	static __m256i Blend(__m256i src, __m256i dst)
+	{
+		__m256i srcscale = _mm256_sub_epi16(_mm256_set1_epi16(255), dst);
+		srcscale = _mm256_add_epi16(srcscale, _mm256_srli_epi16(srcscale, 7));
+		return _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(src, srcscale), _mm256_set1_epi16(127)), 8);
+	}
+};
+
+struct AVX2Blend_RevSub_Src_One
+{
+	static __m256i Blend(__m256i src, __m256i dst)
+	{
+		__m256i srcscale = AVX2SplatAlpha(src);
+		srcscale = _mm256_add_epi16(srcscale, _mm256_srli_epi16(srcscale, 7));
+		return _mm256_sub_epi16(dst, _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(src, srcscale), _mm256_set1_epi16(127)), 8));
+	}
+};
+
+template<typename OpT, void (*PolySpanKernels::*Tail)(uint32_t*, const uint32_t*, int, int)>
+static void AVX2Blend(uint32_t* line, const uint32_t* fragcolor, int x0, int x1)
+{
+	// Unpacking and packing both work per 128-bit lane, so the pixels stay in order
+	int avxend = x0 + ((x1 - x0) & ~7);
+	for (int x = x0; x < avxend; x += 8)
+	{
+		__m256i dst = _mm256_loadu_si256((const __m256i*)&line[x]);
+		__m256i src = _mm256_loadu_si256((const __m256i*)&fragcolor[x]);
+		__m256i lo = OpT::Blend(_mm256_unpacklo_epi8(src, _mm256_setzero_si256()), _mm256_unpacklo_epi8(dst, _mm256_setzero_si256()));
+		__m256i hi = OpT::Blend(_mm256_unpackhi_epi8(src, _mm256_setzero_si256()), _mm256_unpackhi_epi8(dst, _mm256_setzero_si256()));
+		_mm256_storeu_si256((__m256i*)&line[x], _mm256_packus_epi16(lo, hi));
+	}
+	(PolySpanScalar.*Tail)(line, fragcolor, avxend, x1);
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+static const PolySpanKernels PolySpanAVX2Kernels =
+{
+	"AVX2",
+	&AVX2DepthPassEnd,
+	&AVX2DepthFailEnd,
+	&AVX2StencilPassEnd,
+	&AVX2StencilFailEnd,
+	&AVX2SampleBgra,
+	&AVX2ModulateLight,
+	&AVX2AlphaTest,
+	&AVX2Blend<AVX2Blend_Src_InvSrc, &PolySpanKernels::BlendAdd_Src_InvSrc>,
+	&AVX2Blend<AVX2Blend_SrcCol_InvSrcCol, &PolySpanKernels::BlendAdd_SrcCol_InvSrcCol>,
+	&AVX2Blend<AVX2Blend_Src_One, &PolySpanKernels::BlendAdd_Src_One>,
+	&AVX2Blend<AVX2Blend_SrcCol_One, &PolySpanKernels::BlendAdd_SrcCol_One>,
+	&AVX2Blend<AVX2Blend_DstCol_Zero, &PolySpanKernels::BlendAdd_DstCol_Zero>,
+	&AVX2Blend<AVX2Blend_InvDstCol_Zero, &PolySpanKernels::BlendAdd_InvDstCol_Zero>,
+	&AVX2Blend<AVX2Blend_RevSub_Src_One, &PolySpanKernels::BlendRevSub_Src_One>
+};
+
+const PolySpanKernels *PolySpanAVX2 = &PolySpanAVX2Kernels;
+
+#else
+
+const PolySpanKernels *PolySpanAVX2 = nullptr;
+
+#endif
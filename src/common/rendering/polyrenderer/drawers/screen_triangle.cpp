@@ -126,16 +126,14 @@ static void DepthTestSpan(int y, int x0, int x1, const TriDrawTriangleArgs* args
 	{
 		int xstart = x;
 
-		while (zbufferLine[x] >= w[x] + depthbias && x < xend)
-			x++;
+		x = thread->span->DepthPassEnd(zbufferLine, w, depthbias, x, xend);
 
 		if (x > xstart)
 		{
 			DrawSpan(y, xstart, x, args, thread);
 		}
 
-		while (zbufferLine[x] < w[x] + depthbias && x < xend)
-			x++;
+		x = thread->span->DepthFailEnd(zbufferLine, w, depthbias, x, xend);
 	}
 }
 
@@ -149,16 +147,14 @@ static void DepthStencilTestSpan(int y, int x0, int x1, const TriDrawTriangleArg
 	while (x < xend)
 	{
 		int xstart = x;
-		while (stencilLine[x] == stencilTestValue && x < xend)
-			x++;
+		x = thread->span->StencilPassEnd(stencilLine, stencilTestValue, x, xend);
 
 		if (x > xstart)
 		{
 			DepthTestSpan(y, xstart, x, args, thread);
 		}
 
-		while (stencilLine[x] != stencilTestValue && x < xend)
-			x++;
+		x = thread->span->StencilFailEnd(stencilLine, stencilTestValue, x, xend);
 	}
 }
 
@@ -172,8 +168,7 @@ static void StencilTestSpan(int y, int x0, int x1, const TriDrawTriangleArgs* ar
 	while (x < xend)
 	{
 		int xstart = x;
-		while (stencilLine[x] == stencilTestValue && x < xend)
-			x++;
+		x = thread->span->StencilPassEnd(stencilLine, stencilTestValue, x, xend);
 
 		if (x > xstart)
 		{
@@ -181,8 +176,7 @@ static void StencilTestSpan(int y, int x0, int x1, const TriDrawTriangleArgs* ar
 			DrawSpan(y, xstart, x, args, thread);
 		}
 
-		while (stencilLine[x] != stencilTestValue && x < xend)
-			x++;
+		x = thread->span->StencilFailEnd(stencilLine, stencilTestValue, x, xend);
 	}
 }
 
@@ -202,14 +196,23 @@ static void SortVertices(const TriDrawTriangleArgs* args, ScreenTriVertex** sort
 
 void ScreenTriangle::Draw(const TriDrawTriangleArgs* args, PolyTriangleThreadData* thread)
 {
-	// Sort vertices by Y position
-	ScreenTriVertex* sortedVertices[3];
-	SortVertices(args, sortedVertices);
-
 	int clipleft = thread->clip.left;
 	int cliptop = MAX(thread->clip.top, thread->numa_start_y);
 	int clipright = thread->clip.right;
 	int clipbottom = MIN(thread->clip.bottom, thread->numa_end_y);
+	DrawClipped(args, thread, clipleft, cliptop, clipright, clipbottom, true);
+}
+
+void ScreenTriangle::DrawTile(const TriDrawTriangleArgs* args, PolyTriangleThreadData* thread, int tileleft, int tiletop, int tileright, int tilebottom)
+{
+	DrawClipped(args, thread, tileleft, tiletop, tileright, tilebottom, false);
+}
+
+void ScreenTriangle::DrawClipped(const TriDrawTriangleArgs* args, PolyTriangleThreadData* thread, int clipleft, int cliptop, int clipright, int clipbottom, bool interleaved)
+{
+	// Sort vertices by Y position
+	ScreenTriVertex* sortedVertices[3];
+	SortVertices(args, sortedVertices);
 
 	int topY = (int)(sortedVertices[0]->y + 0.5f);
 	int midY = (int)(sortedVertices[1]->y + 0.5f);
@@ -232,8 +235,13 @@ void ScreenTriangle::Draw(const TriDrawTriangleArgs* args, PolyTriangleThreadDat
 	if (thread->StencilTest) opt |= SWTRI_StencilTest;
 	testfunc = ScreenTriangle::TestSpanOpts[opt];
 
-	topY += thread->skipped_by_thread(topY);
-	int num_cores = thread->num_cores;
+	// In tile binning mode the whole tile belongs to this thread
+	int num_cores = 1;
+	if (interleaved)
+	{
+		topY += thread->skipped_by_thread(topY);
+		num_cores = thread->num_cores;
+	}
 
 	// Find start/end X positions for each line covered by the triangle:
 
@@ -113,7 +113,12 @@ class ScreenTriangle
 public:
 	static void Draw(const TriDrawTriangleArgs* args, PolyTriangleThreadData* thread);
 
+	// Draws every line of the triangle within the given tile (tile binning mode)
+	static void DrawTile(const TriDrawTriangleArgs* args, PolyTriangleThreadData* thread, int tileleft, int tiletop, int tileright, int tilebottom);
+
 private:
+	static void DrawClipped(const TriDrawTriangleArgs* args, PolyTriangleThreadData* thread, int clipleft, int cliptop, int clipright, int clipbottom, bool interleaved);
+
 	static void(*TestSpanOpts[])(int y, int x0, int x1, const TriDrawTriangleArgs* args, PolyTriangleThreadData* thread);
 };
 
@@ -4,3 +4,4 @@
 #include "drawers/screen_scanline_setup.cpp"
 #include "drawers/screen_shader.cpp"
 #include "drawers/screen_blend.cpp"
+#include "drawers/screen_span.cpp"
@@ -53,7 +53,6 @@ DrawerThreads::DrawerThreads()
 
 DrawerThreads::~DrawerThreads()
 {
-	StopThreads();
 }
 
 void DrawerThreads::Execute(DrawerCommandQueuePtr commands)
@@ -62,23 +61,46 @@ void DrawerThreads::Execute(DrawerCommandQueuePtr commands)
 		return;
 	
 	auto queue = Instance();
+	auto jobs = FJobSystem::Instance();
 
 	queue->StartThreads();
-
-	// Add to queue and awaken worker threads
-	std::unique_lock<std::mutex> start_lock(queue->start_mutex);
-	std::unique_lock<std::mutex> end_lock(queue->end_mutex);
 	queue->active_commands.push_back(commands);
-	queue->tasks_left += queue->threads.size();
-	end_lock.unlock();
-	start_lock.unlock();
-	queue->start_condition.notify_all();
+
+	// Every slice gets one job per section of the command list between two barriers.
+	// A barrier is a job that waits for all slices of the section before it.
+	DrawerCommandQueue *list = commands.get();
+	size_t count = list->commands.size();
+	size_t first = 0;
+	FJobPtr barrier;
+	while (true)
+	{
+		size_t last = first;
+		while (last < count && !dynamic_cast<GroupMemoryBarrierCommand *>(list->commands[last]))
+			last++;
+
+		FJobPtr nextbarrier = last < count ? jobs->Create([]() {}, &queue->active_jobs) : nullptr;
+		for (size_t i = 0; i < queue->threads.size(); i++)
+		{
+			DrawerThread *thread = &queue->threads[i];
+			FJobPtr job = jobs->Create([=]() { queue->ExecuteSlice(thread, list, first, last); }, &queue->active_jobs);
+			if (queue->last_jobs[i]) jobs->AddDependency(job, queue->last_jobs[i]);
+			if (barrier) jobs->AddDependency(job, barrier);
+			if (nextbarrier) jobs->AddDependency(nextbarrier, job);
+			jobs->Submit(job);
+			queue->last_jobs[i] = job;
+		}
+		if (!nextbarrier)
+			break;
+
+		jobs->Submit(nextbarrier);
+		barrier = nextbarrier;
+		first = last + 1;
+	}
 }
 
 void DrawerThreads::ResetDebugDrawPos()
 {
 	auto queue = Instance();
-	std::unique_lock<std::mutex> start_lock(queue->start_mutex);
 	bool reached_end = false;
 	for (auto &thread : queue->threads)
 	{
@@ -96,10 +118,9 @@ void DrawerThreads::WaitForWorkers()
 {
 	using namespace std::chrono_literals;
 
-	// Wait for workers to finish
+	// Wait for workers to finish. This thread helps executing the remaining jobs.
 	auto queue = Instance();
-	std::unique_lock<std::mutex> end_lock(queue->end_mutex);
-	if (!queue->end_condition.wait_for(end_lock, 5s, [&]() { return queue->tasks_left == 0; }))
+	if (!FJobSystem::Instance()->WaitFor(queue->active_jobs, 5s))
 	{
 #ifdef WIN32
 		PeekThreadedErrorPane();
@@ -108,12 +129,10 @@ void DrawerThreads::WaitForWorkers()
 		int *threadCrashed = nullptr;
 		*threadCrashed = 0xdeadbeef;
 	}
-	end_lock.unlock();
 
 	// Clean up
-	std::unique_lock<std::mutex> start_lock(queue->start_mutex);
-	for (auto &thread : queue->threads)
-		thread.current_queue = 0;
+	for (auto &job : queue->last_jobs)
+		job = nullptr;
 
 	for (auto &list : queue->active_commands)
 	{
@@ -124,59 +143,39 @@ void DrawerThreads::WaitForWorkers()
 	queue->active_commands.clear();
 }
 
-void DrawerThreads::WorkerMain(DrawerThread *thread)
+void DrawerThreads::ExecuteSlice(DrawerThread *thread, DrawerCommandQueue *list, size_t first, size_t last)
 {
-	while (true)
+	thread->numa_start_y = thread->numa_node * screen->GetHeight() / thread->num_numa_nodes;
+	thread->numa_end_y = (thread->numa_node + 1) * screen->GetHeight() / thread->num_numa_nodes;
+	if (thread->poly)
 	{
-		// Wait until we are signalled to run:
-		std::unique_lock<std::mutex> start_lock(start_mutex);
-		start_condition.wait(start_lock, [&]() { return thread->current_queue < active_commands.size() || shutdown_flag; });
-		if (shutdown_flag)
-			break;
+		thread->poly->numa_start_y = thread->numa_start_y;
+		thread->poly->numa_end_y = thread->numa_end_y;
+	}
 
-		// Grab the commands
-		DrawerCommandQueuePtr list = active_commands[thread->current_queue];
-		thread->current_queue++;
-		thread->numa_start_y = thread->numa_node * screen->GetHeight() / thread->num_numa_nodes;
-		thread->numa_end_y = (thread->numa_node + 1) * screen->GetHeight() / thread->num_numa_nodes;
-		if (thread->poly)
+	if (r_debug_draw)
+	{
+		for (size_t i = first; i < last; i++)
 		{
-			thread->poly->numa_start_y = thread->numa_start_y;
-			thread->poly->numa_end_y = thread->numa_end_y;
+			thread->debug_draw_pos++;
+			if (thread->debug_draw_pos < debug_draw_end)
+				list->commands[i]->Execute(thread);
 		}
-		start_lock.unlock();
-
-		// Do the work:
-		if (r_debug_draw)
-		{
-			for (auto& command : list->commands)
-			{
-				thread->debug_draw_pos++;
-				if (thread->debug_draw_pos < debug_draw_end)
-					command->Execute(thread);
-			}
-		}
-		else
+	}
+	else
+	{
+		for (size_t i = first; i < last; i++)
 		{
-			for (auto& command : list->commands)
-			{
-				command->Execute(thread);
-			}
+			list->commands[i]->Execute(thread);
 		}
-
-		// Notify main thread that we finished:
-		std::unique_lock<std::mutex> end_lock(end_mutex);
-		tasks_left--;
-		bool finishedTasks = tasks_left == 0;
-		end_lock.unlock();
-		if (finishedTasks)
-			end_condition.notify_all();
 	}
 }
 
 void DrawerThreads::StartThreads()
 {
-	std::unique_lock<std::mutex> lock(threads_mutex);
+	// The slices cannot be changed while some are still executing.
+	if (!active_commands.empty())
+		return;
 
 	int num_numathreads = 0;
 	for (int i = 0; i < I_GetNumaNodeCount(); i++)
@@ -203,10 +202,12 @@ void DrawerThreads::StartThreads()
 
 	if (num_threads != (int)threads.size())
 	{
-		StopThreads();
-
+		threads.clear();
 		threads.resize(num_threads);
+		last_jobs.clear();
+		last_jobs.resize(num_threads);
 
+		// The slices still get assigned to NUMA nodes so that each node works on its own part of the screen.
 		if (num_threads == num_numathreads)
 		{
 			int curThread = 0;
@@ -214,14 +215,11 @@ void DrawerThreads::StartThreads()
 			{
 				for (int i = 0; i < I_GetNumaNodeThreadCount(numaNode); i++)
 				{
-					DrawerThreads *queue = this;
 					DrawerThread *thread = &threads[curThread++];
 					thread->core = i;
 					thread->num_cores = I_GetNumaNodeThreadCount(numaNode);
 					thread->numa_node = numaNode;
 					thread->num_numa_nodes = I_GetNumaNodeCount();
-					thread->thread = std::thread([=]() { queue->WorkerMain(thread); });
-					I_SetThreadNumaNode(thread->thread, numaNode);
 				}
 			}
 		}
@@ -229,32 +227,16 @@ void DrawerThreads::StartThreads()
 		{
 			for (int i = 0; i < num_threads; i++)
 			{
-				DrawerThreads *queue = this;
 				DrawerThread *thread = &threads[i];
 				thread->core = i;
 				thread->num_cores = num_threads;
 				thread->numa_node = 0;
 				thread->num_numa_nodes = 1;
-				thread->thread = std::thread([=]() { queue->WorkerMain(thread); });
-				I_SetThreadNumaNode(thread->thread, 0);
 			}
 		}
 	}
 }
 
-void DrawerThreads::StopThreads()
-{
-	std::unique_lock<std::mutex> lock(start_mutex);
-	shutdown_flag = true;
-	lock.unlock();
-	start_condition.notify_all();
-	for (auto &thread : threads)
-		thread.thread.join();
-	threads.clear();
-	lock.lock();
-	shutdown_flag = false;
-}
-
 /////////////////////////////////////////////////////////////////////////////
 
 DrawerCommandQueue::DrawerCommandQueue(RenderMemory *frameMemory) : FrameMemory(frameMemory)
@@ -268,16 +250,6 @@ void *DrawerCommandQueue::AllocMemory(size_t size)
 
 /////////////////////////////////////////////////////////////////////////////
 
-void GroupMemoryBarrierCommand::Execute(DrawerThread *thread)
-{
-	std::unique_lock<std::mutex> lock(mutex);
-	count++;
-	condition.notify_all();
-	condition.wait(lock, [&]() { return count >= (size_t)thread->num_cores; });
-}
-
-/////////////////////////////////////////////////////////////////////////////
-
 MemcpyCommand::MemcpyCommand(void *dest, int destpitch, const void *src, int width, int height, int srcpitch, int pixelsize)
 	: dest(dest), src(src), destpitch(destpitch), width(width), height(height), srcpitch(srcpitch), pixelsize(pixelsize)
 {
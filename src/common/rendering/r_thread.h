@@ -24,12 +24,11 @@
 
 #include <vector>
 #include <memory>
-#include <thread>
 #include <mutex>
-#include <condition_variable>
 #include "templates.h"
 #include "c_cvars.h"
 #include "basics.h"
+#include "jobsystem.h"
 
 // Use multiple threads when drawing
 EXTERN_CVAR(Int, r_multithreaded)
@@ -38,13 +37,11 @@ class PolyTriangleThreadData;
 
 namespace swrenderer { class WallColumnDrawerArgs; }
 
-// Worker data for each thread executing drawer commands
+// Worker data for each line slice executing drawer commands.
+// The slices run as jobs, but each slice executes its commands in order.
 class DrawerThread
 {
 public:
-	std::thread thread;
-	size_t current_queue = 0;
-
 	// Thread line index of this thread
 	int core = 0;
 
@@ -114,16 +111,12 @@ public:
 	virtual void Execute(DrawerThread *thread) = 0;
 };
 
-// Wait for all worker threads before executing next command
+// Wait for all worker threads before executing next command.
+// The queue is split into separate jobs at this command, so it does nothing by itself.
 class GroupMemoryBarrierCommand : public DrawerCommand
 {
 public:
-	void Execute(DrawerThread *thread);
-
-private:
-	std::mutex mutex;
-	std::condition_variable condition;
-	size_t count = 0;
+	void Execute(DrawerThread *thread) { }
 };
 
 // Copy finished rows to video memory
@@ -162,22 +155,16 @@ private:
 	~DrawerThreads();
 	
 	void StartThreads();
-	void StopThreads();
-	void WorkerMain(DrawerThread *thread);
+	void ExecuteSlice(DrawerThread *thread, DrawerCommandQueue *list, size_t first, size_t last);
 
 	static DrawerThreads *Instance();
 	
-	std::mutex threads_mutex;
 	std::vector<DrawerThread> threads;
 
-	std::mutex start_mutex;
-	std::condition_variable start_condition;
+	// The last job of each slice. The next job of a slice depends on it to keep the commands in order.
+	std::vector<FJobPtr> last_jobs;
 	std::vector<DrawerCommandQueuePtr> active_commands;
-	bool shutdown_flag = false;
-
-	std::mutex end_mutex;
-	std::condition_variable end_condition;
-	size_t tasks_left = 0;
+	FJobCounter active_jobs;
 
 	size_t debug_draw_end = 0;
 
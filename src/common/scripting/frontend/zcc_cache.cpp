@@ -0,0 +1,1097 @@
+/*
+** zcc_cache.cpp
+**
+** Persistent cache for parsed ZScript syntax trees
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 The GZDoom Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** Scanning and parsing the ZScript sources is the part of the script
+** compiler that does not depend on anything but the text of the script
+** lumps, so its result - the syntax tree - gets stored in the cache
+** directory after a successful parse. On the next start the tree is
+** loaded from there if the engine build, all parsed lumps (base lump and
+** includes) and their contents are still the same.
+**
+** Names are stored as text and get recreated in the exact order the
+** scanner would have created them so that the name table is identical
+** to a run without the cache.
+**
+*/
+
+#ifndef _WIN32
+#include <unistd.h>
+#else
+#include <direct.h>
+#define rmdir _rmdir
+#endif
+#include <zlib.h>
+
+#include "zcc_parser.h"
+#include "filesystem.h"
+#include "files.h"
+#include "cmdlib.h"
+#include "c_cvars.h"
+#include "c_dispatch.h"
+#include "i_specialpaths.h"
+#include "md5.h"
+#include "printf.h"
+#include "version.h"
+#include "m_swap.h"
+
+CVAR(Bool, zscript_parsecache, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+// Must be bumped whenever the layout of the syntax tree changes.
+static const uint32_t PARSECACHE_VERSION = 1;
+
+typedef TArray<uint8_t> MemFile;
+
+//==========================================================================
+//
+// File helpers
+//
+//==========================================================================
+
+static FString CreateCacheName(int lump, bool create)
+{
+	FString path = M_GetCachePath(create);
+	FString lumpname = fileSystem.GetFileFullPath(lump);
+	auto separator = lumpname.IndexOf(':');
+	path << "/zscript/" << lumpname.Left(separator);
+	if (create) CreatePath(path);
+
+	lumpname.ReplaceChars('/', '%');
+	lumpname.ReplaceChars(':', '$');
+	path << '/' << lumpname.Right((ptrdiff_t)lumpname.Len() - separator - 1) << ".zsc";
+	return path;
+}
+
+static void WriteBytes(MemFile &f, const void *data, size_t size)
+{
+	if (size == 0) return;
+	int v = f.Reserve((unsigned)size);
+	memcpy(&f[v], data, size);
+}
+
+static void WriteLong(MemFile &f, uint32_t b)
+{
+	int v = f.Reserve(4);
+	f[v] = (uint8_t)b;
+	f[v+1] = (uint8_t)(b>>8);
+	f[v+2] = (uint8_t)(b>>16);
+	f[v+3] = (uint8_t)(b>>24);
+}
+
+static void WriteString(MemFile &f, const char *str)
+{
+	size_t len = strlen(str);
+	WriteLong(f, (uint32_t)len);
+	WriteBytes(f, str, len);
+}
+
+struct FCacheReader
+{
+	const uint8_t *Data;
+	size_t Size;
+	size_t Pos = 0;
+	bool Failed = false;
+
+	FCacheReader(const TArray<uint8_t> &data) : Data(data.Data()), Size(data.Size()) {}
+
+	bool ReadBytes(void *dest, size_t size)
+	{
+		if (Failed || size > Size - Pos)
+		{
+			Failed = true;
+			memset(dest, 0, size);
+			return false;
+		}
+		memcpy(dest, Data + Pos, size);
+		Pos += size;
+		return true;
+	}
+
+	uint32_t ReadLong()
+	{
+		uint8_t b[4];
+		ReadBytes(b, 4);
+		return b[0] | (b[1] << 8) | (b[2] << 16) | (uint32_t(b[3]) << 24);
+	}
+
+	FString ReadString()
+	{
+		uint32_t len = ReadLong();
+		if (Failed || len > Size - Pos)
+		{
+			Failed = true;
+			return "";
+		}
+		FString str((const char *)Data + Pos, len);
+		Pos += len;
+		return str;
+	}
+};
+
+// The lump's MD5 and size identify its contents.
+static void GetLumpChecksum(int lump, uint8_t md5[16])
+{
+	auto data = fileSystem.ReadFile(lump);
+	MD5Context ctx;
+	ctx.Init();
+	ctx.Update((const uint8_t *)data.GetMem(), (unsigned)data.GetSize());
+	ctx.Final(md5);
+}
+
+//==========================================================================
+//
+// Types that can appear in the syntax tree before compilation
+//
+//==========================================================================
+
+static PType *GetParseType(unsigned index)
+{
+	PType *const types[] = { nullptr, TypeSInt32, TypeUInt32, TypeFloat64, TypeName, TypeBool, TypeString, TypeNullPtr, TypeError };
+	return index < countof(types) ? types[index] : TypeError;
+}
+
+static int GetParseTypeIndex(PType *type)
+{
+	for (unsigned i = 0; i < 9; i++)
+	{
+		if (GetParseType(i) == type) return i;
+	}
+	return -1;
+}
+
+static size_t GetNodeSize(EZCCTreeNodeType type)
+{
+	switch (type)
+	{
+#define xx(n) case AST_##n: return sizeof(ZCC_##n);
+	xx(Identifier) xx(Class) xx(Struct) xx(Enum) xx(EnumTerminator) xx(States) xx(StatePart) xx(StateLabel)
+	xx(StateStop) xx(StateWait) xx(StateFail) xx(StateLoop) xx(StateGoto) xx(StateLine) xx(VarName) xx(VarInit)
+	xx(Type) xx(BasicType) xx(MapType) xx(DynArrayType) xx(ClassType) xx(Expression) xx(ExprID) xx(ExprTypeRef)
+	xx(ExprConstant) xx(ExprFuncCall) xx(ExprMemberAccess) xx(ExprUnary) xx(ExprBinary) xx(ExprTrinary) xx(FuncParm)
+	xx(Statement) xx(CompoundStmt) xx(ContinueStmt) xx(BreakStmt) xx(ReturnStmt) xx(ExpressionStmt) xx(IterationStmt)
+	xx(IfStmt) xx(SwitchStmt) xx(CaseStmt) xx(AssignStmt) xx(LocalVarStmt) xx(FuncParamDecl) xx(ConstantDef)
+	xx(Declarator) xx(VarDeclarator) xx(FuncDeclarator) xx(Default) xx(FlagStmt) xx(PropertyStmt) xx(VectorValue)
+	xx(DeclFlags) xx(ClassCast) xx(StaticArrayStatement) xx(Property) xx(FlagDef) xx(MixinDef) xx(MixinStmt)
+#undef xx
+	default: return 0;
+	}
+}
+
+//==========================================================================
+//
+// Syntax tree traversal
+//
+// One function lists the fields of all node types for all passes over the
+// tree: collecting the nodes, writing, reading and resolving names.
+// Compiler-only fields (symbols and resolved types) are always null after
+// parsing and are not stored.
+//
+// [pbeta]'s note for TreeNodeDeepCopy applies here as well: any change of
+// the node structures must be reflected here and in PARSECACHE_VERSION.
+//
+//==========================================================================
+
+template<class V> static void SerializeExpression(V &v, ZCC_Expression *node)
+{
+	v.Value(node->Operation);
+	v.Type(node->Type);
+}
+
+template<class V> static void SerializeStruct(V &v, ZCC_Struct *node)
+{
+	v.Name(node->NodeName);
+	v.Value(node->Flags);
+	v.Node(node->Body);
+	v.Value(node->Version);
+}
+
+template<class V> static void SerializeDeclarator(V &v, ZCC_Declarator *node)
+{
+	v.Node(node->Type);
+	v.Value(node->Flags);
+	v.Value(node->Version);
+}
+
+template<class V> static void SerializeVarName(V &v, ZCC_VarName *node)
+{
+	v.Name(node->Name);
+	v.Node(node->ArraySize);
+}
+
+template<class V>
+static void SerializeNode(V &v, ZCC_TreeNode *node)
+{
+	v.Node(node->SiblingNext);
+	v.Node(node->SiblingPrev);
+	v.String(node->SourceName);
+	v.Lump(node->SourceLump);
+	v.Value(node->SourceLoc);
+
+	switch (node->NodeType)
+	{
+	case AST_Identifier:
+		v.Name(static_cast<ZCC_Identifier *>(node)->Id);
+		break;
+
+	case AST_Struct:
+		SerializeStruct(v, static_cast<ZCC_Struct *>(node));
+		break;
+
+	case AST_Class:
+	{
+		auto cls = static_cast<ZCC_Class *>(node);
+		SerializeStruct(v, cls);
+		v.Node(cls->ParentName);
+		v.Node(cls->Replaces);
+		break;
+	}
+
+	case AST_Property:
+	{
+		auto prop = static_cast<ZCC_Property *>(node);
+		v.Name(prop->NodeName);
+		v.Node(prop->Body);
+		break;
+	}
+
+	case AST_FlagDef:
+	{
+		auto flag = static_cast<ZCC_FlagDef *>(node);
+		v.Name(flag->NodeName);
+		v.Name(flag->RefName);
+		v.Value(flag->BitValue);
+		break;
+	}
+
+	case AST_MixinDef:
+	{
+		auto mixin = static_cast<ZCC_MixinDef *>(node);
+		v.Name(mixin->NodeName);
+		v.Node(mixin->Body);
+		v.Value(mixin->MixinType);
+		break;
+	}
+
+	case AST_Enum:
+	{
+		auto enm = static_cast<ZCC_Enum *>(node);
+		v.Name(enm->NodeName);
+		v.Value(enm->EnumType);
+		v.Node(enm->Elements);
+		break;
+	}
+
+	case AST_EnumTerminator:
+	case AST_StatePart:
+	case AST_StateStop:
+	case AST_StateWait:
+	case AST_StateFail:
+	case AST_StateLoop:
+	case AST_Statement:
+	case AST_ContinueStmt:
+	case AST_BreakStmt:
+		break;
+
+	case AST_States:
+	{
+		auto states = static_cast<ZCC_States *>(node);
+		v.Node(states->Body);
+		v.Node(states->Flags);
+		break;
+	}
+
+	case AST_StateLabel:
+		v.Name(static_cast<ZCC_StateLabel *>(node)->Label);
+		break;
+
+	case AST_StateGoto:
+	{
+		auto go = static_cast<ZCC_StateGoto *>(node);
+		v.Node(go->Qualifier);
+		v.Node(go->Label);
+		v.Node(go->Offset);
+		break;
+	}
+
+	case AST_StateLine:
+	{
+		auto line = static_cast<ZCC_StateLine *>(node);
+		int bits = line->bBright | (line->bFast << 1) | (line->bSlow << 2) | (line->bNoDelay << 3) | (line->bCanRaise << 4);
+		v.String(line->Sprite);
+		v.Value(bits);
+		line->bBright = bits & 1;
+		line->bFast = (bits >> 1) & 1;
+		line->bSlow = (bits >> 2) & 1;
+		line->bNoDelay = (bits >> 3) & 1;
+		line->bCanRaise = (bits >> 4) & 1;
+		v.String(line->Frames);
+		v.Node(line->Duration);
+		v.Node(line->Offset);
+		v.Node(line->Lights);
+		v.Node(line->Action);
+		break;
+	}
+
+	case AST_VarName:
+		SerializeVarName(v, static_cast<ZCC_VarName *>(node));
+		break;
+
+	case AST_VarInit:
+	{
+		auto init = static_cast<ZCC_VarInit *>(node);
+		SerializeVarName(v, init);
+		v.Node(init->Init);
+		v.Value(init->InitIsArray);
+		break;
+	}
+
+	case AST_Type:
+		v.Node(static_cast<ZCC_Type *>(node)->ArraySize);
+		break;
+
+	case AST_BasicType:
+	{
+		auto type = static_cast<ZCC_BasicType *>(node);
+		v.Node(type->ArraySize);
+		v.Value(type->Type);
+		v.Node(type->UserType);
+		v.Value(type->isconst);
+		break;
+	}
+
+	case AST_MapType:
+	{
+		auto type = static_cast<ZCC_MapType *>(node);
+		v.Node(type->ArraySize);
+		v.Node(type->KeyType);
+		v.Node(type->ValueType);
+		break;
+	}
+
+	case AST_DynArrayType:
+	{
+		auto type = static_cast<ZCC_DynArrayType *>(node);
+		v.Node(type->ArraySize);
+		v.Node(type->ElementType);
+		break;
+	}
+
+	case AST_ClassType:
+	{
+		auto type = static_cast<ZCC_ClassType *>(node);
+		v.Node(type->ArraySize);
+		v.Node(type->Restriction);
+		break;
+	}
+
+	case AST_Expression:
+		SerializeExpression(v, static_cast<ZCC_Expression *>(node));
+		break;
+
+	case AST_ExprID:
+	{
+		auto expr = static_cast<ZCC_ExprID *>(node);
+		SerializeExpression(v, expr);
+		v.Name(expr->Identifier);
+		break;
+	}
+
+	case AST_ExprTypeRef:
+	{
+		auto expr = static_cast<ZCC_ExprTypeRef *>(node);
+		SerializeExpression(v, expr);
+		v.Type(expr->RefType);
+		break;
+	}
+
+	case AST_ExprConstant:
+	{
+		auto expr = static_cast<ZCC_ExprConstant *>(node);
+		SerializeExpression(v, expr);
+		if (expr->Type == TypeString) v.String(expr->StringVal);
+		else if (expr->Type == TypeFloat64) v.Value(expr->DoubleVal);
+		else if (expr->Type == TypeName) v.Name(expr->IntVal);
+		else v.Value(expr->IntVal);
+		break;
+	}
+
+	case AST_ExprFuncCall:
+	{
+		auto expr = static_cast<ZCC_ExprFuncCall *>(node);
+		SerializeExpression(v, expr);
+		v.Node(expr->Function);
+		v.Node(expr->Parameters);
+		break;
+	}
+
+	case AST_ClassCast:
+	{
+		auto expr = static_cast<ZCC_ClassCast *>(node);
+		SerializeExpression(v, expr);
+		v.Name(expr->ClassName);
+		v.Node(expr->Parameters);
+		break;
+	}
+
+	case AST_ExprMemberAccess:
+	{
+		auto expr = static_cast<ZCC_ExprMemberAccess *>(node);
+		SerializeExpression(v, expr);
+		v.Node(expr->Left);
+		v.Name(expr->Right);
+		break;
+	}
+
+	case AST_ExprUnary:
+	{
+		auto expr = static_cast<ZCC_ExprUnary *>(node);
+		SerializeExpression(v, expr);
+		v.Node(expr->Operand);
+		break;
+	}
+
+	case AST_ExprBinary:
+	{
+		auto expr = static_cast<ZCC_ExprBinary *>(node);
+		SerializeExpression(v, expr);
+		v.Node(expr->Left);
+		v.Node(expr->Right);
+		break;
+	}
+
+	case AST_ExprTrinary:
+	{
+		auto expr = static_cast<ZCC_ExprTrinary *>(node);
+		SerializeExpression(v, expr);
+		v.Node(expr->Test);
+		v.Node(expr->Left);
+		v.Node(expr->Right);
+		break;
+	}
+
+	case AST_VectorValue:
+	{
+		auto expr = static_cast<ZCC_VectorValue *>(node);
+		SerializeExpression(v, expr);
+		v.Node(expr->X);
+		v.Node(expr->Y);
+		v.Node(expr->Z);
+		break;
+	}
+
+	case AST_FuncParm:
+	{
+		auto parm = static_cast<ZCC_FuncParm *>(node);
+		v.Node(parm->Value);
+		v.Name(parm->Label);
+		break;
+	}
+
+	case AST_StaticArrayStatement:
+	{
+		auto stmt = static_cast<ZCC_StaticArrayStatement *>(node);
+		v.Node(stmt->Type);
+		v.Name(stmt->Id);
+		v.Node(stmt->Values);
+		break;
+	}
+
+	case AST_CompoundStmt:
+	case AST_Default:
+		v.Node(static_cast<ZCC_CompoundStmt *>(node)->Content);
+		break;
+
+	case AST_ReturnStmt:
+		v.Node(static_cast<ZCC_ReturnStmt *>(node)->Values);
+		break;
+
+	case AST_ExpressionStmt:
+		v.Node(static_cast<ZCC_ExpressionStmt *>(node)->Expression);
+		break;
+
+	case AST_IterationStmt:
+	{
+		auto stmt = static_cast<ZCC_IterationStmt *>(node);
+		v.Node(stmt->LoopCondition);
+		v.Node(stmt->LoopStatement);
+		v.Node(stmt->LoopBumper);
+		v.Value(stmt->CheckAt);
+		break;
+	}
+
+	case AST_IfStmt:
+	{
+		auto stmt = static_cast<ZCC_IfStmt *>(node);
+		v.Node(stmt->Condition);
+		v.Node(stmt->TruePath);
+		v.Node(stmt->FalsePath);
+		break;
+	}
+
+	case AST_SwitchStmt:
+	{
+		auto stmt = static_cast<ZCC_SwitchStmt *>(node);
+		v.Node(stmt->Condition);
+		v.Node(stmt->Content);
+		break;
+	}
+
+	case AST_CaseStmt:
+		v.Node(static_cast<ZCC_CaseStmt *>(node)->Condition);
+		break;
+
+	case AST_AssignStmt:
+	{
+		auto stmt = static_cast<ZCC_AssignStmt *>(node);
+		v.Node(stmt->Dests);
+		v.Node(stmt->Sources);
+		v.Value(stmt->AssignOp);
+		break;
+	}
+
+	case AST_LocalVarStmt:
+	{
+		auto stmt = static_cast<ZCC_LocalVarStmt *>(node);
+		v.Node(stmt->Type);
+		v.Node(stmt->Vars);
+		break;
+	}
+
+	case AST_FuncParamDecl:
+	{
+		auto decl = static_cast<ZCC_FuncParamDecl *>(node);
+		v.Node(decl->Type);
+		v.Node(decl->Default);
+		v.Name(decl->Name);
+		v.Value(decl->Flags);
+		break;
+	}
+
+	case AST_DeclFlags:
+	{
+		auto flags = static_cast<ZCC_DeclFlags *>(node);
+		v.Node(flags->Id);
+		v.String(flags->DeprecationMessage);
+		v.Value(flags->Version);
+		v.Value(flags->Flags);
+		break;
+	}
+
+	case AST_ConstantDef:
+	{
+		auto def = static_cast<ZCC_ConstantDef *>(node);
+		v.Name(def->NodeName);
+		v.Node(def->Value);
+		break;
+	}
+
+	case AST_Declarator:
+		SerializeDeclarator(v, static_cast<ZCC_Declarator *>(node));
+		break;
+
+	case AST_VarDeclarator:
+	{
+		auto decl = static_cast<ZCC_VarDeclarator *>(node);
+		SerializeDeclarator(v, decl);
+		v.Node(decl->Names);
+		v.String(decl->DeprecationMessage);
+		break;
+	}
+
+	case AST_FuncDeclarator:
+	{
+		auto decl = static_cast<ZCC_FuncDeclarator *>(node);
+		SerializeDeclarator(v, decl);
+		v.Node(decl->Params);
+		v.Name(decl->Name);
+		v.Node(decl->Body);
+		v.Node(decl->UseFlags);
+		v.String(decl->DeprecationMessage);
+		break;
+	}
+
+	case AST_PropertyStmt:
+	{
+		auto stmt = static_cast<ZCC_PropertyStmt *>(node);
+		v.Node(stmt->Prop);
+		v.Node(stmt->Values);
+		break;
+	}
+
+	case AST_FlagStmt:
+	{
+		auto stmt = static_cast<ZCC_FlagStmt *>(node);
+		v.Node(stmt->name);
+		v.Value(stmt->set);
+		break;
+	}
+
+	case AST_MixinStmt:
+		v.Name(static_cast<ZCC_MixinStmt *>(node)->MixinName);
+		break;
+
+	default:
+		v.Unknown();
+		break;
+	}
+}
+
+//==========================================================================
+//
+// Tree passes
+//
+//==========================================================================
+
+// Base with no-ops for everything a pass does not care about.
+struct FTreePass
+{
+	bool Failed = false;
+
+	template<class T> void Node(T *&) {}
+	template<class T> void Name(T &) {}
+	template<class T> void Value(T &) {}
+	void String(FString *&) {}
+	void Lump(int &) {}
+	void Type(PType *&) {}
+	void Unknown() { Failed = true; }
+};
+
+// Assigns an index to every node reachable from the top node.
+struct FNodeCollector : FTreePass
+{
+	TArray<ZCC_TreeNode *> Nodes;
+	TMap<ZCC_TreeNode *, uint32_t> Indices;
+
+	template<class T> void Node(T *&node)
+	{
+		if (node != nullptr && Indices.CheckKey(node) == nullptr)
+		{
+			Indices.Insert(node, Nodes.Push(node));
+		}
+	}
+};
+
+struct FNodeWriter : FTreePass
+{
+	MemFile &Out;
+	FNodeCollector &Collector;
+	const TArray<int> &Lumps;
+	TArray<int> NameTable;
+	TMap<int, uint32_t> NameIndices;
+	TArray<FString *> StringTable;
+	TMap<FString *, uint32_t> StringIndices;
+
+	FNodeWriter(MemFile &out, FNodeCollector &collector, const TArray<int> &lumps) : Out(out), Collector(collector), Lumps(lumps) {}
+
+	uint32_t AddName(int name)
+	{
+		auto index = NameIndices.CheckKey(name);
+		if (index != nullptr) return *index;
+		uint32_t newindex = NameTable.Push(name);
+		NameIndices.Insert(name, newindex);
+		return newindex;
+	}
+
+	template<class T> void Node(T *&node)
+	{
+		WriteLong(Out, node == nullptr ? 0 : *Collector.Indices.CheckKey(node) + 1);
+	}
+
+	template<class T> void Name(T &name)
+	{
+		WriteLong(Out, AddName((int)name));
+	}
+
+	template<class T> void Value(T &value)
+	{
+		WriteBytes(Out, &value, sizeof(value));
+	}
+
+	void String(FString *&str)
+	{
+		uint32_t index = 0;
+		if (str != nullptr)
+		{
+			auto check = StringIndices.CheckKey(str);
+			if (check != nullptr) index = *check;
+			else
+			{
+				index = StringTable.Push(str) + 1;
+				StringIndices.Insert(str, index);
+			}
+		}
+		WriteLong(Out, index);
+	}
+
+	void Lump(int &lump)
+	{
+		WriteLong(Out, Lumps.Find(lump));	// == Lumps.Size() if the lump is not in the list.
+	}
+
+	void Type(PType *&type)
+	{
+		int index = GetParseTypeIndex(type);
+		if (index < 0) Failed = true;
+		WriteLong(Out, index);
+	}
+};
+
+// Names are read as indices into the cache's name table and get resolved by FNameResolver
+// once everything has been read, so that a broken cache file cannot add any names.
+struct FNodeReader : FTreePass
+{
+	FCacheReader &In;
+	const TArray<ZCC_TreeNode *> &Nodes;
+	const TArray<FString *> &Strings;
+	const TArray<int> &Lumps;
+	unsigned NumNames;
+
+	FNodeReader(FCacheReader &in, const TArray<ZCC_TreeNode *> &nodes, const TArray<FString *> &strings, const TArray<int> &lumps, unsigned numnames)
+		: In(in), Nodes(nodes), Strings(strings), Lumps(lumps), NumNames(numnames) {}
+
+	template<class T> void Node(T *&node)
+	{
+		uint32_t index = In.ReadLong();
+		if (index > Nodes.Size()) Failed = true;
+		node = index == 0 || Failed ? nullptr : static_cast<T *>(Nodes[index - 1]);
+	}
+
+	template<class T> void Name(T &name)
+	{
+		uint32_t index = In.ReadLong();
+		if (index >= NumNames) Failed = true;
+		name = (T)index;
+	}
+
+	template<class T> void Value(T &value)
+	{
+		In.ReadBytes(&value, sizeof(value));
+	}
+
+	void String(FString *&str)
+	{
+		uint32_t index = In.ReadLong();
+		if (index > Strings.Size()) Failed = true;
+		str = index == 0 || Failed ? nullptr : Strings[index - 1];
+	}
+
+	void Lump(int &lump)
+	{
+		uint32_t index = In.ReadLong();
+		lump = index < Lumps.Size() ? Lumps[index] : -1;
+	}
+
+	void Type(PType *&type)
+	{
+		type = GetParseType(In.ReadLong());
+	}
+};
+
+struct FNameResolver : FTreePass
+{
+	const TArray<FName> &Names;
+
+	FNameResolver(const TArray<FName> &names) : Names(names) {}
+
+	template<class T> void Name(T &name)
+	{
+		name = (T)Names[(unsigned)name].GetIndex();
+	}
+};
+
+//==========================================================================
+//
+// ZCC_SaveParseCache
+//
+// 'lumps' are all lumps that got parsed, the base lump first.
+//
+//==========================================================================
+
+void ZCC_SaveParseCache(int baselump, const TArray<int> &lumps, ZCCParseState &state)
+{
+	if (!zscript_parsecache || state.TopNode == nullptr || FScriptPosition::ErrorCounter > 0)
+	{
+		return;
+	}
+
+	FNodeCollector collector;
+	collector.Node(state.TopNode);
+	for (unsigned i = 0; i < collector.Nodes.Size() && !collector.Failed; i++)
+	{
+		SerializeNode(collector, collector.Nodes[i]);
+	}
+
+	MemFile fields;
+	FNodeWriter writer(fields, collector, lumps);
+	// Everything the scanner produced comes first, in its original order.
+	for (auto name : state.NameOrder)
+	{
+		writer.AddName(name);
+	}
+	for (unsigned i = 0; i < collector.Nodes.Size() && !writer.Failed; i++)
+	{
+		SerializeNode(writer, collector.Nodes[i]);
+	}
+	if (collector.Failed || writer.Failed)
+	{
+		DPrintf(DMSG_NOTIFY, "%s contains nodes that cannot be cached\n", fileSystem.GetFileFullPath(baselump).GetChars());
+		return;
+	}
+
+	MemFile body;
+	WriteLong(body, state.ParseVersion.major);
+	WriteLong(body, state.ParseVersion.minor);
+	WriteLong(body, state.ParseVersion.revision);
+
+	WriteLong(body, lumps.Size());
+	for (auto lump : lumps)
+	{
+		uint8_t md5[16];
+		GetLumpChecksum(lump, md5);
+		WriteString(body, fileSystem.GetFileFullName(lump, false));
+		WriteString(body, fileSystem.GetResourceFileFullName(fileSystem.GetFileContainer(lump)));
+		WriteLong(body, fileSystem.FileLength(lump));
+		WriteBytes(body, md5, 16);
+	}
+
+	WriteLong(body, writer.NameTable.Size());
+	for (auto name : writer.NameTable)
+	{
+		WriteString(body, FName(ENamedName(name)).GetChars());
+	}
+	WriteLong(body, writer.StringTable.Size());
+	for (auto str : writer.StringTable)
+	{
+		WriteLong(body, (uint32_t)str->Len());
+		WriteBytes(body, str->GetChars(), str->Len());
+	}
+	WriteLong(body, collector.Nodes.Size());
+	for (auto node : collector.Nodes)
+	{
+		body.Push((uint8_t)node->NodeType);
+	}
+	WriteBytes(body, fields.Data(), fields.Size());
+
+	uLongf outlen = compressBound(body.Size());
+	TArray<Bytef> compressed(outlen, true);
+	if (compress(compressed.Data(), &outlen, body.Data(), body.Size()) != Z_OK)
+	{
+		return;
+	}
+
+	MemFile header;
+	WriteBytes(header, "ZSCA", 4);
+	WriteLong(header, PARSECACHE_VERSION);
+	WriteString(header, GetGitHash());
+	WriteString(header, GetVersionString());
+	WriteLong(header, body.Size());
+
+	FString path = CreateCacheName(baselump, true);
+	FileWriter *fw = FileWriter::Open(path);
+	if (fw != nullptr)
+	{
+		if (fw->Write(header.Data(), header.Size()) != header.Size() || fw->Write(compressed.Data(), outlen) != outlen)
+		{
+			Printf("Error saving parse cache to file %s\n", path.GetChars());
+		}
+		delete fw;
+	}
+	else
+	{
+		Printf("Cannot open parse cache file %s for writing\n", path.GetChars());
+	}
+}
+
+//==========================================================================
+//
+// ZCC_LoadParseCache
+//
+// Returns false if there is no usable cache, in which case nothing has
+// been changed and the scripts need to be parsed normally.
+//
+//==========================================================================
+
+bool ZCC_LoadParseCache(int baselump, ZCCParseState &state)
+{
+	if (!zscript_parsecache)
+	{
+		return false;
+	}
+
+	FString path = CreateCacheName(baselump, false);
+	FileReader fr;
+	if (!fr.OpenFile(path)) return false;
+
+	TArray<uint8_t> filedata(fr.GetLength(), true);
+	if (fr.Read(filedata.Data(), filedata.Size()) != (long)filedata.Size()) return false;
+
+	FCacheReader header(filedata);
+	char magic[4];
+	header.ReadBytes(magic, 4);
+	if (header.Failed || memcmp(magic, "ZSCA", 4)) return false;
+	if (header.ReadLong() != PARSECACHE_VERSION) return false;
+	if (header.ReadString().Compare(GetGitHash()) != 0) return false;
+	if (header.ReadString().Compare(GetVersionString()) != 0) return false;
+	uLongf bodysize = header.ReadLong();
+	if (header.Failed) return false;
+
+	TArray<uint8_t> body(bodysize, true);
+	if (uncompress(body.Data(), &bodysize, filedata.Data() + header.Pos, uLong(filedata.Size() - header.Pos)) != Z_OK || bodysize != body.Size())
+	{
+		return false;
+	}
+
+	FCacheReader in(body);
+	VersionInfo version;
+	version.major = (uint16_t)in.ReadLong();
+	version.minor = (uint16_t)in.ReadLong();
+	version.revision = in.ReadLong();
+
+	// All lumps must still resolve to the same data, otherwise the result of parsing may be different.
+	TArray<int> lumps;
+	TArray<uint8_t> checksums;
+	unsigned numlumps = in.ReadLong();
+	for (unsigned i = 0; i < numlumps && !in.Failed; i++)
+	{
+		FString name = in.ReadString();
+		FString container = in.ReadString();
+		unsigned size = in.ReadLong();
+		uint8_t md5[16];
+		in.ReadBytes(md5, 16);
+
+		int lump = i == 0 ? baselump : fileSystem.CheckNumForFullName(name, true);
+		if (lump < 0 || name.Compare(fileSystem.GetFileFullName(lump, false)) != 0) return false;
+		int fileno = fileSystem.GetFileContainer(lump);
+		if (container.Compare(fileSystem.GetResourceFileFullName(fileno)) != 0) return false;
+		// Let the parser report a mod that overrides a core script.
+		if (i > 0 && fileSystem.GetFileContainer(baselump) == 0 && fileno != 0) return false;
+		if ((unsigned)fileSystem.FileLength(lump) != size) return false;
+		lumps.Push(lump);
+		memcpy(&checksums[checksums.Reserve(16)], md5, 16);
+	}
+	if (in.Failed) return false;
+
+	// The scripts in a pk3 are usually compressed so let them get inflated in parallel.
+	auto prefetched = fileSystem.PrefetchFiles(lumps);
+	for (unsigned i = 0; i < lumps.Size(); i++)
+	{
+		uint8_t lumpmd5[16];
+		GetLumpChecksum(lumps[i], lumpmd5);
+		if (memcmp(&checksums[i * 16], lumpmd5, 16)) return false;
+	}
+	prefetched.Release();
+
+	TArray<FString> names;
+	unsigned numnames = in.ReadLong();
+	for (unsigned i = 0; i < numnames && !in.Failed; i++)
+	{
+		names.Push(in.ReadString());
+	}
+
+	TArray<FString *> strings;
+	unsigned numstrings = in.ReadLong();
+	for (unsigned i = 0; i < numstrings && !in.Failed; i++)
+	{
+		strings.Push(state.Strings.Alloc(in.ReadString()));
+	}
+
+	TArray<ZCC_TreeNode *> nodes;
+	unsigned numnodes = in.ReadLong();
+	if (in.Failed || numnodes == 0 || numnodes > in.Size - in.Pos) return false;
+	nodes.Resize(numnodes);
+	for (auto &node : nodes)
+	{
+		uint8_t type;
+		in.ReadBytes(&type, 1);
+		size_t size = GetNodeSize(EZCCTreeNodeType(type));
+		if (size == 0) return false;
+		node = state.ZCC_AST::InitNode(size, EZCCTreeNodeType(type), nullptr);
+		memset((uint8_t *)node + sizeof(ZCC_TreeNode), 0, size - sizeof(ZCC_TreeNode));
+	}
+
+	FNodeReader reader(in, nodes, strings, lumps, numnames);
+	for (unsigned i = 0; i < numnodes && !reader.Failed && !in.Failed; i++)
+	{
+		SerializeNode(reader, nodes[i]);
+	}
+	if (reader.Failed || in.Failed || in.Pos != in.Size) return false;
+
+	// The cache is valid. Only now create the names so that a failed attempt leaves no trace.
+	TArray<FName> fnames(numnames, true);
+	for (unsigned i = 0; i < numnames; i++)
+	{
+		fnames[i] = names[i];
+	}
+	FNameResolver resolver(fnames);
+	for (auto node : nodes)
+	{
+		SerializeNode(resolver, node);
+	}
+
+	state.ParseVersion = version;
+	state.TopNode = nodes[0];
+	DPrintf(DMSG_NOTIFY, "Loaded syntax tree of %s from the cache\n", fileSystem.GetFileFullPath(baselump).GetChars());
+	return true;
+}
+
+//==========================================================================
+//
+// CCMD clearzscriptcache
+//
+//==========================================================================
+
+UNSAFE_CCMD(clearzscriptcache)
+{
+	TArray<FFileList> list;
+	FString path = M_GetCachePath(false);
+	path += "/zscript/";
+
+	if (!ScanDirectory(list, path))
+	{
+		Printf("Unable to scan parse cache directory %s\n", path.GetChars());
+		return;
+	}
+
+	// Scan list backwards so that when we reach a directory
+	// all files within are already deleted.
+	for(int i = list.Size()-1; i >= 0; i--)
+	{
+		if (list[i].isDirectory)
+		{
+			rmdir(list[i].Filename);
+		}
+		else
+		{
+			remove(list[i].Filename);
+		}
+	}
+}
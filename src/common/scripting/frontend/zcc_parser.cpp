@@ -278,6 +278,7 @@ static void ParseSingleFile(FScanner *pSC, const char *filename, int lump, void
 
 		case TK_NameConst:
 			value.Int = FName(sc.String).GetIndex();
+			state.AddName(value.Int);
 			tokentype = ZCC_NAMECONST;
 			break;
 
@@ -299,11 +300,13 @@ static void ParseSingleFile(FScanner *pSC, const char *filename, int lump, void
 		case TK_None:	// 'NONE' is a token for SBARINFO but not here.
 		case TK_Identifier:
 			value.Int = FName(sc.String).GetIndex();
+			state.AddName(value.Int);
 			tokentype = ZCC_IDENTIFIER;
 			break;
 
 		case TK_NonWhitespace:
 			value.Int = FName(sc.String).GetIndex();
+			state.AddName(value.Int);
 			tokentype = ZCC_NWS;
 			break;
 
@@ -350,7 +353,7 @@ parse_end:
 
 //**--------------------------------------------------------------------------
 
-PNamespace *ParseOneScript(const int baselump, ZCCParseState &state)
+static void ParseScriptLumps(const int baselump, ZCCParseState &state, TArray<int> &parsedlumps)
 {
 	FScanner sc;
 	void *parser;
@@ -418,6 +421,7 @@ PNamespace *ParseOneScript(const int baselump, ZCCParseState &state)
 	}
 
 	ParseSingleFile(&sc, nullptr, lumpnum, parser, state);
+	parsedlumps.Push(lumpnum);
 	for (unsigned i = 0; i < Includes.Size(); i++)
 	{
 		lumpnum = fileSystem.CheckNumForFullName(Includes[i], true);
@@ -435,6 +439,7 @@ PNamespace *ParseOneScript(const int baselump, ZCCParseState &state)
 			}
 
 			ParseSingleFile(nullptr, nullptr, lumpnum, parser, state);
+			parsedlumps.Push(lumpnum);
 		}
 	}
 	Includes.Clear();
@@ -459,6 +464,18 @@ PNamespace *ParseOneScript(const int baselump, ZCCParseState &state)
 		fclose(f);
 	}
 #endif
+}
+
+//**--------------------------------------------------------------------------
+
+PNamespace *ParseOneScript(const int baselump, ZCCParseState &state)
+{
+	if (!ZCC_LoadParseCache(baselump, state))
+	{
+		TArray<int> parsedlumps;
+		ParseScriptLumps(baselump, state, parsedlumps);
+		ZCC_SaveParseCache(baselump, parsedlumps, state);
+	}
 
 	// Make a dump of the AST before running the compiler for diagnostic purposes.
 	if (Args->CheckParm("-dumpast"))
@@ -611,7 +611,20 @@ struct ZCCParseState : public ZCC_AST
 	ZCCParseState(FScanner *scanner = nullptr) : sc(scanner) {}
 	ZCC_TreeNode *InitNode(size_t size, EZCCTreeNodeType type);
 
+	// Names produced by the scanner in order of first appearance. The parse cache
+	// needs this to recreate them in the same order.
+	void AddName(int name)
+	{
+		if (NamesSeen.CheckKey(name) == nullptr)
+		{
+			NamesSeen.Insert(name, true);
+			NameOrder.Push(name);
+		}
+	}
+
 	FScanner *sc;
+	TArray<int> NameOrder;
+	TMap<int, bool> NamesSeen;
 };
 
 const char *GetMixinTypeString(EZCCMixinType type);
@@ -621,4 +634,8 @@ ZCC_TreeNode *TreeNodeDeepCopy(ZCC_AST *ast, ZCC_TreeNode *orig, bool copySiblin
 // Main entry point for the parser. Returns some data needed by the compiler.
 PNamespace* ParseOneScript(const int baselump, ZCCParseState& state);
 
+// Persistent cache for the syntax tree (zcc_cache.cpp)
+bool ZCC_LoadParseCache(int baselump, ZCCParseState &state);
+void ZCC_SaveParseCache(int baselump, const TArray<int> &lumps, ZCCParseState &state);
+
 #endif
@@ -3,13 +3,18 @@
 #include "jitintern.h"
 #include "printf.h"
 
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
 extern PString *TypeString;
 extern PStruct *TypeVector2;
 extern PStruct *TypeVector3;
 
-static void OutputJitLog(const asmjit::StringLogger &logger);
+static void OutputJitLog(const char *log);
 
-JitFuncPtr JitCompile(VMScriptFunction *sfunc)
+// Compiles the function without printing anything, so that it can also be used by the compile thread.
+static JitFuncPtr JitCompileQuiet(VMScriptFunction *sfunc, FString &log, FString &error)
 {
 #if 0
 	if (strcmp(sfunc->PrintableName.GetChars(), "StatusScreen.drawNum") != 0)
@@ -18,6 +23,7 @@ JitFuncPtr JitCompile(VMScriptFunction *sfunc)
 
 	using namespace asmjit;
 	StringLogger logger;
+	std::lock_guard<std::mutex> lock(JitMutex);
 	try
 	{
 		ThrowingErrorHandler errorHandler;
@@ -31,16 +37,29 @@ JitFuncPtr JitCompile(VMScriptFunction *sfunc)
 	}
 	catch (const CRecoverableError &e)
 	{
-		OutputJitLog(logger);
-		Printf("%s: Unexpected JIT error: %s\n",sfunc->PrintableName.GetChars(), e.what());
+		log = logger.getString();
+		error.Format("%s: Unexpected JIT error: %s\n", sfunc->PrintableName.GetChars(), e.what());
 		return nullptr;
 	}
 }
 
+JitFuncPtr JitCompile(VMScriptFunction *sfunc)
+{
+	FString log, error;
+	JitFuncPtr func = JitCompileQuiet(sfunc, log, error);
+	if (func == nullptr && error.IsNotEmpty())
+	{
+		OutputJitLog(log.GetChars());
+		Printf("%s", error.GetChars());
+	}
+	return func;
+}
+
 void JitDumpLog(FILE *file, VMScriptFunction *sfunc)
 {
 	using namespace asmjit;
 	StringLogger logger;
+	std::lock_guard<std::mutex> lock(JitMutex);
 	try
 	{
 		ThrowingErrorHandler errorHandler;
@@ -67,10 +86,10 @@ void JitDumpLog(FILE *file, VMScriptFunction *sfunc)
 	}
 }
 
-static void OutputJitLog(const asmjit::StringLogger &logger)
+static void OutputJitLog(const char *log)
 {
 	// Write line by line since I_FatalError seems to cut off long strings
-	const char *pos = logger.getString();
+	const char *pos = log;
 	const char *end = pos;
 	while (*end)
 	{
@@ -88,6 +107,100 @@ static void OutputJitLog(const asmjit::StringLogger &logger)
 
 /////////////////////////////////////////////////////////////////////////////
 
+// Background compilation: functions get queued on their first call and are
+// interpreted until the compile thread has native code for them. The code is
+// installed by VMScriptFunction::PendingJitScriptCall on the main thread.
+
+static std::thread CompileThread;
+static std::mutex CompileMutex;
+static std::condition_variable CompileCondition;
+static std::deque<VMScriptFunction *> CompileQueue;
+static bool CompileThreadStop;
+static FString CompileErrors;
+
+static void CompileThreadMain()
+{
+	std::unique_lock<std::mutex> lock(CompileMutex);
+	while (true)
+	{
+		CompileCondition.wait(lock, []() { return CompileThreadStop || !CompileQueue.empty(); });
+		if (CompileThreadStop)
+			break;
+
+		VMScriptFunction *sfunc = CompileQueue.front();
+		CompileQueue.pop_front();
+		lock.unlock();
+
+		FString log, error;
+		JitFuncPtr func = nullptr;
+		try
+		{
+			func = JitCompileQuiet(sfunc, log, error);
+		}
+		catch (const std::exception &e)
+		{
+			// Fatal code generation errors must not take down the game from this thread. The function just stays interpreted.
+			error.Format("%s: Unexpected JIT error: %s\n", sfunc->PrintableName.GetChars(), e.what());
+		}
+		sfunc->JitCode = func;
+		sfunc->JitState.store(VMScriptFunction::JIT_Done, std::memory_order_release);
+
+		lock.lock();
+		if (error.IsNotEmpty())
+		{
+			CompileErrors << log << error;
+		}
+	}
+}
+
+void JitCompileInBackground(VMScriptFunction *sfunc)
+{
+	sfunc->JitState.store(VMScriptFunction::JIT_Pending, std::memory_order_relaxed);
+	{
+		std::unique_lock<std::mutex> lock(CompileMutex);
+		if (!CompileThread.joinable())
+		{
+			CompileThreadStop = false;
+			CompileThread = std::thread(CompileThreadMain);
+		}
+		CompileQueue.push_back(sfunc);
+	}
+	CompileCondition.notify_one();
+}
+
+// Prints the errors of failed background compiles. Must be called from the main thread.
+void JitPrintBackgroundErrors()
+{
+	FString errors;
+	{
+		std::unique_lock<std::mutex> lock(CompileMutex);
+		errors = std::move(CompileErrors);
+		CompileErrors = "";
+	}
+	if (errors.IsNotEmpty())
+	{
+		OutputJitLog(errors.GetChars());
+	}
+}
+
+// Functions that are still queued stay interpreted.
+void JitStopCompileThread()
+{
+	{
+		std::unique_lock<std::mutex> lock(CompileMutex);
+		CompileThreadStop = true;
+		CompileQueue.clear();
+	}
+	CompileCondition.notify_one();
+	if (CompileThread.joinable())
+	{
+		CompileThread.join();
+	}
+	CompileErrors = "";
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
 static const char *OpNames[NUM_OPS] =
 {
 #define xx(op, name, mode, alt, kreg, ktype)	#op,
@@ -4,5 +4,7 @@
 #include "vmintern.h"
 
 JitFuncPtr JitCompile(VMScriptFunction *func);
+void JitCompileInBackground(VMScriptFunction *func);
+void JitPrintBackgroundErrors();
 void JitDumpLog(FILE *file, VMScriptFunction *func);
 FString JitCaptureStackTrace(int framesToSkip, bool includeNativeFrames);
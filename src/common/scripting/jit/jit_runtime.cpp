@@ -22,6 +22,8 @@ struct JitFuncInfo
 	void *end;
 };
 
+std::mutex JitMutex;
+
 static TArray<JitFuncInfo> JitDebugInfo;
 static TArray<uint8_t*> JitBlocks;
 static TArray<uint8_t*> JitFrames;
@@ -737,6 +739,7 @@ void *AddJitFunction(asmjit::CodeHolder* code, JitCompiler *compiler)
 
 void JitRelease()
 {
+	std::lock_guard<std::mutex> lock(JitMutex);
 #ifdef _WIN64
 	for (auto p : JitFrames)
 	{
@@ -962,6 +965,7 @@ FString JitCaptureStackTrace(int framesToSkip, bool includeNativeFrames)
 		nativeSymbols.reset(new NativeSymbolResolver());
 
 	FString s;
+	std::lock_guard<std::mutex> lock(JitMutex);
 	for (int i = framesToSkip + 1; i < numframes; i++)
 	{
 		s += JitGetStackFrameName(nativeSymbols.get(), frames[i]);
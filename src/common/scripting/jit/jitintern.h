@@ -11,6 +11,7 @@
 #include <asmjit/asmjit.h>
 #include <asmjit/x86.h>
 #include <functional>
+#include <mutex>
 #include <vector>
 
 extern cycle_t VMCycles[10];
@@ -334,4 +335,7 @@ public:
 };
 
 void *AddJitFunction(asmjit::CodeHolder* code, JitCompiler *compiler);
+
+// Guards the code generator and the JIT memory, which are shared with the background compile thread.
+extern std::mutex JitMutex;
 asmjit::CodeInfo GetHostCodeInfo();
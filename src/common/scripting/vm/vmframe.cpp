@@ -54,10 +54,13 @@ CUSTOM_CVAR(Bool, vm_jit, true, CVAR_NOINITCALL)
 	Printf("You must restart " GAMENAME " for this change to take effect.\n");
 	Printf("This cvar is currently not saved. You must specify it on the command line.");
 }
+// Compiles functions on a separate thread so that their first calls do not have to wait for the JIT.
+CVAR(Bool, vm_jit_background, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 #else
 CVAR(Bool, vm_jit, false, CVAR_NOINITCALL|CVAR_NOSET)
 FString JitCaptureStackTrace(int framesToSkip, bool includeNativeFrames) { return FString(); }
 void JitRelease() {}
+void JitStopCompileThread() {}
 #endif
 
 cycle_t VMCycles[10];
@@ -294,9 +297,17 @@ int VMScriptFunction::FirstScriptCall(VMFunction *func, VMValue *params, int num
 #ifdef HAVE_VM_JIT
 	if (vm_jit && CanJit(static_cast<VMScriptFunction*>(func)))
 	{
-		func->ScriptCall = JitCompile(static_cast<VMScriptFunction*>(func));
-		if (!func->ScriptCall)
-			func->ScriptCall = VMExec;
+		if (vm_jit_background)
+		{
+			JitCompileInBackground(static_cast<VMScriptFunction*>(func));
+			func->ScriptCall = &VMScriptFunction::PendingJitScriptCall;
+		}
+		else
+		{
+			func->ScriptCall = JitCompile(static_cast<VMScriptFunction*>(func));
+			if (!func->ScriptCall)
+				func->ScriptCall = VMExec;
+		}
 	}
 	else
 #endif // HAVE_VM_JIT
@@ -307,6 +318,28 @@ int VMScriptFunction::FirstScriptCall(VMFunction *func, VMValue *params, int num
 	return func->ScriptCall(func, params, numparams, ret, numret);
 }
 
+// Runs the function in the interpreter until the compile thread is done with it.
+int VMScriptFunction::PendingJitScriptCall(VMFunction *func, VMValue *params, int numparams, VMReturn *ret, int numret)
+{
+#ifdef HAVE_VM_JIT
+	auto sfunc = static_cast<VMScriptFunction*>(func);
+	if (sfunc->JitState.load(std::memory_order_acquire) == JIT_Done)
+	{
+		if (sfunc->JitCode != nullptr)
+		{
+			func->ScriptCall = sfunc->JitCode;
+		}
+		else
+		{
+			func->ScriptCall = VMExec;
+			JitPrintBackgroundErrors();
+		}
+		return func->ScriptCall(func, params, numparams, ret, numret);
+	}
+#endif // HAVE_VM_JIT
+	return VMExec(func, params, numparams, ret, numret);
+}
+
 int VMNativeFunction::NativeScriptCall(VMFunction *func, VMValue *params, int numparams, VMReturn *returns, int numret)
 {
 	try
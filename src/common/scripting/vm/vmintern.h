@@ -1,6 +1,7 @@
 #pragma once
 
 #include "vm.h"
+#include <atomic>
 #include <csetjmp>
 
 class VMScriptFunction;
@@ -473,6 +474,11 @@ public:
 	VM_UBYTE NumArgs;		// Number of arguments this function takes
 	TArray<FTypeAndOffset> SpecialInits;	// list of all contents on the extra stack which require construction and destruction
 
+	// State of background JIT compilation. JitCode may only be read once JitState is JIT_Done.
+	enum { JIT_None, JIT_Pending, JIT_Done };
+	std::atomic<int> JitState { JIT_None };
+	JitFuncPtr JitCode = nullptr;
+
 	void InitExtra(void *addr);
 	void DestroyExtra(void *addr);
 	int AllocExtraStack(PType *type);
@@ -480,4 +486,5 @@ public:
 
 private:
 	static int FirstScriptCall(VMFunction *func, VMValue *params, int numparams, VMReturn *ret, int numret);
+	static int PendingJitScriptCall(VMFunction *func, VMValue *params, int numparams, VMReturn *ret, int numret);
 };
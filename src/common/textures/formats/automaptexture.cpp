@@ -92,7 +92,7 @@ FAutomapTexture::FAutomapTexture (int lumpnum)
 TArray<uint8_t> FAutomapTexture::CreatePalettedPixels(int conversion)
 {
 	int x, y;
-	FileData data = fileSystem.ReadFile (SourceLump);
+	FileData data = fileSystem.ReadFileView (SourceLump);
 	const uint8_t *indata = (const uint8_t *)data.GetMem();
 
 	TArray<uint8_t> Pixels(Width * Height, true);
@@ -172,7 +172,7 @@ FRawPageTexture::FRawPageTexture (int lumpnum)
 
 TArray<uint8_t> FRawPageTexture::CreatePalettedPixels(int conversion)
 {
-	FileData lump = fileSystem.ReadFile (SourceLump);
+	FileData lump = fileSystem.ReadFileView (SourceLump);
 	const uint8_t *source = (const uint8_t *)lump.GetMem();
 	const uint8_t *source_p = source;
 	uint8_t *dest_p;
@@ -204,8 +204,8 @@ int FRawPageTexture::CopyPixels(FBitmap *bmp, int conversion)
 	if (mPaletteLump < 0) return FImageSource::CopyPixels(bmp, conversion);
 	else
 	{
-		FileData lump = fileSystem.ReadFile(SourceLump);
-		FileData plump = fileSystem.ReadFile(mPaletteLump);
+		FileData lump = fileSystem.ReadFileView(SourceLump);
+		FileData plump = fileSystem.ReadFileView(mPaletteLump);
 		const uint8_t *source = (const uint8_t *)lump.GetMem();
 		const uint8_t *psource = (const uint8_t *)plump.GetMem();
 		PalEntry paldata[256];
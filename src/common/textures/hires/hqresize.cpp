@@ -34,7 +34,13 @@
 **
 */
 
+#include <zlib.h>
 #include "c_cvars.h"
+#include "c_dispatch.h"
+#include "cmdlib.h"
+#include "files.h"
+#include "md5.h"
+#include "i_specialpaths.h"
 #include "hqnx/hqx.h"
 #ifdef HAVE_MMX
 #include "hqnx_asm/hqnx_asm.h"
@@ -87,6 +93,7 @@ CVAR (Flag, gl_texture_hqresize_fonts, gl_texture_hqresize_targets, 4);
 CVAR (Flag, gl_texture_hqresize_skins, gl_texture_hqresize_targets, 8);
 
 CVAR(Bool, gl_texture_hqresize_multithread, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
+CVAR(Bool, gl_texture_hqresize_diskcache, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 
 CUSTOM_CVAR(Int, gl_texture_hqresize_mt_width, 16, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 {
@@ -296,13 +303,9 @@ static unsigned char *hqNxAsmHelper( void (*hqNxFunction) ( int*, unsigned char*
 	outWidth = N * inWidth;
 	outHeight = N *inHeight;
 
-	static int initdone = false;
-
-	if (!initdone)
-	{
-		HQnX_asm::InitLUTs();
-		initdone = true;
-	}
+	// Textures may get upscaled on the precacher's worker threads.
+	static bool initdone = (HQnX_asm::InitLUTs(), true);
+	(void)initdone;
 
 	HQnX_asm::CImage cImageIn;
 	cImageIn.SetImage(inputBuffer, inWidth, inHeight, 32);
@@ -315,7 +318,7 @@ static unsigned char *hqNxAsmHelper( void (*hqNxFunction) ( int*, unsigned char*
 }
 #endif
 
-static unsigned char *hqNxHelper( void (HQX_CALLCONV *hqNxFunction) ( unsigned*, unsigned*, int, int ),
+static unsigned char *hqNxHelper( void (HQX_CALLCONV *hqNxFunction) ( uint32_t*, uint32_t, uint32_t*, uint32_t, int, int, int, int ),
 							  const int N,
 							  unsigned char *inputBuffer,
 							  const int inWidth,
@@ -323,18 +326,34 @@ static unsigned char *hqNxHelper( void (HQX_CALLCONV *hqNxFunction) ( unsigned*,
 							  int &outWidth,
 							  int &outHeight )
 {
-	static int initdone = false;
-
-	if (!initdone)
-	{
-		hqxInit();
-		initdone = true;
-	}
+	static bool initdone = (hqxInit(), true);
+	(void)initdone;
 	outWidth = N * inWidth;
 	outHeight = N *inHeight;
 
 	unsigned char * newBuffer = new unsigned char[outWidth*outHeight*4];
-	hqNxFunction( reinterpret_cast<unsigned*>(inputBuffer), reinterpret_cast<unsigned*>(newBuffer), inWidth, inHeight );
+
+	uint32_t *src = reinterpret_cast<uint32_t*>(inputBuffer);
+	uint32_t *dest = reinterpret_cast<uint32_t*>(newBuffer);
+	const uint32_t srcPitch = inWidth * 4;
+	const uint32_t destPitch = outWidth * 4;
+	const int thresholdWidth  = gl_texture_hqresize_mt_width;
+	const int thresholdHeight = gl_texture_hqresize_mt_height;
+
+	if (gl_texture_hqresize_multithread
+		&& inWidth  > thresholdWidth
+		&& inHeight > thresholdHeight)
+	{
+		parallel_for(inHeight, thresholdHeight, [=](int sliceY)
+		{
+			hqNxFunction(src, srcPitch, dest, destPitch, inWidth, inHeight, sliceY, sliceY + thresholdHeight);
+		});
+	}
+	else
+	{
+		hqNxFunction(src, srcPitch, dest, destPitch, inWidth, inHeight, 0, inHeight);
+	}
+
 	delete[] inputBuffer;
 	return newBuffer;
 }
@@ -413,20 +432,197 @@ static void xbrzOldScale(size_t factor, const uint32_t* src, uint32_t* trg, int
 
 
 //===========================================================================
-// 
-// [BB] Upsamples the texture in texbuffer.mBuffer, frees texbuffer.mBuffer and returns
-//  the upsampled buffer.
+//
+// Upscale cache
+//
+// The results of the expensive filters get stored in the cache folder,
+// keyed by the source pixels, the filter and its settings, so that later
+// sessions can load them instead of running the filter again.
 //
 //===========================================================================
 
-void FTexture::CreateUpsampledTextureBuffer(FTextureBuffer &texbuffer, bool hasAlpha, bool checkonly)
+enum
 {
-	// [BB] Make sure that inWidth and inHeight denote the size of
-	// the returned buffer even if we don't upsample the input buffer.
+	UPSCALECACHE_VERSION = 1,
+	UPSCALECACHE_MINPIXELS = 32 * 32,	// smaller images are faster to scale than to load.
+};
 
+struct FUpscaleCacheKey
+{
+	uint8_t Hash[16];
+	FString CacheName;
+};
+
+static FString UpscaleCachePath(bool create)
+{
+	FString path = M_GetCachePath(create);
+	path += "/upscale";
+	if (create) CreatePath(path);
+	return path;
+}
+
+static bool GetUpscaleCacheKey(const FTextureBuffer &texbuffer, int type, int mult, FUpscaleCacheKey &key)
+{
+	if (!gl_texture_hqresize_diskcache || type < 2 || type > 5 || texbuffer.mWidth * texbuffer.mHeight < UPSCALECACHE_MINPIXELS)
+		return false;
+
+	int32_t params[5] = { UPSCALECACHE_VERSION, texbuffer.mWidth, texbuffer.mHeight, type, mult };
+	MD5Context md5;
+	md5.Update((const uint8_t *)params, sizeof(params));
+	if (type >= 4)
+	{
+		float xbrzparams[5] = { xbrz_luminanceweight, xbrz_equalcolortolerance, xbrz_centerdirectionbias, xbrz_dominantdirectionthreshold, xbrz_steepdirectionthreshold };
+		int32_t colorformat = xbrz_colorformat;
+		md5.Update((const uint8_t *)xbrzparams, sizeof(xbrzparams));
+		md5.Update((const uint8_t *)&colorformat, sizeof(colorformat));
+	}
+	md5.Update(texbuffer.mBuffer, texbuffer.mWidth * texbuffer.mHeight * 4);
+	md5.Final(key.Hash);
+
+	key.CacheName = UpscaleCachePath(false) + "/";
+	for (auto c : key.Hash) key.CacheName.AppendFormat("%02x", c);
+	key.CacheName << ".gzu";
+	return true;
+}
+
+static bool ReadUpscaleCache(const FUpscaleCacheKey &key, FTextureBuffer &texbuffer, int mult)
+{
+	FileReader fr;
+	if (!fr.OpenFile(key.CacheName))
+		return false;
+
+	char magic[4];
+	uint8_t hash[16];
+	uint32_t header[4];
+	if (fr.Read(magic, 4) != 4 || memcmp(magic, "GZU1", 4) || fr.Read(hash, 16) != 16 || memcmp(hash, key.Hash, 16))
+		return false;
+	if (fr.Read(header, sizeof(header)) != sizeof(header))
+		return false;
+
+	int outWidth = texbuffer.mWidth * mult;
+	int outHeight = texbuffer.mHeight * mult;
+	uint32_t compressedSize = LittleLong(header[3]);
+	if (LittleLong(header[0]) != UPSCALECACHE_VERSION || LittleLong(header[1]) != (uint32_t)outWidth || LittleLong(header[2]) != (uint32_t)outHeight ||
+		compressedSize != uint32_t(fr.GetLength() - fr.Tell()))
+		return false;
+
+	TArray<uint8_t> compressed(compressedSize, true);
+	if (fr.Read(compressed.Data(), compressedSize) != compressedSize)
+		return false;
+
+	uLongf size = outWidth * outHeight * 4;
+	unsigned char *buffer = new unsigned char[size];
+	if (uncompress(buffer, &size, compressed.Data(), compressedSize) != Z_OK || size != uLongf(outWidth * outHeight * 4))
+	{
+		delete[] buffer;
+		return false;
+	}
+	delete[] texbuffer.mBuffer;
+	texbuffer.mBuffer = buffer;
+	texbuffer.mWidth = outWidth;
+	texbuffer.mHeight = outHeight;
+	return true;
+}
+
+static void WriteUpscaleCache(const FUpscaleCacheKey &key, const FTextureBuffer &texbuffer)
+{
+	uLong size = texbuffer.mWidth * texbuffer.mHeight * 4;
+	uLongf compressedSize = compressBound(size);
+	const unsigned headerSize = 4 + 16 + 16;
+	TArray<uint8_t> out(unsigned(headerSize + compressedSize), true);
+
+	// Speed matters more than size here, the filters' output compresses well anyway.
+	if (compress2(out.Data() + headerSize, &compressedSize, texbuffer.mBuffer, size, Z_BEST_SPEED) != Z_OK)
+		return;
+
+	uint32_t header[4] = { LittleLong(uint32_t(UPSCALECACHE_VERSION)), LittleLong(uint32_t(texbuffer.mWidth)), LittleLong(uint32_t(texbuffer.mHeight)), LittleLong(uint32_t(compressedSize)) };
+	memcpy(out.Data(), "GZU1", 4);
+	memcpy(out.Data() + 4, key.Hash, 16);
+	memcpy(out.Data() + 20, header, 16);
+
+	// Textures get upscaled on several threads and two of them may have the same content,
+	// so this writes to a temporary file and renames it when done.
+	UpscaleCachePath(true);
+	FString tempname;
+	tempname.Format("%s.%p", key.CacheName.GetChars(), (void *)texbuffer.mBuffer);
+	auto fw = FileWriter::Open(tempname);
+	if (fw == nullptr)
+		return;
+	size_t length = headerSize + compressedSize;
+	bool ok = fw->Write(out.Data(), length) == length;
+	delete fw;
+	if (ok && rename(tempname, key.CacheName) != 0)
+	{
+		// rename does not replace existing files on Windows.
+		remove(key.CacheName);
+		ok = rename(tempname, key.CacheName) == 0;
+	}
+	if (!ok) remove(tempname);
+}
+
+//===========================================================================
+// 
+// Runs the scaler. Returns false if the settings do not select one.
+//
+//===========================================================================
+
+static bool RunUpscaler(FTextureBuffer &texbuffer, int type, int mult)
+{
 	int inWidth = texbuffer.mWidth;
 	int inHeight = texbuffer.mHeight;
 
+	if (type == 1)
+	{
+		if (mult == 2)
+			texbuffer.mBuffer = scaleNxHelper(&scale2x, 2, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+		else if (mult == 3)
+			texbuffer.mBuffer = scaleNxHelper(&scale3x, 3, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+		else if (mult == 4)
+			texbuffer.mBuffer = scaleNxHelper(&scale4x, 4, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+		else return false;
+	}
+	else if (type == 2)
+	{
+		if (mult == 2)
+			texbuffer.mBuffer = hqNxHelper(&hq2x_32_rb_rows, 2, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+		else if (mult == 3)
+			texbuffer.mBuffer = hqNxHelper(&hq3x_32_rb_rows, 3, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+		else if (mult == 4)
+			texbuffer.mBuffer = hqNxHelper(&hq4x_32_rb_rows, 4, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+		else return false;
+	}
+#ifdef HAVE_MMX
+	else if (type == 3)
+	{
+		if (mult == 2)
+			texbuffer.mBuffer = hqNxAsmHelper(&HQnX_asm::hq2x_32, 2, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+		else if (mult == 3)
+			texbuffer.mBuffer = hqNxAsmHelper(&HQnX_asm::hq3x_32, 3, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+		else if (mult == 4)
+			texbuffer.mBuffer = hqNxAsmHelper(&HQnX_asm::hq4x_32, 4, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+		else return false;
+	}
+#endif
+	else if (type == 4)
+		texbuffer.mBuffer = xbrzHelper(xbrz::scale, mult, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+	else if (type == 5)
+		texbuffer.mBuffer = xbrzHelper(xbrzOldScale, mult, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+	else if (type == 6)
+		texbuffer.mBuffer = normalNx(mult, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+	else
+		return false;
+	return true;
+}
+
+//===========================================================================
+// 
+// [BB] Upsamples the texture in texbuffer.mBuffer, frees texbuffer.mBuffer and returns
+//  the upsampled buffer.
+//
+//===========================================================================
+
+void FTexture::CreateUpsampledTextureBuffer(FTextureBuffer &texbuffer, bool hasAlpha, bool checkonly)
+{
 	int type = gl_texture_hqresizemode;
 	int mult = gl_texture_hqresizemult;
 #ifdef HAVE_MMX
@@ -442,46 +638,13 @@ void FTexture::CreateUpsampledTextureBuffer(FTextureBuffer &texbuffer, bool hasA
 
 	if (!checkonly)
 	{
-		if (type == 1)
-		{
-			if (mult == 2)
-				texbuffer.mBuffer = scaleNxHelper(&scale2x, 2, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-			else if (mult == 3)
-				texbuffer.mBuffer = scaleNxHelper(&scale3x, 3, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-			else if (mult == 4)
-				texbuffer.mBuffer = scaleNxHelper(&scale4x, 4, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-			else return;
-		}
-		else if (type == 2)
+		FUpscaleCacheKey cacheKey;
+		bool usecache = GetUpscaleCacheKey(texbuffer, type, mult, cacheKey);
+		if (!usecache || !ReadUpscaleCache(cacheKey, texbuffer, mult))
 		{
-			if (mult == 2)
-				texbuffer.mBuffer = hqNxHelper(&hq2x_32, 2, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-			else if (mult == 3)
-				texbuffer.mBuffer = hqNxHelper(&hq3x_32, 3, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-			else if (mult == 4)
-				texbuffer.mBuffer = hqNxHelper(&hq4x_32, 4, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-			else return;
+			if (!RunUpscaler(texbuffer, type, mult)) return;
+			if (usecache) WriteUpscaleCache(cacheKey, texbuffer);
 		}
-#ifdef HAVE_MMX
-		else if (type == 3)
-		{
-			if (mult == 2)
-				texbuffer.mBuffer = hqNxAsmHelper(&HQnX_asm::hq2x_32, 2, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-			else if (mult == 3)
-				texbuffer.mBuffer = hqNxAsmHelper(&HQnX_asm::hq3x_32, 3, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-			else if (mult == 4)
-				texbuffer.mBuffer = hqNxAsmHelper(&HQnX_asm::hq4x_32, 4, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-			else return;
-		}
-#endif
-		else if (type == 4)
-			texbuffer.mBuffer = xbrzHelper(xbrz::scale, mult, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-		else if (type == 5)
-			texbuffer.mBuffer = xbrzHelper(xbrzOldScale, mult, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-		else if (type == 6)
-			texbuffer.mBuffer = normalNx(mult, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-		else
-			return;
 	}
 	else
 	{
@@ -520,4 +683,34 @@ void calcShouldUpscale(FGameTexture *tex)
 		return;
 
 	tex->SetUpscaleFlag(1);
-}
\ No newline at end of file
+}
+
+//===========================================================================
+//
+// CCMD clearupscalecache
+//
+//===========================================================================
+
+UNSAFE_CCMD(clearupscalecache)
+{
+	TArray<FFileList> list;
+	FString path = UpscaleCachePath(false) + "/";
+
+	if (!ScanDirectory(list, path))
+	{
+		Printf("Unable to scan upscale cache %s\n", path.GetChars());
+		return;
+	}
+
+	for (int i = list.Size() - 1; i >= 0; i--)
+	{
+		if (list[i].isDirectory)
+		{
+			rmdir(list[i].Filename);
+		}
+		else
+		{
+			remove(list[i].Filename);
+		}
+	}
+}
@@ -34,17 +34,20 @@
 **
 */
 
+#include <mutex>
 #include "bitmap.h"
 #include "image.h"
 #include "filesystem.h"
 #include "files.h"
 #include "cmdlib.h"
 #include "palettecontainer.h"
+#include "jobsystem.h"
 
 FMemArena ImageArena(32768);
 TArray<FImageSource *>FImageSource::ImageForLump;
 int FImageSource::NextID;
 static PrecacheInfo precacheInfo;
+static std::mutex precacheMutex;	// the precacher decodes images on multiple threads.
 
 struct PrecacheDataPaletted
 {
@@ -89,6 +92,7 @@ PalettedPixels FImageSource::GetCachedPalettedPixels(int conversion)
 	auto imageID = ImageID;
 
 	// Do we have this image in the cache?
+	std::unique_lock<std::mutex> lock(precacheMutex);
 	unsigned index = conversion != normal? UINT_MAX : precacheDataPaletted.FindEx([=](PrecacheDataPaletted &entry) { return entry.ImageID == imageID; });
 	if (index < precacheDataPaletted.Size())
 	{
@@ -97,7 +101,16 @@ PalettedPixels FImageSource::GetCachedPalettedPixels(int conversion)
 		if (cache->RefCount > 1)
 		{
 			//Printf("returning reference to %s, refcount = %d\n", name.GetChars(), cache->RefCount);
-			ret.Pixels.Set(cache->Pixels.Data(), cache->Pixels.Size());
+			// Jobs need a copy because the last user takes over the cached data and may free it on another thread.
+			if (FJobSystem::InJob())
+			{
+				ret.PixelStore = cache->Pixels;
+				ret.Pixels.Set(ret.PixelStore.Data(), ret.PixelStore.Size());
+			}
+			else
+			{
+				ret.Pixels.Set(cache->Pixels.Data(), cache->Pixels.Size());
+			}
 			cache->RefCount--;
 		}
 		else if (cache->Pixels.Size() > 0)
@@ -120,6 +133,7 @@ PalettedPixels FImageSource::GetCachedPalettedPixels(int conversion)
 		{
 			// This is either the only copy needed or some access outside the caching block. In these cases create a new one and directly return it.
 			//Printf("returning fresh copy of %s\n", name.GetChars());
+			lock.unlock();
 			ret.PixelStore = CreatePalettedPixels(conversion);
 			ret.Pixels.Set(ret.PixelStore.Data(), ret.PixelStore.Size());
 		}
@@ -127,13 +141,26 @@ PalettedPixels FImageSource::GetCachedPalettedPixels(int conversion)
 		{
 			//Printf("creating cached entry for %s, refcount = %d\n", name.GetChars(), info->second);
 			// This is the first time it gets accessed and needs to be placed in the cache.
-			PrecacheDataPaletted *pdp = &precacheDataPaletted[precacheDataPaletted.Reserve(1)];
+			// The image gets created without holding the lock. Other threads which want it in the meantime create their own copy.
+			int refcount = info->second - 1;
+			info->second = 0;
+			lock.unlock();
+			auto pixels = CreatePalettedPixels(normal);
+			if (FJobSystem::InJob())
+			{
+				ret.PixelStore = pixels;
+				ret.Pixels.Set(ret.PixelStore.Data(), ret.PixelStore.Size());
+			}
+			else
+			{
+				ret.Pixels.Set(pixels.Data(), pixels.Size());	// the buffer stays the same when it is moved into the cache.
+			}
 
+			lock.lock();
+			PrecacheDataPaletted *pdp = &precacheDataPaletted[precacheDataPaletted.Reserve(1)];
 			pdp->ImageID = imageID;
-			pdp->RefCount = info->second - 1;
-			info->second = 0;
-			pdp->Pixels = CreatePalettedPixels(normal);
-			ret.Pixels.Set(pdp->Pixels.Data(), pdp->Pixels.Size());
+			pdp->RefCount = refcount;
+			pdp->Pixels = std::move(pixels);
 		}
 	}
 	return ret;
@@ -216,6 +243,7 @@ FBitmap FImageSource::GetCachedBitmap(const PalEntry *remap, int conversion, int
 	{
 		if (conversion == luminance) conversion = normal;	// luminance has no meaning for true color.
 		// Do we have this image in the cache?
+		std::unique_lock<std::mutex> lock(precacheMutex);
 		unsigned index = conversion != normal? UINT_MAX : precacheDataRgba.FindEx([=](PrecacheDataRgba &entry) { return entry.ImageID == imageID; });
 		if (index < precacheDataRgba.Size())
 		{
@@ -225,7 +253,8 @@ FBitmap FImageSource::GetCachedBitmap(const PalEntry *remap, int conversion, int
 			if (cache->RefCount > 1)
 			{
 				//Printf("returning reference to %s, refcount = %d\n", name.GetChars(), cache->RefCount);
-				ret.Copy(cache->Pixels, false);
+				// Jobs need a copy because the last user takes over the cached data and may free it on another thread.
+				ret.Copy(cache->Pixels, FJobSystem::InJob());
 				cache->RefCount--;
 			}
 			else if (cache->Pixels.GetPixels())
@@ -238,6 +267,7 @@ FBitmap FImageSource::GetCachedBitmap(const PalEntry *remap, int conversion, int
 			{
 				// This should never happen if the function is implemented correctly
 				//Printf("something bad happened for %s, refcount = %d\n", name.GetChars(), cache->RefCount);
+				lock.unlock();
 				ret.Create(Width, Height);
 				trans = CopyPixels(&ret, normal);
 			}
@@ -250,6 +280,7 @@ FBitmap FImageSource::GetCachedBitmap(const PalEntry *remap, int conversion, int
 			{
 				// This is either the only copy needed or some access outside the caching block. In these cases create a new one and directly return it.
 				//Printf("returning fresh copy of %s\n", name.GetChars());
+				lock.unlock();
 				ret.Create(Width, Height);
 				trans = CopyPixels(&ret, conversion);
 			}
@@ -257,14 +288,21 @@ FBitmap FImageSource::GetCachedBitmap(const PalEntry *remap, int conversion, int
 			{
 				//Printf("creating cached entry for %s, refcount = %d\n", name.GetChars(), info->first);
 				// This is the first time it gets accessed and needs to be placed in the cache.
+				// The image gets created without holding the lock. Other threads which want it in the meantime create their own copy.
+				int refcount = info->first - 1;
+				info->first = 0;
+				lock.unlock();
+				FBitmap pixels;
+				pixels.Create(Width, Height);
+				trans = CopyPixels(&pixels, normal);
+				ret.Copy(pixels, FJobSystem::InJob());	// the buffer stays the same when it is moved into the cache.
+
+				lock.lock();
 				PrecacheDataRgba *pdr = &precacheDataRgba[precacheDataRgba.Reserve(1)];
-				
 				pdr->ImageID = imageID;
-				pdr->RefCount = info->first - 1;
-				info->first = 0;
-				pdr->Pixels.Create(Width, Height);
-				trans = pdr->TransInfo = CopyPixels(&pdr->Pixels, normal);
-				ret.Copy(pdr->Pixels, false);
+				pdr->RefCount = refcount;
+				pdr->TransInfo = trans;
+				pdr->Pixels = std::move(pixels);
 			}
 		}
 	}
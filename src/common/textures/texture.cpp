@@ -34,6 +34,7 @@
 **
 */
 
+#include <mutex>
 #include "printf.h"
 #include "files.h"
 #include "filesystem.h"
@@ -326,6 +327,19 @@ void V_ApplyLuminosityTranslation(int translation, uint8_t *buffer, int size);
 FTextureBuffer FTexture::CreateTexBuffer(int translation, int flags)
 {
 	FTextureBuffer result;
+	if (StagedBuffers.Size() > 0 && !(flags & CTF_CheckOnly))
+	{
+		for (unsigned i = 0; i < StagedBuffers.Size(); i++)
+		{
+			auto &staged = StagedBuffers[i];
+			if (staged.Translation == translation && staged.Flags == flags)
+			{
+				result = std::move(staged.Buffer);
+				StagedBuffers.Delete(i);
+				return result;
+			}
+		}
+	}
 	if (flags & CTF_Indexed)
 	{
 		// Indexed textures will never be translated and never be scaled.
@@ -409,6 +423,28 @@ FTextureBuffer FTexture::CreateTexBuffer(int translation, int flags)
 
 }
 
+//===========================================================================
+// 
+// Creates a buffer in advance so that the next CreateTexBuffer call with
+// the same arguments only has to return it. This is for the precacher,
+// which prepares the buffers on worker threads before uploading them.
+// All variants of one texture must be staged by the same thread.
+//
+//===========================================================================
+
+void FTexture::StageTexBuffer(int translation, int flags)
+{
+	for (auto &staged : StagedBuffers)
+	{
+		if (staged.Translation == translation && staged.Flags == flags) return;
+	}
+	FTextureBuffer buffer = CreateTexBuffer(translation, flags);
+	auto &staged = StagedBuffers[StagedBuffers.Reserve(1)];
+	staged.Translation = translation;
+	staged.Flags = flags;
+	staged.Buffer = std::move(buffer);
+}
+
 //===========================================================================
 // 
 // Dummy texture for the 0-entry.
@@ -422,6 +458,20 @@ bool FTexture::DetermineTranslucency()
 	return !!bTranslucent;
 }
 
+//===========================================================================
+// 
+// The hardware renderer's BSP workers can ask for the same texture's
+// translucency at the same time, so the image may only be checked once.
+//
+//===========================================================================
+
+bool FTexture::DetermineTranslucencyLocked()
+{
+	static std::mutex TranslucencyMutex;
+	std::lock_guard<std::mutex> lock(TranslucencyMutex);
+	return bTranslucent != -1 ? !!bTranslucent : DetermineTranslucency();
+}
+
 //===========================================================================
 // 
 // the default just returns an empty texture.
@@ -220,6 +220,14 @@ protected:
 	int8_t bTranslucent = -1;
 	int8_t areacount = 0;			// this is capped at 4 sections.
 
+	// Buffers the precacher created ahead of time which are waiting for their upload.
+	struct FStagedBuffer
+	{
+		int Translation;
+		int Flags;
+		FTextureBuffer Buffer;
+	};
+	TArray<FStagedBuffer> StagedBuffers;
 
 public:
 
@@ -287,11 +295,14 @@ public:
 
 public:
 	FTextureBuffer CreateTexBuffer(int translation, int flags = 0);
+	void StageTexBuffer(int translation, int flags);
+	void ClearStagedBuffers() { StagedBuffers.Clear(); }
 	virtual bool DetermineTranslucency();
 	bool GetTranslucency()
 	{
-		return bTranslucent != -1 ? bTranslucent : DetermineTranslucency();
+		return bTranslucent != -1 ? bTranslucent : DetermineTranslucencyLocked();
 	}
+	bool DetermineTranslucencyLocked();
 
 public:
 
@@ -33,10 +33,21 @@
 **
 */
 
+#include <limits.h>
 #include "files.h"
 #include "templates.h"	// just for 'clamp'
 #include "zstring.h"
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 
 FILE *myfopen(const char *filename, const char *flags)
 {
@@ -349,6 +360,87 @@ public:
 
 
 
+//==========================================================================
+//
+// MappedFileReader
+//
+// reads data from a file that is mapped into the address space.
+// Since this exposes the file's contents through GetBuffer, resource
+// files opened through it can serve uncompressed lumps without copying
+// them. The mapping is copy-on-write so that code which modifies a
+// lump's cache in place cannot change the file.
+//
+//==========================================================================
+
+class MappedFileReader : public MemoryReader
+{
+#ifdef _WIN32
+	HANDLE hMapping = nullptr;
+#endif
+
+public:
+	MappedFileReader() {}
+
+	~MappedFileReader()
+	{
+		if (bufptr != nullptr)
+		{
+#ifdef _WIN32
+			UnmapViewOfFile(bufptr);
+			CloseHandle(hMapping);
+#else
+			munmap(const_cast<char*>(bufptr), Length);
+#endif
+		}
+	}
+
+	bool Open(const char *filename)
+	{
+#ifdef _WIN32
+		auto widename = WideString(filename);
+		HANDLE hFile = CreateFileW(widename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (hFile == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(hFile, &size) || size.QuadPart <= 0 || size.QuadPart > LONG_MAX)
+		{
+			CloseHandle(hFile);
+			return false;
+		}
+		hMapping = CreateFileMappingW(hFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		CloseHandle(hFile);	// the mapping keeps its own reference.
+		if (hMapping == nullptr) return false;
+
+		void *mem = MapViewOfFile(hMapping, FILE_MAP_COPY, 0, 0, 0);
+		if (mem == nullptr)
+		{
+			CloseHandle(hMapping);
+			hMapping = nullptr;
+			return false;
+		}
+		Length = (long)size.QuadPart;
+#else
+		int fd = open(filename, O_RDONLY);
+		if (fd < 0) return false;
+
+		struct stat info;
+		if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0 || info.st_size > LONG_MAX)
+		{
+			close(fd);
+			return false;
+		}
+		void *mem = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		close(fd);	// the mapping keeps its own reference.
+		if (mem == MAP_FAILED) return false;
+		Length = (long)info.st_size;
+#endif
+		bufptr = (const char *)mem;
+		FilePos = 0;
+		return true;
+	}
+};
+
+
 //==========================================================================
 //
 // FileReader
@@ -370,6 +462,19 @@ bool FileReader::OpenFile(const char *filename, FileReader::Size start, FileRead
 	return true;
 }
 
+bool FileReader::OpenMappedFile(const char *filename)
+{
+	auto reader = new MappedFileReader;
+	if (!reader->Open(filename))
+	{
+		delete reader;
+		return false;
+	}
+	Close();
+	mReader = reader;
+	return true;
+}
+
 bool FileReader::OpenFilePart(FileReader &parent, FileReader::Size start, FileReader::Size length)
 {
 	auto reader = new FileReaderRedirect(parent, (long)start, (long)length);
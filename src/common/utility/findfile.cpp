@@ -46,16 +46,10 @@
 
 #include "cmdlib.h"
 
-static const char *pattern;
-
-static int matchfile(const struct dirent *ent)
-{
-	return fnmatch(pattern, ent->d_name, FNM_NOESCAPE) == 0;
-}
-
 void *I_FindFirst(const char *const filespec, findstate_t *const fileinfo)
 {
 	FString dir;
+	const char *pattern;
 
 	const char *const slash = strrchr(filespec, '/');
 
@@ -71,12 +65,33 @@ void *I_FindFirst(const char *const filespec, findstate_t *const fileinfo)
 		dir = ".";
 	}
 
+	// scandir's filter callback has no user data, so the pattern is applied here
+	// instead of through a static. This keeps concurrent searches independent.
 	fileinfo->current = 0;
-	fileinfo->count = scandir(dir.GetChars(), &fileinfo->namelist, matchfile, alphasort);
+	fileinfo->count = scandir(dir.GetChars(), &fileinfo->namelist, nullptr, alphasort);
 
 	if (fileinfo->count > 0)
 	{
-		return fileinfo;
+		int count = 0;
+		for (int i = 0; i < fileinfo->count; ++i)
+		{
+			if (fnmatch(pattern, fileinfo->namelist[i]->d_name, FNM_NOESCAPE) == 0)
+			{
+				fileinfo->namelist[count++] = fileinfo->namelist[i];
+			}
+			else
+			{
+				free(fileinfo->namelist[i]);
+			}
+		}
+		fileinfo->count = count;
+
+		if (count > 0)
+		{
+			return fileinfo;
+		}
+		free(fileinfo->namelist);
+		fileinfo->namelist = nullptr;
 	}
 
 	return (void *)-1;
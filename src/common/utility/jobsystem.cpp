@@ -0,0 +1,277 @@
+/*
+** jobsystem.cpp
+**
+** Shared work-stealing job system
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 The GZDoom Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** There is one worker thread per hardware thread except the main thread's.
+** Each worker has its own queue. New jobs go to the queue of the thread that
+** created them (all other threads share one extra queue) and idle threads
+** steal from the other queues. Threads that wait for a batch of jobs execute
+** queued jobs in the meantime instead of blocking, so nested parallel loops
+** cannot exhaust the pool.
+**
+*/
+
+#include "jobsystem.h"
+
+static thread_local int WorkerIndex = -1;
+static thread_local int JobDepth = 0;
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+FJobSystem *FJobSystem::Instance()
+{
+	static FJobSystem jobs;
+	return &jobs;
+}
+
+FJobSystem::FJobSystem()
+{
+	int numworkers = std::max<int>(std::thread::hardware_concurrency(), 2) - 1;
+
+	for (int i = 0; i <= numworkers; i++)
+	{
+		Queues.push_back(std::make_unique<WorkerQueue>());
+	}
+	for (int i = 0; i < numworkers; i++)
+	{
+		Workers.push_back(std::thread([=]() { WorkerMain(i); }));
+	}
+}
+
+FJobSystem::~FJobSystem()
+{
+	std::unique_lock<std::mutex> lock(WakeMutex);
+	Shutdown = true;
+	lock.unlock();
+	WakeCondition.notify_all();
+	for (auto &thread : Workers)
+		thread.join();
+}
+
+//==========================================================================
+//
+// Job creation
+//
+//==========================================================================
+
+FJobPtr FJobSystem::Create(std::function<void()> func, FJobCounter *counter)
+{
+	if (counter) counter->Pending.fetch_add(1, std::memory_order_relaxed);
+	return std::make_shared<FJob>(std::move(func), counter);
+}
+
+void FJobSystem::AddDependency(const FJobPtr &job, const FJobPtr &dependency)
+{
+	std::unique_lock<std::mutex> lock(dependency->Mutex);
+	if (!dependency->Finished)
+	{
+		job->Dependencies.fetch_add(1, std::memory_order_relaxed);
+		dependency->Successors.push_back(job);
+	}
+}
+
+void FJobSystem::Submit(const FJobPtr &job)
+{
+	if (job->Dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		Enqueue(job);
+	}
+}
+
+//==========================================================================
+//
+// Queue management
+//
+//==========================================================================
+
+void FJobSystem::Enqueue(FJobPtr job)
+{
+	int index = WorkerIndex >= 0 ? WorkerIndex : (int)Workers.size();
+	auto &queue = *Queues[index];
+	{
+		std::unique_lock<std::mutex> lock(queue.Mutex);
+		queue.Jobs.push_back(std::move(job));
+	}
+	QueuedJobs.fetch_add(1, std::memory_order_release);
+
+	// The mutex must be taken so that a thread cannot miss the notification between checking for work and going to sleep.
+	{
+		std::unique_lock<std::mutex> lock(WakeMutex);
+	}
+	WakeCondition.notify_one();
+}
+
+FJobPtr FJobSystem::GetJob(int index)
+{
+	if (QueuedJobs.load(std::memory_order_acquire) == 0)
+		return nullptr;
+
+	// Newest job from the own queue first, because its data is most likely still in the cache.
+	if (index >= 0)
+	{
+		auto &queue = *Queues[index];
+		std::unique_lock<std::mutex> lock(queue.Mutex);
+		if (!queue.Jobs.empty())
+		{
+			FJobPtr job = std::move(queue.Jobs.back());
+			queue.Jobs.pop_back();
+			QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+			return job;
+		}
+	}
+
+	// Otherwise steal the oldest job from another queue.
+	unsigned numqueues = (unsigned)Queues.size();
+	unsigned start = NextQueue.fetch_add(1, std::memory_order_relaxed);
+	for (unsigned i = 0; i < numqueues; i++)
+	{
+		auto &queue = *Queues[(start + i) % numqueues];
+		std::unique_lock<std::mutex> lock(queue.Mutex);
+		if (!queue.Jobs.empty())
+		{
+			FJobPtr job = std::move(queue.Jobs.front());
+			queue.Jobs.pop_front();
+			QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+//==========================================================================
+//
+// Execution
+//
+//==========================================================================
+
+void FJobSystem::Execute(const FJobPtr &job)
+{
+	JobDepth++;
+	job->Func();
+	JobDepth--;
+	job->Func = nullptr;	// release everything the function has captured.
+
+	std::vector<FJobPtr> successors;
+	{
+		std::unique_lock<std::mutex> lock(job->Mutex);
+		job->Finished = true;
+		successors.swap(job->Successors);
+	}
+	for (auto &next : successors)
+	{
+		Submit(next);
+	}
+
+	if (job->Counter && job->Counter->Pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		// Wake up whoever is waiting for this batch.
+		{
+			std::unique_lock<std::mutex> lock(WakeMutex);
+		}
+		WakeCondition.notify_all();
+	}
+}
+
+void FJobSystem::WorkerMain(int index)
+{
+	WorkerIndex = index;
+	while (true)
+	{
+		FJobPtr job = GetJob(index);
+		if (job)
+		{
+			Execute(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(WakeMutex);
+		WakeCondition.wait(lock, [&]() { return Shutdown || QueuedJobs.load(std::memory_order_acquire) > 0; });
+		if (Shutdown)
+			break;
+	}
+}
+
+//==========================================================================
+//
+// Waiting
+//
+//==========================================================================
+
+bool FJobSystem::WaitInternal(FJobCounter &counter, const std::chrono::steady_clock::time_point *deadline)
+{
+	while (!counter.Done())
+	{
+		FJobPtr job = GetJob(WorkerIndex);
+		if (job)
+		{
+			Execute(job);
+			continue;
+		}
+
+		// Nothing left to help with - the remaining jobs are running on other threads or waiting for their dependencies.
+		std::unique_lock<std::mutex> lock(WakeMutex);
+		auto ready = [&]() { return counter.Done() || QueuedJobs.load(std::memory_order_acquire) > 0; };
+		if (deadline == nullptr)
+		{
+			WakeCondition.wait(lock, ready);
+		}
+		else if (!WakeCondition.wait_until(lock, *deadline, ready))
+		{
+			return false;
+		}
+	}
+
+	// If this thread consumed a notification meant for a worker, pass it on.
+	if (QueuedJobs.load(std::memory_order_acquire) > 0)
+		WakeCondition.notify_one();
+	return true;
+}
+
+bool FJobSystem::InJob()
+{
+	return JobDepth > 0;
+}
+
+void FJobSystem::Wait(FJobCounter &counter)
+{
+	WaitInternal(counter, nullptr);
+}
+
+bool FJobSystem::WaitFor(FJobCounter &counter, std::chrono::milliseconds timeout)
+{
+	auto deadline = std::chrono::steady_clock::now() + timeout;
+	return WaitInternal(counter, &deadline);
+}
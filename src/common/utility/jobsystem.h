@@ -0,0 +1,177 @@
+/*
+** jobsystem.h
+**
+** Shared work-stealing job system
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 The GZDoom Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counts the unfinished jobs of a batch.
+class FJobCounter
+{
+public:
+	bool Done() const { return Pending.load(std::memory_order_acquire) == 0; }
+
+private:
+	std::atomic<int> Pending{ 0 };
+
+	friend class FJobSystem;
+};
+
+// A single unit of work. Jobs can depend on other jobs, which makes it
+// possible to build task graphs: a job only gets queued once all jobs it
+// depends on have finished.
+class FJob
+{
+public:
+	FJob(std::function<void()> &&func, FJobCounter *counter) : Func(std::move(func)), Counter(counter) {}
+
+private:
+	std::function<void()> Func;
+	FJobCounter *Counter;
+
+	// Starts at 1 so that the job cannot be queued before it has been submitted.
+	std::atomic<int> Dependencies{ 1 };
+
+	std::mutex Mutex;
+	bool Finished = false;
+	std::vector<std::shared_ptr<FJob>> Successors;
+
+	friend class FJobSystem;
+};
+
+typedef std::shared_ptr<FJob> FJobPtr;
+
+class FJobSystem
+{
+public:
+	static FJobSystem *Instance();
+
+	// Number of threads that can execute jobs at the same time, including a waiting caller.
+	int NumThreads() const { return (int)Workers.size() + 1; }
+
+	// Creates a job without queuing it yet, so that dependencies can be added to it.
+	FJobPtr Create(std::function<void()> func, FJobCounter *counter = nullptr);
+
+	// The job will not start before 'dependency' has finished.
+	// Must be called before the job is submitted.
+	void AddDependency(const FJobPtr &job, const FJobPtr &dependency);
+
+	// Queues the job as soon as all its dependencies have finished.
+	void Submit(const FJobPtr &job);
+
+	// Shortcut for a job without dependencies.
+	void Run(std::function<void()> func, FJobCounter *counter = nullptr)
+	{
+		Submit(Create(std::move(func), counter));
+	}
+
+	// Waits for all jobs of the counter to finish. The calling thread executes
+	// queued jobs while waiting, so this may also be called from within a job.
+	void Wait(FJobCounter &counter);
+
+	// Same but gives up after the timeout. Returns false if the jobs did not finish.
+	bool WaitFor(FJobCounter &counter, std::chrono::milliseconds timeout);
+
+	// True while the calling thread executes a job, including a waiting caller that helps out.
+	static bool InJob();
+
+private:
+	FJobSystem();
+	~FJobSystem();
+
+	struct WorkerQueue
+	{
+		std::mutex Mutex;
+		std::deque<FJobPtr> Jobs;
+	};
+
+	void WorkerMain(int index);
+	void Enqueue(FJobPtr job);
+	FJobPtr GetJob(int index);
+	void Execute(const FJobPtr &job);
+	bool WaitInternal(FJobCounter &counter, const std::chrono::steady_clock::time_point *deadline);
+
+	std::vector<std::thread> Workers;
+	std::vector<std::unique_ptr<WorkerQueue>> Queues;	// one per worker plus one for all other threads
+	std::atomic<int> QueuedJobs{ 0 };
+	std::atomic<unsigned> NextQueue{ 0 };
+
+	std::mutex WakeMutex;
+	std::condition_variable WakeCondition;
+	bool Shutdown = false;
+};
+
+// Calls function(i) for first <= i < last in steps of 'step', distributed over the job system.
+// Returns when all calls have finished.
+template <typename Index, typename Function>
+void JobParallelFor(const Index first, const Index last, const Index step, const Function &function)
+{
+	if (first >= last) return;
+
+	auto jobs = FJobSystem::Instance();
+	const Index count = (last - first + step - 1) / step;
+
+	// A few batches per thread so that stealing can balance uneven workloads.
+	Index batches = std::min<Index>(count, Index(jobs->NumThreads() * 4));
+	if (batches <= 1)
+	{
+		for (Index i = first; i < last; i += step) function(i);
+		return;
+	}
+
+	// The first count % batches batches get one extra item. Unlike count * b / batches this cannot overflow.
+	const Index size = count / batches, extra = count % batches;
+	FJobCounter counter;
+	for (Index b = 0; b < batches; b++)
+	{
+		Index begin = first + (b * size + std::min(b, extra)) * step;
+		Index end = first + ((b + 1) * size + std::min<Index>(b + 1, extra)) * step;
+		if (end > last) end = last;
+		jobs->Run([=, &function]()
+		{
+			for (Index i = begin; i < end; i += step) function(i);
+		}, &counter);
+	}
+	jobs->Wait(counter);
+}
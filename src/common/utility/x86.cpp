@@ -63,6 +63,15 @@ FString DumpCPUInfo(const CPUInfo *cpu)
 	: "=a" ((output)[0]), "=b" ((output)[1]), "=c" ((output)[2]), "=d" ((output)[3]) \
 	: "a" (func), "c" (subfunc));
 #define __cpuid(output, func) __cpuidex(output, func, 0)
+
+static inline uint64_t _xgetbv_0()
+{
+	uint32_t lo, hi;
+	__asm__ __volatile__("xgetbv" : "=a" (lo), "=d" (hi) : "c" (0));
+	return ((uint64_t)hi << 32) | lo;
+}
+#else
+#define _xgetbv_0() _xgetbv(0)
 #endif
 
 void CheckCPUID(CPUInfo *cpu)
@@ -159,6 +168,12 @@ void CheckCPUID(CPUInfo *cpu)
 		__cpuidex(foo, 7, 1);
 		cpu->FeatureFlags[7] = foo[0];
 	}
+
+	// The OS must have enabled the SSE and AVX state in XCR0, otherwise any use of the YMM registers faults.
+	if (cpu->bOSXSAVE && cpu->bAVX && cpu->bAVX2)
+	{
+		cpu->bAVX2Usable = (_xgetbv_0() & 6) == 6;
+	}
 }
 
 FString DumpCPUInfo(const CPUInfo *cpu)
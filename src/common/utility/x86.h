@@ -211,6 +211,7 @@ struct CPUInfo	// 92 bytes
 	uint8_t AMDModel;
 	uint8_t AMDFamily;
 	uint8_t bIsAMD;
+	uint8_t bAVX2Usable;	// the CPU has AVX2 and the OS saves the YMM registers
 
 	union
 	{
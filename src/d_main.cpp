@@ -1202,6 +1202,7 @@ void D_DoomLoop ()
 				C_Ticker ();
 				M_Ticker ();
 				G_Ticker ();
+				G_BenchmarkTic ();
 				// [RH] Use the consoleplayer's camera to update sounds
 				S_UpdateSounds (players[consoleplayer].camera);	// move positional sounds
 				gametic++;
@@ -1963,9 +1964,10 @@ static void D_DoomInit()
 	gamestate = GS_STARTUP;
 
 	const char *v = Args->CheckValue("-rngseed");
-	if (v)
+	if (v || Args->CheckParm("-benchmark"))
 	{
-		rngseed = staticrngseed = atoi(v);
+		// Benchmarks must be reproducible so they always use a static seed.
+		rngseed = staticrngseed = v ? atoi(v) : 0;
 		use_staticrng = true;
 		if (!batchrun) Printf("D_DoomInit: Static RNGseed %d set.\n", rngseed);
 	}
@@ -3189,6 +3191,7 @@ static int D_DoomMain_Internal (void)
 
 		LumpFilterInfo lfi;
 		lfi.dotFilter = LumpFilterIWAD;
+		lfi.useDirCache = true;
 
 		static const struct { int match; const char* name; } blanket[] =
 		{
@@ -3506,7 +3509,11 @@ static int D_DoomMain_Internal (void)
 				return 1337; // special exit
 			}
 
-			V_Init2();
+			// A benchmark runs headless and keeps the dummy framebuffer.
+			if (!G_InitBenchmark())
+			{
+				V_Init2();
+			}
 			twod->fullscreenautoaspect = gameinfo.fullscreenautoaspect;
 			// Initialize the size of the 2D drawer so that an attempt to access it outside the draw code won't crash.
 			twod->Begin(screen->GetWidth(), screen->GetHeight());
@@ -3651,6 +3658,8 @@ int GameMain()
 
 void D_Cleanup()
 {
+	G_CheckBackgroundSave(true);
+
 	if (demorecording)
 	{
 		G_CheckDemoStatus();
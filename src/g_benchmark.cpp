@@ -0,0 +1,681 @@
+/*
+** g_benchmark.cpp
+**
+** Headless playsim benchmark with a machine readable timing report
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 The GZDoom Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** -benchmark <tics> runs the playsim for the given number of tics as fast
+** as possible, either on the map given with -warp/+map or on the demo
+** given with -timedemo. No window or render device is created. When done,
+** the per-tic values of the playsim's cycle_t clocks are summarized into
+** a JSON report (-benchmarkout, defaults to benchmark.json) and the
+** engine exits.
+**
+** -renderbenchmark <dir> renders frames with the software renderer into
+** offscreen canvases instead, also without a window, and writes them as
+** PNGs into the given directory. With -renderviews <file> the views are
+** read from a file of "x y z yaw pitch" lines and rendered once on the
+** start map. Otherwise the console player's camera is rendered every
+** -renderevery <n> tics of the -timedemo/-playdemo, or once on the start
+** map without a demo. -renderframes <n> limits the number of frames and
+** -renderwidth/-renderheight set the frame size. vid_rendermode selects
+** between paletted and truecolor output. The report (-benchmarkout,
+** defaults to report.json in the output directory) has the per-frame
+** times of the whole scene, the postprocessing, which is the screen blend
+** and the PNG output, and the same walls/planes/masked split as the fps
+** stat. Those three are measured on the main render thread's slice only.
+** The drawers run inline as the scene is walked, so "walls" is the BSP
+** walk including the wall drawing, "planes" is the flats and sky and
+** "masked" is the sprites and translucent geometry.
+**
+*/
+
+#define RAPIDJSON_48BITPOINTER_OPTIMIZATION 0	// disable this insanity which is bound to make the code break over time.
+#define RAPIDJSON_HAS_CXX11_RVALUE_REFS 1
+#define RAPIDJSON_HAS_CXX11_RANGE_FOR 1
+
+#include "rapidjson/rapidjson.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+
+#include "doomstat.h"
+#include "g_game.h"
+#include "g_levellocals.h"
+#include "m_argv.h"
+#include "stats.h"
+#include "files.h"
+#include "printf.h"
+#include "v_text.h"
+#include "version.h"
+#include "engineerrors.h"
+#include "i_time.h"
+#include "d_main.h"
+#include "d_player.h"
+#include "actor.h"
+#include "cmdlib.h"
+#include "sc_man.h"
+#include "m_png.h"
+#include "v_video.h"
+#include "r_utility.h"
+#include "swrenderer/r_renderer.h"
+#include "swrenderer/scene/r_scene.h"
+
+extern cycle_t ThinkCycles, ActionCycles, MovementCycles, SightCycles, ACSTime, BotSupportCycles;
+extern cycle_t VMCycles[10];
+extern int VMCalls[10];
+extern int ThinkCount;
+extern int sightcounts[6];
+extern int sightcachehits, sightcachemisses;
+extern bool singletics;
+extern FString defdemoname;
+
+void DoWriteSavePic(FileWriter *file, ESSType ssformat, uint8_t *scr, int width, int height, sector_t *viewsector, bool upsidedown);
+
+cycle_t PlaysimCycles;
+
+enum EBenchClock
+{
+	BENCH_Playsim,
+	BENCH_Think,
+	BENCH_Action,
+	BENCH_Movement,
+	BENCH_Sight,
+	BENCH_ACS,
+	BENCH_VM,
+	BENCH_Bots,
+	NUM_BENCHCLOCKS
+};
+
+static const char *const BenchClockNames[NUM_BENCHCLOCKS] =
+{
+	"playsim", "think", "action", "movement", "sight", "acs", "vm", "bots"
+};
+
+struct FBenchSample
+{
+	double Clocks[NUM_BENCHCLOCKS];
+	int Thinkers;
+	int VMCalls;
+	int SightCounts[6];
+	int SightCacheHits;
+	int SightCacheMisses;
+};
+
+enum ERenderClock
+{
+	RENDER_Scene,
+	RENDER_Walls,
+	RENDER_Planes,
+	RENDER_Masked,
+	RENDER_Postprocess,
+	NUM_RENDERCLOCKS
+};
+
+static const char *const RenderClockNames[NUM_RENDERCLOCKS] =
+{
+	"scene", "walls", "planes", "masked", "postprocess"
+};
+
+struct FRenderBenchView
+{
+	DVector3 Pos;
+	double Yaw;
+	double Pitch;
+};
+
+struct FRenderBenchSample
+{
+	FString File;
+	int Tic;
+	double Clocks[NUM_RENDERCLOCKS];
+};
+
+static int BenchTics;
+static FString BenchOutput;
+static TArray<FBenchSample> BenchSamples;
+static uint64_t BenchStartTime;
+static double LastVMTime;
+static int LastVMCalls;
+
+static FString RenderBenchDir;
+static TArray<FRenderBenchView> RenderBenchViews;
+static TArray<FRenderBenchSample> RenderBenchSamples;
+static int RenderBenchEvery;
+static int RenderBenchFrames;
+static int RenderBenchWidth;
+static int RenderBenchHeight;
+static int RenderBenchTics;
+
+//==========================================================================
+//
+// G_InitBenchmark
+//
+// Parses -benchmark. Returns true if the engine is supposed to run headless.
+//
+//==========================================================================
+
+static void G_SetupHeadless()
+{
+	nodrawers = true;
+	noblit = true;
+	singletics = true;
+	if (!Args->CheckParm("-timedemo") && !Args->CheckParm("-playdemo"))
+	{
+		// Without a demo the benchmark runs on the start map.
+		autostart = true;
+	}
+}
+
+static bool G_InitRenderBenchmark(const char *dir)
+{
+	if (Args->CheckParm("-benchmark"))
+	{
+		I_FatalError("-benchmark and -renderbenchmark cannot be combined");
+	}
+	if (*dir == 0)
+	{
+		I_FatalError("-renderbenchmark requires an output directory");
+	}
+	RenderBenchDir = dir;
+	FixPathSeperator(RenderBenchDir);
+	if (RenderBenchDir.Back() != '/')
+	{
+		RenderBenchDir += '/';
+	}
+	CreatePath(RenderBenchDir);
+
+	const char *v = Args->CheckValue("-benchmarkout");
+	BenchOutput = v ? FString(v) : RenderBenchDir + "report.json";
+	v = Args->CheckValue("-renderwidth");
+	RenderBenchWidth = v ? atoi(v) : 640;
+	v = Args->CheckValue("-renderheight");
+	RenderBenchHeight = v ? atoi(v) : 400;
+	if (RenderBenchWidth <= 0 || RenderBenchWidth > MAXWIDTH || RenderBenchHeight <= 0 || RenderBenchHeight > MAXHEIGHT)
+	{
+		I_FatalError("Invalid -renderwidth/-renderheight");
+	}
+	v = Args->CheckValue("-renderevery");
+	RenderBenchEvery = v ? atoi(v) : 1;
+	if (RenderBenchEvery <= 0)
+	{
+		I_FatalError("-renderevery requires a positive number of tics");
+	}
+
+	RenderBenchViews.Clear();
+	v = Args->CheckValue("-renderviews");
+	if (v != nullptr)
+	{
+		FScanner sc;
+		if (!sc.OpenFile(v))
+		{
+			I_FatalError("Unable to open %s", v);
+		}
+		while (sc.CheckFloat())
+		{
+			FRenderBenchView view;
+			view.Pos.X = sc.Float;
+			sc.MustGetFloat();
+			view.Pos.Y = sc.Float;
+			sc.MustGetFloat();
+			view.Pos.Z = sc.Float;
+			sc.MustGetFloat();
+			view.Yaw = sc.Float;
+			sc.MustGetFloat();
+			view.Pitch = sc.Float;
+			RenderBenchViews.Push(view);
+		}
+		if (sc.GetString())
+		{
+			sc.ScriptError("Number expected, got '%s'", sc.String);
+		}
+		if (RenderBenchViews.Size() == 0)
+		{
+			I_FatalError("%s does not contain any views", v);
+		}
+	}
+
+	// Without a demo or a list of views there is only the start of the map to render.
+	v = Args->CheckValue("-renderframes");
+	if (v != nullptr)
+	{
+		RenderBenchFrames = atoi(v);
+	}
+	else
+	{
+		bool demo = Args->CheckParm("-timedemo") || Args->CheckParm("-playdemo");
+		RenderBenchFrames = demo || RenderBenchViews.Size() > 0 ? 0 : 1;
+	}
+
+	RenderBenchSamples.Clear();
+	RenderBenchTics = 0;
+
+	G_SetupHeadless();
+	Printf("Rendering %dx%d benchmark frames to %s\n", RenderBenchWidth, RenderBenchHeight, RenderBenchDir.GetChars());
+	return true;
+}
+
+bool G_InitBenchmark()
+{
+	const char *v = Args->CheckValue("-renderbenchmark");
+	if (v != nullptr)
+	{
+		return G_InitRenderBenchmark(v);
+	}
+	v = Args->CheckValue("-benchmark");
+	if (v == nullptr)
+	{
+		return false;
+	}
+	BenchTics = atoi(v);
+	if (BenchTics <= 0)
+	{
+		I_FatalError("-benchmark requires a positive number of tics");
+	}
+	v = Args->CheckValue("-benchmarkout");
+	BenchOutput = v ? v : "benchmark.json";
+
+	BenchSamples.Clear();
+	BenchSamples.Grow(BenchTics);
+	BenchStartTime = 0;
+
+	G_SetupHeadless();
+	Printf("Benchmarking %d tics, report goes to %s\n", BenchTics, BenchOutput.GetChars());
+	return true;
+}
+
+bool G_BenchmarkActive()
+{
+	return BenchTics > 0 || RenderBenchDir.IsNotEmpty();
+}
+
+//==========================================================================
+//
+// Report output
+//
+//==========================================================================
+
+template<class W>
+static void WriteSummary(W &w, const char *key, const TArray<double> &values)
+{
+	double total = 0, minv = 0, maxv = 0;
+	TArray<double> sorted = values;
+	std::sort(sorted.begin(), sorted.end());
+	for (auto val : sorted) total += val;
+	if (sorted.Size() > 0)
+	{
+		minv = sorted[0];
+		maxv = sorted.Last();
+	}
+	auto percentile = [&](double p) { return sorted.Size() == 0 ? 0. : sorted[unsigned((sorted.Size() - 1) * p)]; };
+
+	w.Key(key);
+	w.StartObject();
+	w.Key("total_ms"); w.Double(total);
+	w.Key("mean_ms"); w.Double(sorted.Size() ? total / sorted.Size() : 0.);
+	w.Key("min_ms"); w.Double(minv);
+	w.Key("median_ms"); w.Double(percentile(0.5));
+	w.Key("p95_ms"); w.Double(percentile(0.95));
+	w.Key("max_ms"); w.Double(maxv);
+	w.EndObject();
+}
+
+static void G_WriteBenchmarkReport(bool demoended)
+{
+	static const char *const sightnames[6] = { "rejected", "blocked", "traversed", "lines", "corners", "aborted" };
+	double realtime = (I_nsTime() - BenchStartTime) * 1e-6;
+	unsigned count = BenchSamples.Size();
+
+	rapidjson::StringBuffer buffer;
+	rapidjson::PrettyWriter<rapidjson::StringBuffer> w(buffer);
+
+	w.StartObject();
+	w.Key("engine"); w.String(GetVersionString());
+	w.Key("map"); w.String(primaryLevel->MapName.GetChars());
+	w.Key("demo"); w.String(demoplayback || demoended ? defdemoname.GetChars() : "");
+	w.Key("requested_tics"); w.Int(BenchTics);
+	w.Key("tics"); w.Int(count);
+	w.Key("realtime_ms"); w.Double(realtime);
+	w.Key("tics_per_second"); w.Double(realtime > 0 ? count * 1000. / realtime : 0.);
+
+	w.Key("clocks");
+	w.StartObject();
+	TArray<double> values(count, true);
+	for (int c = 0; c < NUM_BENCHCLOCKS; c++)
+	{
+		for (unsigned i = 0; i < count; i++) values[i] = BenchSamples[i].Clocks[c];
+		WriteSummary(w, BenchClockNames[c], values);
+	}
+	w.EndObject();
+
+	int64_t thinkers = 0, vmcalls = 0, sight[6] = {}, cachehits = 0, cachemisses = 0;
+	int maxthinkers = 0;
+	for (auto &sample : BenchSamples)
+	{
+		thinkers += sample.Thinkers;
+		maxthinkers = std::max(maxthinkers, sample.Thinkers);
+		vmcalls += sample.VMCalls;
+		for (int i = 0; i < 6; i++) sight[i] += sample.SightCounts[i];
+		cachehits += sample.SightCacheHits;
+		cachemisses += sample.SightCacheMisses;
+	}
+	w.Key("counters");
+	w.StartObject();
+	w.Key("thinkers_mean"); w.Double(count ? double(thinkers) / count : 0.);
+	w.Key("thinkers_max"); w.Int(maxthinkers);
+	w.Key("vm_calls"); w.Int64(vmcalls);
+	w.Key("sight");
+	w.StartObject();
+	for (int i = 0; i < 6; i++)
+	{
+		w.Key(sightnames[i]); w.Int64(sight[i]);
+	}
+	w.Key("cache_hits"); w.Int64(cachehits);
+	w.Key("cache_misses"); w.Int64(cachemisses);
+	w.EndObject();
+	w.EndObject();
+
+	// Per-tic playsim time so that spikes can be located in the run.
+	w.Key("playsim_ms");
+	w.StartArray();
+	for (auto &sample : BenchSamples) w.Double(sample.Clocks[BENCH_Playsim]);
+	w.EndArray();
+	w.EndObject();
+
+	auto fw = FileWriter::Open(BenchOutput);
+	if (fw == nullptr)
+	{
+		Printf(TEXTCOLOR_RED "Unable to write benchmark report %s\n", BenchOutput.GetChars());
+		return;
+	}
+	fw->Write(buffer.GetString(), buffer.GetSize());
+	delete fw;
+	Printf("Benchmark: %u tics in %.1f ms (%.1f tics/s)\n", count, realtime, realtime > 0 ? count * 1000. / realtime : 0.);
+}
+
+static void G_WriteRenderBenchmarkReport(bool demoended)
+{
+	unsigned count = RenderBenchSamples.Size();
+
+	rapidjson::StringBuffer buffer;
+	rapidjson::PrettyWriter<rapidjson::StringBuffer> w(buffer);
+
+	w.StartObject();
+	w.Key("engine"); w.String(GetVersionString());
+	w.Key("map"); w.String(primaryLevel->MapName.GetChars());
+	w.Key("demo"); w.String(demoplayback || demoended ? defdemoname.GetChars() : "");
+	w.Key("renderer"); w.String(V_IsTrueColor() ? "software truecolor" : "software");
+	w.Key("width"); w.Int(RenderBenchWidth);
+	w.Key("height"); w.Int(RenderBenchHeight);
+	w.Key("frames"); w.Int(count);
+
+	w.Key("clocks");
+	w.StartObject();
+	TArray<double> values(count, true);
+	for (int c = 0; c < NUM_RENDERCLOCKS; c++)
+	{
+		for (unsigned i = 0; i < count; i++) values[i] = RenderBenchSamples[i].Clocks[c];
+		WriteSummary(w, RenderClockNames[c], values);
+	}
+	w.EndObject();
+
+	// Per-frame times so that they can be matched with the images.
+	w.Key("frame_times");
+	w.StartArray();
+	for (auto &sample : RenderBenchSamples)
+	{
+		w.StartObject();
+		w.Key("file"); w.String(sample.File.GetChars());
+		w.Key("tic"); w.Int(sample.Tic);
+		for (int c = 0; c < NUM_RENDERCLOCKS; c++)
+		{
+			w.Key(FStringf("%s_ms", RenderClockNames[c]).GetChars()); w.Double(sample.Clocks[c]);
+		}
+		w.EndObject();
+	}
+	w.EndArray();
+	w.EndObject();
+
+	auto fw = FileWriter::Open(BenchOutput);
+	if (fw == nullptr)
+	{
+		Printf(TEXTCOLOR_RED "Unable to write benchmark report %s\n", BenchOutput.GetChars());
+		return;
+	}
+	fw->Write(buffer.GetString(), buffer.GetSize());
+	delete fw;
+	Printf("Render benchmark: %u frames written to %s\n", count, RenderBenchDir.GetChars());
+}
+
+//==========================================================================
+//
+// G_RenderBenchmarkFrame
+//
+// Renders one frame into an offscreen canvas and writes it as a PNG.
+// The swrenderer clocks are only taken by the main render thread.
+//
+//==========================================================================
+
+static void G_RenderBenchmarkFrame(AActor *camera, const FString &name)
+{
+	FRenderBenchSample &sample = RenderBenchSamples[RenderBenchSamples.Reserve(1)];
+	sample.File = name;
+	sample.Tic = gametic;
+
+	DCanvas canvas(RenderBenchWidth, RenderBenchHeight, V_IsTrueColor());
+	cycle_t sceneclock, postclock;
+
+	// Render the state at the end of the tic so that the images are reproducible.
+	bool savedNoInterpolate = r_NoInterpolate;
+	r_NoInterpolate = true;
+	sceneclock.Reset();
+	sceneclock.Clock();
+	SWRenderer->RenderViewToCanvas(camera, &canvas);
+	sceneclock.Unclock();
+	r_NoInterpolate = savedNoInterpolate;
+
+	sample.Clocks[RENDER_Scene] = sceneclock.TimeMS();
+	sample.Clocks[RENDER_Walls] = swrenderer::WallCycles.TimeMS();
+	sample.Clocks[RENDER_Planes] = swrenderer::PlaneCycles.TimeMS();
+	sample.Clocks[RENDER_Masked] = swrenderer::MaskedCycles.TimeMS();
+
+	// Same screen blend and PNG output as the savegame pictures.
+	postclock.Reset();
+	postclock.Clock();
+	int width = canvas.GetWidth();
+	int height = canvas.GetHeight();
+	TArray<uint8_t> pixels;
+	if (canvas.IsBgra())
+	{
+		pixels.Resize(width * height * 3);
+		for (int y = 0; y < height; y++)
+		{
+			const uint32_t *src = (const uint32_t *)canvas.GetPixels() + y * canvas.GetPitch();
+			uint8_t *dest = &pixels[y * width * 3];
+			for (int x = 0; x < width; x++)
+			{
+				PalEntry color = src[x];
+				dest[x * 3] = color.r;
+				dest[x * 3 + 1] = color.g;
+				dest[x * 3 + 2] = color.b;
+			}
+		}
+	}
+	else
+	{
+		pixels.Resize(width * height);
+		for (int y = 0; y < height; y++)
+		{
+			memcpy(&pixels[y * width], canvas.GetPixels() + y * canvas.GetPitch(), width);
+		}
+	}
+
+	FString filename = RenderBenchDir + name;
+	auto fw = FileWriter::Open(filename);
+	if (fw != nullptr)
+	{
+		DoWriteSavePic(fw, canvas.IsBgra() ? SS_RGB : SS_PAL, pixels.Data(), width, height, camera->Sector, false);
+		M_FinishPNG(fw);
+		delete fw;
+	}
+	else
+	{
+		Printf(TEXTCOLOR_RED "Unable to write %s\n", filename.GetChars());
+	}
+	postclock.Unclock();
+	sample.Clocks[RENDER_Postprocess] = postclock.TimeMS();
+}
+
+//==========================================================================
+//
+// G_RenderBenchmarkTic
+//
+// The render benchmark's part of G_BenchmarkTic.
+//
+//==========================================================================
+
+static void G_RenderBenchmarkTic()
+{
+	if (gamestate != GS_LEVEL || paused)
+	{
+		return;
+	}
+
+	if (RenderBenchViews.Size() > 0)
+	{
+		// All views are rendered from a temporary map spot on the first tic of the map.
+		for (unsigned i = 0; i < RenderBenchViews.Size(); i++)
+		{
+			if (RenderBenchFrames > 0 && RenderBenchSamples.Size() >= (unsigned)RenderBenchFrames)
+			{
+				break;
+			}
+			auto &view = RenderBenchViews[i];
+			AActor *camera = Spawn(primaryLevel, NAME_MapSpot, view.Pos, NO_REPLACE);
+			camera->Angles.Yaw = DAngle(view.Yaw);
+			camera->Angles.Pitch = DAngle(view.Pitch);
+			camera->ClearInterpolation();
+			G_RenderBenchmarkFrame(camera, FStringf("view%04u.png", i));
+			camera->Destroy();
+		}
+		G_WriteRenderBenchmarkReport(false);
+		throw CExitEvent(0);
+	}
+
+	if (RenderBenchTics++ % RenderBenchEvery == 0)
+	{
+		AActor *camera = players[consoleplayer].camera;
+		if (camera != nullptr)
+		{
+			G_RenderBenchmarkFrame(camera, FStringf("tic%06d.png", gametic));
+		}
+	}
+
+	if (RenderBenchFrames > 0 && RenderBenchSamples.Size() >= (unsigned)RenderBenchFrames)
+	{
+		G_WriteRenderBenchmarkReport(false);
+		throw CExitEvent(0);
+	}
+}
+
+//==========================================================================
+//
+// G_BenchmarkTic
+//
+// Called after each G_Ticker call. All playsim clocks are reset at the
+// start of a tic, so this is the place to collect their values.
+//
+//==========================================================================
+
+void G_BenchmarkTic()
+{
+	if (RenderBenchDir.IsNotEmpty())
+	{
+		G_RenderBenchmarkTic();
+		return;
+	}
+	if (BenchTics <= 0 || gamestate != GS_LEVEL || paused)
+	{
+		return;
+	}
+	if (BenchStartTime == 0)
+	{
+		// The first level tic also includes the map setup so it is not part of the measurement.
+		BenchStartTime = I_nsTime();
+		LastVMTime = VMCycles[0].TimeMS();
+		LastVMCalls = VMCalls[0];
+		return;
+	}
+
+	FBenchSample &sample = BenchSamples[BenchSamples.Reserve(1)];
+	sample.Clocks[BENCH_Playsim] = PlaysimCycles.TimeMS();
+	sample.Clocks[BENCH_Think] = ThinkCycles.TimeMS();
+	sample.Clocks[BENCH_Action] = ActionCycles.TimeMS();
+	sample.Clocks[BENCH_Movement] = MovementCycles.TimeMS();
+	sample.Clocks[BENCH_Sight] = SightCycles.TimeMS();
+	sample.Clocks[BENCH_ACS] = ACSTime.TimeMS();
+	sample.Clocks[BENCH_VM] = VMCycles[0].TimeMS() - LastVMTime;
+	sample.Clocks[BENCH_Bots] = BotSupportCycles.TimeMS();
+	sample.Thinkers = ThinkCount;
+	sample.VMCalls = VMCalls[0] - LastVMCalls;
+	memcpy(sample.SightCounts, sightcounts, sizeof(sightcounts));
+	sample.SightCacheHits = sightcachehits;
+	sample.SightCacheMisses = sightcachemisses;
+	LastVMTime = VMCycles[0].TimeMS();
+	LastVMCalls = VMCalls[0];
+
+	if (BenchSamples.Size() >= (unsigned)BenchTics)
+	{
+		G_WriteBenchmarkReport(false);
+		throw CExitEvent(0);
+	}
+}
+
+//==========================================================================
+//
+// G_EndBenchmark
+//
+// Called when a benchmarked demo ends before the requested tic or frame
+// count.
+//
+//==========================================================================
+
+void G_EndBenchmark()
+{
+	if (BenchTics > 0)
+	{
+		G_WriteBenchmarkReport(true);
+		throw CExitEvent(0);
+	}
+	if (RenderBenchDir.IsNotEmpty())
+	{
+		G_WriteRenderBenchmarkReport(true);
+		throw CExitEvent(0);
+	}
+}
@@ -27,6 +27,8 @@
 #include <stdio.h>
 #include <stddef.h>
 #include <memory>
+#include <atomic>
+#include <thread>
 
 #include "i_time.h"
 #include "templates.h"
@@ -102,7 +104,7 @@ void	G_DoPlayDemo (void);
 void	G_DoCompleted (void);
 void	G_DoVictory (void);
 void	G_DoWorldDone (void);
-void	G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, const char *description);
+void	G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, const char *description, bool background = false);
 void	G_DoAutoSave ();
 void	G_DoQuickSave ();
 
@@ -111,12 +113,14 @@ bool WriteZip(const char *filename, TArray<FString> &filenames, TArray<FCompress
 
 FIntCVar gameskill ("skill", 2, CVAR_SERVERINFO|CVAR_LATCH);
 CVAR(Bool, save_formatted, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// use formatted JSON for saves (more readable but a larger files and a bit slower.
+CVAR(Bool, save_binary, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// use the compact binary format for saves (faster and smaller, but not human readable). Ignored if save_formatted is set.
 CVAR (Int, deathmatch, 0, CVAR_SERVERINFO|CVAR_LATCH);
 CVAR (Bool, chasedemo, false, 0);
 CVAR (Bool, storesavepic, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 CVAR (Bool, longsavemessages, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 CVAR (String, save_dir, "", CVAR_ARCHIVE|CVAR_GLOBALCONFIG);
 CVAR (Bool, cl_waitforsave, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
+CVAR (Bool, save_background, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);	// compress and write autosaves on a separate thread
 CVAR (Bool, enablescriptscreenshot, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 EXTERN_CVAR (Float, con_midtime);
 
@@ -139,6 +143,7 @@ CUSTOM_CVAR (Int, displaynametags, 0, CVAR_ARCHIVE)
 CVAR(Int, nametagcolor, CR_GOLD, CVAR_ARCHIVE)
 
 extern bool playedtitlemusic;
+extern cycle_t PlaysimCycles;
 
 gameaction_t	gameaction;
 gamestate_t 	gamestate = GS_STARTUP;
@@ -1129,6 +1134,8 @@ void G_Ticker ()
 		AddCommandString ("toggle vid_fullscreen");
 	}
 
+	G_CheckBackgroundSave(false);
+
 	// do things to change the game state
 	oldgamestate = gamestate;
 	while (gameaction != ga_nothing)
@@ -1285,7 +1292,10 @@ void G_Ticker ()
 	switch (gamestate)
 	{
 	case GS_LEVEL:
+		PlaysimCycles.Reset();
+		PlaysimCycles.Clock();
 		P_Ticker ();
+		PlaysimCycles.Unclock();
 		primaryLevel->automap->Ticker ();
 		break;
 
@@ -1974,6 +1984,8 @@ void G_DoLoadGame ()
 	hidecon = gameaction == ga_loadgamehidecon;
 	gameaction = ga_nothing;
 
+	G_CheckBackgroundSave(true);
+
 	std::unique_ptr<FResourceFile> resfile(FResourceFile::OpenResourceFile(savename.GetChars(), true, true));
 	if (resfile == nullptr)
 	{
@@ -2242,7 +2254,7 @@ void G_DoAutoSave ()
 
 	readableTime = myasctime ();
 	description.Format("Autosave %s", readableTime);
-	G_DoSaveGame (false, false, file, description);
+	G_DoSaveGame (false, false, file, description, save_background);
 }
 
 void G_DoQuickSave ()
@@ -2325,7 +2337,112 @@ static void PutSavePic (FileWriter *file, int width, int height)
 	}
 }
 
-void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, const char *description)
+//==========================================================================
+//
+// Background saves
+//
+// The game state is serialized into uncompressed buffers on the game
+// thread. Compressing them and writing the zip file then happens on a
+// separate thread while play continues. The result is picked up by
+// G_CheckBackgroundSave on the game thread, which is also where the
+// save gets reported and registered with the savegame manager.
+//
+//==========================================================================
+
+struct FBackgroundSave
+{
+	FString Filename;
+	FString Description;
+	bool OkForQuicksave;
+	bool ForceQuicksave;
+	TArray<FString> Filenames;
+	TArray<FCompressedBuffer> Content;	// owned by this object
+
+	std::thread Thread;
+	std::atomic<bool> Finished{ false };
+	bool Succeeded = false;
+
+	~FBackgroundSave()
+	{
+		if (Thread.joinable()) Thread.join();
+		for (auto &buff : Content) buff.Clean();
+	}
+
+	void Run()
+	{
+		// The first entry is the picture which already is compressed.
+		for (unsigned i = 1; i < Content.Size(); i++)
+		{
+			CompressStoredBuffer(Content[i]);
+		}
+		Succeeded = WriteZip(Filename, Filenames, Content);
+		Finished.store(true, std::memory_order_release);
+	}
+};
+
+static std::unique_ptr<FBackgroundSave> BackgroundSave;
+
+static void G_SaveFinished(bool okForQuicksave, bool forceQuicksave, const FString &filename, const char *description, bool succeeded)
+{
+	if (succeeded)
+	{
+		// Check whether the file is ok by trying to open it.
+		FResourceFile *test = FResourceFile::OpenResourceFile(filename, true);
+		if (test != nullptr)
+		{
+			delete test;
+		}
+		else
+		{
+			succeeded = false;
+		}
+	}
+
+	if (succeeded)
+	{
+		savegameManager.NotifyNewSave(filename, description, okForQuicksave, forceQuicksave);
+		BackupSaveName = filename;
+
+		if (longsavemessages) Printf("%s (%s)\n", GStrings("GGSAVED"), filename.GetChars());
+		else Printf("%s\n", GStrings("GGSAVED"));
+	}
+	else if (longsavemessages)
+	{
+		Printf(PRINT_HIGH, "%s (%s)\n", GStrings("TXT_SAVEFAILED"), filename.GetChars());
+	}
+	else
+	{
+		Printf(PRINT_HIGH, "%s\n", GStrings("TXT_SAVEFAILED"));
+	}
+}
+
+//==========================================================================
+//
+// G_CheckBackgroundSave
+//
+// Completes a background save if it is done, or waits for it if 'wait'
+// is set. Anything that reads save files or is about to write a new one
+// has to call this with wait = true first.
+//
+//==========================================================================
+
+void G_CheckBackgroundSave(bool wait)
+{
+	if (BackgroundSave == nullptr) return;
+	if (!wait && !BackgroundSave->Finished.load(std::memory_order_acquire)) return;
+
+	std::unique_ptr<FBackgroundSave> save = std::move(BackgroundSave);
+	save->Thread.join();
+	G_SaveFinished(save->OkForQuicksave, save->ForceQuicksave, save->Filename, save->Description, save->Succeeded);
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, const char *description, bool background)
 {
 	TArray<FCompressedBuffer> savegame_content;
 	TArray<FString> savegame_filenames;
@@ -2344,13 +2461,16 @@ void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, c
 		filename = G_BuildSaveName ("demosave." SAVEGAME_EXT, -1);
 	}
 
+	// Only one save can be in flight, and it may be the file that is about to be overwritten.
+	G_CheckBackgroundSave(true);
+
 	if (cl_waitforsave)
 		I_FreezeTime(true);
 
 	insave = true;
 	try
 	{
-		level.SnapshotLevel();
+		level.SnapshotLevel(!background);
 	}
 	catch(CRecoverableError &err)
 	{
@@ -2377,7 +2497,7 @@ void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, c
 	FSerializer savegameglobals;	// and this for non-level related info that must be saved.
 
 	savegameinfo.OpenWriter(true);
-	savegameglobals.OpenWriter(save_formatted);
+	savegameglobals.OpenWriter(save_formatted, save_binary && !save_formatted);
 
 	SaveVersion = SAVEVER;
 	PutSavePic(&savepic, SAVEPICWIDTH, SAVEPICHEIGHT);
@@ -2425,47 +2545,67 @@ void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, c
 	auto picdata = savepic.GetBuffer();
 	FCompressedBuffer bufpng = { picdata->Size(), picdata->Size(), METHOD_STORED, 0, static_cast<unsigned int>(crc32(0, &(*picdata)[0], picdata->Size())), (char*)&(*picdata)[0] };
 
-	savegame_content.Push(bufpng);
-	savegame_filenames.Push("savepic.png");
-	savegame_content.Push(savegameinfo.GetCompressedOutput());
-	savegame_filenames.Push("info.json");
-	savegame_content.Push(savegameglobals.GetCompressedOutput());
-	savegame_filenames.Push("globals.json");
-
-	G_WriteSnapshots (savegame_filenames, savegame_content);
-	
-
-	bool succeeded = false;
-
-	if (WriteZip(filename, savegame_filenames, savegame_content))
-	{
-		// Check whether the file is ok by trying to open it.
-		FResourceFile *test = FResourceFile::OpenResourceFile(filename, true);
-		if (test != nullptr)
-		{
-			delete test;
-			succeeded = true;
+	if (background)
+	{
+		// The save thread needs its own copy of everything because the level snapshots
+		// and the picture buffer do not outlive this function.
+		auto save = std::make_unique<FBackgroundSave>();
+		save->Filename = filename;
+		save->Description = description;
+		save->OkForQuicksave = okForQuicksave;
+		save->ForceQuicksave = forceQuicksave;
+
+		FCompressedBuffer piccopy = bufpng;
+		piccopy.mBuffer = new char[bufpng.mCompressedSize];
+		memcpy(piccopy.mBuffer, bufpng.mBuffer, bufpng.mCompressedSize);
+		save->Content.Push(piccopy);
+		save->Filenames.Push("savepic.png");
+		save->Content.Push(savegameinfo.GetStoredOutput());
+		save->Filenames.Push("info.json");
+		save->Content.Push(savegameglobals.GetStoredOutput());
+		save->Filenames.Push("globals.json");
+
+		G_WriteSnapshots (savegame_filenames, savegame_content);
+		for (unsigned i = 0; i < savegame_content.Size(); i++)
+		{
+			FCompressedBuffer buff = savegame_content[i];
+			if (buff.mBuffer == level.info->Snapshot.mBuffer)
+			{
+				// The current level's snapshot was only made for this save so it can be handed over as is.
+				level.info->Snapshot.mBuffer = nullptr;
+			}
+			else
+			{
+				buff.mBuffer = new char[buff.mCompressedSize];
+				memcpy(buff.mBuffer, savegame_content[i].mBuffer, buff.mCompressedSize);
+			}
+			save->Content.Push(buff);
+			save->Filenames.Push(savegame_filenames[i]);
 		}
-	}
 
-	if (succeeded)
-	{
-		savegameManager.NotifyNewSave(filename, description, okForQuicksave, forceQuicksave);
-		BackupSaveName = filename;
-
-		if (longsavemessages) Printf("%s (%s)\n", GStrings("GGSAVED"), filename.GetChars());
-		else Printf("%s\n", GStrings("GGSAVED"));
+		auto saveptr = save.get();
+		save->Thread = std::thread([=]() { saveptr->Run(); });
+		BackgroundSave = std::move(save);
 	}
 	else
 	{
-		Printf(PRINT_HIGH, "%s\n", GStrings("TXT_SAVEFAILED"));
-	}
+		savegame_content.Push(bufpng);
+		savegame_filenames.Push("savepic.png");
+		savegame_content.Push(savegameinfo.GetCompressedOutput());
+		savegame_filenames.Push("info.json");
+		savegame_content.Push(savegameglobals.GetCompressedOutput());
+		savegame_filenames.Push("globals.json");
 
+		G_WriteSnapshots (savegame_filenames, savegame_content);
 
-	// delete the JSON buffers we created just above. Everything else will
-	// either still be needed or taken care of automatically.
-	savegame_content[1].Clean();
-	savegame_content[2].Clean();
+		bool succeeded = WriteZip(filename, savegame_filenames, savegame_content);
+		G_SaveFinished(okForQuicksave, forceQuicksave, filename, description, succeeded);
+
+		// delete the JSON buffers we created just above. Everything else will
+		// either still be needed or taken care of automatically.
+		savegame_content[1].Clean();
+		savegame_content[2].Clean();
+	}
 
 	// We don't need the snapshot any longer.
 	level.info->Snapshot.Clean();
@@ -2953,7 +3093,7 @@ void G_DoPlayDemo (void)
 //
 void G_TimeDemo (const char* name)
 {
-	nodrawers = !!Args->CheckParm ("-nodraw");
+	nodrawers = !!Args->CheckParm ("-nodraw") || G_BenchmarkActive();
 	noblit = !!Args->CheckParm ("-noblit");
 	timingdemo = true;
 	singletics = true;
@@ -3007,6 +3147,7 @@ bool G_CheckDemoStatus (void)
 		}
 		if (singledemo || timingdemo)
 		{
+			G_EndBenchmark();	// does not return if a benchmark is running
 			if (timingdemo)
 			{
 				// Trying to get back to a stable state after timing a demo
@@ -65,6 +65,8 @@ void G_DoLoadGame (void);
 void G_SaveGame (const char *filename, const char *description);
 // Called by messagebox
 void G_DoQuickSave ();
+// Reports a finished background save. With wait set it blocks until the save is done.
+void G_CheckBackgroundSave (bool wait);
 
 // Only called by startup code.
 void G_RecordDemo (const char* name);
@@ -75,6 +77,12 @@ void G_PlayDemo (char* name);
 void G_TimeDemo (const char* name);
 bool G_CheckDemoStatus (void);
 
+// Headless playsim benchmarking (-benchmark)
+bool G_InitBenchmark ();
+bool G_BenchmarkActive ();
+void G_BenchmarkTic ();
+void G_EndBenchmark ();
+
 void G_Ticker (void);
 bool G_Responder (event_t*	ev);
 
@@ -1623,6 +1623,7 @@ FLevelLocals::~FLevelLocals()
 {
 	if (localEventManager) delete localEventManager;
 	if (aabbTree) delete aabbTree;
+	if (traceTree) delete traceTree;
 }
 
 //==========================================================================
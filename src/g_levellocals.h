@@ -169,7 +169,7 @@ private:
 	void PlayerSpawnPickClass (int playernum);
 
 public:
-	void SnapshotLevel();
+	void SnapshotLevel(bool compress = true);
 	void UnSnapshotLevel(bool hubLoad);
 
 	void FinalizePortals();
@@ -461,6 +461,7 @@ public:
 	FCanvasTextureInfo canvasTextureInfo;
 	EventManager *localEventManager = nullptr;
 	DoomLevelAABBTree* aabbTree = nullptr;
+	DoomLevelAABBTree* traceTree = nullptr;	// contains all lines, only created on demand for the playsim's traces.
 
 	// [ZZ] Destructible geometry information
 	TMap<int, FHealthGroup> healthGroups;
@@ -2,6 +2,7 @@
 #define __P_BLOCKMAP_H
 
 #include "doomtype.h"
+#include "tarray.h"
 
 class AActor;
 
@@ -22,6 +23,31 @@ struct FBlockNode
 	static FBlockNode *FreeBlocks;
 };
 
+// Copies of the fields the broad phase needs from all actors linked into one
+// block. They are kept in separate arrays in the order of the block's node
+// chain so that a block can be tested without touching the actors themselves.
+// Any change to the chain or to the position or radius of a linked actor
+// invalidates the copy, which is then rebuilt the next time it is needed.
+struct FBlockThings
+{
+	TArray<double> X;
+	TArray<double> Y;
+	TArray<double> Radius;
+	TArray<uint8_t> SingleBlock;	// actor is only linked into this block
+	TArray<AActor *> Actors;
+	TArray<FBlockNode *> Nodes;
+	unsigned Version = 0;
+	bool Valid = false;
+
+	void Invalidate()
+	{
+		Valid = false;
+		Version++;
+	}
+
+	void Rebuild(FBlockNode *chain);
+};
+
 // BLOCKMAP
 // Created from axis aligned bounding box
 // of the map, a rectangular array of
@@ -40,6 +66,7 @@ struct FBlockmap
 	double				bmaporgx;
 	double				bmaporgy;		// origin of block map
 	FBlockNode**		blocklinks; 	// for thing chains
+	FBlockThings*		blockthings = nullptr;	// hot actor fields for each entry in blocklinks
 
 	// mapblocks are used to check movement
 	// against lines and things
@@ -75,6 +102,11 @@ struct FBlockmap
 
 	bool VerifyBlockMap(int count, unsigned numlines);
 
+	void InvalidateThings(int index)
+	{
+		if (blockthings != nullptr) blockthings[index].Invalidate();
+	}
+
 	void Clear()
 	{
 		if (blockmaplump != nullptr)
@@ -87,6 +119,11 @@ struct FBlockmap
 			delete[] blocklinks;
 			blocklinks = nullptr;
 		}
+		if (blockthings != nullptr)
+		{
+			delete[] blockthings;
+			blockthings = nullptr;
+		}
 	}
 
 	~FBlockmap()
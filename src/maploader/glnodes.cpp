@@ -997,17 +997,20 @@ bool MapLoader::CheckNodes(MapData * map, bool rebuilt, int buildtime)
 typedef TArray<uint8_t> MemFile;
 
 
+// The nodes only depend on the map's data so the cache is addressed by its checksum.
+// This way a map gets built only once no matter in how many files or under which
+// names it is found, and moving or renaming a mod does not invalidate its cache.
 static FString CreateCacheName(MapData *map, bool create)
 {
+	uint8_t md5[16];
+	map->GetChecksum(md5);
+
 	FString path = M_GetCachePath(create);
-	FString lumpname = fileSystem.GetFileFullPath(map->lumpnum);
-	auto separator = lumpname.IndexOf(':');
-	path << '/' << lumpname.Left(separator);
+	path << "/nodes";
 	if (create) CreatePath(path);
-
-	lumpname.ReplaceChars('/', '%');
-	lumpname.ReplaceChars(':', '$');
-	path << '/' << lumpname.Right((ptrdiff_t)lumpname.Len() - separator - 1) << ".gzc";
+	path << '/';
+	for (auto c : md5) path.AppendFormat("%02x", c);
+	path << ".gzc";
 	return path;
 }
 
@@ -52,6 +52,8 @@
 #include "xlat/xlat.h"
 #include "maploader.h"
 #include "texturemanager.h"
+#include "c_dispatch.h"
+#include "i_time.h"
 
 //===========================================================================
 //
@@ -139,9 +141,9 @@ namespace
 //
 //===========================================================================
 
-void UDMFParserBase::Skip()
+void UDMFParserBase::Skip(const char *key)
 {
-	if (developer >= DMSG_WARNING) sc.ScriptMessage("Ignoring unknown UDMF key \"%s\".", sc.String);
+	if (developer >= DMSG_WARNING) sc.ScriptMessage("Ignoring unknown UDMF key \"%s\".", key);
 	if(sc.CheckToken('{'))
 	{
 		int level = 1;
@@ -152,7 +154,6 @@ void UDMFParserBase::Skip()
 				level--;
 				if(level == 0)
 				{
-					sc.UnGet();
 					break;
 				}
 			}
@@ -173,6 +174,275 @@ void UDMFParserBase::Skip()
 	}
 }
 
+//===========================================================================
+//
+// Fast path for the key parser
+//
+// Nearly all of a TEXTMAP consists of plain 'key = value;' lines, so these
+// get scanned directly from the script buffer without going through the
+// generic tokenizer and the string copies it makes. Anything unusual, like
+// escape sequences, hex or octal numbers or syntax errors, is left to the
+// regular FScanner code which then continues from the same position.
+//
+//===========================================================================
+
+static inline bool IsKeyStart(char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static inline bool IsKeyChar(char c)
+{
+	return IsKeyStart(c) || (c >= '0' && c <= '9');
+}
+
+static inline bool IsDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+static inline bool IsBlank(char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Returns nullptr if the end of the script is reached.
+const char *UDMFParserBase::SkipWhitespace(const char *p, const char *end, int &line)
+{
+	while (p < end)
+	{
+		char c = *p;
+		if (c == '\n')
+		{
+			line++;
+			p++;
+		}
+		else if (IsBlank(c))
+		{
+			p++;
+		}
+		else if (c == '/' && p + 1 < end && p[1] == '/')
+		{
+			p += 2;
+			while (p < end && *p != '\n') p++;
+		}
+		else if (c == '/' && p + 1 < end && p[1] == '*')
+		{
+			p += 2;
+			while (p + 1 < end && (p[0] != '*' || p[1] != '/'))
+			{
+				if (*p == '\n') line++;
+				p++;
+			}
+			if (p + 1 >= end) return nullptr;
+			p += 2;
+		}
+		else return p;
+	}
+	return nullptr;
+}
+
+// Key names repeat constantly so the last FName for each hash slot is kept around.
+FName UDMFParserBase::LookupKey(const char *text, size_t length)
+{
+	if (length >= sizeof(FKeyCacheEntry::Text))
+	{
+		return FName(text, length, false);
+	}
+	if (KeyCache.Size() == 0)
+	{
+		KeyCache.Resize(256);
+		for (auto &entry : KeyCache) entry.Length = 0;
+	}
+
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < length; i++)
+	{
+		hash = (hash ^ (uint8_t)text[i]) * 16777619u;
+	}
+	auto &entry = KeyCache[(hash ^ (hash >> 8)) & 255];
+	if (entry.Length != length || memcmp(entry.Text, text, length))
+	{
+		memcpy(entry.Text, text, length);
+		entry.Length = (uint8_t)length;
+		entry.Name = FName(text, length, false);
+	}
+	return entry.Name;
+}
+
+bool UDMFParserBase::ParseKeyFast(FName &key, bool checkblock, bool *isblock)
+{
+	auto pos = sc.GetScanPos();
+	const char *end = sc.GetScriptEnd();
+	const char *p = pos.SavedScriptPtr;
+	int line = pos.SavedScriptLine;
+
+	if (p == nullptr || (p = SkipWhitespace(p, end, line)) == nullptr || !IsKeyStart(*p))
+	{
+		return false;
+	}
+	const char *keystart = p;
+	while (p < end && IsKeyChar(*p)) p++;
+	size_t keylength = p - keystart;
+
+	if ((p = SkipWhitespace(p, end, line)) == nullptr)
+	{
+		return false;
+	}
+	if (*p == '{')
+	{
+		if (!checkblock) return false;
+		key = LookupKey(keystart, keylength);
+		if (isblock) *isblock = true;
+		// The brace goes through the scanner so that the caller can still UnGet it.
+		sc.RestorePos({ p, line });
+		sc.MustGetToken('{');
+		return true;
+	}
+	if (*p != '=' || (p = SkipWhitespace(p + 1, end, line)) == nullptr)
+	{
+		return false;
+	}
+
+	int token;
+	int number = 0;
+	int64_t bignumber = 0;
+	double fnumber = 0;
+	const char *strstart = nullptr;
+	const char *strend = nullptr;
+	bool neg = false;
+
+	if (*p == '+' || *p == '-')
+	{
+		// Only a sign directly followed by the number, everything else goes the slow way.
+		neg = *p == '-';
+		if (++p >= end) return false;
+	}
+	if (IsDigit(*p) || (*p == '.' && p + 1 < end && IsDigit(p[1])))
+	{
+		const char *numstart = p;
+		bool isfloat = false;
+
+		while (p < end && IsDigit(*p)) p++;
+		size_t intdigits = p - numstart;
+		if (p < end && *p == '.')
+		{
+			isfloat = true;
+			p++;
+			while (p < end && IsDigit(*p)) p++;
+		}
+		if (p < end && (*p == 'e' || *p == 'E'))
+		{
+			p++;
+			if (p < end && (*p == '+' || *p == '-')) p++;
+			if (p >= end || !IsDigit(*p)) return false;
+			while (p < end && IsDigit(*p)) p++;
+			isfloat = true;
+		}
+		// Suffixes and hex numbers are left to the scanner.
+		if (p >= end || !(IsBlank(*p) || *p == ';' || *p == '/'))
+		{
+			return false;
+		}
+		if (isfloat)
+		{
+			token = TK_FloatConst;
+			fnumber = strtod(numstart, nullptr);
+		}
+		else
+		{
+			if (*numstart == '0' && intdigits > 1) return false;	// octal
+			token = TK_IntConst;
+			bignumber = strtoll(numstart, nullptr, 10);
+			number = (int)bignumber;
+			fnumber = number;
+		}
+		if (neg)
+		{
+			number = -number;
+			fnumber = -fnumber;
+		}
+	}
+	else if (neg)
+	{
+		return false;
+	}
+	else if (*p == '"')
+	{
+		strstart = ++p;
+		while (p < end && *p != '"')
+		{
+			if (*p == '\\' || *p == 0) return false;
+			if (*p == '\n') line++;
+			p++;
+		}
+		if (p >= end) return false;
+		strend = p++;
+		token = TK_StringConst;
+	}
+	else if (IsKeyStart(*p))
+	{
+		const char *ident = p;
+		while (p < end && IsKeyChar(*p)) p++;
+		if (p - ident == 4 && !strnicmp(ident, "true", 4)) token = TK_True;
+		else if (p - ident == 5 && !strnicmp(ident, "false", 5)) token = TK_False;
+		else return false;
+	}
+	else
+	{
+		return false;
+	}
+
+	if ((p = SkipWhitespace(p, end, line)) == nullptr || *p != ';')
+	{
+		return false;
+	}
+
+	key = LookupKey(keystart, keylength);
+	if (checkblock && isblock) *isblock = false;
+	if (token == TK_StringConst)
+	{
+		parsedString = FString(strstart, strend - strstart);
+	}
+	sc.RestorePos({ p + 1, line });
+	sc.TokenType = token;
+	sc.Number = number;
+	sc.Float = fnumber;
+	if (token == TK_IntConst) sc.BigNumber = bignumber;
+	return true;
+}
+
+//===========================================================================
+//
+// Checks for the end of a block. A key in front is left untouched.
+//
+//===========================================================================
+
+bool UDMFParserBase::CheckBlockEnd()
+{
+	if (FastKeys)
+	{
+		auto pos = sc.GetScanPos();
+		int line = pos.SavedScriptLine;
+		const char *p = pos.SavedScriptPtr ? SkipWhitespace(pos.SavedScriptPtr, sc.GetScriptEnd(), line) : nullptr;
+		if (p != nullptr)
+		{
+			if (*p == '}')
+			{
+				sc.RestorePos({ p + 1, line });
+				sc.TokenType = '}';
+				return true;
+			}
+			if (IsKeyStart(*p))
+			{
+				sc.RestorePos({ p, line });
+				return false;
+			}
+		}
+	}
+	return sc.CheckToken('}');
+}
+
 //===========================================================================
 //
 // Parses a 'key = value' line of the map
@@ -181,6 +451,12 @@ void UDMFParserBase::Skip()
 
 FName UDMFParserBase::ParseKey(bool checkblock, bool *isblock)
 {
+	FName fastkey;
+	if (FastKeys && ParseKeyFast(fastkey, checkblock, isblock))
+	{
+		return fastkey;
+	}
+
 	sc.MustGetString();
 	FName key = sc.String;
 	if (checkblock)
@@ -481,7 +757,7 @@ public:
 		th->Health = 1;
 		th->FloatbobPhase = -1;
 		sc.MustGetToken('{');
-		while (!sc.CheckToken('}'))
+		while (!CheckBlockEnd())
 		{
 			FName key = ParseKey();
 			switch(key.GetIndex())
@@ -827,7 +1103,7 @@ public:
 		if (Level->flags2 & LEVEL2_CHECKSWITCHRANGE) ld->flags |= ML_CHECKSWITCHRANGE;
 
 		sc.MustGetToken('{');
-		while (!sc.CheckToken('}'))
+		while (!CheckBlockEnd())
 		{
 			FName key = ParseKey();
 
@@ -1208,7 +1484,7 @@ public:
 		sd->UDMFIndex = index;
 
 		sc.MustGetToken('{');
-		while (!sc.CheckToken('}'))
+		while (!CheckBlockEnd())
 		{
 			FName key = ParseKey();
 			switch(key.GetIndex())
@@ -1520,7 +1796,7 @@ public:
 		sec->movefactor = ORIG_FRICTION_FACTOR;
 
 		sc.MustGetToken('{');
-		while (!sc.CheckToken('}'))
+		while (!CheckBlockEnd())
 		{
 			FName key = ParseKey();
 			switch(key.GetIndex())
@@ -2056,7 +2332,7 @@ public:
 
 		sc.MustGetToken('{');
 		double x = 0, y = 0;
-		while (!sc.CheckToken('}'))
+		while (!CheckBlockEnd())
 		{
 			FName key = ParseKey();
 			switch (key.GetIndex())
@@ -2316,7 +2592,7 @@ public:
 			}
 			else
 			{
-				Skip();
+				Skip(sc.String);
 			}
 		}
 
@@ -2365,3 +2641,181 @@ void MapLoader::ParseTextMap(MapData *map, FMissingTextureTracker &missingtex)
 
 	parse.ParseTextMap(map);
 }
+
+//===========================================================================
+//
+// Times the tokenizing of a map's TEXTMAP lump, once with the fast path and
+// once with FScanner only. Nothing gets created, all values are only summed
+// up to make sure that both ways read the same data.
+//
+//===========================================================================
+
+// A dialogue with the constructs that the USDF parser skips with UnGet and Skip.
+static const char BenchDialogue[] =
+	"namespace = \"strife\";\n"
+	"conversation\n"
+	"{\n"
+	"	actor = 64;\n"
+	"	unknownblock { foo = 1; bar { baz = \"x\"; } }\n"
+	"	page\n"
+	"	{\n"
+	"		name = \"Speaker\";\n"
+	"		dialog = \"Hello\";\n"
+	"		choice\n"
+	"		{\n"
+	"			text = \"Bye\";\n"
+	"			require { item = \"Coin\"; amount = 10; }\n"
+	"			nextpage = -1;\n"
+	"		}\n"
+	"	}\n"
+	"}\n";
+
+class UDMFBenchParser : public UDMFParserBase
+{
+	uint64_t checksum;
+
+	void Add(uint64_t value)
+	{
+		checksum = checksum * 31 + value;
+	}
+
+	void AddValue(FName key)
+	{
+		Add(key.GetIndex());
+		Add(sc.TokenType);
+		switch (sc.TokenType)
+		{
+		case TK_IntConst:
+			Add(sc.Number);
+			break;
+		case TK_FloatConst:
+			Add((uint64_t)(int64_t)(sc.Float * 65536.));
+			break;
+		case TK_StringConst:
+			Add(parsedString.Len());
+			for (unsigned i = 0; i < parsedString.Len(); i++) Add((uint8_t)parsedString[i]);
+			break;
+		}
+	}
+
+	// Walks the blocks the same way as the USDF parser.
+	void RunDialogueBlock()
+	{
+		while (!sc.CheckToken('}'))
+		{
+			bool block = false;
+			FName key = ParseKey(true, &block);
+			if (!block)
+			{
+				AddValue(key);
+			}
+			else if (key == NAME_Page || key == NAME_Choice)
+			{
+				Add(key.GetIndex());
+				RunDialogueBlock();
+			}
+			else
+			{
+				sc.UnGet();
+				Skip(key.GetChars());
+			}
+		}
+	}
+
+public:
+	uint64_t Run(const TArray<uint8_t> &text, bool fast)
+	{
+		checksum = 0;
+		FastKeys = fast;
+		sc.OpenMem("TEXTMAP", text);
+		sc.SetCMode(true);
+		if (sc.CheckString("namespace"))
+		{
+			sc.MustGetStringName("=");
+			sc.MustGetString();
+			sc.MustGetStringName(";");
+		}
+		while (sc.GetString())
+		{
+			sc.MustGetToken('{');
+			while (!CheckBlockEnd())
+			{
+				AddValue(ParseKey());
+			}
+		}
+		sc.Close();
+		return checksum;
+	}
+
+	uint64_t RunDialogue(bool fast)
+	{
+		checksum = 0;
+		FastKeys = fast;
+		sc.OpenString("DIALOGUE", BenchDialogue);
+		sc.SetCMode(true);
+		sc.MustGetStringName("namespace");
+		sc.MustGetToken('=');
+		sc.MustGetToken(TK_StringConst);
+		sc.MustGetToken(';');
+		while (sc.GetString())
+		{
+			if (sc.Compare("conversation"))
+			{
+				sc.MustGetToken('{');
+				RunDialogueBlock();
+			}
+			else
+			{
+				Skip(sc.String);
+			}
+		}
+		sc.Close();
+		return checksum;
+	}
+};
+
+CCMD(benchudmf)
+{
+	if (argv.argc() < 2)
+	{
+		Printf("Usage: benchudmf <map> [passes]\n");
+		return;
+	}
+	int passes = argv.argc() > 2 ? max(atoi(argv[2]), 1) : 10;
+
+	MapData *map = P_OpenMapData(argv[1], false);
+	if (map == nullptr)
+	{
+		Printf("Map %s not found\n", argv[1]);
+		return;
+	}
+	if (!map->isText)
+	{
+		Printf("%s is not a UDMF map\n", argv[1]);
+		delete map;
+		return;
+	}
+	TArray<uint8_t> text = map->Read(ML_TEXTMAP);
+	delete map;
+
+	uint64_t checksum[2];
+	double mbs[2];
+	for (int fast = 0; fast < 2; fast++)
+	{
+		UDMFBenchParser parser;
+		uint64_t start = I_nsTime();
+		for (int i = 0; i < passes; i++)
+		{
+			checksum[fast] = parser.Run(text, !!fast);
+		}
+		double seconds = (I_nsTime() - start) * 1e-9;
+		mbs[fast] = seconds > 0 ? text.Size() * double(passes) / (seconds * 1048576.) : 0.;
+	}
+	Printf("TEXTMAP %u bytes, %d passes: scanner %.1f MB/s, fast path %.1f MB/s, %s\n", text.Size(), passes,
+		mbs[0], mbs[1], checksum[0] == checksum[1] ? "results match" : TEXTCOLOR_RED "RESULTS DIFFER");
+
+	// The dialogue parser uses the same key parser but also skips unknown blocks.
+	UDMFBenchParser dialogue;
+	bool dialoguematch = dialogue.RunDialogue(false) == dialogue.RunDialogue(true);
+	Printf("Dialogue: %s\n", dialoguematch ? "results match" : TEXTCOLOR_RED "RESULTS DIFFER");
+}
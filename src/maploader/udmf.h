@@ -12,9 +12,22 @@ protected:
 	int namespace_bits;
 	FString parsedString;
 	bool BadCoordinates = false;
+	bool FastKeys = true;	// scan simple 'key = value;' lines directly from the buffer
 
-	void Skip();
+	struct FKeyCacheEntry
+	{
+		char Text[32];
+		uint8_t Length;
+		FName Name;
+	};
+	TArray<FKeyCacheEntry> KeyCache;
+
+	void Skip(const char *key);
+	FName LookupKey(const char *text, size_t length);
+	const char *SkipWhitespace(const char *p, const char *end, int &line);
+	bool ParseKeyFast(FName &key, bool checkblock, bool *isblock);
 	FName ParseKey(bool checkblock = false, bool *isblock = NULL);
+	bool CheckBlockEnd();
 	int CheckInt(FName key);
 	double CheckFloat(FName key);
 	double CheckCoordinate(FName key);
@@ -239,7 +239,7 @@ class USDFParser : public UDMFParserBase
 
 				default:
 					sc.UnGet();
-					Skip();
+					Skip(key.GetChars());
 				}
 			}
 		}
@@ -406,7 +406,7 @@ class USDFParser : public UDMFParserBase
 
 				default:
 					sc.UnGet();
-					Skip();
+					Skip(key.GetChars());
 				}
 			}
 		}
@@ -471,7 +471,7 @@ class USDFParser : public UDMFParserBase
 
 				default:
 					sc.UnGet();
-					Skip();
+					Skip(key.GetChars());
 				}
 			}
 		}
@@ -609,7 +609,7 @@ public:
 			}
 			else
 			{
-				Skip();
+				Skip(sc.String);
 			}
 		}
 
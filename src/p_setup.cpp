@@ -152,7 +152,7 @@ static void AddToList(uint8_t *hitlist, FTextureID texid, int bitmask)
 
 static void PrecacheLevel(FLevelLocals *Level)
 {
-	if (demoplayback)
+	if (demoplayback || nodrawers)
 		return;
 
 	int i;
@@ -373,6 +373,8 @@ void FLevelLocals::ClearLevelData()
 	localEventManager->Shutdown();
 	if (aabbTree) delete aabbTree;
 	aabbTree = nullptr;
+	if (traceTree) delete traceTree;
+	traceTree = nullptr;
 	if (screen)
 		screen->SetAABBTree(nullptr);
 }
@@ -1372,15 +1372,24 @@ public:
 	{
 		__Pos.X = npos.X;
 		__Pos.Y = npos.Y;
+		if (BlockNode != nullptr) InvalidateBlockThings();
 	}
 	void SetXYZ(double xx, double yy, double zz)
 	{
 		__Pos = { xx,yy,zz };
+		if (BlockNode != nullptr) InvalidateBlockThings();
 	}
 	void SetXYZ(const DVector3 &npos)
 	{
 		__Pos = npos;
+		if (BlockNode != nullptr) InvalidateBlockThings();
 	}
+	void SetRadius(double newradius)
+	{
+		radius = newradius;
+		if (BlockNode != nullptr) InvalidateBlockThings();
+	}
+	void InvalidateBlockThings();
 
 	double VelXYToSpeed() const
 	{
@@ -46,10 +46,11 @@
 #include "g_cvars.h"
 #include "d_main.h"
 
-static int ThinkCount;
-static cycle_t ThinkCycles;
+int ThinkCount;
+cycle_t ThinkCycles;
 extern cycle_t BotSupportCycles;
 extern cycle_t ActionCycles;
+extern cycle_t MovementCycles;
 extern int BotWTG;
 
 IMPLEMENT_CLASS(DThinker, false, false)
@@ -92,7 +93,12 @@ void FThinkerCollection::Link(DThinker *thinker, int statnum)
 
 //==========================================================================
 //
-//
+// Thinkers are always ticked serially and in list order. AActor::Tick runs
+// ZScript on the one global VM stack, draws from the shared FRandom
+// streams, uses validcount and allocates sector and blockmap links from
+// global free lists, so any concurrency here would break demo and network
+// sync. Only the particles, which never interact with anything, are moved
+// in parallel (see P_ThinkParticles).
 //
 //==========================================================================
 
@@ -104,6 +110,7 @@ void FThinkerCollection::RunThinkers(FLevelLocals *Level)
 	ThinkCycles.Reset();
 	BotSupportCycles.Reset();
 	ActionCycles.Reset();
+	MovementCycles.Reset();
 	BotWTG = 0;
 
 	ThinkCycles.Clock();
@@ -1042,6 +1049,6 @@ DThinker *FThinkerIterator::Next (bool exact)
 ADD_STAT (think)
 {
 	FString out;
-	out.Format ("Think time = %04.2f ms - %d thinkers, Action = %04.2f ms", ThinkCycles.TimeMS(), ThinkCount, ActionCycles.TimeMS());
+	out.Format ("Think time = %04.2f ms - %d thinkers, Action = %04.2f ms, Movement = %04.2f ms", ThinkCycles.TimeMS(), ThinkCount, ActionCycles.TimeMS(), MovementCycles.TimeMS());
 	return out;
 }
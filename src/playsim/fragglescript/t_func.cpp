@@ -2138,6 +2138,7 @@ void FParser::SF_SetLineBlocking(void)
 			{
 				Level->lines[i].flags = (Level->lines[i].flags & ~(ML_BLOCKING | ML_BLOCKEVERYTHING)) | blocking;
 			}
+			P_InvalidateSightCache();
 		}
 	}
 }
@@ -2161,6 +2162,7 @@ void FParser::SF_SetLineMonsterBlocking(void)
 		{
 			Level->lines[i].flags = (Level->lines[i].flags & ~ML_BLOCKMONSTERS) | blocking;
 		}
+		P_InvalidateSightCache();
 	}
 }
 
@@ -2719,7 +2721,7 @@ void FParser::SF_MoveCamera(void)
 		bool finishedmove = false;
 		bool finishedangle = false;
 
-		cam->radius = 1 / 8192.;
+		cam->SetRadius(1 / 8192.);
 		cam->Height = 1 / 8192.;
 
 		if (campos != targpos)
@@ -3199,6 +3201,7 @@ void FParser::SF_LineFlag()
 			line->flags &= ~(1 << flagnum);
 			if(intvalue(t_argv[2]))
 				line->flags |= (1 << flagnum);
+			P_InvalidateSightCache();
 		}
 		
 		t_return.type = svt_int;
@@ -3284,7 +3287,7 @@ void FParser::SF_Resurrect()
 
 		mo->SetState(state);
 		mo->Height = mo->GetDefault()->Height;
-		mo->radius = mo->GetDefault()->radius;
+		mo->SetRadius(mo->GetDefault()->radius);
 		mo->Revive();
 		mo->target = nullptr;
 	}
@@ -3568,7 +3571,7 @@ void FParser::SF_MobjRadius(void)
 		if(t_argc > 1)
 		{
 			if(mo) 
-				mo->radius = floatvalue(t_argv[1]);
+				mo->SetRadius(floatvalue(t_argv[1]));
 		}
 		t_return.setDouble(mo ? mo->radius : 0.);
 	}
@@ -3802,6 +3805,7 @@ void FParser::SF_SetLineTrigger()
 				(f & ~(ML_MONSTERSCANACTIVATE | ML_REPEAT_SPECIAL | ML_SPAC_MASK | ML_FIRSTSIDEONLY));
 
 		}
+		P_InvalidateSightCache();
 	}
 }
 
@@ -3309,6 +3309,7 @@ void FBehavior::StartTypedScripts (uint16_t type, AActor *activator, bool always
 			if (nullptr != runningScript && runNow)
 			{
 				runningScript->RunScript();
+				P_InvalidateSightCache();
 			}
 		}
 	}
@@ -3423,6 +3424,8 @@ void DACSThinker::Tick ()
 		script->RunScript();
 		script = next;
 	}
+	// Scripts can change anything that affects sight checks.
+	P_InvalidateSightCache();
 
 //	GlobalACSStrings.Clear();
 
@@ -8977,6 +8980,7 @@ scriptwait:
 						break;
 					}
 				}
+				P_InvalidateSightCache();
 
 				sp -= 2;
 			}
@@ -8994,6 +8998,7 @@ scriptwait:
 					else
 						Level->lines[line].flags &= ~ML_BLOCKMONSTERS;
 				}
+				P_InvalidateSightCache();
 
 				sp -= 2;
 			}
@@ -10457,7 +10462,9 @@ int P_StartScript (FLevelLocals *Level, AActor *who, line_t *where, int script,
 			{
 				if (flags & ACS_WANTRESULT)
 				{
-					return runningScript->RunScript();
+					int res = runningScript->RunScript();
+					P_InvalidateSightCache();
+					return res;
 				}
 				return true;
 			}
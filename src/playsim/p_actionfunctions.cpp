@@ -1976,7 +1976,7 @@ DEFINE_ACTION_FUNCTION(AActor, A_Respawn)
 
 	self->flags |= MF_SOLID;
 	self->Height = self->GetDefault()->Height;
-	self->radius = self->GetDefault()->radius;
+	self->SetRadius(self->GetDefault()->radius);
 	self->RestoreSpecialPosition();
 
 	if (flags & RSF_TELEFRAG)
@@ -4950,14 +4950,14 @@ DEFINE_ACTION_FUNCTION(AActor, A_SetSize)
 
 	FLinkContext ctx;
 	self->UnlinkFromWorld(&ctx);
-	self->radius = newradius;
+	self->SetRadius(newradius);
 	self->Height = newheight;
 	self->LinkToWorld(&ctx);
 
 	if (testpos && !P_TestMobjLocation(self))
 	{
 		self->UnlinkFromWorld(&ctx);
-		self->radius = oldradius;
+		self->SetRadius(oldradius);
 		self->Height = oldheight;
 		self->LinkToWorld(&ctx);
 		ACTION_RETURN_BOOL(false);
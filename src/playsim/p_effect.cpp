@@ -49,18 +49,23 @@
 #include "vm.h"
 #include "actorinlines.h"
 #include "g_game.h"
+#include "parallel_for.h"
 
 CVAR (Int, cl_rockettrails, 1, CVAR_ARCHIVE);
 CVAR (Bool, r_rail_smartspiral, 0, CVAR_ARCHIVE);
 CVAR (Int, r_rail_spiralsparsity, 1, CVAR_ARCHIVE);
 CVAR (Int, r_rail_trailsparsity, 1, CVAR_ARCHIVE);
 CVAR (Bool, r_particles, true, 0);
+CVAR (Bool, r_parallelparticles, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG);
 EXTERN_CVAR(Int, r_maxparticles);
 
 FRandom pr_railtrail("RailTrail");
 
 #define FADEFROMTTL(a)	(1.f/(a))
 
+// Below this the thread startup costs more than the particles themselves.
+enum { PARALLEL_PARTICLES_MIN = 1024 };
+
 static int grey1, grey2, grey3, grey4, red, green, blue, yellow, black,
 		   red1, green1, blue1, yellow1, purple, purple1, white,
 		   rblue1, rblue2, rblue3, rblue4, orange, yorange, dred, grey5,
@@ -210,11 +215,112 @@ void P_InitEffects ()
 	blood2 = ParticleColor(RPART(kind)/3, GPART(kind)/3, BPART(kind)/3);
 }
 
+//==========================================================================
+//
+// ThinkParticle
+//
+// Advances a single particle. Returns false if it has expired and needs
+// to be freed by the caller. This only reads level data, so it may run on
+// several particles at once as long as no line portal needs to be checked.
+//
+//==========================================================================
+
+static bool ThinkParticle (FLevelLocals *Level, particle_t *particle)
+{
+	auto oldtrans = particle->alpha;
+	particle->alpha -= particle->fadestep;
+	particle->size += particle->sizestep;
+	if (particle->alpha <= 0 || oldtrans < particle->alpha || --particle->ttl <= 0 || (particle->size <= 0))
+	{ // The particle has expired
+		return false;
+	}
+
+	// Handle crossing a line portal
+	DVector2 newxy = Level->GetPortalOffsetPosition(particle->Pos.X, particle->Pos.Y, particle->Vel.X, particle->Vel.Y);
+	particle->Pos.X = newxy.X;
+	particle->Pos.Y = newxy.Y;
+	particle->Pos.Z += particle->Vel.Z;
+	particle->Vel += particle->Acc;
+	particle->subsector = Level->PointInRenderSubsector(particle->Pos);
+	sector_t *s = particle->subsector->sector;
+	// Handle crossing a sector portal.
+	if (!s->PortalBlocksMovement(sector_t::ceiling))
+	{
+		if (particle->Pos.Z > s->GetPortalPlaneZ(sector_t::ceiling))
+		{
+			particle->Pos += s->GetPortalDisplacement(sector_t::ceiling);
+			particle->subsector = NULL;
+		}
+	}
+	else if (!s->PortalBlocksMovement(sector_t::floor))
+	{
+		if (particle->Pos.Z < s->GetPortalPlaneZ(sector_t::floor))
+		{
+			particle->Pos += s->GetPortalDisplacement(sector_t::floor);
+			particle->subsector = NULL;
+		}
+	}
+	return true;
+}
+
+//==========================================================================
+//
+// P_ThinkParticles
+//
+// With r_parallelparticles the particles are advanced on all cores first.
+// Expired particles are then freed in list order, so the resulting lists
+// are exactly the same as with the serial loop.
+//
+//==========================================================================
+
 void P_ThinkParticles (FLevelLocals *Level)
 {
 	int i;
 	particle_t *particle, *prev;
 
+	// The line portal traverser uses validcount so it cannot run in parallel.
+	if (r_parallelparticles && !Level->PortalBlockmap.containsLines)
+	{
+		static TArray<uint16_t> active;
+		static TArray<uint8_t> alive;
+		bool frozen = Level->isFrozen();
+
+		active.Clear();
+		for (i = Level->ActiveParticles; i != NO_PARTICLE; i = Level->Particles[i].tnext)
+		{
+			active.Push(uint16_t(i));
+		}
+		if (active.Size() >= PARALLEL_PARTICLES_MIN)
+		{
+			alive.Resize(active.Size());
+			parallel_for(int(active.Size()), [=](int index)
+			{
+				particle_t *p = &Level->Particles[active[index]];
+				alive[index] = (!p->notimefreeze && frozen) || ThinkParticle(Level, p);
+			});
+
+			prev = NULL;
+			for (unsigned j = 0; j < active.Size(); j++)
+			{
+				particle = &Level->Particles[active[j]];
+				i = particle->tnext;
+				if (!alive[j])
+				{ // The particle has expired, so free it
+					memset (particle, 0, sizeof(particle_t));
+					if (prev)
+						prev->tnext = i;
+					else
+						Level->ActiveParticles = i;
+					particle->tnext = Level->InactiveParticles;
+					Level->InactiveParticles = active[j];
+					continue;
+				}
+				prev = particle;
+			}
+			return;
+		}
+	}
+
 	i = Level->ActiveParticles;
 	prev = NULL;
 	while (i != NO_PARTICLE)
@@ -227,10 +333,7 @@ void P_ThinkParticles (FLevelLocals *Level)
 			continue;
 		}
 		
-		auto oldtrans = particle->alpha;
-		particle->alpha -= particle->fadestep;
-		particle->size += particle->sizestep;
-		if (particle->alpha <= 0 || oldtrans < particle->alpha || --particle->ttl <= 0 || (particle->size <= 0))
+		if (!ThinkParticle(Level, particle))
 		{ // The particle has expired, so free it
 			memset (particle, 0, sizeof(particle_t));
 			if (prev)
@@ -241,32 +344,6 @@ void P_ThinkParticles (FLevelLocals *Level)
 			Level->InactiveParticles = (int)(particle - Level->Particles.Data());
 			continue;
 		}
-
-		// Handle crossing a line portal
-		DVector2 newxy = Level->GetPortalOffsetPosition(particle->Pos.X, particle->Pos.Y, particle->Vel.X, particle->Vel.Y);
-		particle->Pos.X = newxy.X;
-		particle->Pos.Y = newxy.Y;
-		particle->Pos.Z += particle->Vel.Z;
-		particle->Vel += particle->Acc;
-		particle->subsector = Level->PointInRenderSubsector(particle->Pos);
-		sector_t *s = particle->subsector->sector;
-		// Handle crossing a sector portal.
-		if (!s->PortalBlocksMovement(sector_t::ceiling))
-		{
-			if (particle->Pos.Z > s->GetPortalPlaneZ(sector_t::ceiling))
-			{
-				particle->Pos += s->GetPortalDisplacement(sector_t::ceiling);
-				particle->subsector = NULL;
-			}
-		}
-		else if (!s->PortalBlocksMovement(sector_t::floor))
-		{
-			if (particle->Pos.Z < s->GetPortalPlaneZ(sector_t::floor))
-			{
-				particle->Pos += s->GetPortalDisplacement(sector_t::floor);
-				particle->subsector = NULL;
-			}
-		}
 		prev = particle;
 	}
 }
@@ -2785,7 +2785,7 @@ bool P_CheckForResurrection(AActor* self, bool usevilestates, FState* state = nu
 				corpsehit->Height = corpsehit->GetDefault()->Height;
 				bool check = P_CheckPosition(corpsehit, corpsehit->Pos());
 				corpsehit->flags = oldflags;
-				corpsehit->radius = oldradius;
+				corpsehit->SetRadius(oldradius);
 				corpsehit->Height = oldheight;
 				if (!check || !P_CanResurrect(self, corpsehit)) continue;
 
@@ -2849,7 +2849,7 @@ bool P_CheckForResurrection(AActor* self, bool usevilestates, FState* state = nu
 				else
 				{
 					corpsehit->Height = info->Height;	// [RH] Use real mobj height
-					corpsehit->radius = info->radius;	// [RH] Use real radius
+					corpsehit->SetRadius(info->radius);	// [RH] Use real radius
 				}
 
 				corpsehit->Revive();
@@ -79,9 +79,22 @@
 // State.
 #include "po_man.h"
 #include "vm.h"
+#include "doom_aabbtree.h"
+
+#if !defined(NO_SSE) && (defined(_M_X64) || defined(__SSE2__))
+#define BLOCKTHINGS_SSE2
+#include <emmintrin.h>
+#endif
 
 int P_VanillaPointOnDivlineSide(double x, double y, const divline_t* line);
 
+// Lets hitscans, autoaim and sight checks find the lines they cross with the
+// level's line tree instead of walking the blockmap. This is a lot faster for
+// long traces through large open areas but intercepts at the exact same
+// distance may be processed in a different order and lines missing from a
+// map's blockmap are no longer ignored, so it is not the default.
+CVAR(Bool, sv_linetreetraces, false, CVAR_ARCHIVE | CVAR_SERVERINFO)
+
 
 //==========================================================================
 //
@@ -340,6 +353,7 @@ void AActor::UnlinkFromWorld (FLinkContext *ctx)
 				block->NextActor->PrevActor = block->PrevActor;
 			}
 			*(block->PrevActor) = block->NextActor;
+			Level->blockmap.InvalidateThings(block->BlockIndex);
 			FBlockNode *next = block->NextBlock;
 			block->Release ();
 			block = next;
@@ -545,6 +559,7 @@ void AActor::LinkToWorld(FLinkContext *ctx, bool spawningmapthing, sector_t *sec
 						}
 						node->PrevActor = link;
 						*link = node;
+						Level->blockmap.InvalidateThings(node->BlockIndex);
 
 						// Link in to actor
 						node->PrevBlock = alink;
@@ -560,6 +575,50 @@ void AActor::LinkToWorld(FLinkContext *ctx, bool spawningmapthing, sector_t *sec
 	if (!spawningmapthing) UpdateRenderSectorList();
 }
 
+//==========================================================================
+//
+// AActor :: InvalidateBlockThings
+//
+// Must be called when the position or radius of a linked actor changes
+// without relinking it.
+//
+//==========================================================================
+
+void AActor::InvalidateBlockThings()
+{
+	for (FBlockNode *block = BlockNode; block != nullptr; block = block->NextBlock)
+	{
+		Level->blockmap.InvalidateThings(block->BlockIndex);
+	}
+}
+
+//==========================================================================
+//
+// FBlockThings :: Rebuild
+//
+//==========================================================================
+
+void FBlockThings::Rebuild(FBlockNode *chain)
+{
+	X.Clear();
+	Y.Clear();
+	Radius.Clear();
+	SingleBlock.Clear();
+	Actors.Clear();
+	Nodes.Clear();
+	for (FBlockNode *node = chain; node != nullptr; node = node->NextActor)
+	{
+		AActor *me = node->Me;
+		X.Push(me->X());
+		Y.Push(me->Y());
+		Radius.Push(me->radius);
+		SingleBlock.Push(node->NextBlock == nullptr && node->PrevBlock == &me->BlockNode);
+		Actors.Push(me);
+		Nodes.Push(node);
+	}
+	Valid = true;
+}
+
 void AActor::SetOrigin(double x, double y, double z, bool moving)
 {
 	FLinkContext ctx;
@@ -943,9 +1002,18 @@ void FBlockThingsIterator::StartBlock(int x, int y)
 {
 	curx = x;
 	cury = y;
+	things = nullptr;
 	if (Level->blockmap.isValidBlock(x, y))
 	{
-		block = Level->blockmap.blocklinks[y*Level->blockmap.bmapwidth + x];
+		int index = y*Level->blockmap.bmapwidth + x;
+		block = Level->blockmap.blocklinks[index];
+		if (filter && block != nullptr && Level->blockmap.blockthings != nullptr)
+		{
+			things = &Level->blockmap.blockthings[index];
+			if (!things->Valid) things->Rebuild(block);
+			thingsVersion = things->Version;
+			thingsIndex = 0;
+		}
 	}
 	else
 	{
@@ -954,6 +1022,66 @@ void FBlockThingsIterator::StartBlock(int x, int y)
 	}
 }
 
+//===========================================================================
+//
+// FBlockThingsIterator :: SetFilter
+//
+// Skips all actors whose box does not overlap the given square.
+// This is only valid for callers that would ignore these actors anyway.
+//
+//===========================================================================
+
+void FBlockThingsIterator::SetFilter(double x, double y, double radius)
+{
+	filter = true;
+	filterX = x;
+	filterY = y;
+	filterRadius = radius;
+	StartBlock(curx, cury);
+}
+
+//===========================================================================
+//
+// FBlockThingsIterator :: AddToHash
+//
+// Returns false if the actor has already been checked.
+//
+//===========================================================================
+
+bool FBlockThingsIterator::AddToHash(AActor *me)
+{
+	HashEntry *entry;
+	size_t hash = ((size_t)me >> 3) % countof(Buckets);
+	for (int i = Buckets[hash]; i >= 0; )
+	{
+		entry = GetHashEntry(i);
+		if (entry->Actor == me)
+		{ // I've already been checked.
+			return false;
+		}
+		i = entry->Next;
+	}
+	if (NumFixedHash < (int)countof(FixedHash))
+	{
+		entry = &FixedHash[NumFixedHash];
+		entry->Next = Buckets[hash];
+		Buckets[hash] = NumFixedHash++;
+	}
+	else
+	{
+		if (DynHash.Size() == 0)
+		{
+			DynHash.Grow(50);
+		}
+		int i = DynHash.Reserve(1);
+		entry = &DynHash[i];
+		entry->Next = Buckets[hash];
+		Buckets[hash] = i + countof(FixedHash);
+	}
+	entry->Actor = me;
+	return true;
+}
+
 //===========================================================================
 //
 // FBlockThingsIterator :: SwitchBlock
@@ -967,6 +1095,49 @@ void FBlockThingsIterator::SwitchBlock(int x, int y)
 	StartBlock(x, y);
 }
 
+//===========================================================================
+//
+// BlockOverlapMask
+//
+// Tests up to 32 entries of a block's hot field copies against the
+// filter square and returns a bit mask of the overlapping ones.
+// This has to give exactly the same result as FBlockThingsIterator::Overlaps.
+//
+//===========================================================================
+
+static uint32_t BlockOverlapMask(const FBlockThings &things, unsigned start, unsigned count, double fx, double fy, double fradius)
+{
+	const double *px = &things.X[start];
+	const double *py = &things.Y[start];
+	const double *pr = &things.Radius[start];
+	uint32_t mask = 0;
+	unsigned i = 0;
+
+#ifdef BLOCKTHINGS_SSE2
+	__m128d filterx = _mm_set1_pd(fx);
+	__m128d filtery = _mm_set1_pd(fy);
+	__m128d filterr = _mm_set1_pd(fradius);
+	__m128d signbit = _mm_set1_pd(-0.0);
+	for (; i + 2 <= count; i += 2)
+	{
+		__m128d blockdist = _mm_add_pd(_mm_loadu_pd(pr + i), filterr);
+		__m128d dx = _mm_andnot_pd(signbit, _mm_sub_pd(_mm_loadu_pd(px + i), filterx));
+		__m128d dy = _mm_andnot_pd(signbit, _mm_sub_pd(_mm_loadu_pd(py + i), filtery));
+		__m128d hit = _mm_and_pd(_mm_cmplt_pd(dx, blockdist), _mm_cmplt_pd(dy, blockdist));
+		mask |= uint32_t(_mm_movemask_pd(hit)) << i;
+	}
+#endif
+	for (; i < count; i++)
+	{
+		double blockdist = pr[i] + fradius;
+		if (fabs(px[i] - fx) < blockdist && fabs(py[i] - fy) < blockdist)
+		{
+			mask |= 1u << i;
+		}
+	}
+	return mask;
+}
+
 //===========================================================================
 //
 // FBlockThingsIterator :: Next
@@ -977,16 +1148,55 @@ AActor *FBlockThingsIterator::Next(bool centeronly)
 {
 	for (;;)
 	{
+		// Scan the hot field copies as long as the block has not been changed
+		// since it was started. Everything skipped here would also have been
+		// rejected by the caller, so the result is the same as walking the chain.
+		if (things != nullptr && !centeronly && things->Version == thingsVersion &&
+			thingsIndex < things->Nodes.Size() && things->Nodes[thingsIndex] == block)
+		{
+			unsigned count = things->Nodes.Size();
+			while (thingsIndex < count)
+			{
+				unsigned base = thingsIndex;
+				unsigned batch = std::min(count - base, 32u);
+				uint32_t hits = BlockOverlapMask(*things, base, batch, filterX, filterY, filterRadius);
+
+				for (unsigned i = base; i < base + batch; i++)
+				{
+					AActor *me = things->Actors[i];
+					thingsIndex = i + 1;
+
+					if (!(hits & (1u << (i - base))))
+					{
+						// The unfiltered iterator would have returned this actor here, so it must not be returned from another block.
+						if (!things->SingleBlock[i]) AddToHash(me);
+						continue;
+					}
+					block = things->Nodes[i]->NextActor;
+					if (things->SingleBlock[i] || AddToHash(me))
+					{
+						return me;
+					}
+				}
+			}
+			block = NULL;
+		}
+		things = nullptr;
+
 		while (block != NULL)
 		{
 			AActor *me = block->Me;
 			FBlockNode *mynode = block;
-			HashEntry *entry;
-			int i;
 
 			block = block->NextActor;
+			bool single = mynode->NextBlock == NULL && mynode->PrevBlock == &me->BlockNode;
+			if (filter && !centeronly && !Overlaps(me->X(), me->Y(), me->radius))
+			{
+				if (!single) AddToHash(me);
+				continue;
+			}
 			// Don't recheck things that were already checked
-			if (mynode->NextBlock == NULL && mynode->PrevBlock == &me->BlockNode)
+			if (single)
 			{ // This actor doesn't span blocks, so we know it can only ever be checked once.
 				return me;
 			}
@@ -1005,40 +1215,9 @@ AActor *FBlockThingsIterator::Next(bool centeronly)
 					return me;
 				}
 			}
-			else
-			{
-				size_t hash = ((size_t)me >> 3) % countof(Buckets);
-				for (i = Buckets[hash]; i >= 0; )
-				{
-					entry = GetHashEntry(i);
-					if (entry->Actor == me)
-					{ // I've already been checked. Skip to the next actor.
-						break;
-					}
-					i = entry->Next;
-				}
-				if (i < 0)
-				{ // Add me to the hash table and return me.
-					if (NumFixedHash < (int)countof(FixedHash))
-					{
-						entry = &FixedHash[NumFixedHash];
-						entry->Next = Buckets[hash];
-						Buckets[hash] = NumFixedHash++;
-					}
-					else
-					{
-						if (DynHash.Size() == 0)
-						{
-							DynHash.Grow(50);
-						}
-						i = DynHash.Reserve(1);
-						entry = &DynHash[i];
-						entry->Next = Buckets[hash];
-						Buckets[hash] = i + countof(FixedHash);
-					}
-					entry->Actor = me;
-					return me;
-				}
+			else if (AddToHash(me))
+			{ // Not checked yet.
+				return me;
 			}
 		}
 
@@ -1156,6 +1335,22 @@ void FMultiBlockThingsIterator::Reset()
 	blockIterator.ClearHash();
 }
 
+//===========================================================================
+//
+// Only return actors that overlap the checked area. The positions this
+// iterator returns are only identical to the actors' own for levels
+// without linked portals, so the filter is not used elsewhere.
+//
+//===========================================================================
+
+void FMultiBlockThingsIterator::SetOverlapFilter()
+{
+	if (blockIterator.Level->Displacements.size <= 1)
+	{
+		blockIterator.SetFilter(checkpoint.X, checkpoint.Y, checkpoint.Z);
+	}
+}
+
 //===========================================================================
 //
 // FPathTraverse :: Intercepts
@@ -1177,6 +1372,33 @@ TArray<intercept_t> FPathTraverse::intercepts(128);
 //
 //===========================================================================
 
+void FPathTraverse::AddLineIntercept(line_t *ld)
+{
+	int 				s1;
+	int 				s2;
+	double 				frac;
+	divline_t			dl;
+
+	s1 = P_PointOnDivlineSide (ld->v1->fX(), ld->v1->fY(), &trace);
+	s2 = P_PointOnDivlineSide (ld->v2->fX(), ld->v2->fY(), &trace);
+	
+	if (s1 == s2) return;	// line isn't crossed
+	
+	// hit the line
+	P_MakeDivline (ld, &dl);
+	frac = P_InterceptVector (&trace, &dl);
+
+	if (frac < Startfrac || frac > 1.) return;	// behind source or beyond end point
+		
+	intercept_t newintercept;
+
+	newintercept.frac = frac;
+	newintercept.isaline = true;
+	newintercept.done = false;
+	newintercept.d.line = ld;
+	intercepts.Push (newintercept);
+}
+
 void FPathTraverse::AddLineIntercepts(int bx, int by)
 {
 	FBlockLinesIterator it(Level, bx, by, bx, by, true);
@@ -1184,32 +1406,51 @@ void FPathTraverse::AddLineIntercepts(int bx, int by)
 
 	while ((ld = it.Next()))
 	{
-		int 				s1;
-		int 				s2;
-		double 				frac;
-		divline_t			dl;
+		AddLineIntercept(ld);
+	}
+}
 
-		s1 = P_PointOnDivlineSide (ld->v1->fX(), ld->v1->fY(), &trace);
-		s2 = P_PointOnDivlineSide (ld->v2->fX(), ld->v2->fY(), &trace);
-		
-		if (s1 == s2) continue;	// line isn't crossed
-		
-		// hit the line
-		P_MakeDivline (ld, &dl);
-		frac = P_InterceptVector (&trace, &dl);
+//===========================================================================
+//
+// FPathTraverse :: AddTreeLineIntercepts
+//
+// Same as above for all lines the line tree returns for the trace.
+// Each line is only returned once so no validcount check is needed.
+//
+//===========================================================================
 
-		if (frac < Startfrac || frac > 1.) continue;	// behind source or beyond end point
-			
-		intercept_t newintercept;
+void FPathTraverse::AddTreeLineIntercepts(DoomLevelAABBTree *tree)
+{
+	static TArray<line_t *> lines;
 
-		newintercept.frac = frac;
-		newintercept.isaline = true;
-		newintercept.done = false;
-		newintercept.d.line = ld;
-		intercepts.Push (newintercept);
+	DVector2 start = { trace.x + trace.dx * Startfrac, trace.y + trace.dy * Startfrac };
+	DVector2 end = { trace.x + trace.dx, trace.y + trace.dy };
+	lines.Clear();
+	tree->FindLinesOnSegment(start, end, lines);
+	for (auto ld : lines)
+	{
+		AddLineIntercept(ld);
 	}
 }
 
+//===========================================================================
+//
+// P_GetTraceTree
+//
+// Returns the line tree for traces if sv_linetreetraces is on.
+//
+//===========================================================================
+
+DoomLevelAABBTree *P_GetTraceTree(FLevelLocals *Level)
+{
+	if (!sv_linetreetraces) return nullptr;
+	if (Level->traceTree == nullptr)
+	{
+		Level->traceTree = new DoomLevelAABBTree(Level, true);
+	}
+	return Level->traceTree;
+}
+
 
 //===========================================================================
 //
@@ -1463,6 +1704,20 @@ void FPathTraverse::init(double x1, double y1, double x2, double y2, int flags,
 	intercept_index = intercepts.Size();
 	Startfrac = startfrac;
 
+	bool compatible = (flags & PT_COMPATIBLE) && (Level->i_compatflags & COMPATF_HITSCAN);
+
+	if ((flags & (PT_ADDLINES | PT_LINETREE)) == (PT_ADDLINES | PT_LINETREE) && !compatible)
+	{
+		DoomLevelAABBTree *tree = P_GetTraceTree(Level);
+		if (tree != nullptr)
+		{
+			AddTreeLineIntercepts(tree);
+			flags &= ~PT_ADDLINES;
+			// Without things to collect there is no need to walk the blockmap at all.
+			if (!(flags & PT_ADDTHINGS)) return;
+		}
+	}
+
 	if (flags & PT_DELTA)
 	{
 		x2 += x1;
@@ -1550,8 +1805,6 @@ void FPathTraverse::init(double x1, double y1, double x2, double y2, int flags,
 	// Count is present to prevent a round off error
 	// from skipping the break statement.
 
-	bool compatible = (flags & PT_COMPATIBLE) && (Level->i_compatflags & COMPATF_HITSCAN);
-		
 	// we want to use one list of checked actors for the entire operation
 	FBlockThingsIterator btit(Level);
 	for (count = 0 ; count < 1000 ; count++)
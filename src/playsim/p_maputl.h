@@ -10,6 +10,8 @@
 
 extern int validcount;
 struct FBlockNode;
+struct FBlockThings;
+class DoomLevelAABBTree;
 
 struct divline_t
 {
@@ -288,6 +290,15 @@ class FBlockThingsIterator
 
 	FBlockNode *block;
 
+	// Optional overlap filter. If set, only actors whose box overlaps the
+	// given square are returned. The hot field copies of the current block
+	// are used for this as long as the block does not change.
+	bool filter = false;
+	double filterX, filterY, filterRadius;
+	FBlockThings *things = nullptr;
+	unsigned thingsVersion;
+	unsigned thingsIndex;
+
 	int Buckets[32];
 
 	struct HashEntry
@@ -304,6 +315,12 @@ class FBlockThingsIterator
 	void StartBlock(int x, int y);
 	void SwitchBlock(int x, int y);
 	void ClearHash();
+	bool AddToHash(AActor *me);
+	bool Overlaps(double x, double y, double radius) const
+	{
+		double blockdist = radius + filterRadius;
+		return fabs(x - filterX) < blockdist && fabs(y - filterY) < blockdist;
+	}
 
 	// The following is only for use in the path traverser 
 	// and therefore declared private.
@@ -320,6 +337,7 @@ public:
 		init(box);
 	}
 	void init(const FBoundingBox &box, bool clearhash = true);
+	void SetFilter(double x, double y, double radius);
 	AActor *Next(bool centeronly = false);
 	void Reset() { StartBlock(minx, miny); }
 };
@@ -351,6 +369,7 @@ public:
 	FMultiBlockThingsIterator(FPortalGroupArray &check, FLevelLocals *Level, double checkx, double checky, double checkz, double checkh, double checkradius, bool ignorerestricted, sector_t *newsec);
 	bool Next(CheckResult *item);
 	void Reset();
+	void SetOverlapFilter();
 	const FBoundingBox &Box() const
 	{
 		return bbox;
@@ -371,7 +390,9 @@ protected:
 	unsigned int intercept_count;
 	unsigned int count;
 
+	void AddLineIntercept(line_t *ld);
 	virtual void AddLineIntercepts(int bx, int by);
+	void AddTreeLineIntercepts(DoomLevelAABBTree *tree);
 	virtual void AddThingIntercepts(int bx, int by, FBlockThingsIterator &it, bool compatible);
 	FPathTraverse(FLevelLocals *l) 
 	{
@@ -416,6 +437,9 @@ double P_InterceptVector(const divline_t *v2, const divline_t *v1);
 #define PT_ADDTHINGS	2
 #define PT_COMPATIBLE	4
 #define PT_DELTA		8		// x2,y2 is passed as a delta, not as an endpoint
+#define PT_LINETREE		16		// lines may be collected from the level's line tree instead of the blockmap
+
+DoomLevelAABBTree *P_GetTraceTree(FLevelLocals *Level);
 
 int BoxOnLineSide(const FBoundingBox& box, const line_t* ld);
 
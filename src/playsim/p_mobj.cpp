@@ -139,6 +139,8 @@ static FRandom pr_multiclasschoice ("MultiClassChoice");
 static FRandom pr_rockettrail("RocketTrail");
 static FRandom pr_uniquetid("UniqueTID");
 
+cycle_t MovementCycles;
+
 // PUBLIC DATA DEFINITIONS -------------------------------------------------
 
 FRandom pr_spawnmobj ("SpawnActor");
@@ -1176,7 +1178,7 @@ bool AActor::Grind(bool items)
 			flags &= ~MF_SOLID;
 			flags3 |= MF3_DONTGIB;
 			Height = 0;
-			radius = 0;
+			SetRadius(0);
 			return false;
 		}
 
@@ -1203,7 +1205,7 @@ bool AActor::Grind(bool items)
 			flags &= ~MF_SOLID;
 			flags3 |= MF3_DONTGIB;
 			Height = 0;
-			radius = 0;
+			SetRadius(0);
 			SetState (state);
 			if (isgeneric)	// Not a custom crush state, so colorize it appropriately.
 			{
@@ -1239,7 +1241,7 @@ bool AActor::Grind(bool items)
 				flags &= ~MF_SOLID;
 				flags3 |= MF3_DONTGIB;
 				Height = 0;
-				radius = 0;
+				SetRadius(0);
 				return false;
 			}
 
@@ -1249,7 +1251,7 @@ bool AActor::Grind(bool items)
 				gib->RenderStyle = RenderStyle;
 				gib->Alpha = Alpha;
 				gib->Height = 0;
-				gib->radius = 0;
+				gib->SetRadius(0);
 				gib->Translation = BloodTranslation;
 			}
 			S_Sound (this, CHAN_BODY, 0, "misc/fallingsplat", 1, ATTN_IDLE);
@@ -3967,7 +3969,9 @@ void AActor::Tick ()
 		Blocking3DFloor = nullptr;
 		BlockingFloor = nullptr;
 		BlockingCeiling = nullptr;
+		MovementCycles.Clock();
 		double oldfloorz = P_XYMovement (this, cumm);
+		MovementCycles.Unclock();
 		if (ObjectFlags & OF_EuthanizeMe)
 		{ // actor was destroyed
 			return;
@@ -3995,7 +3999,9 @@ void AActor::Tick ()
 			{
 				if (!(onmo = P_CheckOnmobj (this)))
 				{
+					MovementCycles.Clock();
 					P_ZMovement (this, oldfloorz);
+					MovementCycles.Unclock();
 					flags2 &= ~MF2_ONMOBJ;
 				}
 				else
@@ -4059,7 +4065,9 @@ void AActor::Tick ()
 			}
 			else
 			{
+				MovementCycles.Clock();
 				P_ZMovement (this, oldfloorz);
+				MovementCycles.Unclock();
 			}
 
 			if (ObjectFlags & OF_EuthanizeMe)
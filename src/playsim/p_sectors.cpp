@@ -1122,6 +1122,7 @@ double GetFriction(const sector_t *self, int plane, double *pMoveFac)
 			 line->sidedef[1]->SetTexture(side_t::mid, FNullTextureID());
 		 }
 	 }
+	 P_InvalidateSightCache();
  }
 
  //===========================================================================
@@ -36,6 +36,7 @@
 
 #include "g_levellocals.h"
 #include "actorinlines.h"
+#include "doom_aabbtree.h"
 
 static FRandom pr_botchecksight ("BotCheckSight");
 static FRandom pr_checksight ("CheckSight");
@@ -51,10 +52,86 @@ This uses specialized forms of the maputils routines for optimized performance
 */
 
 // Performance meters
-static int sightcounts[6];
-static cycle_t SightCycles;
+int sightcounts[6];
+int sightcachehits, sightcachemisses;
+cycle_t SightCycles;
 static cycle_t MaxSightCycles;
 
+//==========================================================================
+//
+// Sight cache
+//
+// Stores the result of the line of sight traversal for the exact inputs it
+// depends on. Many sight checks are repeated with identical parameters
+// within a tic (e.g. A_Chase's melee and missile range checks) so this saves
+// a lot of blockmap traversals. The cache is emptied at the start of every
+// tic and whenever map geometry that can block sight changes.
+//
+//==========================================================================
+
+enum
+{
+	SIGHTCACHE_SIZE = 1024,	// must be a power of 2
+	SIGHTCACHE_FLAGS = SF_SEEPASTSHOOTABLELINES | SF_SEEPASTBLOCKEVERYTHING | SF_IGNOREWATERBOUNDARY
+};
+
+struct SightCacheKey
+{
+	FLevelLocals *Level;
+	sector_t *Sector1;
+	sector_t *Sector2;
+	double Pos1[3];
+	double Pos2[3];
+	double Height1;
+	double Height2;
+	int Flags;
+};
+
+struct SightCacheEntry
+{
+	SightCacheKey Key;
+	unsigned Generation;
+	bool Result;
+};
+
+static SightCacheEntry SightCache[SIGHTCACHE_SIZE];
+static unsigned SightCacheGeneration = 1;
+
+void P_InvalidateSightCache()
+{
+	SightCacheGeneration++;
+}
+
+static void MakeSightCacheKey(SightCacheKey &key, AActor *t1, AActor *t2, int flags)
+{
+	// The key is compared bytewise so the padding must be cleared.
+	memset(&key, 0, sizeof(key));
+	key.Level = t1->Level;
+	key.Sector1 = t1->Sector;
+	key.Sector2 = t2->Sector;
+	key.Pos1[0] = t1->X();
+	key.Pos1[1] = t1->Y();
+	key.Pos1[2] = t1->Z();
+	key.Pos2[0] = t2->X();
+	key.Pos2[1] = t2->Y();
+	key.Pos2[2] = t2->Z();
+	key.Height1 = t1->Height;
+	key.Height2 = t2->Height;
+	key.Flags = flags & SIGHTCACHE_FLAGS;
+}
+
+static SightCacheEntry *FindSightCacheEntry(const SightCacheKey &key)
+{
+	// FNV-1a over the key bytes.
+	const uint8_t *data = (const uint8_t *)&key;
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < sizeof(key); i++)
+	{
+		hash = (hash ^ data[i]) * 16777619u;
+	}
+	return &SightCache[hash & (SIGHTCACHE_SIZE - 1)];
+}
+
 enum
 {
 	SO_TOPFRONT = 1,
@@ -113,6 +190,7 @@ class SightCheck
 	bool PTR_SightTraverse (intercept_t *in);
 	bool P_SightCheckLine (line_t *ld);
 	int P_SightBlockLinesIterator (int x, int y);
+	bool P_SightTreeLinesIterator (DoomLevelAABBTree *tree, double x1, double y1, double x2, double y2);
 	bool P_SightTraverseIntercepts ();
 	bool LineBlocksSight(line_t *ld);
 
@@ -523,6 +601,30 @@ int SightCheck::P_SightBlockLinesIterator (int x, int y)
 	return res;			// everything was checked
 }
 
+/*
+==================
+=
+= P_SightTreeLinesIterator
+=
+= Collects the lines from the line tree instead of the blockmap.
+= Only usable if the map contains no linked portals.
+=
+===================
+*/
+
+bool SightCheck::P_SightTreeLinesIterator (DoomLevelAABBTree *tree, double x1, double y1, double x2, double y2)
+{
+	static TArray<line_t *> lines;
+
+	lines.Clear();
+	tree->FindLinesOnSegment({ x1, y1 }, { x2, y2 }, lines);
+	for (auto ld : lines)
+	{
+		if (!P_SightCheckLine (ld)) return false;
+	}
+	return true;
+}
+
 /*
 ====================
 =
@@ -667,6 +769,23 @@ bool SightCheck::P_SightPathTraverse ()
 		portals.Push({ 0, topslope, bottomslope, sector_t::floor, lastsector->GetOppositePortalGroup(sector_t::floor) });
 	}
 
+	// Without linked portals no block can set portalfound, so the blockmap walk below
+	// only collects the crossed lines and can be replaced by a query of the line tree.
+	auto &pblockmap = Level->PortalBlockmap;
+	DoomLevelAABBTree *linetree = (pblockmap.containsLines || pblockmap.hasLinkedSectorPortals || pblockmap.hasLinkedPolyPortals) ? nullptr : P_GetTraceTree(Level);
+	if (linetree != nullptr)
+	{
+		if (!P_SightTreeLinesIterator(linetree, x1, y1, x2, y2))
+		{
+			sightcounts[1]++;
+			return false;	// early out
+		}
+		sightcounts[2]++;
+		bool traverseres = P_SightTraverseIntercepts ( );
+		if (seeingthing->Sector->PortalGroup != portalgroup) return false;
+		return traverseres;
+	}
+
 	x1 -= Level->blockmap.bmaporgx;
 	y1 -= Level->blockmap.bmaporgy;
 	xt1 = x1 / FBlockmap::MAPBLOCKUNITS;
@@ -899,6 +1018,18 @@ sightcounts[0]++;
 	// An unobstructed LOS is possible.
 	// Now look from eyes of t1 to any part of t2.
 
+	SightCacheKey key;
+	SightCacheEntry *entry;
+	MakeSightCacheKey(key, t1, t2, flags);
+	entry = FindSightCacheEntry(key);
+	if (entry->Generation == SightCacheGeneration && !memcmp(&entry->Key, &key, sizeof(key)))
+	{
+		sightcachehits++;
+		res = entry->Result;
+		goto done;
+	}
+	sightcachemisses++;
+
 	validcount++;
 	portals.Clear();
 	{
@@ -929,6 +1060,9 @@ sightcounts[0]++;
 			}
 		}
 	}
+	entry->Key = key;
+	entry->Generation = SightCacheGeneration;
+	entry->Result = res;
 
 done:
 	SightCycles.Unclock();
@@ -938,9 +1072,10 @@ done:
 ADD_STAT (sight)
 {
 	FString out;
-	out.Format ("%04.1f ms (%04.1f max), %5d %2d%4d%4d%4d%4d\n",
+	out.Format ("%04.1f ms (%04.1f max), %5d %2d%4d%4d%4d%4d, cache %d/%d\n",
 		SightCycles.TimeMS(), MaxSightCycles.TimeMS(),
-		sightcounts[3], sightcounts[0], sightcounts[1], sightcounts[2], sightcounts[4], sightcounts[5]);
+		sightcounts[3], sightcounts[0], sightcounts[1], sightcounts[2], sightcounts[4], sightcounts[5],
+		sightcachehits, sightcachehits + sightcachemisses);
 	return out;
 }
 
@@ -956,4 +1091,6 @@ void P_ResetSightCounters (bool full)
 	}
 	SightCycles.Reset();
 	memset (sightcounts, 0, sizeof(sightcounts));
+	sightcachehits = sightcachemisses = 0;
+	P_InvalidateSightCache();
 }
@@ -685,7 +685,7 @@ bool player_t::Resurrect()
 	viewheight = DefaultViewHeight();
 	mo->renderflags &= ~RF_INVISIBLE;
 	mo->Height = mo->GetDefault()->Height;
-	mo->radius = mo->GetDefault()->radius;
+	mo->SetRadius(mo->GetDefault()->radius);
 	mo->special1 = 0;	// required for the Hexen fighter's fist attack. 
 								// This gets set by AActor::Die as flag for the wimpy death and must be reset here.
 	mo->SetState(mo->SpawnState);
@@ -1455,6 +1455,7 @@ void P_PredictPlayer (player_t *player)
 			block->NextActor->PrevActor = block->PrevActor;
 		}
 		*(block->PrevActor) = block->NextActor;
+		act->Level->blockmap.InvalidateThings(block->BlockIndex);
 		block = block->NextBlock;
 	}
 	act->BlockNode = NULL;
@@ -1598,6 +1599,7 @@ void P_UnPredictPlayer ()
 			{
 				block->NextActor->PrevActor = &block->NextActor;
 			}
+			act->Level->blockmap.InvalidateThings(block->BlockIndex);
 			block = block->NextBlock;
 		}
 
@@ -27,9 +27,10 @@
 
 using namespace hwrenderer;
 
-DoomLevelAABBTree::DoomLevelAABBTree(FLevelLocals *lev)
+DoomLevelAABBTree::DoomLevelAABBTree(FLevelLocals *lev, bool alllines)
 {
 	Level = lev;
+	AllLines = alllines;
 	// Calculate the center of all lines
 	TArray<FVector2> centroids;
 	for (unsigned int i = 0; i < Level->lines.Size(); i++)
@@ -85,7 +86,7 @@ bool DoomLevelAABBTree::GenerateTree(const FVector2 *centroids, bool dynamicsubt
 	auto &maplines = Level->lines;
 	for (unsigned int i = 0; i < maplines.Size(); i++)
 	{
-		if (!maplines[i].backsector)
+		if (AllLines || !maplines[i].backsector)
 		{
 			bool isPolyLine = maplines[i].sidedef[0] && (maplines[i].sidedef[0]->Flags & WALLF_POLYOBJ);
 			if (isPolyLine && dynamicsubtree)
@@ -161,6 +162,54 @@ bool DoomLevelAABBTree::Update()
 	return modified;
 }
 
+void DoomLevelAABBTree::FindLinesOnSegment(const DVector2 &start, const DVector2 &end, TArray<line_t *> &result)
+{
+	if (nodes.Size() == 0)
+		return;
+
+	if (Dirty)
+	{
+		Update();
+		Dirty = false;
+	}
+
+	// The node boxes are stored as floats so they get enlarged a bit to make up for the rounding.
+	const double margin = 1.0;
+	DVector2 center = (start + end) * 0.5;
+	DVector2 halfdelta = end - center;
+	DVector2 absdelta = { fabs(halfdelta.X), fabs(halfdelta.Y) };
+
+	// The tree is not necessarily balanced so this needs a stack that can grow.
+	static TArray<int> stack;
+	stack.Clear();
+	stack.Push(nodes.Size() - 1); // root node is the last node in the list
+	while (stack.Size() > 0)
+	{
+		int node_index;
+		stack.Pop(node_index);
+		const AABBTreeNode &node = nodes[node_index];
+
+		// 2D separating axis test between the segment and the node's box.
+		DVector2 extents = { ((double)node.aabb_right - node.aabb_left) * 0.5 + margin, ((double)node.aabb_bottom - node.aabb_top) * 0.5 + margin };
+		DVector2 c = { center.X - (node.aabb_right + (double)node.aabb_left) * 0.5, center.Y - (node.aabb_bottom + (double)node.aabb_top) * 0.5 };
+
+		if (fabs(c.X) > absdelta.X + extents.X || fabs(c.Y) > absdelta.Y + extents.Y)
+			continue;
+		if (fabs(c.X * halfdelta.Y - c.Y * halfdelta.X) > extents.X * absdelta.Y + extents.Y * absdelta.X)
+			continue;
+
+		if (node.line_index != -1)
+		{
+			result.Push(&Level->lines[mapLines[node.line_index]]);
+		}
+		else
+		{
+			// Push the right child first so that the left one gets examined first.
+			if (node.right_node != -1) stack.Push(node.right_node);
+			if (node.left_node != -1) stack.Push(node.left_node);
+		}
+	}
+}
 
 int DoomLevelAABBTree::GenerateTreeNode(int *lines, int num_lines, const FVector2 *centroids, int *work_buffer)
 {
@@ -2,15 +2,24 @@
 #include "hw_aabbtree.h"
 
 struct FLevelLocals;
+struct line_t;
 
 // Axis aligned bounding box tree used for ray testing treelines.
 class DoomLevelAABBTree : public hwrenderer::LevelAABBTree
 {
 public:
-	// Constructs a tree for the current level
-	DoomLevelAABBTree(FLevelLocals *lev);
+	// Constructs a tree for the current level. The renderer only needs the one-sided lines,
+	// the playsim's traces need all of them.
+	DoomLevelAABBTree(FLevelLocals *lev, bool alllines = false);
 	bool Update() override;
 
+	// Collects all lines whose bounding box may be touched by the segment. The box test
+	// is conservative so the result is a superset of the lines actually crossed.
+	void FindLinesOnSegment(const DVector2 &start, const DVector2 &end, TArray<line_t *> &result);
+
+	// Polyobjects have moved so the dynamic subtree needs to be updated before the next query.
+	void SetDirty() { Dirty = true; }
+
 private:
 	bool GenerateTree(const FVector2 *centroids, bool dynamicsubtree);
 
@@ -19,5 +28,7 @@ private:
 
 	TArray<int> mapLines;
 	FLevelLocals *Level;
+	bool AllLines;
+	bool Dirty = false;
 };
 
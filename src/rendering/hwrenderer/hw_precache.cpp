@@ -40,8 +40,20 @@
 #include "modelrenderer.h"
 #include "hw_models.h"
 #include "d_main.h"
+#include "printf.h"
+#include "jobsystem.h"
 
 EXTERN_CVAR(Bool, gl_precache)
+CVAR(Bool, gl_precache_threads, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+struct FPrecacheMaterial
+{
+	FMaterial *mat;
+	int translation;
+};
+
+// Upper limit for the decoded image data that is waiting for its upload.
+static const size_t PrecacheBatchBytes = 256 << 20;
 
 //==========================================================================
 //
@@ -49,7 +61,7 @@ EXTERN_CVAR(Bool, gl_precache)
 //
 //==========================================================================
 
-static void PrecacheTexture(FGameTexture *tex, int cache)
+static void PrecacheTexture(FGameTexture *tex, int cache, TArray<FPrecacheMaterial> &list)
 {
 	if (cache & (FTextureManager::HIT_Wall | FTextureManager::HIT_Flat | FTextureManager::HIT_Sky))
 	{
@@ -57,7 +69,7 @@ static void PrecacheTexture(FGameTexture *tex, int cache)
 		if (shouldUpscale(tex, UF_Texture)) scaleflags |= CTF_Upscale;
 
 		FMaterial * gltex = FMaterial::ValidateTexture(tex, scaleflags);
-		if (gltex) screen->PrecacheMaterial(gltex, 0);
+		if (gltex) list.Push({ gltex, 0 });
 	}
 }
 
@@ -66,11 +78,11 @@ static void PrecacheTexture(FGameTexture *tex, int cache)
 //
 //
 //===========================================================================
-static void PrecacheList(FMaterial *gltex, SpriteHits& translations)
+static void PrecacheList(FMaterial *gltex, SpriteHits& translations, TArray<FPrecacheMaterial> &list)
 {
 	SpriteHits::Iterator it(translations);
 	SpriteHits::Pair* pair;
-	while (it.NextPair(pair)) screen->PrecacheMaterial(gltex, pair->Key);
+	while (it.NextPair(pair)) list.Push({ gltex, pair->Key });
 }
 
 //==========================================================================
@@ -79,13 +91,104 @@ static void PrecacheList(FMaterial *gltex, SpriteHits& translations)
 //
 //==========================================================================
 
-static void PrecacheSprite(FGameTexture *tex, SpriteHits &hits)
+static void PrecacheSprite(FGameTexture *tex, SpriteHits &hits, TArray<FPrecacheMaterial> &list)
 {
 	int scaleflags = CTF_Expand;
 	if (shouldUpscale(tex, UF_Sprite)) scaleflags |= CTF_Upscale;
 
 	FMaterial * gltex = FMaterial::ValidateTexture(tex, scaleflags);
-	if (gltex) PrecacheList(gltex, hits);
+	if (gltex) PrecacheList(gltex, hits, list);
+}
+
+//==========================================================================
+//
+// PrecacheMaterials
+//
+// Reading, decoding and upscaling the images is done on the job system.
+// The results are staged in the textures so that the backend finds them
+// when it creates the hardware textures on this thread. This is done in
+// batches to put a limit on the memory used by the staged images.
+//
+//==========================================================================
+
+static void PrecacheMaterials(TArray<FPrecacheMaterial> &list)
+{
+	struct FStageJob
+	{
+		FTexture *tex;
+		TArray<std::pair<int, int>> variants;
+		FString output;
+	};
+
+	unsigned start = 0;
+	while (start < list.Size())
+	{
+		TArray<FStageJob> jobs;
+		TMap<FTexture *, unsigned> jobindex;
+		size_t batchbytes = 0;
+		unsigned end = start;
+
+		for (; end < list.Size() && batchbytes < PrecacheBatchBytes; end++)
+		{
+			auto &layers = list[end].mat->GetLayerArray();
+			for (unsigned i = 0; i < layers.Size(); i++)
+			{
+				// Only the base layer gets translated, see PrecacheMaterial in the backends.
+				FTexture *tex = layers[i].layerTexture;
+				int translation = i == 0 ? list[end].translation : 0;
+				int flags = layers[i].scaleFlags;
+
+				// Skip everything that already got uploaded for an earlier level.
+				if (tex == nullptr || tex->GetImage() == nullptr || tex->isHardwareCanvas() ||
+					tex->SystemTextures.GetHardwareTexture(translation, flags) != nullptr)
+				{
+					continue;
+				}
+
+				// All variants of a texture go into the same job because creating them modifies the texture.
+				unsigned *index = jobindex.CheckKey(tex);
+				if (index == nullptr)
+				{
+					index = &jobindex.Insert(tex, jobs.Reserve(1));
+					jobs[*index].tex = tex;
+				}
+				jobs[*index].variants.Push(std::make_pair(translation, flags | CTF_ProcessData));
+				int scale = (flags & CTF_Upscale) ? 4 : 1;
+				batchbytes += size_t(tex->GetWidth() * scale) * (tex->GetHeight() * scale) * 4;
+			}
+		}
+
+		JobParallelFor(0u, jobs.Size(), 1u, [&](unsigned i)
+		{
+			auto &job = jobs[i];
+			C_SetPrintCapture(&job.output);
+			try
+			{
+				for (auto &variant : job.variants)
+				{
+					job.tex->StageTexBuffer(variant.first, variant.second);
+				}
+			}
+			catch (...)
+			{
+				// Leave it to the upload which repeats the work and reports the error on the main thread.
+			}
+			C_SetPrintCapture(nullptr);
+		});
+
+		for (unsigned i = start; i < end; i++)
+		{
+			screen->PrecacheMaterial(list[i].mat, list[i].translation);
+		}
+
+		// Anything left was not needed by the backend.
+		for (auto &job : jobs)
+		{
+			if (job.output.IsNotEmpty()) PrintString(PRINT_HIGH, job.output);
+			job.tex->ClearStagedBuffers();
+		}
+		start = end;
+	}
 }
 
 
@@ -300,19 +403,29 @@ void hw_PrecacheTexture(uint8_t *texhitlist, TMap<PClassActor*, bool> &actorhitl
 		}
 
 		// cache all used textures
+		TArray<FPrecacheMaterial> materials;
 		for (int i = cnt - 1; i >= 0; i--)
 		{
 			auto gtex = TexMan.GameByIndex(i);
 			if (gtex != nullptr)
 			{
-				PrecacheTexture(gtex, texhitlist[i]);
+				PrecacheTexture(gtex, texhitlist[i], materials);
 				if (spritehitlist[i] != nullptr && (*spritehitlist[i]).CountUsed() > 0)
 				{
-					PrecacheSprite(gtex, *spritehitlist[i]);
+					PrecacheSprite(gtex, *spritehitlist[i], materials);
 				}
 			}
 		}
 
+		if (gl_precache_threads)
+		{
+			PrecacheMaterials(materials);
+		}
+		else
+		{
+			for (auto &entry : materials) screen->PrecacheMaterial(entry.mat, entry.translation);
+		}
+
 
 		FImageSource::EndPrecaching();
 
@@ -326,7 +439,7 @@ void hw_PrecacheTexture(uint8_t *texhitlist, TMap<PClassActor*, bool> &actorhitl
 		delete renderer;
 
 		precache.Unclock();
-		DPrintf(DMSG_NOTIFY, "Textures precached in %.3f ms\n", precache.TimeMS());
+		DPrintf(DMSG_NOTIFY, "%u textures precached in %.3f ms\n", materials.Size(), precache.TimeMS());
 	}
 
 	delete[] spritehitlist;
@@ -32,7 +32,7 @@
 #include "p_effect.h"
 #include "po_man.h"
 #include "m_fixed.h"
-#include "ctpl.h"
+#include "jobsystem.h"
 #include "texturemanager.h"
 #include "hwrenderer/scene/hw_fakeflat.h"
 #include "hwrenderer/scene/hw_clipper.h"
@@ -42,6 +42,7 @@
 #include "hw_clock.h"
 #include "flatvertices.h"
 #include "hw_vertexbuilder.h"
+#include <thread>
 
 #ifdef ARCH_IA32
 #include <immintrin.h>
@@ -49,10 +50,24 @@
 
 CVAR(Bool, gl_multithread, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 
+enum
+{
+	MAXBSPWORKERS = 16,	// including the sprite worker
+	BSPCHUNKSIZE = 64,	// number of consecutive jobs a worker claims at once.
+	BSPSPINCOUNT = 200,	// number of times a worker polls an empty queue before it starts yielding.
+};
+
+// Number of threads that process walls and flats while the main thread traverses the BSP. 0 means one per free hardware thread.
+CUSTOM_CVAR(Int, gl_bspthreads, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	if (self < 0) self = 0;
+	else if (self >= MAXBSPWORKERS) self = MAXBSPWORKERS - 1;
+}
+
 EXTERN_CVAR(Float, r_actorspriteshadowdist)
 
 thread_local bool isWorkerThread;
-ctpl::thread_pool renderPool(1);
+thread_local HWBspOutput *bspOutput;
 bool inited = false;
 
 struct RenderJob
@@ -64,7 +79,6 @@ struct RenderJob
 		SpriteJob,
 		ParticleJob,
 		PortalJob,
-		TerminateJob	// inserted when all work is done so that the worker can return.
 	};
 	
 	int type;
@@ -72,12 +86,45 @@ struct RenderJob
 	seg_t *seg;
 };
 
+// Size of each list of a worker's output, to find the part that belongs to a job chunk.
+struct BspOutputMark
+{
+	unsigned items[GLDL_TYPES];
+	unsigned decals[2];
+	unsigned deferred;
+
+	void Set(HWBspOutput &output)
+	{
+		for (int i = 0; i < GLDL_TYPES; i++) items[i] = output.drawlists[i].drawitems.Size();
+		for (int i = 0; i < 2; i++) decals[i] = output.Decals[i].Size();
+		deferred = output.Deferred.Size();
+	}
+};
+
+struct BspWorker
+{
+	HWBspOutput output;
+	BspOutputMark merged;
+	glcycle_t SetupWall, SetupFlat, Total;
+};
+
+static BspWorker bspWorkers[MAXBSPWORKERS];
 
 class RenderJobQueue
 {
-	RenderJob pool[300000];	// Way more than ever needed. The largest ever seen on a single viewpoint is around 40000.
-	std::atomic<int> readindex{};
+	enum { POOLSIZE = 300000 };	// Way more than ever needed. The largest ever seen on a single viewpoint is around 40000.
+
+	struct Chunk
+	{
+		int worker;
+		BspOutputMark end;
+	};
+
+	RenderJob pool[POOLSIZE];
+	Chunk chunks[(POOLSIZE + BSPCHUNKSIZE - 1) / BSPCHUNKSIZE];
 	std::atomic<int> writeindex{};
+	std::atomic<int> nextchunk{};
+	std::atomic<bool> finished{};
 public:
 	void AddJob(int type, subsector_t *sub, seg_t *seg = nullptr)
 	{
@@ -87,128 +134,297 @@ public:
 		writeindex++;	// update index only after the value has been written.
 	}
 
-	RenderJob *GetJob()
+	// Waits until the job has been added. Returns null if the traversal ended before that.
+	RenderJob *GetJob(int index)
+	{
+		int spins = 0;
+		while (index >= writeindex)
+		{
+			if (finished && index >= writeindex) return nullptr;
+			if (spins == BSPSPINCOUNT)
+			{
+				// The traversal has stalled for a while. With many workers spinning it may be the one
+				// that cannot get a core, so give up the time slice instead of burning it.
+				std::this_thread::yield();
+				continue;
+			}
+			spins++;
+#ifdef ARCH_IA32
+			// The queue is empty. But yielding right away would be too costly and possibly cause further delays down the line if the thread is halted.
+			// So instead add a few pause instructions and retry immediately.
+			_mm_pause();
+			_mm_pause();
+			_mm_pause();
+			_mm_pause();
+			_mm_pause();
+			_mm_pause();
+			_mm_pause();
+			_mm_pause();
+			_mm_pause();
+			_mm_pause();
+#endif // ARCH_IA32
+		}
+		return &pool[index];
+	}
+
+	int ClaimChunk()
+	{
+		return nextchunk++;
+	}
+
+	void EndChunk(int chunk, int worker, HWBspOutput &output)
 	{
-		if (readindex < writeindex) return &pool[readindex++];
-		return nullptr;
+		chunks[chunk].worker = worker;
+		chunks[chunk].end.Set(output);
+	}
+
+	const Chunk &GetChunk(int chunk) const
+	{
+		return chunks[chunk];
+	}
+
+	int NumChunks() const
+	{
+		return (writeindex + BSPCHUNKSIZE - 1) / BSPCHUNKSIZE;
+	}
+
+	void Finish()
+	{
+		finished = true;	// only set after the last job has been added.
 	}
 	
 	void ReleaseAll()
 	{
-		readindex = 0;
 		writeindex = 0;
+		nextchunk = 0;
+		finished = false;
 	}
 };
 
 static RenderJobQueue jobQueue;	// One static queue is sufficient here. This code will never be called recursively.
 
-void HWDrawInfo::WorkerThread()
+//==========================================================================
+//
+// Worker 0 handles all sprites and particles, in order, because things
+// can be linked into several sectors and only may be processed once.
+// The other workers claim chunks of consecutive jobs and process the
+// walls and flats in them.
+//
+//==========================================================================
+
+void HWDrawInfo::WorkerThread(int index)
 {
 	sector_t *front, *back;
+	auto &worker = bspWorkers[index];
+
+	// A thread waiting for other jobs inside a worker may run another worker's job.
+	bool wasWorkerThread = isWorkerThread;
+	auto prevOutput = bspOutput;
 
-	WTTotal.Clock();
+	worker.Total.Clock();
 	isWorkerThread = true;	// for adding asserts in GL API code. The worker thread may never call any GL API.
-	while (true)
+	bspOutput = &worker.output;
+
+	if (index == 0)
 	{
-		auto job = jobQueue.GetJob();
-		if (job == nullptr)
+		RenderJob *job;
+		for (int i = 0; (job = jobQueue.GetJob(i)) != nullptr; i++)
 		{
-#ifdef ARCH_IA32
-			// The queue is empty. But yielding would be too costly here and possibly cause further delays down the line if the thread is halted.
-			// So instead add a few pause instructions and retry immediately.
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-#endif // ARCH_IA32
+			// Note that the main thread MUST have prepared the fake sectors that get used below!
+			// This worker thread cannot prepare them itself without costly synchronization.
+			switch (job->type)
+			{
+			case RenderJob::SpriteJob:
+				SetupSprite.Clock();
+				front = hw_FakeFlat(job->sub->sector, in_area, false);
+				RenderThings(job->sub, front);
+				SetupSprite.Unclock();
+				break;
+
+			case RenderJob::ParticleJob:
+				SetupSprite.Clock();
+				front = hw_FakeFlat(job->sub->sector, in_area, false);
+				RenderParticles(job->sub, front);
+				SetupSprite.Unclock();
+				break;
+			}
 		}
-		// Note that the main thread MUST have prepared the fake sectors that get used below!
-		// This worker thread cannot prepare them itself without costly synchronization.
-		else switch (job->type)
-		{
-		case RenderJob::TerminateJob:
-			WTTotal.Unclock();
-			return;
+	}
+	else while (true)
+	{
+		int chunk = jobQueue.ClaimChunk();
+		int first = chunk * BSPCHUNKSIZE;
+		if (jobQueue.GetJob(first) == nullptr) break;
 
-		case RenderJob::WallJob:
+		for (int i = first; i < first + BSPCHUNKSIZE; i++)
 		{
-			HWWall wall;
-			SetupWall.Clock();
-			wall.sub = job->sub;
-
-			front = hw_FakeFlat(job->sub->sector, in_area, false);
-			auto seg = job->seg;
-			auto backsector = seg->backsector;
-			if (!backsector && seg->linedef->isVisualPortal() && seg->sidedef == seg->linedef->sidedef[0]) // For one-sided portals use the portal's destination sector as backsector.
+			auto job = jobQueue.GetJob(i);
+			if (job == nullptr) break;
+
+			switch (job->type)
 			{
-				auto portal = seg->linedef->getPortal();
-				backsector = portal->mDestination->frontsector;
-				back = hw_FakeFlat(backsector, in_area, true);
-				if (front->floorplane.isSlope() || front->ceilingplane.isSlope() || back->floorplane.isSlope() || back->ceilingplane.isSlope())
-				{
-					// Having a one-sided portal like this with slopes is too messy so let's ignore that case.
-					back = nullptr;
-				}
-			}
-			else if (backsector)
+			case RenderJob::WallJob:
 			{
-				if (front->sectornum == backsector->sectornum || (seg->sidedef->Flags & WALLF_POLYOBJ))
+				HWWall wall;
+				worker.SetupWall.Clock();
+				wall.sub = job->sub;
+
+				front = hw_FakeFlat(job->sub->sector, in_area, false);
+				auto seg = job->seg;
+				auto backsector = seg->backsector;
+				if (!backsector && seg->linedef->isVisualPortal() && seg->sidedef == seg->linedef->sidedef[0]) // For one-sided portals use the portal's destination sector as backsector.
 				{
-					back = front;
+					auto portal = seg->linedef->getPortal();
+					backsector = portal->mDestination->frontsector;
+					back = hw_FakeFlat(backsector, in_area, true);
+					if (front->floorplane.isSlope() || front->ceilingplane.isSlope() || back->floorplane.isSlope() || back->ceilingplane.isSlope())
+					{
+						// Having a one-sided portal like this with slopes is too messy so let's ignore that case.
+						back = nullptr;
+					}
 				}
-				else
+				else if (backsector)
 				{
-					back = hw_FakeFlat(backsector, in_area, true);
+					if (front->sectornum == backsector->sectornum || (seg->sidedef->Flags & WALLF_POLYOBJ))
+					{
+						back = front;
+					}
+					else
+					{
+						back = hw_FakeFlat(backsector, in_area, true);
+					}
 				}
+				else back = nullptr;
+
+				wall.Process(this, job->seg, front, back);
+				rendered_lines++;
+				worker.SetupWall.Unclock();
+				break;
 			}
-			else back = nullptr;
 
-			wall.Process(this, job->seg, front, back);
-			rendered_lines++;
-			SetupWall.Unclock();
-			break;
+			case RenderJob::FlatJob:
+			{
+				HWFlat flat;
+				worker.SetupFlat.Clock();
+				flat.section = job->sub->section;
+				front = hw_FakeFlat(job->sub->render_sector, in_area, false);
+				flat.ProcessSector(this, front);
+				worker.SetupFlat.Unclock();
+				break;
+			}
+
+			case RenderJob::PortalJob:
+				AddSubsectorToPortal((FSectorPortalGroup *)job->seg, job->sub);
+				break;
+			}
 		}
+		jobQueue.EndChunk(chunk, index, worker.output);
+	}
 
-		case RenderJob::FlatJob:
+	bspOutput = prevOutput;
+	isWorkerThread = wasWorkerThread;	// the job system's threads also run other jobs.
+	worker.Total.Unclock();
+}
+
+//==========================================================================
+//
+// Appends everything a worker produced since the last merge and replays
+// its deferred calls.
+//
+//==========================================================================
+
+void HWDrawInfo::MergeWorkerOutput(int index, const BspOutputMark &end)
+{
+	auto &worker = bspWorkers[index];
+	auto &output = worker.output;
+	auto &start = worker.merged;
+
+	for (int i = 0; i < GLDL_TYPES; i++)
+	{
+		drawlists[i].AppendItems(output.drawlists[i], start.items[i], end.items[i]);
+	}
+	for (int i = 0; i < 2; i++)
+	{
+		for (unsigned j = start.decals[i]; j < end.decals[i]; j++) Decals[i].Push(output.Decals[i][j]);
+	}
+	for (unsigned j = start.deferred; j < end.deferred; j++)
+	{
+		auto &call = output.Deferred[j];
+		switch (call.type)
 		{
-			HWFlat flat;
-			SetupFlat.Clock();
-			flat.section = job->sub->section;
-			front = hw_FakeFlat(job->sub->render_sector, in_area, false);
-			flat.ProcessSector(this, front);
-			SetupFlat.Unclock();
+		case HWBspOutput::DEFER_Portal:
+			static_cast<HWWall *>(call.object)->PutPortal(this, call.ptype, call.plane);
 			break;
-		}
 
-		case RenderJob::SpriteJob:
-			SetupSprite.Clock();
-			front = hw_FakeFlat(job->sub->sector, in_area, false);
-			RenderThings(job->sub, front);
-			SetupSprite.Unclock();
+		case HWBspOutput::DEFER_UpperMissingTexture:
+			AddUpperMissingTexture(static_cast<side_t *>(call.object), call.sub, call.height);
 			break;
 
-		case RenderJob::ParticleJob:
-			SetupSprite.Clock();
-			front = hw_FakeFlat(job->sub->sector, in_area, false);
-			RenderParticles(job->sub, front);
-			SetupSprite.Unclock();
+		case HWBspOutput::DEFER_LowerMissingTexture:
+			AddLowerMissingTexture(static_cast<side_t *>(call.object), call.sub, call.height);
 			break;
 
-		case RenderJob::PortalJob:
-			AddSubsectorToPortal((FSectorPortalGroup *)job->seg, job->sub);
+		case HWBspOutput::DEFER_SubsectorPortal:
+			AddSubsectorToPortal(static_cast<FSectorPortalGroup *>(call.object), call.sub);
 			break;
 		}
-
 	}
+	start = end;
 }
 
+//==========================================================================
+//
+// Runs the BSP traversal with the given number of workers and merges
+// their output in job order.
+//
+//==========================================================================
+
+void HWDrawInfo::RenderBSPMultithreaded(void *node, int numworkers)
+{
+	for (int i = 0; i < numworkers; i++)
+	{
+		auto &worker = bspWorkers[i];
+		worker.output.Clear();
+		worker.merged.Set(worker.output);
+		worker.SetupWall.Reset();
+		worker.SetupFlat.Reset();
+		worker.Total.Reset();
+	}
+
+	// If no thread picks up a worker job while the BSP is traversed, the wait below will run it.
+	FJobCounter counter;
+	jobQueue.ReleaseAll();
+	for (int i = 0; i < numworkers; i++)
+	{
+		FJobSystem::Instance()->Run([=]() {
+			WorkerThread(i);
+		}, &counter);
+	}
+	RenderBSPNode(node);
+
+	jobQueue.Finish();
+	Bsp.Unclock();
+	MTWait.Clock();
+	FJobSystem::Instance()->Wait(counter);
+	MTWait.Unclock();
 
+	int numchunks = jobQueue.NumChunks();
+	for (int i = 0; i < numchunks; i++)
+	{
+		auto &chunk = jobQueue.GetChunk(i);
+		MergeWorkerOutput(chunk.worker, chunk.end);
+	}
+	BspOutputMark end;
+	end.Set(bspWorkers[0].output);
+	MergeWorkerOutput(0, end);
+
+	for (int i = 0; i < numworkers; i++)
+	{
+		SetupWall += bspWorkers[i].SetupWall;
+		SetupFlat += bspWorkers[i].SetupFlat;
+		WTTotal += bspWorkers[i].Total;
+	}
+}
 
 
 
@@ -849,17 +1065,10 @@ void HWDrawInfo::RenderBSP(void *node, bool drawpsprites)
 	multithread = gl_multithread;
 	if (multithread)
 	{
-		jobQueue.ReleaseAll();
-		auto future = renderPool.push([&](int id) {
-			WorkerThread();
-		});
-		RenderBSPNode(node);
-
-		jobQueue.AddJob(RenderJob::TerminateJob, nullptr, nullptr);
-		Bsp.Unclock();
-		MTWait.Clock();
-		future.wait();
-		MTWait.Unclock();
+		// The main thread is busy with the traversal and one worker takes care of the sprites.
+		int numworkers = gl_bspthreads > 0 ? gl_bspthreads : FJobSystem::Instance()->NumThreads() - 2;
+		numworkers = clamp(numworkers, 1, MAXBSPWORKERS - 1) + 1;
+		RenderBSPMultithreaded(node, numworkers);
 	}
 	else
 	{
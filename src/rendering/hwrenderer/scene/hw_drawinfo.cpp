@@ -412,8 +412,9 @@ HWPortal * HWDrawInfo::FindPortal(const void * src)
 
 HWDecal *HWDrawInfo::AddDecal(bool onmirror)
 {
-	auto decal = (HWDecal*)RenderDataAllocator.Alloc(sizeof(HWDecal));
-	Decals[onmirror ? 1 : 0].Push(decal);
+	auto decal = (HWDecal*)AllocRenderData(sizeof(HWDecal));
+	auto decals = bspOutput != nullptr ? bspOutput->Decals : Decals;
+	decals[onmirror ? 1 : 0].Push(decal);
 	return decal;
 }
 
@@ -732,6 +733,11 @@ void HWDrawInfo::ProcessScene(bool toscreen)
 
 void HWDrawInfo::AddSubsectorToPortal(FSectorPortalGroup *ptg, subsector_t *sub)
 {
+	if (bspOutput != nullptr)
+	{
+		bspOutput->Defer(HWBspOutput::DEFER_SubsectorPortal, ptg, sub);
+		return;
+	}
 	auto portal = FindPortal(ptg);
 	if (!portal)
 	{
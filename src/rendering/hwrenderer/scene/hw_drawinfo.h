@@ -28,6 +28,7 @@ struct HWDecal;
 class IShadowMap;
 struct particle_t;
 struct FDynLightData;
+struct BspOutputMark;
 struct HUDSprite;
 class Clipper;
 class HWPortal;
@@ -94,6 +95,54 @@ enum DrawListType
 	GLDL_TYPES,
 };
 
+//==========================================================================
+//
+// Output of one BSP worker thread. Draw items go into private lists and
+// calls that modify state shared by the whole scene (portals and missing
+// textures) get recorded. The main thread merges all outputs in job order
+// once the traversal is done, so the result does not depend on timing.
+//
+//==========================================================================
+
+struct HWBspOutput
+{
+	enum EDeferredType
+	{
+		DEFER_Portal,
+		DEFER_UpperMissingTexture,
+		DEFER_LowerMissingTexture,
+		DEFER_SubsectorPortal,
+	};
+
+	struct DeferredCall
+	{
+		int type;
+		void *object;		// HWWall, side_t or FSectorPortalGroup
+		subsector_t *sub;
+		float height;
+		int ptype, plane;
+	};
+
+	HWDrawList drawlists[GLDL_TYPES];
+	TArray<HWDecal *> Decals[2];
+	TArray<DeferredCall> Deferred;
+
+	void Defer(int type, void *object, subsector_t *sub = nullptr, float height = 0, int ptype = 0, int plane = -1)
+	{
+		Deferred.Push({ type, object, sub, height, ptype, plane });
+	}
+
+	void Clear()
+	{
+		for (auto &list : drawlists) list.Reset();
+		Decals[0].Clear();
+		Decals[1].Clear();
+		Deferred.Clear();
+	}
+};
+
+extern thread_local HWBspOutput *bspOutput;	// only set while a BSP worker processes its jobs.
+
 
 struct HWDrawInfo
 {
@@ -188,7 +237,9 @@ private:
 	subsector_t *currentsubsector;	// used by the line processing code.
 	sector_t *currentsector;
 
-	void WorkerThread();
+	void WorkerThread(int index);
+	void MergeWorkerOutput(int index, const BspOutputMark &end);
+	void RenderBSPMultithreaded(void *node, int numworkers);
 
 	void UnclipSubsector(subsector_t *sub);
 	
@@ -25,6 +25,7 @@
 **
 */
 
+#include <mutex>
 #include "r_sky.h"
 #include "r_utility.h"
 #include "doomstat.h"
@@ -40,9 +41,31 @@
 
 FMemArena RenderDataAllocator(1024*1024);	// Use large blocks to reduce allocation time.
 
+// The BSP worker threads cannot share the allocator so each one gets its own arena.
+extern thread_local bool isWorkerThread;
+static thread_local FMemArena *WorkerAllocator;
+static TDeletingArray<FMemArena *> WorkerAllocators;
+static std::mutex WorkerAllocatorMutex;
+
 void ResetRenderDataAllocator()
 {
 	RenderDataAllocator.FreeAll();
+
+	std::lock_guard<std::mutex> lock(WorkerAllocatorMutex);
+	for (auto arena : WorkerAllocators) arena->FreeAll();
+}
+
+void *AllocRenderData(size_t size)
+{
+	if (!isWorkerThread) return RenderDataAllocator.Alloc(size);
+
+	if (WorkerAllocator == nullptr)
+	{
+		std::lock_guard<std::mutex> lock(WorkerAllocatorMutex);
+		WorkerAllocator = new FMemArena(256 * 1024);
+		WorkerAllocators.Push(WorkerAllocator);
+	}
+	return WorkerAllocator->Alloc(size);
 }
 
 //==========================================================================
@@ -753,7 +776,7 @@ void HWDrawList::SortFlats()
 
 HWWall *HWDrawList::NewWall()
 {
-	auto wall = (HWWall*)RenderDataAllocator.Alloc(sizeof(HWWall));
+	auto wall = (HWWall*)AllocRenderData(sizeof(HWWall));
 	drawitems.Push(HWDrawItem(DrawType_WALL, walls.Push(wall)));
 	return wall;
 }
@@ -765,7 +788,7 @@ HWWall *HWDrawList::NewWall()
 //==========================================================================
 HWFlat *HWDrawList::NewFlat()
 {
-	auto flat = (HWFlat*)RenderDataAllocator.Alloc(sizeof(HWFlat));
+	auto flat = (HWFlat*)AllocRenderData(sizeof(HWFlat));
 	drawitems.Push(HWDrawItem(DrawType_FLAT,flats.Push(flat)));
 	return flat;
 }
@@ -777,11 +800,39 @@ HWFlat *HWDrawList::NewFlat()
 //==========================================================================
 HWSprite *HWDrawList::NewSprite()
 {	
-	auto sprite = (HWSprite*)RenderDataAllocator.Alloc(sizeof(HWSprite));
+	auto sprite = (HWSprite*)AllocRenderData(sizeof(HWSprite));
 	drawitems.Push(HWDrawItem(DrawType_SPRITE, sprites.Push(sprite)));
 	return sprite;
 }
 
+//==========================================================================
+//
+// Moves a range of another list's draw items to the end of this one.
+// The items themselves are not copied.
+//
+//==========================================================================
+void HWDrawList::AppendItems(HWDrawList &other, unsigned first, unsigned last)
+{
+	for (unsigned i = first; i < last; i++)
+	{
+		auto &item = other.drawitems[i];
+		switch (item.rendertype)
+		{
+		case DrawType_WALL:
+			drawitems.Push(HWDrawItem(DrawType_WALL, walls.Push(other.walls[item.index])));
+			break;
+
+		case DrawType_FLAT:
+			drawitems.Push(HWDrawItem(DrawType_FLAT, flats.Push(other.flats[item.index])));
+			break;
+
+		case DrawType_SPRITE:
+			drawitems.Push(HWDrawItem(DrawType_SPRITE, sprites.Push(other.sprites[item.index])));
+			break;
+		}
+	}
+}
+
 //==========================================================================
 //
 //
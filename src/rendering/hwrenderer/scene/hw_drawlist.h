@@ -4,6 +4,7 @@
 
 extern FMemArena RenderDataAllocator;
 void ResetRenderDataAllocator();
+void *AllocRenderData(size_t size);
 struct HWDrawInfo;
 class HWWall;
 class HWFlat;
@@ -91,6 +92,7 @@ public:
 	HWWall *NewWall();
 	HWFlat *NewFlat();
 	HWSprite *NewSprite();
+	void AppendItems(HWDrawList &other, unsigned first, unsigned last);
 	void Reset();
 	void SortWalls();
 	void SortFlats();
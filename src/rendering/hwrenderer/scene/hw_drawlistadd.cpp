@@ -39,9 +39,10 @@ EXTERN_CVAR(Bool, gl_seamless)
 
 void HWDrawInfo::AddWall(HWWall *wall)
 {
+	auto lists = bspOutput != nullptr ? bspOutput->drawlists : drawlists;
 	if (wall->flags & HWWall::HWF_TRANSLUCENT)
 	{
-		auto newwall = drawlists[GLDL_TRANSLUCENT].NewWall();
+		auto newwall = lists[GLDL_TRANSLUCENT].NewWall();
 		*newwall = *wall;
 	}
 	else
@@ -57,7 +58,7 @@ void HWDrawInfo::AddWall(HWWall *wall)
 		{
 			list = masked ? GLDL_MASKEDWALLS : GLDL_PLAINWALLS;
 		}
-		auto newwall = drawlists[list].NewWall();
+		auto newwall = lists[list].NewWall();
 		*newwall = *wall;
 	}
 }
@@ -70,6 +71,7 @@ void HWDrawInfo::AddWall(HWWall *wall)
 
 void HWDrawInfo::AddMirrorSurface(HWWall *w)
 {
+	// Mirrors are portals, so the BSP workers leave this to the main thread.
 	w->type = RENDERWALL_MIRRORSURFACE;
 	auto newwall = drawlists[GLDL_TRANSLUCENTBORDER].NewWall();
 	*newwall = *w;
@@ -103,6 +105,7 @@ void HWDrawInfo::AddMirrorSurface(HWWall *w)
 
 void HWDrawInfo::AddFlat(HWFlat *flat, bool fog)
 {
+	auto lists = bspOutput != nullptr ? bspOutput->drawlists : drawlists;
 	int list;
 
 	if (flat->renderstyle != STYLE_Translucent || flat->alpha < 1.f - FLT_EPSILON || fog || flat->texture == nullptr)
@@ -130,7 +133,7 @@ void HWDrawInfo::AddFlat(HWFlat *flat, bool fog)
 		bool masked = flat->texture->isMasked() && ((flat->renderflags&SSRF_RENDER3DPLANES) || flat->stack);
 		list = masked ? GLDL_MASKEDFLATS : GLDL_PLAINFLATS;
 	}
-	auto newflat = drawlists[list].NewFlat();
+	auto newflat = lists[list].NewFlat();
 	*newflat = *flat;
 }
 
@@ -142,6 +145,7 @@ void HWDrawInfo::AddFlat(HWFlat *flat, bool fog)
 //==========================================================================
 void HWDrawInfo::AddSprite(HWSprite *sprite, bool translucent)
 {
+	auto lists = bspOutput != nullptr ? bspOutput->drawlists : drawlists;
 	int list;
 	// [BB] Allow models to be drawn in the GLDL_TRANSLUCENT pass.
 	if (translucent || sprite->actor == nullptr || (!sprite->modelframe && (sprite->actor->renderflags & RF_SPRITETYPEMASK) != RF_WALLSPRITE))
@@ -153,7 +157,7 @@ void HWDrawInfo::AddSprite(HWSprite *sprite, bool translucent)
 		list = GLDL_MODELS;
 	}
 
-	auto newsprt = drawlists[list].NewSprite();
+	auto newsprt = lists[list].NewSprite();
 	*newsprt = *sprite;
 }
 
@@ -194,6 +194,11 @@ void HWDrawInfo::AddOtherCeilingPlane(int sector, gl_subsectorrendernode * node)
 //==========================================================================
 void HWDrawInfo::AddUpperMissingTexture(side_t * side, subsector_t *sub, float Backheight)
 {
+	if (bspOutput != nullptr)
+	{
+		bspOutput->Defer(HWBspOutput::DEFER_UpperMissingTexture, side, sub, Backheight);
+		return;
+	}
 	if (!side->segs[0]->backsector) return;
 
 	for (int i = 0; i < side->numsegs; i++)
@@ -246,6 +251,11 @@ void HWDrawInfo::AddUpperMissingTexture(side_t * side, subsector_t *sub, float B
 //==========================================================================
 void HWDrawInfo::AddLowerMissingTexture(side_t * side, subsector_t *sub, float Backheight)
 {
+	if (bspOutput != nullptr)
+	{
+		bspOutput->Defer(HWBspOutput::DEFER_LowerMissingTexture, side, sub, Backheight);
+		return;
+	}
 	sector_t *backsec = side->segs[0]->backsector;
 	if (!backsec) return;
 	if (backsec->transdoor)
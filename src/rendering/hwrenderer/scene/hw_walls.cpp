@@ -567,6 +567,16 @@ void HWWall::PutPortal(HWDrawInfo *di, int ptype, int plane)
 {
 	HWPortal * portal = nullptr;
 
+	if (bspOutput != nullptr)
+	{
+		// The portal list is shared by the entire scene so a BSP worker must leave this to the main thread.
+		auto wall = (HWWall*)AllocRenderData(sizeof(HWWall));
+		*wall = *this;
+		bspOutput->Defer(HWBspOutput::DEFER_Portal, wall, nullptr, 0, ptype, plane);
+		vertcount = 0;
+		return;
+	}
+
 	MakeVertices(di, false);
 	switch (ptype)
 	{
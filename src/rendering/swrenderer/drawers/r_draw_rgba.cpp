@@ -49,17 +49,20 @@
 #include "r_draw_rgba.h"
 #include "swrenderer/viewport/r_viewport.h"
 #include "swrenderer/scene/r_light.h"
-#ifdef NO_SSE
 #include "r_draw_wall32.h"
 #include "r_draw_sprite32.h"
 #include "r_draw_span32.h"
 #include "r_draw_sky32.h"
-#else
+#ifndef NO_SSE
 #include "r_draw_wall32_sse2.h"
 #include "r_draw_sprite32_sse2.h"
 #include "r_draw_span32_sse2.h"
 #include "r_draw_sky32_sse2.h"
 #endif
+#include "x86.h"
+#include "c_dispatch.h"
+#include "printf.h"
+#include "i_time.h"
 
 #include "gi.h"
 #include "stats.h"
@@ -82,62 +85,62 @@ namespace swrenderer
 {
 	void SWTruecolorDrawers::DrawWall(const WallDrawerArgs &args)
 	{
-		DrawWallColumns<DrawWall32Command>(args);
+		DrawWallColumns(args, kernels->DrawWall);
 	}
 	
 	void SWTruecolorDrawers::DrawWallMasked(const WallDrawerArgs &args)
 	{
-		DrawWallColumns<DrawWallMasked32Command>(args);
+		DrawWallColumns(args, kernels->DrawWallMasked);
 	}
 	
 	void SWTruecolorDrawers::DrawWallAdd(const WallDrawerArgs &args)
 	{
-		DrawWallColumns<DrawWallAddClamp32Command>(args);
+		DrawWallColumns(args, kernels->DrawWallAddClamp);
 	}
 	
 	void SWTruecolorDrawers::DrawWallAddClamp(const WallDrawerArgs &args)
 	{
-		DrawWallColumns<DrawWallAddClamp32Command>(args);
+		DrawWallColumns(args, kernels->DrawWallAddClamp);
 	}
 	
 	void SWTruecolorDrawers::DrawWallSubClamp(const WallDrawerArgs &args)
 	{
-		DrawWallColumns<DrawWallSubClamp32Command>(args);
+		DrawWallColumns(args, kernels->DrawWallSubClamp);
 	}
 	
 	void SWTruecolorDrawers::DrawWallRevSubClamp(const WallDrawerArgs &args)
 	{
-		DrawWallColumns<DrawWallRevSubClamp32Command>(args);
+		DrawWallColumns(args, kernels->DrawWallRevSubClamp);
 	}
 	
 	void SWTruecolorDrawers::DrawColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSprite32Command::DrawColumn(args);
+		kernels->DrawSprite(args);
 	}
 
 	void SWTruecolorDrawers::FillColumn(const SpriteDrawerArgs &args)
 	{
-		FillSprite32Command::DrawColumn(args);
+		kernels->FillSprite(args);
 	}
 
 	void SWTruecolorDrawers::FillAddColumn(const SpriteDrawerArgs &args)
 	{
-		FillSpriteAddClamp32Command::DrawColumn(args);
+		kernels->FillSpriteAddClamp(args);
 	}
 
 	void SWTruecolorDrawers::FillAddClampColumn(const SpriteDrawerArgs &args)
 	{
-		FillSpriteAddClamp32Command::DrawColumn(args);
+		kernels->FillSpriteAddClamp(args);
 	}
 
 	void SWTruecolorDrawers::FillSubClampColumn(const SpriteDrawerArgs &args)
 	{
-		FillSpriteSubClamp32Command::DrawColumn(args);
+		kernels->FillSpriteSubClamp(args);
 	}
 
 	void SWTruecolorDrawers::FillRevSubClampColumn(const SpriteDrawerArgs &args)
 	{
-		FillSpriteRevSubClamp32Command::DrawColumn(args);
+		kernels->FillSpriteRevSubClamp(args);
 	}
 
 	void SWTruecolorDrawers::DrawFuzzColumn(const SpriteDrawerArgs &args)
@@ -151,97 +154,97 @@ namespace swrenderer
 
 	void SWTruecolorDrawers::DrawAddColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteAddClamp32Command::DrawColumn(args);
+		kernels->DrawSpriteAddClamp(args);
 	}
 
 	void SWTruecolorDrawers::DrawTranslatedColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteTranslated32Command::DrawColumn(args);
+		kernels->DrawSpriteTranslated(args);
 	}
 
 	void SWTruecolorDrawers::DrawTranslatedAddColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteTranslatedAddClamp32Command::DrawColumn(args);
+		kernels->DrawSpriteTranslatedAddClamp(args);
 	}
 
 	void SWTruecolorDrawers::DrawShadedColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteShaded32Command::DrawColumn(args);
+		kernels->DrawSpriteShaded(args);
 	}
 
 	void SWTruecolorDrawers::DrawAddClampShadedColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteAddClampShaded32Command::DrawColumn(args);
+		kernels->DrawSpriteAddClampShaded(args);
 	}
 
 	void SWTruecolorDrawers::DrawAddClampColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteAddClamp32Command::DrawColumn(args);
+		kernels->DrawSpriteAddClamp(args);
 	}
 
 	void SWTruecolorDrawers::DrawAddClampTranslatedColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteTranslatedAddClamp32Command::DrawColumn(args);
+		kernels->DrawSpriteTranslatedAddClamp(args);
 	}
 
 	void SWTruecolorDrawers::DrawSubClampColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteSubClamp32Command::DrawColumn(args);
+		kernels->DrawSpriteSubClamp(args);
 	}
 
 	void SWTruecolorDrawers::DrawSubClampTranslatedColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteTranslatedSubClamp32Command::DrawColumn(args);
+		kernels->DrawSpriteTranslatedSubClamp(args);
 	}
 
 	void SWTruecolorDrawers::DrawRevSubClampColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteRevSubClamp32Command::DrawColumn(args);
+		kernels->DrawSpriteRevSubClamp(args);
 	}
 
 	void SWTruecolorDrawers::DrawRevSubClampTranslatedColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteTranslatedRevSubClamp32Command::DrawColumn(args);
+		kernels->DrawSpriteTranslatedRevSubClamp(args);
 	}
 
 	void SWTruecolorDrawers::DrawSpan(const SpanDrawerArgs &args)
 	{
-		DrawSpan32Command::DrawColumn(args);
+		kernels->DrawSpan(args);
 	}
 	
 	void SWTruecolorDrawers::DrawSpanMasked(const SpanDrawerArgs &args)
 	{
-		DrawSpanMasked32Command::DrawColumn(args);
+		kernels->DrawSpanMasked(args);
 	}
 	
 	void SWTruecolorDrawers::DrawSpanTranslucent(const SpanDrawerArgs &args)
 	{
-		DrawSpanTranslucent32Command::DrawColumn(args);
+		kernels->DrawSpanTranslucent(args);
 	}
 	
 	void SWTruecolorDrawers::DrawSpanMaskedTranslucent(const SpanDrawerArgs &args)
 	{
-		DrawSpanAddClamp32Command::DrawColumn(args);
+		kernels->DrawSpanAddClamp(args);
 	}
 	
 	void SWTruecolorDrawers::DrawSpanAddClamp(const SpanDrawerArgs &args)
 	{
-		DrawSpanTranslucent32Command::DrawColumn(args);
+		kernels->DrawSpanTranslucent(args);
 	}
 	
 	void SWTruecolorDrawers::DrawSpanMaskedAddClamp(const SpanDrawerArgs &args)
 	{
-		DrawSpanAddClamp32Command::DrawColumn(args);
+		kernels->DrawSpanAddClamp(args);
 	}
 	
 	void SWTruecolorDrawers::DrawSingleSkyColumn(const SkyDrawerArgs &args)
 	{
-		DrawSkySingle32Command::DrawColumn(args);
+		kernels->DrawSkySingle(args);
 	}
 	
 	void SWTruecolorDrawers::DrawDoubleSkyColumn(const SkyDrawerArgs &args)
 	{
-		DrawSkyDouble32Command::DrawColumn(args);
+		kernels->DrawSkyDouble(args);
 	}
 
 	/////////////////////////////////////////////////////////////////////////////
@@ -866,7 +869,7 @@ namespace swrenderer
 
 			for (int j = 0; j < block.width; j++)
 			{
-				DrawSprite32Command::DrawColumn(drawerargs);
+				kernels->DrawSprite(drawerargs);
 				drawerargs.dc_dest += 4;
 			}
 		}
@@ -874,8 +877,7 @@ namespace swrenderer
 
 	/////////////////////////////////////////////////////////////////////////////
 
-	template<typename DrawerT>
-	void SWTruecolorDrawers::DrawWallColumns(const WallDrawerArgs& wallargs)
+	void SWTruecolorDrawers::DrawWallColumns(const WallDrawerArgs& wallargs, WallColumnFunc drawcolumn)
 	{
 		wallcolargs.wallargs = &wallargs;
 
@@ -948,7 +950,7 @@ namespace swrenderer
 				uint32_t texelStepX = (uint32_t)(int64_t)(scaleU * 0x1'0000'0000LL);
 				uint32_t texelStepY = (uint32_t)(int64_t)(scaleV * 0x1'0000'0000LL);
 
-				DrawWallColumn32<DrawerT>(wallcolargs, x, y1, y2, texelX, texelY, texelStepX, texelStepY);
+				DrawWallColumn32(wallcolargs, drawcolumn, x, y1, y2, texelX, texelY, texelStepX, texelStepY);
 			}
 
 			upos += ustepX;
@@ -982,8 +984,7 @@ namespace swrenderer
 		}
 	}
 
-	template<typename DrawerT>
-	void SWTruecolorDrawers::DrawWallColumn32(WallColumnDrawerArgs& drawerargs, int x, int y1, int y2, uint32_t texelX, uint32_t texelY, uint32_t texelStepX, uint32_t texelStepY)
+	void SWTruecolorDrawers::DrawWallColumn32(WallColumnDrawerArgs& drawerargs, WallColumnFunc drawcolumn, int x, int y1, int y2, uint32_t texelX, uint32_t texelY, uint32_t texelStepX, uint32_t texelStepY)
 	{
 		auto& wallargs = *drawerargs.wallargs;
 		int texwidth = wallargs.texwidth;
@@ -1044,6 +1045,469 @@ namespace swrenderer
 		drawerargs.SetTextureUPos(texturefracx);
 		drawerargs.SetTextureVPos(texelY);
 		drawerargs.SetTextureVStep(texelStepY);
-		DrawerT::DrawColumn(drawerargs);
+		drawcolumn(drawerargs);
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	const SWTruecolorKernels SWTruecolorScalar = SWTRUECOLOR_KERNELS("Scalar");
+
+#ifndef NO_SSE
+	namespace sse2
+	{
+		static const SWTruecolorKernels Kernels = SWTRUECOLOR_KERNELS("SSE2");
+	}
+
+	const SWTruecolorKernels *SWTruecolorSSE2 = &sse2::Kernels;
+#else
+	const SWTruecolorKernels *SWTruecolorSSE2 = nullptr;
+#endif
+
+	const SWTruecolorKernels *GetTruecolorKernels()
+	{
+		static const SWTruecolorKernels *kernels = []() -> const SWTruecolorKernels *
+		{
+			if (SWTruecolorAVX2 && CPU.bAVX2Usable)
+				return SWTruecolorAVX2;
+			else if (SWTruecolorSSE2)
+				return SWTruecolorSSE2;
+			else
+				return &SWTruecolorScalar;
+		}();
+		return kernels;
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+	//
+	// benchswdrawers [columns] [passes]
+	//
+	// Runs every kernel table over a canned set of columns and spans and reports
+	// the throughput of each drawer. The scalar drawers round differently from
+	// the SIMD ones, so only the SIMD tables are compared, against the SSE2 output.
+	//
+	/////////////////////////////////////////////////////////////////////////////
+
+	class SWTruecolorBenchmark
+	{
+	public:
+		enum { Width = 1280, Height = 720, TexSize = 256, FlatSize = 64, NumLights = 4 };
+
+		SWTruecolorBenchmark(int numcolumns) : Canvas(Width + viewwindowx, Height + viewwindowy, true)
+		{
+			Viewport.RenderTarget = &Canvas;
+			CreateColumns(numcolumns);
+			CreateBuffers();
+		}
+
+		void Run(int passes)
+		{
+			const SWTruecolorKernels *tables[] = { &SWTruecolorScalar, SWTruecolorSSE2, SWTruecolorAVX2 };
+			const SWTruecolorKernels *active = GetTruecolorKernels();
+
+			Printf("%u columns, %u spans, %d passes. Active: %s\n", (unsigned)Columns.size(), (unsigned)Spans.size(), passes, active->Name);
+			FString header;
+			header.Format("%-24s", "drawer");
+			for (auto table : tables)
+				if (table) header.AppendFormat(" %12s", table->Name);
+			Printf("%s  (Mpixels/s)\n", header.GetChars());
+
+			bool allmatch = true;
+			for (int k = 0; k < NumKernels; k++)
+			{
+				FString row;
+				row.Format("%-24s", KernelNames[k]);
+				double pixels = (k >= KernelSpanFirst && k < KernelSkyFirst) ? SpanPixels : ColumnPixels;
+				const SWTruecolorKernels *reference = nullptr;
+				uint32_t referencesum = 0;
+				for (auto table : tables)
+				{
+					if (!table)
+						continue;
+
+					// One run from the canned state for the output check, then the timed passes.
+					Reset();
+					uint32_t checksum = RunKernel(*table, k);
+					if (!reference && table != &SWTruecolorScalar)
+					{
+						reference = table;
+						referencesum = checksum;
+					}
+
+					uint64_t start = I_nsTime();
+					for (int i = 0; i < passes; i++)
+						RunKernel(*table, k);
+					double seconds = (I_nsTime() - start) * 1e-9;
+
+					bool match = table == &SWTruecolorScalar || checksum == referencesum;
+					allmatch = allmatch && match;
+					row.AppendFormat(" %11.1f%s", seconds > 0.0 ? pixels * passes / seconds / 1e6 : 0.0, match ? " " : "!");
+				}
+				Printf("%s\n", row.GetChars());
+			}
+
+			if (allmatch)
+				Printf("All SIMD drawers match the SSE2 output\n");
+			else
+				Printf(TEXTCOLOR_RED "Drawers marked with ! do not match the SSE2 output\n");
+		}
+
+	private:
+		enum
+		{
+			KernelWall,
+			KernelWallMasked,
+			KernelWallAddClamp,
+			KernelWallSubClamp,
+			KernelWallRevSubClamp,
+			KernelWallLinear,
+			KernelWallColormap,
+			KernelWallLights,
+			KernelSprite,
+			KernelSpriteAddClamp,
+			KernelSpriteSubClamp,
+			KernelSpriteRevSubClamp,
+			KernelFillSprite,
+			KernelFillSpriteAddClamp,
+			KernelSpriteShaded,
+			KernelSpriteAddClampShaded,
+			KernelSpriteTranslated,
+			KernelSpriteTranslatedAddClamp,
+			KernelSpriteColormap,
+			KernelSpanFirst,
+			KernelSpan = KernelSpanFirst,
+			KernelSpanMasked,
+			KernelSpanTranslucent,
+			KernelSpanAddClamp,
+			KernelSpanColormap,
+			KernelSpanLights,
+			KernelSkyFirst,
+			KernelSkySingle = KernelSkyFirst,
+			KernelSkyDouble,
+			NumKernels
+		};
+
+		static const char *const KernelNames[NumKernels];
+
+		struct FBenchColumn
+		{
+			int x, y, count;
+			uint32_t texturefrac, texturestep;
+			int32_t skyfrac, skystep;
+		};
+
+		struct FBenchSpan
+		{
+			int y, x1, x2;
+			double u, v, ustep, vstep;
+		};
+
+		uint32_t Random()
+		{
+			// xorshift32 so that the stream is the same on every machine
+			Seed ^= Seed << 13;
+			Seed ^= Seed >> 17;
+			Seed ^= Seed << 5;
+			return Seed;
+		}
+
+		void CreateColumns(int numcolumns)
+		{
+			ColumnPixels = 0;
+			SpanPixels = 0;
+			for (int i = 0; i < numcolumns; i++)
+			{
+				FBenchColumn column;
+				column.x = i % Width;
+				column.y = Random() % (Height / 2);
+				column.count = 1 + Random() % (Height - column.y);
+				column.texturefrac = Random();
+				column.texturestep = Random() % 0x1000000;
+
+				// Start above the sky so that every band of the fading sky is drawn
+				column.skyfrac = -(int32_t)(Random() % (1 << 23));
+				column.skystep = (3 << 24) / column.count + 1;
+
+				Columns.push_back(column);
+				ColumnPixels += column.count;
+
+				FBenchSpan span;
+				span.y = Random() % Height;
+				span.x1 = Random() % Width;
+				span.x2 = span.x1 + Random() % (Width - span.x1);
+				span.u = Random() / 4294967296.0;
+				span.v = Random() / 4294967296.0;
+				span.ustep = (Random() % 0x4000000) / 4294967296.0;
+				span.vstep = (Random() % 0x4000000) / 4294967296.0;
+
+				Spans.push_back(span);
+				SpanPixels += span.x2 - span.x1 + 1;
+			}
+		}
+
+		void CreateBuffers()
+		{
+			size_t size = (size_t)Canvas.GetPitch() * Canvas.GetHeight();
+			CannedDest.resize(size);
+			for (auto &pixel : CannedDest)
+				pixel = Random();
+
+			// Some transparent texels for the masked drawers and the back layer of the sky
+			Texels.resize(TexSize * TexSize);
+			for (auto &texel : Texels)
+				texel = (Random() & 7) ? Random() : 0;
+			Flat.resize(FlatSize * FlatSize);
+			for (auto &texel : Flat)
+				texel = (Random() & 7) ? Random() : 0;
+			Translation.resize(256);
+			for (auto &color : Translation)
+				color = Random();
+
+			ShadeMap.resize(256);
+			for (auto &shade : ShadeMap)
+				shade = Random() & 0x7f;
+			Colormap.Maps = ShadeMap.data();
+			Colormap.Color = PalEntry(255, 255, 200, 160);
+			Colormap.Fade = PalEntry(255, 32, 48, 64);
+			Colormap.Desaturate = 96;
+
+			// Dynamic lights in the layout the wall and span drawers expect: the walls get the
+			// squared horizontal distance in x, the attenuation factor in y and the height in z.
+			// The spans get the position along the span in x, the squared distance to the
+			// plane in y and the attenuation factor in z. A zero factor is a simple light.
+			for (int i = 0; i < NumLights; i++)
+			{
+				float distance2 = (float)(Random() % 40000);
+				float position = (float)(Random() % 2000) - 1000.0f;
+				float normal = (i & 1) ? 0.0f : (Random() % 256) / 256.0f;
+				float radius = 256.0f / (64 + Random() % 512);
+				uint32_t color = Random() & 0xffffff;
+				WallLights[i] = { color, distance2, normal, position, radius };
+				SpanLights[i] = { color, position, distance2, normal, radius };
+			}
+		}
+
+		void Reset()
+		{
+			memcpy(Canvas.GetPixels(), CannedDest.data(), CannedDest.size() * sizeof(uint32_t));
+		}
+
+		uint32_t Hash()
+		{
+			// FNV-1a
+			const uint8_t *bytes = Canvas.GetPixels();
+			size_t size = CannedDest.size() * sizeof(uint32_t);
+			uint32_t hash = 2166136261u;
+			for (size_t i = 0; i < size; i++)
+				hash = (hash ^ bytes[i]) * 16777619u;
+			return hash;
+		}
+
+		uint32_t RunKernel(const SWTruecolorKernels &kernels, int kernel)
+		{
+			if (kernel < KernelSprite)
+				RunWalls(kernels, kernel);
+			else if (kernel < KernelSpanFirst)
+				RunSprites(kernels, kernel);
+			else if (kernel < KernelSkyFirst)
+				RunSpans(kernels, kernel);
+			else
+				RunSky(kernels, kernel);
+			return Hash();
+		}
+
+		void RunWalls(const SWTruecolorKernels &kernels, int kernel)
+		{
+			WallDrawerArgs wallargs;
+			wallargs.SetDest(&Viewport);
+			if (kernel == KernelWallColormap)
+				wallargs.SetBaseColormap(&Colormap);
+
+			void (*drawcolumn)(const WallColumnDrawerArgs &args);
+			switch (kernel)
+			{
+			default: wallargs.SetStyle(false, false, OPAQUE, false); drawcolumn = kernels.DrawWall; break;
+			case KernelWallMasked: wallargs.SetStyle(true, false, OPAQUE, false); drawcolumn = kernels.DrawWallMasked; break;
+			case KernelWallAddClamp: wallargs.SetStyle(false, false, OPAQUE * 2 / 3, true); drawcolumn = kernels.DrawWallAddClamp; break;
+			case KernelWallSubClamp: wallargs.SetStyle(false, false, OPAQUE * 2 / 3, true); drawcolumn = kernels.DrawWallSubClamp; break;
+			case KernelWallRevSubClamp: wallargs.SetStyle(false, false, OPAQUE * 2 / 3, true); drawcolumn = kernels.DrawWallRevSubClamp; break;
+			}
+
+			WallColumnDrawerArgs colargs;
+			colargs.wallargs = &wallargs;
+			colargs.SetLight(0.0f, 8 << FRACBITS);
+			if (kernel == KernelWallLights)
+			{
+				for (int i = 0; i < NumLights; i++)
+					colargs.dc_lights[i] = WallLights[i];
+				colargs.dc_num_lights = NumLights;
+			}
+			for (const FBenchColumn &column : Columns)
+			{
+				const uint8_t *source = (const uint8_t *)(Texels.data() + (column.x % TexSize) * TexSize);
+				const uint8_t *source2 = nullptr;
+				if (kernel == KernelWallLinear)
+					source2 = (const uint8_t *)(Texels.data() + ((column.x + 1) % TexSize) * TexSize);
+
+				colargs.SetDest(column.x, column.y);
+				colargs.SetCount(column.count);
+				colargs.SetTexture(source, source2, TexSize);
+				colargs.SetTextureUPos(column.x & 15);
+				colargs.SetTextureVPos(column.texturefrac);
+				colargs.SetTextureVStep(column.texturestep);
+				colargs.dc_viewpos.Z = 500.0f - column.y * 1.3f;
+				colargs.dc_viewpos_step.Z = -1.3f;
+				drawcolumn(colargs);
+			}
+		}
+
+		void RunSprites(const SWTruecolorKernels &kernels, int kernel)
+		{
+			SpriteDrawerArgs args;
+			args.dc_viewport = &Viewport;
+			args.dc_textureheight = TexSize;
+			args.dc_srcalpha = OPAQUE * 2 / 3;
+			args.dc_destalpha = OPAQUE - args.dc_srcalpha;
+			args.dc_color_bgra = 0xff406080;
+			args.dc_srccolor_bgra = 0xffa0c0e0;
+			args.SetLight(0.0f, 8 << FRACBITS);
+			args.SetTranslationMap((uint8_t *)Translation.data());
+			if (kernel == KernelSpriteColormap)
+				args.SetBaseColormap(&Colormap);
+
+			void (*drawcolumn)(const SpriteDrawerArgs &args);
+			switch (kernel)
+			{
+			default: drawcolumn = kernels.DrawSprite; break;
+			case KernelSpriteAddClamp: drawcolumn = kernels.DrawSpriteAddClamp; break;
+			case KernelSpriteSubClamp: drawcolumn = kernels.DrawSpriteSubClamp; break;
+			case KernelSpriteRevSubClamp: drawcolumn = kernels.DrawSpriteRevSubClamp; break;
+			case KernelFillSprite: drawcolumn = kernels.FillSprite; break;
+			case KernelFillSpriteAddClamp: drawcolumn = kernels.FillSpriteAddClamp; break;
+			case KernelSpriteShaded: drawcolumn = kernels.DrawSpriteShaded; break;
+			case KernelSpriteAddClampShaded: drawcolumn = kernels.DrawSpriteAddClampShaded; break;
+			case KernelSpriteTranslated: drawcolumn = kernels.DrawSpriteTranslated; break;
+			case KernelSpriteTranslatedAddClamp: drawcolumn = kernels.DrawSpriteTranslatedAddClamp; break;
+			}
+
+			for (const FBenchColumn &column : Columns)
+			{
+				// Shaded and translated sprites read palette indices from the same texels. The byte
+				// offsets of those go past the column, so stay in the first half of the texture.
+				args.dc_source = (const uint8_t *)(Texels.data() + (column.x % (TexSize / 2)) * TexSize);
+				args.dc_dest = Viewport.GetDest(column.x, column.y);
+				args.dc_dest_y = column.y;
+				args.dc_count = column.count;
+				args.dc_texturefrac = column.texturefrac >> 2;
+				args.dc_iscale = column.texturestep >> 8;
+				drawcolumn(args);
+			}
+		}
+
+		void RunSpans(const SWTruecolorKernels &kernels, int kernel)
+		{
+			SpanDrawerArgs args;
+			args.ds_source = (const uint8_t *)Flat.data();
+			args.ds_source_mipmapped = false;
+			args.ds_texwidth = FlatSize;
+			args.ds_texheight = FlatSize;
+			args.ds_xbits = 6;
+			args.ds_ybits = 6;
+			args.dc_srcalpha = OPAQUE * 2 / 3;
+			args.dc_destalpha = OPAQUE - args.dc_srcalpha;
+			args.dc_viewpos = { 0.0f, 0.0f, 0.0f };
+			args.dc_viewpos_step = { 0.0f, 0.0f, 0.0f };
+			args.SetTextureLOD(0.0);
+			args.SetLight(0.0f, 8 << FRACBITS);
+			if (kernel == KernelSpanColormap)
+				args.SetBaseColormap(&Colormap);
+			if (kernel == KernelSpanLights)
+			{
+				args.dc_lights = SpanLights;
+				args.dc_num_lights = NumLights;
+				args.dc_viewpos_step.X = 0.7f;
+			}
+
+			void (*drawspan)(const SpanDrawerArgs &args);
+			switch (kernel)
+			{
+			default: drawspan = kernels.DrawSpan; break;
+			case KernelSpanMasked: drawspan = kernels.DrawSpanMasked; break;
+			case KernelSpanTranslucent: drawspan = kernels.DrawSpanTranslucent; break;
+			case KernelSpanAddClamp: drawspan = kernels.DrawSpanAddClamp; break;
+			}
+
+			for (const FBenchSpan &span : Spans)
+			{
+				args.SetDestY(&Viewport, span.y);
+				args.SetDestX1(span.x1);
+				args.SetDestX2(span.x2);
+				args.SetTextureUPos(span.u);
+				args.SetTextureVPos(span.v);
+				args.SetTextureUStep(span.ustep);
+				args.SetTextureVStep(span.vstep);
+				if (kernel == KernelSpanLights)
+					args.dc_viewpos.X = span.x1 * 0.7f - 450.0f;
+				drawspan(args);
+			}
+		}
+
+		void RunSky(const SWTruecolorKernels &kernels, int kernel)
+		{
+			SkyDrawerArgs args;
+			args.dc_sourceheight = TexSize;
+			args.dc_sourceheight2 = TexSize / 2;
+			args.SetSolidTop(0xff203040);
+			args.SetSolidBottom(0xff405060);
+			args.SetFadeSky(true);
+
+			auto drawcolumn = kernel == KernelSkyDouble ? kernels.DrawSkyDouble : kernels.DrawSkySingle;
+			for (const FBenchColumn &column : Columns)
+			{
+				args.dc_source = (const uint8_t *)(Texels.data() + (column.x % TexSize) * TexSize);
+				args.dc_source2 = (const uint8_t *)(Texels.data() + ((column.x + 7) % TexSize) * TexSize);
+				args.SetDest(&Viewport, column.x, column.y);
+				args.SetCount(column.count);
+				args.SetTextureVPos(column.skyfrac);
+				args.SetTextureVStep(column.skystep);
+				drawcolumn(args);
+			}
+		}
+
+		uint32_t Seed = 0x1234567;
+		std::vector<FBenchColumn> Columns;
+		std::vector<FBenchSpan> Spans;
+		double ColumnPixels = 0;
+		double SpanPixels = 0;
+
+		DCanvas Canvas;
+		RenderViewport Viewport;
+		FSWColormap Colormap;
+		DrawerLight WallLights[NumLights];
+		DrawerLight SpanLights[NumLights];
+		std::vector<uint32_t> CannedDest, Texels, Flat, Translation;
+		std::vector<uint8_t> ShadeMap;
+	};
+
+	const char *const SWTruecolorBenchmark::KernelNames[NumKernels] =
+	{
+		"wall", "wall masked", "wall addclamp", "wall subclamp", "wall revsubclamp", "wall linear", "wall colormap", "wall lights",
+		"sprite", "sprite addclamp", "sprite subclamp", "sprite revsubclamp", "fill", "fill addclamp",
+		"shaded", "shaded addclamp", "translated", "translated addclamp", "sprite colormap",
+		"span", "span masked", "span translucent", "span addclamp", "span colormap", "span lights",
+		"sky single", "sky double"
+	};
+}
+
+CCMD(benchswdrawers)
+{
+	int numcolumns = argv.argc() > 1 ? atoi(argv[1]) : 20000;
+	int passes = argv.argc() > 2 ? atoi(argv[2]) : 20;
+	if (numcolumns <= 0 || passes <= 0)
+	{
+		Printf("Usage: benchswdrawers [columns] [passes]\n");
+		return;
 	}
+
+	swrenderer::SWTruecolorBenchmark benchmark(numcolumns);
+	benchmark.Run(passes);
 }
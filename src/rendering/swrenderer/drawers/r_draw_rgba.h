@@ -89,6 +89,82 @@ namespace swrenderer
 
 	/////////////////////////////////////////////////////////////////////////////
 
+	// Column and span drawers of one instruction set. The SIMD tables must all
+	// produce the same output; the scalar drawers are the fallback for NO_SSE builds.
+	struct SWTruecolorKernels
+	{
+		const char *Name;
+
+		void (*DrawWall)(const WallColumnDrawerArgs &args);
+		void (*DrawWallMasked)(const WallColumnDrawerArgs &args);
+		void (*DrawWallAddClamp)(const WallColumnDrawerArgs &args);
+		void (*DrawWallSubClamp)(const WallColumnDrawerArgs &args);
+		void (*DrawWallRevSubClamp)(const WallColumnDrawerArgs &args);
+
+		void (*DrawSprite)(const SpriteDrawerArgs &args);
+		void (*DrawSpriteAddClamp)(const SpriteDrawerArgs &args);
+		void (*DrawSpriteSubClamp)(const SpriteDrawerArgs &args);
+		void (*DrawSpriteRevSubClamp)(const SpriteDrawerArgs &args);
+		void (*FillSprite)(const SpriteDrawerArgs &args);
+		void (*FillSpriteAddClamp)(const SpriteDrawerArgs &args);
+		void (*FillSpriteSubClamp)(const SpriteDrawerArgs &args);
+		void (*FillSpriteRevSubClamp)(const SpriteDrawerArgs &args);
+		void (*DrawSpriteShaded)(const SpriteDrawerArgs &args);
+		void (*DrawSpriteAddClampShaded)(const SpriteDrawerArgs &args);
+		void (*DrawSpriteTranslated)(const SpriteDrawerArgs &args);
+		void (*DrawSpriteTranslatedAddClamp)(const SpriteDrawerArgs &args);
+		void (*DrawSpriteTranslatedSubClamp)(const SpriteDrawerArgs &args);
+		void (*DrawSpriteTranslatedRevSubClamp)(const SpriteDrawerArgs &args);
+
+		void (*DrawSpan)(const SpanDrawerArgs &args);
+		void (*DrawSpanMasked)(const SpanDrawerArgs &args);
+		void (*DrawSpanTranslucent)(const SpanDrawerArgs &args);
+		void (*DrawSpanAddClamp)(const SpanDrawerArgs &args);
+
+		void (*DrawSkySingle)(const SkyDrawerArgs &args);
+		void (*DrawSkyDouble)(const SkyDrawerArgs &args);
+	};
+
+	// Builds a kernel table from the drawer commands visible in the current namespace
+	#define SWTRUECOLOR_KERNELS(name) \
+	{ \
+		name, \
+		&DrawWall32Command::DrawColumn, \
+		&DrawWallMasked32Command::DrawColumn, \
+		&DrawWallAddClamp32Command::DrawColumn, \
+		&DrawWallSubClamp32Command::DrawColumn, \
+		&DrawWallRevSubClamp32Command::DrawColumn, \
+		&DrawSprite32Command::DrawColumn, \
+		&DrawSpriteAddClamp32Command::DrawColumn, \
+		&DrawSpriteSubClamp32Command::DrawColumn, \
+		&DrawSpriteRevSubClamp32Command::DrawColumn, \
+		&FillSprite32Command::DrawColumn, \
+		&FillSpriteAddClamp32Command::DrawColumn, \
+		&FillSpriteSubClamp32Command::DrawColumn, \
+		&FillSpriteRevSubClamp32Command::DrawColumn, \
+		&DrawSpriteShaded32Command::DrawColumn, \
+		&DrawSpriteAddClampShaded32Command::DrawColumn, \
+		&DrawSpriteTranslated32Command::DrawColumn, \
+		&DrawSpriteTranslatedAddClamp32Command::DrawColumn, \
+		&DrawSpriteTranslatedSubClamp32Command::DrawColumn, \
+		&DrawSpriteTranslatedRevSubClamp32Command::DrawColumn, \
+		&DrawSpan32Command::DrawColumn, \
+		&DrawSpanMasked32Command::DrawColumn, \
+		&DrawSpanTranslucent32Command::DrawColumn, \
+		&DrawSpanAddClamp32Command::DrawColumn, \
+		&DrawSkySingle32Command::DrawColumn, \
+		&DrawSkyDouble32Command::DrawColumn \
+	}
+
+	extern const SWTruecolorKernels SWTruecolorScalar;
+	extern const SWTruecolorKernels *SWTruecolorSSE2;	// nullptr if not compiled in
+	extern const SWTruecolorKernels *SWTruecolorAVX2;	// nullptr if not compiled in
+
+	// The fastest table supported by this CPU
+	const SWTruecolorKernels *GetTruecolorKernels();
+
+	/////////////////////////////////////////////////////////////////////////////
+
 	class SWTruecolorDrawers : public SWPixelFormatDrawers
 	{
 	public:
@@ -136,10 +212,14 @@ namespace swrenderer
 		void DrawScaledFuzzColumn(const SpriteDrawerArgs& args);
 		void DrawUnscaledFuzzColumn(const SpriteDrawerArgs& args);
 
-		template<typename DrawerT> void DrawWallColumns(const WallDrawerArgs& args);
-		template<typename DrawerT> void DrawWallColumn32(WallColumnDrawerArgs& drawerargs, int x, int y1, int y2, uint32_t texelX, uint32_t texelY, uint32_t texelStepX, uint32_t texelStepY);
+		typedef void(*WallColumnFunc)(const WallColumnDrawerArgs &args);
+		void DrawWallColumns(const WallDrawerArgs& args, WallColumnFunc drawcolumn);
+		void DrawWallColumn32(WallColumnDrawerArgs& drawerargs, WallColumnFunc drawcolumn, int x, int y1, int y2, uint32_t texelX, uint32_t texelY, uint32_t texelStepX, uint32_t texelStepY);
 
 		WallColumnDrawerArgs wallcolargs;
+
+		// Drawers for the instruction set of this CPU
+		const SWTruecolorKernels *kernels = GetTruecolorKernels();
 	};
 
 	/////////////////////////////////////////////////////////////////////////////
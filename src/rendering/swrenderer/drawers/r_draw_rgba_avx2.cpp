@@ -0,0 +1,84 @@
+/*
+**  Drawer commands for the AVX2 instruction set
+**  Copyright (c) 2026 The GZDoom Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+*/
+
+// Only the AVX2 kernels below are compiled for AVX2. The engine headers are
+// included first, outside of the target region, so that the inline functions
+// and templates they define keep the baseline instruction set. Otherwise the
+// linker could pick an AVX2 copy of those for the whole program. Nothing in
+// the target region may be called before GetTruecolorKernels has checked
+// that the CPU supports it.
+
+#include <stddef.h>
+
+#include "templates.h"
+#include "doomdef.h"
+#include "swrenderer/textures/r_swtexture.h"
+#include "swrenderer/r_renderthread.h"
+#include "r_draw_rgba.h"
+#include "r_draw_pal.h"
+#include "swrenderer/viewport/r_viewport.h"
+#include "swrenderer/viewport/r_walldrawer.h"
+#include "swrenderer/viewport/r_spritedrawer.h"
+#include "swrenderer/viewport/r_spandrawer.h"
+#include "swrenderer/viewport/r_skydrawer.h"
+#include "swrenderer/scene/r_light.h"
+
+#if !defined(NO_SSE) && (defined(__GNUC__) || defined(_MSC_VER)) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+#include "r_draw_wall32_avx2.h"
+#include "r_draw_sprite32_avx2.h"
+#include "r_draw_span32_avx2.h"
+#include "r_draw_sky32_avx2.h"
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+namespace swrenderer
+{
+	namespace avx2
+	{
+		static const SWTruecolorKernels Kernels = SWTRUECOLOR_KERNELS("AVX2");
+	}
+
+	const SWTruecolorKernels *SWTruecolorAVX2 = &avx2::Kernels;
+}
+
+#else
+
+namespace swrenderer
+{
+	const SWTruecolorKernels *SWTruecolorAVX2 = nullptr;
+}
+
+#endif
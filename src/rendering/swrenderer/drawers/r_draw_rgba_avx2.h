@@ -0,0 +1,217 @@
+/*
+**  Shared helpers for the AVX2 drawers
+**  Copyright (c) 2026 The GZDoom Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+*/
+
+#pragma once
+
+#include "swrenderer/drawers/r_draw_rgba.h"
+
+namespace swrenderer::avx2
+{
+	// Four pixels with 16 bits per channel. Pixel 0 and 1 live in the low 128-bit lane and
+	// pixel 2 and 3 in the high lane, which is the layout the per-lane pack and unpack
+	// instructions produce. Each lane is then laid out exactly like the two pixels of the
+	// SSE2 drawers, so both give the same results.
+	class Pixels4
+	{
+	public:
+		FORCEINLINE static __m128i VECTORCALL LoadColumn(const uint32_t *src, int pitch)
+		{
+			return _mm_setr_epi32(src[0], src[pitch], src[pitch * 2], src[pitch * 3]);
+		}
+
+		// The missing pixels are zero
+		FORCEINLINE static __m128i VECTORCALL LoadColumn(const uint32_t *src, int pitch, int count)
+		{
+			uint32_t tmp[4] = { 0, 0, 0, 0 };
+			for (int i = 0; i < count; i++)
+				tmp[i] = src[i * pitch];
+			return _mm_loadu_si128((const __m128i*)tmp);
+		}
+
+		FORCEINLINE static void VECTORCALL StoreColumn(uint32_t *dest, int pitch, __m128i c)
+		{
+			dest[0] = _mm_cvtsi128_si32(c);
+			dest[pitch] = _mm_extract_epi32(c, 1);
+			dest[pitch * 2] = _mm_extract_epi32(c, 2);
+			dest[pitch * 3] = _mm_extract_epi32(c, 3);
+		}
+
+		FORCEINLINE static void VECTORCALL StoreColumn(uint32_t *dest, int pitch, __m128i c, int count)
+		{
+			uint32_t tmp[4];
+			_mm_storeu_si128((__m128i*)tmp, c);
+			for (int i = 0; i < count; i++)
+				dest[i * pitch] = tmp[i];
+		}
+
+		FORCEINLINE static __m256i VECTORCALL Unpack(__m128i c)
+		{
+			return _mm256_cvtepu8_epi16(c);
+		}
+
+		FORCEINLINE static __m128i VECTORCALL Pack(__m256i c)
+		{
+			c = _mm256_packus_epi16(c, _mm256_setzero_si256());
+			return _mm256_castsi256_si128(_mm256_permute4x64_epi64(c, _MM_SHUFFLE(3, 1, 2, 0)));
+		}
+
+		// Same value in all four channels of each pixel. The values must fit in a signed 16-bit integer.
+		FORCEINLINE static __m256i VECTORCALL Broadcast(__m128i values)
+		{
+			__m128i v = _mm_packs_epi32(values, values);
+			v = _mm_unpacklo_epi16(v, v);
+			__m128i lo = _mm_unpacklo_epi32(v, v);
+			__m128i hi = _mm_unpackhi_epi32(v, v);
+			return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+		}
+
+		// Same as _mm_set_epi16(a, r, g, b, a, r, g, b) of the SSE2 drawers
+		FORCEINLINE static __m256i VECTORCALL Channels(int a, int r, int g, int b)
+		{
+			uint64_t c = ((uint64_t)(uint16_t)a << 48) | ((uint64_t)(uint16_t)r << 32) | ((uint64_t)(uint16_t)g << 16) | (uint64_t)(uint16_t)b;
+			return _mm256_set1_epi64x((int64_t)c);
+		}
+
+		// ((red * 77 + green * 143 + blue * 37) >> 8) * desaturate in the color channels and zero in alpha
+		FORCEINLINE static __m256i VECTORCALL Intensity(__m256i c, int desaturate)
+		{
+			__m256i sum = _mm256_madd_epi16(c, Channels(0, 77, 143, 37));
+			sum = _mm256_add_epi32(sum, _mm256_srli_epi64(sum, 32));
+			sum = _mm256_mullo_epi32(_mm256_srli_epi32(sum, 8), _mm256_set1_epi32(desaturate));
+			sum = _mm256_shufflelo_epi16(sum, _MM_SHUFFLE(0, 0, 0, 0));
+			sum = _mm256_shufflehi_epi16(sum, _MM_SHUFFLE(0, 0, 0, 0));
+			return _mm256_and_si256(sum, _mm256_set1_epi64x(0x0000ffffffffffffLL));
+		}
+
+		// Per pixel blend factors of the AddClamp, SubClamp and RevSubClamp drawers
+		FORCEINLINE static void VECTORCALL BlendAlpha(__m128i ifgcolor, uint32_t srcalpha, uint32_t destalpha, __m256i &fgalpha, __m256i &bgalpha)
+		{
+			__m128i alpha = _mm_srli_epi32(ifgcolor, 24);
+			alpha = _mm_add_epi32(alpha, _mm_srli_epi32(alpha, 7)); // 255->256
+			__m128i inv_alpha = _mm_sub_epi32(_mm_set1_epi32(256), alpha);
+			__m128i round = _mm_set1_epi32(128);
+
+			__m128i bg = _mm_add_epi32(_mm_mullo_epi32(_mm_set1_epi32(destalpha), alpha), _mm_slli_epi32(inv_alpha, 8));
+			__m128i fg = _mm_mullo_epi32(_mm_set1_epi32(srcalpha), alpha);
+			bgalpha = Broadcast(_mm_srli_epi32(_mm_add_epi32(bg, round), 8));
+			fgalpha = Broadcast(_mm_srli_epi32(_mm_add_epi32(fg, round), 8));
+		}
+
+		enum class BlendOp { Add, Sub, RevSub };
+
+		// (fgcolor * fgalpha op bgcolor * bgalpha) >> 8 with the result clamped to 0-255
+		template<BlendOp Op>
+		FORCEINLINE static __m128i VECTORCALL BlendClamp(__m256i fgcolor, __m256i bgcolor, __m256i fgalpha, __m256i bgalpha)
+		{
+			fgcolor = _mm256_mullo_epi16(fgcolor, fgalpha);
+			bgcolor = _mm256_mullo_epi16(bgcolor, bgalpha);
+
+			__m256i fg_lo = _mm256_unpacklo_epi16(fgcolor, _mm256_setzero_si256());
+			__m256i bg_lo = _mm256_unpacklo_epi16(bgcolor, _mm256_setzero_si256());
+			__m256i fg_hi = _mm256_unpackhi_epi16(fgcolor, _mm256_setzero_si256());
+			__m256i bg_hi = _mm256_unpackhi_epi16(bgcolor, _mm256_setzero_si256());
+
+			__m256i out_lo, out_hi;
+			if (Op == BlendOp::Add)
+			{
+				out_lo = _mm256_add_epi32(fg_lo, bg_lo);
+				out_hi = _mm256_add_epi32(fg_hi, bg_hi);
+			}
+			else if (Op == BlendOp::Sub)
+			{
+				out_lo = _mm256_sub_epi32(fg_lo, bg_lo);
+				out_hi = _mm256_sub_epi32(fg_hi, bg_hi);
+			}
+			else
+			{
+				out_lo = _mm256_sub_epi32(bg_lo, fg_lo);
+				out_hi = _mm256_sub_epi32(bg_hi, fg_hi);
+			}
+
+			out_lo = _mm256_srai_epi32(out_lo, 8);
+			out_hi = _mm256_srai_epi32(out_hi, 8);
+			return _mm_or_si128(Pack(_mm256_packs_epi32(out_lo, out_hi)), _mm_set1_epi32(0xff000000));
+		}
+
+		// Pixels that are black after shading keep the background, like the masked SSE2 drawers
+		FORCEINLINE static __m128i VECTORCALL Masked(__m256i fgcolor, __m256i bgcolor)
+		{
+			__m256i mask = Unpack(_mm_cmpeq_epi32(Pack(fgcolor), _mm_setzero_si128()));
+			__m256i outcolor = _mm256_or_si256(_mm256_and_si256(mask, bgcolor), _mm256_andnot_si256(mask, fgcolor));
+			return _mm_or_si128(Pack(outcolor), _mm_set1_epi32(0xff000000));
+		}
+
+		FORCEINLINE static __m128i VECTORCALL Opaque(__m256i fgcolor)
+		{
+			return _mm_or_si128(Pack(fgcolor), _mm_set1_epi32(0xff000000));
+		}
+
+		// View space positions of four pixels. The SSE2 drawers step a pair of positions by two
+		// pixels at a time, so pixel 2 and 3 are the pair stepped once more. Stepping the same way
+		// keeps the float rounding identical.
+		FORCEINLINE static __m128 VECTORCALL ViewPositions(__m128 pair, __m128 pairstep)
+		{
+			return _mm_movelh_ps(pair, _mm_add_ps(pair, pairstep));
+		}
+
+		FORCEINLINE static __m128 VECTORCALL NextViewPositions(__m128 pair, __m128 pairstep)
+		{
+			return _mm_add_ps(_mm_add_ps(pair, pairstep), pairstep);
+		}
+
+		// Adds the contribution of one dynamic light to lit. The squared distances of the four pixels
+		// are planedist2 + (lightpos - viewpos)^2 and normal is the N.L term of point lights.
+		FORCEINLINE static __m256i VECTORCALL AddLight(__m256i lit, __m128 planedist2, __m128 lightpos, __m128 viewpos, __m128 normal, __m128 light_radius, uint32_t color)
+		{
+			__m128 m256 = _mm_set1_ps(256.0f);
+
+			// L = light-pos
+			// dist = sqrt(dot(L, L))
+			// distance_attenuation = 1 - MIN(dist * (1/radius), 1)
+			__m128 L = _mm_sub_ps(lightpos, viewpos);
+			__m128 dist2 = _mm_add_ps(planedist2, _mm_mul_ps(L, L));
+			__m128 rcp_dist = _mm_rsqrt_ps(dist2);
+			__m128 dist = _mm_mul_ps(dist2, rcp_dist);
+			__m128 distance_attenuation = _mm_sub_ps(m256, _mm_min_ps(_mm_mul_ps(dist, light_radius), m256));
+
+			// The simple light type
+			__m128 simple_attenuation = distance_attenuation;
+
+			// The point light type
+			// diffuse = dot(N,L) * attenuation
+			__m128 point_attenuation = _mm_mul_ps(_mm_mul_ps(normal, rcp_dist), distance_attenuation);
+
+			__m128 is_attenuated = _mm_cmpeq_ps(normal, _mm_setzero_ps());
+			__m128i attenuation = _mm_cvtps_epi32(_mm_or_ps(_mm_and_ps(is_attenuated, simple_attenuation), _mm_andnot_ps(is_attenuated, point_attenuation)));
+
+			__m256i light_color = Unpack(_mm_set1_epi32(color));
+			return _mm256_add_epi16(lit, _mm256_srli_epi16(_mm256_mullo_epi16(light_color, Broadcast(attenuation)), 8));
+		}
+
+		FORCEINLINE static __m256i VECTORCALL ApplyLights(__m256i material, __m256i fgcolor, __m256i lit)
+		{
+			lit = _mm256_min_epi16(lit, _mm256_set1_epi16(256));
+			fgcolor = _mm256_add_epi16(fgcolor, _mm256_srli_epi16(_mm256_mullo_epi16(material, lit), 8));
+			return _mm256_min_epi16(fgcolor, _mm256_set1_epi16(255));
+		}
+	};
+}
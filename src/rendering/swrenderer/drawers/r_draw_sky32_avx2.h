@@ -0,0 +1,210 @@
+/*
+**  Drawer commands for the sky
+**  Copyright (c) 2026 The GZDoom Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+*/
+
+#pragma once
+
+#include "swrenderer/drawers/r_draw_rgba_avx2.h"
+#include "swrenderer/viewport/r_skydrawer.h"
+
+namespace swrenderer::avx2
+{
+	namespace DrawSky32TModes
+	{
+		enum class SkyModes { Single, Double };
+		struct SingleSky { static const int Mode = (int)SkyModes::Single; };
+		struct DoubleSky { static const int Mode = (int)SkyModes::Double; };
+
+		enum class FadeModes { None, Top, Bottom };
+	}
+
+	template<typename SkyT>
+	class DrawSky32T
+	{
+	public:
+		struct TextureData
+		{
+			const uint32_t *source0;
+			const uint32_t *source1;
+			int textureheight0;
+			uint32_t maxtextureheight1;
+		};
+
+		static void DrawColumn(const SkyDrawerArgs& args)
+		{
+			using namespace DrawSky32TModes;
+
+			uint32_t *dest = (uint32_t *)args.Dest();
+			int pitch = args.Viewport()->RenderTarget->GetPitch();
+
+			TextureData texdata;
+			texdata.source0 = (const uint32_t *)args.FrontTexturePixels();
+			texdata.textureheight0 = args.FrontTextureHeight();
+			if (SkyT::Mode == (int)SkyModes::Double)
+			{
+				texdata.source1 = (const uint32_t *)args.BackTexturePixels();
+				texdata.maxtextureheight1 = args.BackTextureHeight() - 1;
+			}
+			else
+			{
+				texdata.source1 = nullptr;
+				texdata.maxtextureheight1 = 0;
+			}
+
+			int32_t frac = args.TextureVPos();
+			int32_t fracstep = args.TextureVStep();
+
+			uint32_t solid_top = args.SolidTopColor();
+			uint32_t solid_bottom = args.SolidBottomColor();
+			bool fadeSky = args.FadeSky();
+
+			int count = args.Count();
+
+			__m128i fracoffsets = _mm_mullo_epi32(_mm_set1_epi32(fracstep), _mm_setr_epi32(0, 1, 2, 3));
+
+			if (!fadeSky)
+			{
+				Band<FadeModes::None>(dest, pitch, frac, fracstep, fracoffsets, count, _mm256_setzero_si256(), texdata);
+				return;
+			}
+
+			// Find bands for top solid color, top fade, center textured, bottom fade, bottom solid color:
+			int start_fade = 2; // How fast it should fade out
+			int fade_length = (1 << (24 - start_fade));
+			int start_fadetop_y = (-frac) / fracstep;
+			int end_fadetop_y = (fade_length - frac) / fracstep;
+			int start_fadebottom_y = ((2 << 24) - fade_length - frac) / fracstep;
+			int end_fadebottom_y = ((2 << 24) - frac) / fracstep;
+			start_fadetop_y = clamp(start_fadetop_y, 0, count);
+			end_fadetop_y = clamp(end_fadetop_y, 0, count);
+			start_fadebottom_y = clamp(start_fadebottom_y, 0, count);
+			end_fadebottom_y = clamp(end_fadebottom_y, 0, count);
+
+			// Both fades blend towards the top color, like the SSE2 drawers do
+			__m256i solid_top_fill = Pixels4::Unpack(_mm_set1_epi32(solid_top));
+
+			int index = 0;
+
+			// Top solid color:
+			while (index < start_fadetop_y)
+			{
+				*dest = solid_top;
+				dest += pitch;
+				frac += fracstep;
+				index++;
+			}
+
+			// Top fade:
+			int length = MAX(end_fadetop_y - index, 0);
+			Band<FadeModes::Top>(dest, pitch, frac, fracstep, fracoffsets, length, solid_top_fill, texdata);
+			dest += pitch * length;
+			frac += fracstep * length;
+			index += length;
+
+			// Textured center:
+			length = MAX(start_fadebottom_y - index, 0);
+			Band<FadeModes::None>(dest, pitch, frac, fracstep, fracoffsets, length, solid_top_fill, texdata);
+			dest += pitch * length;
+			frac += fracstep * length;
+			index += length;
+
+			// Fade bottom:
+			length = MAX(end_fadebottom_y - index, 0);
+			Band<FadeModes::Bottom>(dest, pitch, frac, fracstep, fracoffsets, length, solid_top_fill, texdata);
+			dest += pitch * length;
+			index += length;
+
+			// Bottom solid color:
+			while (index < count)
+			{
+				*dest = solid_bottom;
+				dest += pitch;
+				index++;
+			}
+		}
+
+		template<DrawSky32TModes::FadeModes FadeMode>
+		FORCEINLINE static void VECTORCALL Band(uint32_t *dest, int pitch, int32_t frac, int32_t fracstep, __m128i fracoffsets, int count, __m256i solid_fill, const TextureData &texdata)
+		{
+			int avxcount = count / 4;
+			for (int index = 0; index < avxcount; index++)
+			{
+				__m128i mfrac = _mm_add_epi32(_mm_set1_epi32(frac), fracoffsets);
+				Pixels4::StoreColumn(dest, pitch, Fade<FadeMode>(Sample4(mfrac, texdata), mfrac, solid_fill));
+				dest += pitch * 4;
+				frac += fracstep * 4;
+			}
+
+			int remaining = count - avxcount * 4;
+			if (remaining > 0)
+			{
+				__m128i mfrac = _mm_add_epi32(_mm_set1_epi32(frac), fracoffsets);
+				Pixels4::StoreColumn(dest, pitch, Fade<FadeMode>(Sample4(mfrac, texdata), mfrac, solid_fill), remaining);
+			}
+		}
+
+		FORCEINLINE static __m128i VECTORCALL Sample4(__m128i frac, const TextureData &texdata)
+		{
+			using namespace DrawSky32TModes;
+
+			__m128i sample_index = _mm_srli_epi32(_mm_slli_epi32(frac, 8), FRACBITS);
+			sample_index = _mm_srli_epi32(_mm_mullo_epi32(sample_index, _mm_set1_epi32(texdata.textureheight0)), FRACBITS);
+			__m128i fg = _mm_i32gather_epi32((const int *)texdata.source0, sample_index, 4);
+
+			if (SkyT::Mode == (int)SkyModes::Double)
+			{
+				// Transparent pixels of the front layer show the back layer
+				__m128i sample_index2 = _mm_min_epu32(sample_index, _mm_set1_epi32(texdata.maxtextureheight1));
+				__m128i transparent = _mm_cmpeq_epi32(fg, _mm_setzero_si128());
+				fg = _mm_mask_i32gather_epi32(fg, (const int *)texdata.source1, sample_index2, transparent, 4);
+			}
+
+			return fg;
+		}
+
+		template<DrawSky32TModes::FadeModes FadeMode>
+		FORCEINLINE static __m128i VECTORCALL Fade(__m128i fg, __m128i frac, __m256i solid_fill)
+		{
+			using namespace DrawSky32TModes;
+
+			if (FadeMode == FadeModes::None)
+				return fg;
+
+			int start_fade = 2;
+			__m128i alpha;
+			if (FadeMode == FadeModes::Top)
+				alpha = _mm_srai_epi32(frac, 16 - start_fade);
+			else
+				alpha = _mm_srai_epi32(_mm_sub_epi32(_mm_set1_epi32(2 << 24), frac), 16 - start_fade);
+			alpha = _mm_max_epi32(_mm_min_epi32(alpha, _mm_set1_epi32(256)), _mm_setzero_si128());
+
+			__m256i alpha16 = Pixels4::Broadcast(alpha);
+			__m256i inv_alpha16 = _mm256_sub_epi16(_mm256_set1_epi16(256), alpha16);
+
+			__m256i c = Pixels4::Unpack(fg);
+			c = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(c, alpha16), _mm256_mullo_epi16(solid_fill, inv_alpha16)), 8);
+			return Pixels4::Pack(c);
+		}
+	};
+
+	typedef DrawSky32T<DrawSky32TModes::SingleSky> DrawSkySingle32Command;
+	typedef DrawSky32T<DrawSky32TModes::DoubleSky> DrawSkyDouble32Command;
+}
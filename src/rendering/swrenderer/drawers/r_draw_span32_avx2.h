@@ -0,0 +1,421 @@
+/*
+**  Drawer commands for spans
+**  Copyright (c) 2026 The GZDoom Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+*/
+
+#pragma once
+
+#include "swrenderer/drawers/r_draw_rgba_avx2.h"
+#include "swrenderer/viewport/r_spandrawer.h"
+
+namespace swrenderer::avx2
+{
+	namespace DrawSpan32TModes
+	{
+		enum class SpanBlendModes { Opaque, Masked, Translucent, AddClamp, SubClamp, RevSubClamp };
+		struct OpaqueSpan { static const int Mode = (int)SpanBlendModes::Opaque; };
+		struct MaskedSpan { static const int Mode = (int)SpanBlendModes::Masked; };
+		struct TranslucentSpan { static const int Mode = (int)SpanBlendModes::Translucent; };
+		struct AddClampSpan { static const int Mode = (int)SpanBlendModes::AddClamp; };
+		struct SubClampSpan { static const int Mode = (int)SpanBlendModes::SubClamp; };
+		struct RevSubClampSpan { static const int Mode = (int)SpanBlendModes::RevSubClamp; };
+
+		enum class FilterModes { Nearest, Linear };
+		struct NearestFilter { static const int Mode = (int)FilterModes::Nearest; };
+		struct LinearFilter { static const int Mode = (int)FilterModes::Linear; };
+
+		enum class ShadeMode { Simple, Advanced };
+		struct SimpleShade { static const int Mode = (int)ShadeMode::Simple; };
+		struct AdvancedShade { static const int Mode = (int)ShadeMode::Advanced; };
+
+		enum class SpanTextureSize { SizeAny, Size64x64 };
+		struct TextureSizeAny { static const int Mode = (int)SpanTextureSize::SizeAny; };
+		struct TextureSize64x64 { static const int Mode = (int)SpanTextureSize::Size64x64; };
+	}
+
+	template<typename BlendT>
+	class DrawSpan32T
+	{
+	public:
+		struct TextureData
+		{
+			uint32_t width;
+			uint32_t height;
+			uint32_t xone;
+			uint32_t yone;
+			uint32_t xstep;
+			uint32_t ystep;
+			uint32_t xfrac;
+			uint32_t yfrac;
+			const uint32_t *source;
+		};
+
+		static void DrawColumn(const SpanDrawerArgs& args)
+		{
+			using namespace DrawSpan32TModes;
+
+			TextureData texdata;
+			texdata.width = args.TextureWidth();
+			texdata.height = args.TextureHeight();
+			texdata.xstep = args.TextureUStep();
+			texdata.ystep = args.TextureVStep();
+			texdata.xfrac = args.TextureUPos();
+			texdata.yfrac = args.TextureVPos();
+
+			texdata.source = (const uint32_t*)args.TexturePixels();
+
+			double lod = args.TextureLOD();
+			bool mipmapped = args.MipmappedTexture();
+
+			bool magnifying = lod < 0.0;
+			if (r_mipmap && mipmapped)
+			{
+				int level = (int)lod;
+				while (level > 0)
+				{
+					if (texdata.width <= 2 || texdata.height <= 2)
+						break;
+
+					texdata.source += texdata.width * texdata.height;
+					texdata.width = MAX<uint32_t>(texdata.width / 2, 1);
+					texdata.height = MAX<uint32_t>(texdata.height / 2, 1);
+					level--;
+				}
+			}
+
+			texdata.xone = (0x80000000u / texdata.width) << 1;
+			texdata.yone = (0x80000000u / texdata.height) << 1;
+
+			bool is_nearest_filter = (magnifying && !r_magfilter) || (!magnifying && !r_minfilter);
+			bool is_64x64 = texdata.width == 64 && texdata.height == 64;
+
+			auto shade_constants = args.ColormapConstants();
+			if (shade_constants.simple_shade)
+			{
+				if (is_nearest_filter)
+				{
+					if (is_64x64)
+						Loop<SimpleShade, NearestFilter, TextureSize64x64>(args, texdata, shade_constants);
+					else
+						Loop<SimpleShade, NearestFilter, TextureSizeAny>(args, texdata, shade_constants);
+				}
+				else
+				{
+					if (is_64x64)
+						Loop<SimpleShade, LinearFilter, TextureSize64x64>(args, texdata, shade_constants);
+					else
+						Loop<SimpleShade, LinearFilter, TextureSizeAny>(args, texdata, shade_constants);
+				}
+			}
+			else
+			{
+				if (is_nearest_filter)
+				{
+					if (is_64x64)
+						Loop<AdvancedShade, NearestFilter, TextureSize64x64>(args, texdata, shade_constants);
+					else
+						Loop<AdvancedShade, NearestFilter, TextureSizeAny>(args, texdata, shade_constants);
+				}
+				else
+				{
+					if (is_64x64)
+						Loop<AdvancedShade, LinearFilter, TextureSize64x64>(args, texdata, shade_constants);
+					else
+						Loop<AdvancedShade, LinearFilter, TextureSizeAny>(args, texdata, shade_constants);
+				}
+			}
+		}
+
+		template<typename ShadeModeT, typename FilterModeT, typename TextureSizeT>
+		FORCEINLINE static void VECTORCALL Loop(const SpanDrawerArgs& args, TextureData texdata, ShadeConstants shade_constants)
+		{
+			using namespace DrawSpan32TModes;
+
+			// Shade constants
+			int light = 256 - (args.Light() >> (FRACBITS - 8));
+			__m256i mlight = Pixels4::Channels(256, light, light, light);
+			__m256i inv_light = Pixels4::Channels(0, 256 - light, 256 - light, 256 - light);
+
+			__m256i inv_desaturate, shade_fade, shade_light;
+			int desaturate;
+			if (ShadeModeT::Mode == (int)ShadeMode::Advanced)
+			{
+				inv_desaturate = Pixels4::Channels(256 - shade_constants.desaturate, 256 - shade_constants.desaturate, 256 - shade_constants.desaturate, 256);
+				shade_fade = Pixels4::Channels(shade_constants.fade_alpha, shade_constants.fade_red, shade_constants.fade_green, shade_constants.fade_blue);
+				shade_fade = _mm256_mullo_epi16(shade_fade, inv_light);
+				shade_light = Pixels4::Channels(shade_constants.light_alpha, shade_constants.light_red, shade_constants.light_green, shade_constants.light_blue);
+				desaturate = shade_constants.desaturate;
+			}
+			else
+			{
+				inv_desaturate = _mm256_setzero_si256();
+				shade_fade = _mm256_setzero_si256();
+				shade_light = _mm256_setzero_si256();
+				desaturate = 0;
+			}
+
+			auto lights = args.dc_lights;
+			auto num_lights = args.dc_num_lights;
+			float vpx = args.dc_viewpos.X;
+			float stepvpx = args.dc_viewpos_step.X;
+			__m128 viewpos_pair = _mm_setr_ps(vpx, vpx + stepvpx, 0.0f, 0.0f);
+			__m128 step_viewpos_pair = _mm_set1_ps(stepvpx * 2.0f);
+
+			int count = args.DestX2() - args.DestX1() + 1;
+			uint32_t *dest = (uint32_t*)args.Viewport()->GetDest(args.DestX1(), args.DestY());
+
+			if (FilterModeT::Mode == (int)FilterModes::Linear)
+			{
+				texdata.xfrac -= texdata.xone / 2;
+				texdata.yfrac -= texdata.yone / 2;
+			}
+
+			uint32_t srcalpha = args.SrcAlpha() >> (FRACBITS - 8);
+			uint32_t destalpha = args.DestAlpha() >> (FRACBITS - 8);
+
+			__m128i steps = _mm_setr_epi32(0, 1, 2, 3);
+			__m128i xoffsets = _mm_mullo_epi32(_mm_set1_epi32(texdata.xstep), steps);
+			__m128i yoffsets = _mm_mullo_epi32(_mm_set1_epi32(texdata.ystep), steps);
+
+			int avxcount = count / 4;
+			for (int index = 0; index < avxcount; index++)
+			{
+				int offset = index * 4;
+
+				__m256i bgcolor;
+				if (BlendT::Mode != (int)SpanBlendModes::Opaque)
+				{
+					bgcolor = Pixels4::Unpack(_mm_loadu_si128((const __m128i*)(dest + offset)));
+				}
+				else
+				{
+					bgcolor = _mm256_setzero_si256();
+				}
+
+				__m128i ifgcolor = Sample4<FilterModeT, TextureSizeT>(texdata, xoffsets, yoffsets);
+				texdata.xfrac += texdata.xstep * 4;
+				texdata.yfrac += texdata.ystep * 4;
+
+				__m256i fgcolor = Pixels4::Unpack(ifgcolor);
+				__m128 viewpos_x = Pixels4::ViewPositions(viewpos_pair, step_viewpos_pair);
+				fgcolor = Shade<ShadeModeT>(fgcolor, mlight, desaturate, inv_desaturate, shade_fade, shade_light, lights, num_lights, viewpos_x);
+				__m128i outcolor = Blend(fgcolor, bgcolor, srcalpha, destalpha, ifgcolor);
+
+				_mm_storeu_si128((__m128i*)(dest + offset), outcolor);
+				viewpos_pair = Pixels4::NextViewPositions(viewpos_pair, step_viewpos_pair);
+			}
+
+			int remaining = count - avxcount * 4;
+			if (remaining > 0)
+			{
+				uint32_t *d = dest + avxcount * 4;
+
+				__m256i bgcolor;
+				if (BlendT::Mode != (int)SpanBlendModes::Opaque)
+				{
+					bgcolor = Pixels4::Unpack(Pixels4::LoadColumn(d, 1, remaining));
+				}
+				else
+				{
+					bgcolor = _mm256_setzero_si256();
+				}
+
+				uint32_t ifgtmp[4] = { 0, 0, 0, 0 };
+				for (int i = 0; i < remaining; i++)
+				{
+					ifgtmp[i] = Sample<FilterModeT, TextureSizeT>(texdata.width, texdata.height, texdata.xone, texdata.yone, texdata.xfrac, texdata.yfrac, texdata.source);
+					texdata.xfrac += texdata.xstep;
+					texdata.yfrac += texdata.ystep;
+				}
+				__m128i ifgcolor = _mm_loadu_si128((const __m128i*)ifgtmp);
+
+				__m256i fgcolor = Pixels4::Unpack(ifgcolor);
+				__m128 viewpos_x = Pixels4::ViewPositions(viewpos_pair, step_viewpos_pair);
+				fgcolor = Shade<ShadeModeT>(fgcolor, mlight, desaturate, inv_desaturate, shade_fade, shade_light, lights, num_lights, viewpos_x);
+				__m128i outcolor = Blend(fgcolor, bgcolor, srcalpha, destalpha, ifgcolor);
+
+				Pixels4::StoreColumn(d, 1, outcolor, remaining);
+			}
+		}
+
+		template<typename FilterModeT, typename TextureSizeT>
+		FORCEINLINE static __m128i VECTORCALL Sample4(const TextureData &texdata, __m128i xoffsets, __m128i yoffsets)
+		{
+			using namespace DrawSpan32TModes;
+
+			if (FilterModeT::Mode == (int)FilterModes::Nearest)
+			{
+				__m128i xfrac = _mm_add_epi32(_mm_set1_epi32(texdata.xfrac), xoffsets);
+				__m128i yfrac = _mm_add_epi32(_mm_set1_epi32(texdata.yfrac), yoffsets);
+
+				__m128i sample_index;
+				if (TextureSizeT::Mode == (int)SpanTextureSize::Size64x64)
+				{
+					sample_index = _mm_add_epi32(_mm_and_si128(_mm_srli_epi32(xfrac, 32 - 6 - 6), _mm_set1_epi32(63 * 64)), _mm_srli_epi32(yfrac, 32 - 6));
+				}
+				else
+				{
+					__m128i height = _mm_set1_epi32(texdata.height);
+					__m128i x = _mm_srli_epi32(_mm_mullo_epi32(_mm_srli_epi32(xfrac, 16), _mm_set1_epi32(texdata.width)), 16);
+					__m128i y = _mm_srli_epi32(_mm_mullo_epi32(_mm_srli_epi32(yfrac, 16), height), 16);
+					sample_index = _mm_add_epi32(_mm_mullo_epi32(x, height), y);
+				}
+				return _mm_i32gather_epi32((const int*)texdata.source, sample_index, 4);
+			}
+			else
+			{
+				uint32_t ifgcolor[4];
+				for (int i = 0; i < 4; i++)
+				{
+					ifgcolor[i] = Sample<FilterModeT, TextureSizeT>(texdata.width, texdata.height, texdata.xone, texdata.yone, texdata.xfrac + texdata.xstep * i, texdata.yfrac + texdata.ystep * i, texdata.source);
+				}
+				return _mm_loadu_si128((const __m128i*)ifgcolor);
+			}
+		}
+
+		template<typename FilterModeT, typename TextureSizeT>
+		FORCEINLINE static unsigned int VECTORCALL Sample(uint32_t width, uint32_t height, uint32_t xone, uint32_t yone, uint32_t xfrac, uint32_t yfrac, const uint32_t *source)
+		{
+			using namespace DrawSpan32TModes;
+
+			if (FilterModeT::Mode == (int)FilterModes::Nearest && TextureSizeT::Mode == (int)SpanTextureSize::Size64x64)
+			{
+				int sample_index = ((xfrac >> (32 - 6 - 6)) & (63 * 64)) + (yfrac >> (32 - 6));
+				return source[sample_index];
+			}
+			else if (FilterModeT::Mode == (int)FilterModes::Nearest)
+			{
+				uint32_t x = ((xfrac >> 16) * width) >> 16;
+				uint32_t y = ((yfrac >> 16) * height) >> 16;
+				int sample_index = x * height + y;
+				return source[sample_index];
+			}
+			else
+			{
+				uint32_t p00, p01, p10, p11;
+				uint32_t frac_x, frac_y;
+				if (TextureSizeT::Mode == (int)SpanTextureSize::Size64x64)
+				{
+					frac_x = xfrac >> 16 << 6;
+					frac_y = yfrac >> 16 << 6;
+					uint32_t x0 = frac_x >> 16;
+					uint32_t y0 = frac_y >> 16;
+					uint32_t x1 = (x0 + 1) & 0x3f;
+					uint32_t y1 = (y0 + 1) & 0x3f;
+					p00 = source[(y0 + (x0 << 6))];
+					p01 = source[(y1 + (x0 << 6))];
+					p10 = source[(y0 + (x1 << 6))];
+					p11 = source[(y1 + (x1 << 6))];
+				}
+				else
+				{
+					frac_x = (xfrac >> 16) * width;
+					frac_y = (yfrac >> 16) * height;
+					uint32_t x0 = frac_x >> 16;
+					uint32_t y0 = frac_y >> 16;
+					uint32_t x1 = (((xfrac + xone) >> 16) * width) >> 16;
+					uint32_t y1 = (((yfrac + yone) >> 16) * height) >> 16;
+					p00 = source[y0 + x0 * height];
+					p01 = source[y1 + x0 * height];
+					p10 = source[y0 + x1 * height];
+					p11 = source[y1 + x1 * height];
+				}
+
+				uint32_t inv_b = (frac_x >> 12) & 15;
+				uint32_t inv_a = (frac_y >> 12) & 15;
+				uint32_t a = 16 - inv_a;
+				uint32_t b = 16 - inv_b;
+
+				uint32_t sred = (RPART(p00) * (a * b) + RPART(p01) * (inv_a * b) + RPART(p10) * (a * inv_b) + RPART(p11) * (inv_a * inv_b) + 127) >> 8;
+				uint32_t sgreen = (GPART(p00) * (a * b) + GPART(p01) * (inv_a * b) + GPART(p10) * (a * inv_b) + GPART(p11) * (inv_a * inv_b) + 127) >> 8;
+				uint32_t sblue = (BPART(p00) * (a * b) + BPART(p01) * (inv_a * b) + BPART(p10) * (a * inv_b) + BPART(p11) * (inv_a * inv_b) + 127) >> 8;
+				uint32_t salpha = (APART(p00) * (a * b) + APART(p01) * (inv_a * b) + APART(p10) * (a * inv_b) + APART(p11) * (inv_a * inv_b) + 127) >> 8;
+
+				return (salpha << 24) | (sred << 16) | (sgreen << 8) | sblue;
+			}
+		}
+
+		template<typename ShadeModeT>
+		FORCEINLINE static __m256i VECTORCALL Shade(__m256i fgcolor, __m256i mlight, int desaturate, __m256i inv_desaturate, __m256i shade_fade, __m256i shade_light, const DrawerLight *lights, int num_lights, __m128 viewpos_x)
+		{
+			using namespace DrawSpan32TModes;
+
+			__m256i material = fgcolor;
+			if (ShadeModeT::Mode == (int)ShadeMode::Simple)
+			{
+				fgcolor = _mm256_srli_epi16(_mm256_mullo_epi16(fgcolor, mlight), 8);
+			}
+			else
+			{
+				__m256i intensity = Pixels4::Intensity(fgcolor, desaturate);
+
+				fgcolor = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(fgcolor, inv_desaturate), intensity), 8);
+				fgcolor = _mm256_mullo_epi16(fgcolor, mlight);
+				fgcolor = _mm256_srli_epi16(_mm256_add_epi16(shade_fade, fgcolor), 8);
+				fgcolor = _mm256_srli_epi16(_mm256_mullo_epi16(fgcolor, shade_light), 8);
+			}
+
+			__m256i lit = _mm256_setzero_si256();
+			for (int i = 0; i != num_lights; i++)
+			{
+				// L.y*L.y + L.z*L.z is precalculated in the y component
+				lit = Pixels4::AddLight(lit, _mm_set1_ps(lights[i].y), _mm_set1_ps(lights[i].x), viewpos_x, _mm_set1_ps(lights[i].z), _mm_set1_ps(lights[i].radius), lights[i].color);
+			}
+			return Pixels4::ApplyLights(material, fgcolor, lit);
+		}
+
+		FORCEINLINE static __m128i VECTORCALL Blend(__m256i fgcolor, __m256i bgcolor, uint32_t srcalpha, uint32_t destalpha, __m128i ifgcolor)
+		{
+			using namespace DrawSpan32TModes;
+
+			if (BlendT::Mode == (int)SpanBlendModes::Opaque)
+			{
+				return Pixels4::Opaque(fgcolor);
+			}
+			else if (BlendT::Mode == (int)SpanBlendModes::Masked)
+			{
+				return Pixels4::Masked(fgcolor, bgcolor);
+			}
+			else if (BlendT::Mode == (int)SpanBlendModes::Translucent)
+			{
+				return Pixels4::BlendClamp<Pixels4::BlendOp::Add>(fgcolor, bgcolor, _mm256_set1_epi16(srcalpha), _mm256_set1_epi16(destalpha));
+			}
+			else
+			{
+				__m256i fgalpha, bgalpha;
+				Pixels4::BlendAlpha(ifgcolor, srcalpha, destalpha, fgalpha, bgalpha);
+
+				if (BlendT::Mode == (int)SpanBlendModes::AddClamp)
+					return Pixels4::BlendClamp<Pixels4::BlendOp::Add>(fgcolor, bgcolor, fgalpha, bgalpha);
+				else if (BlendT::Mode == (int)SpanBlendModes::SubClamp)
+					return Pixels4::BlendClamp<Pixels4::BlendOp::Sub>(fgcolor, bgcolor, fgalpha, bgalpha);
+				else
+					return Pixels4::BlendClamp<Pixels4::BlendOp::RevSub>(fgcolor, bgcolor, fgalpha, bgalpha);
+			}
+		}
+	};
+
+	typedef DrawSpan32T<DrawSpan32TModes::OpaqueSpan> DrawSpan32Command;
+	typedef DrawSpan32T<DrawSpan32TModes::MaskedSpan> DrawSpanMasked32Command;
+	typedef DrawSpan32T<DrawSpan32TModes::TranslucentSpan> DrawSpanTranslucent32Command;
+	typedef DrawSpan32T<DrawSpan32TModes::AddClampSpan> DrawSpanAddClamp32Command;
+	typedef DrawSpan32T<DrawSpan32TModes::SubClampSpan> DrawSpanSubClamp32Command;
+	typedef DrawSpan32T<DrawSpan32TModes::RevSubClampSpan> DrawSpanRevSubClamp32Command;
+}
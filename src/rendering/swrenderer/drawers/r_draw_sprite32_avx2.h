@@ -0,0 +1,454 @@
+/*
+**  Drawer commands for sprites
+**  Copyright (c) 2026 The GZDoom Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+*/
+
+#pragma once
+
+#include "swrenderer/drawers/r_draw_rgba_avx2.h"
+#include "swrenderer/viewport/r_spritedrawer.h"
+
+namespace swrenderer::avx2
+{
+	namespace DrawSprite32TModes
+	{
+		enum class SpriteBlendModes { Copy, Opaque, Shaded, AddClampShaded, AddClamp, SubClamp, RevSubClamp };
+		struct CopySprite { static const int Mode = (int)SpriteBlendModes::Copy; };
+		struct OpaqueSprite { static const int Mode = (int)SpriteBlendModes::Opaque; };
+		struct ShadedSprite { static const int Mode = (int)SpriteBlendModes::Shaded; };
+		struct AddClampShadedSprite { static const int Mode = (int)SpriteBlendModes::AddClampShaded; };
+		struct AddClampSprite { static const int Mode = (int)SpriteBlendModes::AddClamp; };
+		struct SubClampSprite { static const int Mode = (int)SpriteBlendModes::SubClamp; };
+		struct RevSubClampSprite { static const int Mode = (int)SpriteBlendModes::RevSubClamp; };
+
+		enum class FilterModes { Nearest, Linear };
+		struct NearestFilter { static const int Mode = (int)FilterModes::Nearest; };
+		struct LinearFilter { static const int Mode = (int)FilterModes::Linear; };
+
+		enum class ShadeMode { Simple, Advanced };
+		struct SimpleShade { static const int Mode = (int)ShadeMode::Simple; };
+		struct AdvancedShade { static const int Mode = (int)ShadeMode::Advanced; };
+
+		enum class SpriteSamplers { Texture, Fill, Shaded, Translated };
+		struct TextureSampler { static const int Mode = (int)SpriteSamplers::Texture; };
+		struct FillSampler { static const int Mode = (int)SpriteSamplers::Fill; };
+		struct ShadedSampler { static const int Mode = (int)SpriteSamplers::Shaded; };
+		struct TranslatedSampler { static const int Mode = (int)SpriteSamplers::Translated; };
+	}
+
+	template<typename BlendT, typename SamplerT>
+	class DrawSprite32T
+	{
+	public:
+		struct SamplerData
+		{
+			const uint32_t *source;
+			const uint32_t *source2;
+			const uint8_t *colormap;
+			const uint32_t *translation;
+			int textureheight;
+			uint32_t one;
+			uint32_t texturefracx;
+			uint32_t color;
+			uint32_t srccolor;
+		};
+
+		static void DrawColumn(const SpriteDrawerArgs& args)
+		{
+			using namespace DrawSprite32TModes;
+
+			auto shade_constants = args.ColormapConstants();
+			if (SamplerT::Mode == (int)SpriteSamplers::Texture)
+			{
+				const uint32_t *source2 = (const uint32_t*)args.TexturePixels2();
+				bool is_nearest_filter = (source2 == nullptr);
+
+				if (shade_constants.simple_shade)
+				{
+					if (is_nearest_filter)
+						Loop<SimpleShade, NearestFilter>(args, shade_constants);
+					else
+						Loop<SimpleShade, LinearFilter>(args, shade_constants);
+				}
+				else
+				{
+					if (is_nearest_filter)
+						Loop<AdvancedShade, NearestFilter>(args, shade_constants);
+					else
+						Loop<AdvancedShade, LinearFilter>(args, shade_constants);
+				}
+			}
+			else // no linear filtering for translated, shaded or fill
+			{
+				if (shade_constants.simple_shade)
+				{
+					Loop<SimpleShade, NearestFilter>(args, shade_constants);
+				}
+				else
+				{
+					Loop<AdvancedShade, NearestFilter>(args, shade_constants);
+				}
+			}
+		}
+
+		template<typename ShadeModeT, typename FilterModeT>
+		FORCEINLINE static void VECTORCALL Loop(const SpriteDrawerArgs& args, ShadeConstants shade_constants)
+		{
+			using namespace DrawSprite32TModes;
+
+			SamplerData sampler;
+			if (SamplerT::Mode == (int)SpriteSamplers::Shaded || SamplerT::Mode == (int)SpriteSamplers::Translated)
+			{
+				sampler.source = (const uint32_t*)args.TexturePixels();
+				sampler.source2 = nullptr;
+				sampler.colormap = args.Colormap(args.Viewport());
+				sampler.translation = (const uint32_t*)args.TranslationMap();
+			}
+			else
+			{
+				sampler.source = (const uint32_t*)args.TexturePixels();
+				sampler.source2 = (const uint32_t*)args.TexturePixels2();
+				sampler.colormap = nullptr;
+				sampler.translation = nullptr;
+			}
+
+			sampler.textureheight = args.TextureHeight();
+			sampler.one = ((0x20000000 + sampler.textureheight - 1) / sampler.textureheight) * 2 + 1;
+
+			// Shade constants
+			__m256i dynlight = Pixels4::Unpack(_mm_set1_epi32(args.DynamicLight()));
+			int light = 256 - (args.Light() >> (FRACBITS - 8));
+			__m256i mlight = Pixels4::Channels(256, light, light, light);
+
+			__m256i inv_desaturate, shade_fade, shade_light;
+			int desaturate;
+			__m256i lightcontrib;
+			if (ShadeModeT::Mode == (int)ShadeMode::Advanced)
+			{
+				__m256i inv_light = Pixels4::Channels(0, 256 - light, 256 - light, 256 - light);
+				inv_desaturate = Pixels4::Channels(256 - shade_constants.desaturate, 256 - shade_constants.desaturate, 256 - shade_constants.desaturate, 256);
+				shade_fade = Pixels4::Channels(shade_constants.fade_alpha, shade_constants.fade_red, shade_constants.fade_green, shade_constants.fade_blue);
+				shade_fade = _mm256_mullo_epi16(shade_fade, inv_light);
+				shade_light = Pixels4::Channels(shade_constants.light_alpha, shade_constants.light_red, shade_constants.light_green, shade_constants.light_blue);
+				desaturate = shade_constants.desaturate;
+
+				lightcontrib = _mm256_min_epi16(_mm256_add_epi16(mlight, dynlight), _mm256_set1_epi16(256));
+				lightcontrib = _mm256_sub_epi16(lightcontrib, mlight);
+			}
+			else
+			{
+				inv_desaturate = _mm256_setzero_si256();
+				shade_fade = _mm256_setzero_si256();
+				shade_light = _mm256_setzero_si256();
+				desaturate = 0;
+				lightcontrib = _mm256_setzero_si256();
+
+				mlight = _mm256_min_epi16(_mm256_add_epi16(mlight, dynlight), _mm256_set1_epi16(256));
+			}
+
+			int count = args.Count();
+			if (count <= 0) return;
+			int pitch = args.Viewport()->RenderTarget->GetPitch();
+			uint32_t fracstep = args.TextureVStep();
+			uint32_t frac = args.TextureVPos();
+			sampler.texturefracx = args.TextureUPos();
+			uint32_t *dest = (uint32_t*)args.Dest();
+
+			if (FilterModeT::Mode == (int)FilterModes::Linear)
+			{
+				frac -= sampler.one / 2;
+			}
+
+			uint32_t srcalpha = args.SrcAlpha() >> (FRACBITS - 8);
+			uint32_t destalpha = args.DestAlpha() >> (FRACBITS - 8);
+			sampler.srccolor = args.SrcColorBgra();
+			sampler.color = LightBgra::shade_bgra_simple(args.SolidColorBgra(),
+				LightBgra::calc_light_multiplier(light));
+
+			__m128i fracoffsets = _mm_mullo_epi32(_mm_set1_epi32(fracstep), _mm_setr_epi32(0, 1, 2, 3));
+
+			int avxcount = count / 4;
+			for (int index = 0; index < avxcount; index++)
+			{
+				uint32_t *d = dest + index * pitch * 4;
+
+				__m256i bgcolor;
+				if (BlendT::Mode != (int)SpriteBlendModes::Opaque && BlendT::Mode != (int)SpriteBlendModes::Copy)
+				{
+					bgcolor = Pixels4::Unpack(Pixels4::LoadColumn(d, pitch));
+				}
+				else
+				{
+					bgcolor = _mm256_setzero_si256();
+				}
+
+				__m128i ifgcolor = Sample4<FilterModeT>(frac, fracstep, fracoffsets, sampler);
+				__m128i ifgshade = SampleShade4(frac, fracstep, sampler);
+				frac += fracstep * 4;
+
+				__m256i fgcolor = Pixels4::Unpack(ifgcolor);
+				fgcolor = Shade<ShadeModeT>(fgcolor, mlight, desaturate, inv_desaturate, shade_fade, shade_light, lightcontrib);
+				__m128i outcolor = Blend(fgcolor, bgcolor, ifgcolor, ifgshade, srcalpha, destalpha);
+
+				Pixels4::StoreColumn(d, pitch, outcolor);
+			}
+
+			int remaining = count - avxcount * 4;
+			if (remaining > 0)
+			{
+				uint32_t *d = dest + avxcount * pitch * 4;
+
+				__m256i bgcolor;
+				if (BlendT::Mode != (int)SpriteBlendModes::Opaque && BlendT::Mode != (int)SpriteBlendModes::Copy)
+				{
+					bgcolor = Pixels4::Unpack(Pixels4::LoadColumn(d, pitch, remaining));
+				}
+				else
+				{
+					bgcolor = _mm256_setzero_si256();
+				}
+
+				uint32_t ifgtmp[4] = { 0, 0, 0, 0 };
+				uint32_t ifgshadetmp[4] = { 0, 0, 0, 0 };
+				for (int i = 0; i < remaining; i++)
+				{
+					ifgtmp[i] = Sample<FilterModeT>(frac, sampler);
+					ifgshadetmp[i] = SampleShade(frac, sampler);
+					frac += fracstep;
+				}
+				__m128i ifgcolor = _mm_loadu_si128((const __m128i*)ifgtmp);
+				__m128i ifgshade = _mm_loadu_si128((const __m128i*)ifgshadetmp);
+
+				__m256i fgcolor = Pixels4::Unpack(ifgcolor);
+				fgcolor = Shade<ShadeModeT>(fgcolor, mlight, desaturate, inv_desaturate, shade_fade, shade_light, lightcontrib);
+				__m128i outcolor = Blend(fgcolor, bgcolor, ifgcolor, ifgshade, srcalpha, destalpha);
+
+				Pixels4::StoreColumn(d, pitch, outcolor, remaining);
+			}
+		}
+
+		template<typename FilterModeT>
+		FORCEINLINE static __m128i VECTORCALL Sample4(uint32_t frac, uint32_t fracstep, __m128i fracoffsets, const SamplerData &sampler)
+		{
+			using namespace DrawSprite32TModes;
+
+			if (SamplerT::Mode == (int)SpriteSamplers::Shaded)
+			{
+				return _mm_set1_epi32(sampler.color);
+			}
+			else if (SamplerT::Mode == (int)SpriteSamplers::Fill)
+			{
+				return _mm_set1_epi32(sampler.srccolor);
+			}
+			else if (SamplerT::Mode == (int)SpriteSamplers::Texture && FilterModeT::Mode == (int)FilterModes::Nearest)
+			{
+				__m128i mfrac = _mm_add_epi32(_mm_set1_epi32(frac), fracoffsets);
+				__m128i sample_index = _mm_srli_epi32(_mm_slli_epi32(mfrac, 2), FRACBITS);
+				sample_index = _mm_srli_epi32(_mm_mullo_epi32(sample_index, _mm_set1_epi32(sampler.textureheight)), FRACBITS);
+				return _mm_i32gather_epi32((const int*)sampler.source, sample_index, 4);
+			}
+			else
+			{
+				return _mm_setr_epi32(
+					Sample<FilterModeT>(frac, sampler),
+					Sample<FilterModeT>(frac + fracstep, sampler),
+					Sample<FilterModeT>(frac + fracstep * 2, sampler),
+					Sample<FilterModeT>(frac + fracstep * 3, sampler));
+			}
+		}
+
+		template<typename FilterModeT>
+		FORCEINLINE static unsigned int VECTORCALL Sample(uint32_t frac, const SamplerData &sampler)
+		{
+			using namespace DrawSprite32TModes;
+
+			if (SamplerT::Mode == (int)SpriteSamplers::Shaded)
+			{
+				return sampler.color;
+			}
+			else if (SamplerT::Mode == (int)SpriteSamplers::Translated)
+			{
+				const uint8_t *sourcepal = (const uint8_t *)sampler.source;
+				return sampler.translation[sourcepal[frac >> FRACBITS]];
+			}
+			else if (SamplerT::Mode == (int)SpriteSamplers::Fill)
+			{
+				return sampler.srccolor;
+			}
+			else if (FilterModeT::Mode == (int)FilterModes::Nearest)
+			{
+				int sample_index = (((frac << 2) >> FRACBITS) * sampler.textureheight) >> FRACBITS;
+				return sampler.source[sample_index];
+			}
+			else
+			{
+				const uint32_t *source = sampler.source;
+				const uint32_t *source2 = sampler.source2;
+				int textureheight = sampler.textureheight;
+
+				// Clamp to edge
+				unsigned int frac_y0 = (clamp<unsigned int>(frac, 0, 1 << 30) >> (FRACBITS - 2)) * textureheight;
+				unsigned int frac_y1 = (clamp<unsigned int>(frac + sampler.one, 0, 1 << 30) >> (FRACBITS - 2)) * textureheight;
+				unsigned int y0 = frac_y0 >> FRACBITS;
+				unsigned int y1 = frac_y1 >> FRACBITS;
+
+				unsigned int p00 = source[y0];
+				unsigned int p01 = source[y1];
+				unsigned int p10 = source2[y0];
+				unsigned int p11 = source2[y1];
+
+				unsigned int inv_b = sampler.texturefracx;
+				unsigned int inv_a = (frac_y1 >> (FRACBITS - 4)) & 15;
+				unsigned int a = 16 - inv_a;
+				unsigned int b = 16 - inv_b;
+
+				unsigned int sred = (RPART(p00) * (a * b) + RPART(p01) * (inv_a * b) + RPART(p10) * (a * inv_b) + RPART(p11) * (inv_a * inv_b) + 127) >> 8;
+				unsigned int sgreen = (GPART(p00) * (a * b) + GPART(p01) * (inv_a * b) + GPART(p10) * (a * inv_b) + GPART(p11) * (inv_a * inv_b) + 127) >> 8;
+				unsigned int sblue = (BPART(p00) * (a * b) + BPART(p01) * (inv_a * b) + BPART(p10) * (a * inv_b) + BPART(p11) * (inv_a * inv_b) + 127) >> 8;
+				unsigned int salpha = (APART(p00) * (a * b) + APART(p01) * (inv_a * b) + APART(p10) * (a * inv_b) + APART(p11) * (inv_a * inv_b) + 127) >> 8;
+
+				return (salpha << 24) | (sred << 16) | (sgreen << 8) | sblue;
+			}
+		}
+
+		FORCEINLINE static __m128i VECTORCALL SampleShade4(uint32_t frac, uint32_t fracstep, const SamplerData &sampler)
+		{
+			using namespace DrawSprite32TModes;
+
+			if (SamplerT::Mode == (int)SpriteSamplers::Shaded)
+			{
+				return _mm_setr_epi32(
+					SampleShade(frac, sampler),
+					SampleShade(frac + fracstep, sampler),
+					SampleShade(frac + fracstep * 2, sampler),
+					SampleShade(frac + fracstep * 3, sampler));
+			}
+			else
+			{
+				return _mm_setzero_si128();
+			}
+		}
+
+		FORCEINLINE static unsigned int VECTORCALL SampleShade(uint32_t frac, const SamplerData &sampler)
+		{
+			using namespace DrawSprite32TModes;
+
+			if (SamplerT::Mode == (int)SpriteSamplers::Shaded)
+			{
+				const uint8_t *sourcepal = (const uint8_t *)sampler.source;
+				unsigned int sampleshadeout = sampler.colormap[sourcepal[frac >> FRACBITS]];
+				return clamp<unsigned int>(sampleshadeout, 0, 64) * 4;
+			}
+			else
+			{
+				return 0;
+			}
+		}
+
+		template<typename ShadeModeT>
+		FORCEINLINE static __m256i VECTORCALL Shade(__m256i fgcolor, __m256i mlight, int desaturate, __m256i inv_desaturate, __m256i shade_fade, __m256i shade_light, __m256i lightcontrib)
+		{
+			using namespace DrawSprite32TModes;
+
+			if (BlendT::Mode == (int)SpriteBlendModes::Copy)
+				return fgcolor;
+
+			if (ShadeModeT::Mode == (int)ShadeMode::Simple)
+			{
+				fgcolor = _mm256_srli_epi16(_mm256_mullo_epi16(fgcolor, mlight), 8);
+				return fgcolor;
+			}
+			else
+			{
+				__m256i lit_dynlight = _mm256_srli_epi16(_mm256_mullo_epi16(fgcolor, lightcontrib), 8);
+				__m256i intensity = Pixels4::Intensity(fgcolor, desaturate);
+
+				fgcolor = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(fgcolor, inv_desaturate), intensity), 8);
+				fgcolor = _mm256_mullo_epi16(fgcolor, mlight);
+				fgcolor = _mm256_srli_epi16(_mm256_add_epi16(shade_fade, fgcolor), 8);
+				fgcolor = _mm256_srli_epi16(_mm256_mullo_epi16(fgcolor, shade_light), 8);
+
+				fgcolor = _mm256_add_epi16(fgcolor, lit_dynlight);
+				fgcolor = _mm256_min_epi16(fgcolor, _mm256_set1_epi16(255));
+				return fgcolor;
+			}
+		}
+
+		FORCEINLINE static __m128i VECTORCALL Blend(__m256i fgcolor, __m256i bgcolor, __m128i ifgcolor, __m128i ifgshade, uint32_t srcalpha, uint32_t destalpha)
+		{
+			using namespace DrawSprite32TModes;
+
+			if (BlendT::Mode == (int)SpriteBlendModes::Opaque || BlendT::Mode == (int)SpriteBlendModes::Copy)
+			{
+				return Pixels4::Opaque(fgcolor);
+			}
+			else if (BlendT::Mode == (int)SpriteBlendModes::Shaded)
+			{
+				__m256i alpha = Pixels4::Broadcast(ifgshade);
+				__m256i inv_alpha = _mm256_sub_epi16(_mm256_set1_epi16(256), alpha);
+
+				fgcolor = _mm256_mullo_epi16(fgcolor, alpha);
+				bgcolor = _mm256_mullo_epi16(bgcolor, inv_alpha);
+				__m256i outcolor = _mm256_srli_epi16(_mm256_add_epi16(fgcolor, bgcolor), 8);
+				return _mm_or_si128(Pixels4::Pack(outcolor), _mm_set1_epi32(0xff000000));
+			}
+			else if (BlendT::Mode == (int)SpriteBlendModes::AddClampShaded)
+			{
+				__m256i alpha = Pixels4::Broadcast(ifgshade);
+
+				fgcolor = _mm256_srli_epi16(_mm256_mullo_epi16(fgcolor, alpha), 8);
+				__m256i outcolor = _mm256_add_epi16(fgcolor, bgcolor);
+				return _mm_or_si128(Pixels4::Pack(outcolor), _mm_set1_epi32(0xff000000));
+			}
+			else
+			{
+				__m256i fgalpha, bgalpha;
+				Pixels4::BlendAlpha(ifgcolor, srcalpha, destalpha, fgalpha, bgalpha);
+
+				if (BlendT::Mode == (int)SpriteBlendModes::SubClamp)
+					return Pixels4::BlendClamp<Pixels4::BlendOp::Sub>(fgcolor, bgcolor, fgalpha, bgalpha);
+				else if (BlendT::Mode == (int)SpriteBlendModes::RevSubClamp)
+					return Pixels4::BlendClamp<Pixels4::BlendOp::RevSub>(fgcolor, bgcolor, fgalpha, bgalpha);
+				else
+					return Pixels4::BlendClamp<Pixels4::BlendOp::Add>(fgcolor, bgcolor, fgalpha, bgalpha);
+			}
+		}
+	};
+
+	typedef DrawSprite32T<DrawSprite32TModes::CopySprite, DrawSprite32TModes::TextureSampler> DrawSpriteCopy32Command;
+
+	typedef DrawSprite32T<DrawSprite32TModes::OpaqueSprite, DrawSprite32TModes::TextureSampler> DrawSprite32Command;
+	typedef DrawSprite32T<DrawSprite32TModes::AddClampSprite, DrawSprite32TModes::TextureSampler> DrawSpriteAddClamp32Command;
+	typedef DrawSprite32T<DrawSprite32TModes::SubClampSprite, DrawSprite32TModes::TextureSampler> DrawSpriteSubClamp32Command;
+	typedef DrawSprite32T<DrawSprite32TModes::RevSubClampSprite, DrawSprite32TModes::TextureSampler> DrawSpriteRevSubClamp32Command;
+
+	typedef DrawSprite32T<DrawSprite32TModes::OpaqueSprite, DrawSprite32TModes::FillSampler> FillSprite32Command;
+	typedef DrawSprite32T<DrawSprite32TModes::AddClampSprite, DrawSprite32TModes::FillSampler> FillSpriteAddClamp32Command;
+	typedef DrawSprite32T<DrawSprite32TModes::SubClampSprite, DrawSprite32TModes::FillSampler> FillSpriteSubClamp32Command;
+	typedef DrawSprite32T<DrawSprite32TModes::RevSubClampSprite, DrawSprite32TModes::FillSampler> FillSpriteRevSubClamp32Command;
+
+	typedef DrawSprite32T<DrawSprite32TModes::ShadedSprite, DrawSprite32TModes::ShadedSampler> DrawSpriteShaded32Command;
+	typedef DrawSprite32T<DrawSprite32TModes::AddClampShadedSprite, DrawSprite32TModes::ShadedSampler> DrawSpriteAddClampShaded32Command;
+
+	typedef DrawSprite32T<DrawSprite32TModes::OpaqueSprite, DrawSprite32TModes::TranslatedSampler> DrawSpriteTranslated32Command;
+	typedef DrawSprite32T<DrawSprite32TModes::AddClampSprite, DrawSprite32TModes::TranslatedSampler> DrawSpriteTranslatedAddClamp32Command;
+	typedef DrawSprite32T<DrawSprite32TModes::SubClampSprite, DrawSprite32TModes::TranslatedSampler> DrawSpriteTranslatedSubClamp32Command;
+	typedef DrawSprite32T<DrawSprite32TModes::RevSubClampSprite, DrawSprite32TModes::TranslatedSampler> DrawSpriteTranslatedRevSubClamp32Command;
+}
@@ -25,7 +25,7 @@
 #include "swrenderer/drawers/r_draw_rgba.h"
 #include "swrenderer/viewport/r_walldrawer.h"
 
-namespace swrenderer
+namespace swrenderer::sse2
 {
 	namespace DrawSprite32TModes
 	{
@@ -0,0 +1,312 @@
+/*
+**  Drawer commands for walls
+**  Copyright (c) 2026 The GZDoom Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+*/
+
+#pragma once
+
+#include "swrenderer/drawers/r_draw_pal.h"
+#include "swrenderer/drawers/r_draw_rgba_avx2.h"
+#include "swrenderer/viewport/r_walldrawer.h"
+
+namespace swrenderer::avx2
+{
+	namespace DrawWall32TModes
+	{
+		enum class WallBlendModes { Opaque, Masked, AddClamp, SubClamp, RevSubClamp };
+		struct OpaqueWall { static const int Mode = (int)WallBlendModes::Opaque; };
+		struct MaskedWall { static const int Mode = (int)WallBlendModes::Masked; };
+		struct AddClampWall { static const int Mode = (int)WallBlendModes::AddClamp; };
+		struct SubClampWall { static const int Mode = (int)WallBlendModes::SubClamp; };
+		struct RevSubClampWall { static const int Mode = (int)WallBlendModes::RevSubClamp; };
+
+		enum class FilterModes { Nearest, Linear };
+		struct NearestFilter { static const int Mode = (int)FilterModes::Nearest; };
+		struct LinearFilter { static const int Mode = (int)FilterModes::Linear; };
+
+		enum class ShadeMode { Simple, Advanced };
+		struct SimpleShade { static const int Mode = (int)ShadeMode::Simple; };
+		struct AdvancedShade { static const int Mode = (int)ShadeMode::Advanced; };
+	}
+
+	template<typename BlendT>
+	class DrawWall32T
+	{
+	public:
+		static void DrawColumn(const WallColumnDrawerArgs& args)
+		{
+			using namespace DrawWall32TModes;
+
+			const uint32_t *source2 = (const uint32_t*)args.TexturePixels2();
+			bool is_nearest_filter = (source2 == nullptr);
+			auto shade_constants = args.ColormapConstants();
+			if (shade_constants.simple_shade)
+			{
+				if (is_nearest_filter)
+					Loop<SimpleShade, NearestFilter>(args, shade_constants);
+				else
+					Loop<SimpleShade, LinearFilter>(args, shade_constants);
+			}
+			else
+			{
+				if (is_nearest_filter)
+					Loop<AdvancedShade, NearestFilter>(args, shade_constants);
+				else
+					Loop<AdvancedShade, LinearFilter>(args, shade_constants);
+			}
+		}
+
+		template<typename ShadeModeT, typename FilterModeT>
+		FORCEINLINE static void VECTORCALL Loop(const WallColumnDrawerArgs& args, ShadeConstants shade_constants)
+		{
+			using namespace DrawWall32TModes;
+
+			const uint32_t *source = (const uint32_t*)args.TexturePixels();
+			const uint32_t *source2 = (const uint32_t*)args.TexturePixels2();
+			int textureheight = args.TextureHeight();
+			uint32_t one = ((0x80000000 + textureheight - 1) / textureheight) * 2 + 1;
+
+			// Shade constants
+			int light = 256 - (args.Light() >> (FRACBITS - 8));
+			__m256i mlight = Pixels4::Channels(256, light, light, light);
+			__m256i inv_light = Pixels4::Channels(0, 256 - light, 256 - light, 256 - light);
+
+			__m256i inv_desaturate, shade_fade, shade_light;
+			int desaturate;
+			if (ShadeModeT::Mode == (int)ShadeMode::Advanced)
+			{
+				inv_desaturate = Pixels4::Channels(256 - shade_constants.desaturate, 256 - shade_constants.desaturate, 256 - shade_constants.desaturate, 256);
+				shade_fade = Pixels4::Channels(shade_constants.fade_alpha, shade_constants.fade_red, shade_constants.fade_green, shade_constants.fade_blue);
+				shade_fade = _mm256_mullo_epi16(shade_fade, inv_light);
+				shade_light = Pixels4::Channels(shade_constants.light_alpha, shade_constants.light_red, shade_constants.light_green, shade_constants.light_blue);
+				desaturate = shade_constants.desaturate;
+			}
+			else
+			{
+				inv_desaturate = _mm256_setzero_si256();
+				shade_fade = _mm256_setzero_si256();
+				shade_light = _mm256_setzero_si256();
+				desaturate = 0;
+			}
+
+			int count = args.Count();
+			if (count <= 0) return;
+
+			int pitch = args.Viewport()->RenderTarget->GetPitch();
+			uint32_t fracstep = args.TextureVStep();
+			uint32_t frac = args.TextureVPos();
+			uint32_t texturefracx = args.TextureUPos();
+			uint32_t *dest = (uint32_t*)args.Dest();
+
+			auto lights = args.dc_lights;
+			auto num_lights = args.dc_num_lights;
+			float vpz = args.dc_viewpos.Z;
+			float stepvpz = args.dc_viewpos_step.Z;
+			__m128 viewpos_pair = _mm_setr_ps(vpz, vpz + stepvpz, 0.0f, 0.0f);
+			__m128 step_viewpos_pair = _mm_set1_ps(stepvpz * 2.0f);
+
+			if (FilterModeT::Mode == (int)FilterModes::Linear)
+			{
+				frac -= one / 2;
+			}
+
+			uint32_t srcalpha = args.SrcAlpha() >> (FRACBITS - 8);
+			uint32_t destalpha = args.DestAlpha() >> (FRACBITS - 8);
+
+			__m128i fracoffsets = _mm_mullo_epi32(_mm_set1_epi32(fracstep), _mm_setr_epi32(0, 1, 2, 3));
+
+			int avxcount = count / 4;
+			for (int index = 0; index < avxcount; index++)
+			{
+				uint32_t *d = dest + index * pitch * 4;
+
+				__m256i bgcolor;
+				if (BlendT::Mode != (int)WallBlendModes::Opaque)
+				{
+					bgcolor = Pixels4::Unpack(Pixels4::LoadColumn(d, pitch));
+				}
+				else
+				{
+					bgcolor = _mm256_setzero_si256();
+				}
+
+				__m128i ifgcolor = Sample4<FilterModeT>(frac, fracstep, fracoffsets, source, source2, textureheight, one, texturefracx);
+				frac += fracstep * 4;
+
+				__m256i fgcolor = Pixels4::Unpack(ifgcolor);
+				__m128 viewpos_z = Pixels4::ViewPositions(viewpos_pair, step_viewpos_pair);
+				fgcolor = Shade<ShadeModeT>(fgcolor, mlight, desaturate, inv_desaturate, shade_fade, shade_light, lights, num_lights, viewpos_z);
+				__m128i outcolor = Blend(fgcolor, bgcolor, ifgcolor, srcalpha, destalpha);
+
+				Pixels4::StoreColumn(d, pitch, outcolor);
+				viewpos_pair = Pixels4::NextViewPositions(viewpos_pair, step_viewpos_pair);
+			}
+
+			int remaining = count - avxcount * 4;
+			if (remaining > 0)
+			{
+				uint32_t *d = dest + avxcount * pitch * 4;
+
+				__m256i bgcolor;
+				if (BlendT::Mode != (int)WallBlendModes::Opaque)
+				{
+					bgcolor = Pixels4::Unpack(Pixels4::LoadColumn(d, pitch, remaining));
+				}
+				else
+				{
+					bgcolor = _mm256_setzero_si256();
+				}
+
+				uint32_t ifgtmp[4] = { 0, 0, 0, 0 };
+				for (int i = 0; i < remaining; i++)
+				{
+					ifgtmp[i] = Sample<FilterModeT>(frac, source, source2, textureheight, one, texturefracx);
+					frac += fracstep;
+				}
+				__m128i ifgcolor = _mm_loadu_si128((const __m128i*)ifgtmp);
+
+				__m256i fgcolor = Pixels4::Unpack(ifgcolor);
+				__m128 viewpos_z = Pixels4::ViewPositions(viewpos_pair, step_viewpos_pair);
+				fgcolor = Shade<ShadeModeT>(fgcolor, mlight, desaturate, inv_desaturate, shade_fade, shade_light, lights, num_lights, viewpos_z);
+				__m128i outcolor = Blend(fgcolor, bgcolor, ifgcolor, srcalpha, destalpha);
+
+				Pixels4::StoreColumn(d, pitch, outcolor, remaining);
+			}
+		}
+
+		template<typename FilterModeT>
+		FORCEINLINE static __m128i VECTORCALL Sample4(uint32_t frac, uint32_t fracstep, __m128i fracoffsets, const uint32_t *source, const uint32_t *source2, int textureheight, uint32_t one, uint32_t texturefracx)
+		{
+			using namespace DrawWall32TModes;
+
+			if (FilterModeT::Mode == (int)FilterModes::Nearest)
+			{
+				__m128i mfrac = _mm_add_epi32(_mm_set1_epi32(frac), fracoffsets);
+				__m128i sample_index = _mm_srli_epi32(_mm_mullo_epi32(_mm_srli_epi32(mfrac, FRACBITS), _mm_set1_epi32(textureheight)), FRACBITS);
+				return _mm_i32gather_epi32((const int*)source, sample_index, 4);
+			}
+			else
+			{
+				return _mm_setr_epi32(
+					Sample<FilterModeT>(frac, source, source2, textureheight, one, texturefracx),
+					Sample<FilterModeT>(frac + fracstep, source, source2, textureheight, one, texturefracx),
+					Sample<FilterModeT>(frac + fracstep * 2, source, source2, textureheight, one, texturefracx),
+					Sample<FilterModeT>(frac + fracstep * 3, source, source2, textureheight, one, texturefracx));
+			}
+		}
+
+		template<typename FilterModeT>
+		FORCEINLINE static unsigned int VECTORCALL Sample(uint32_t frac, const uint32_t *source, const uint32_t *source2, int textureheight, uint32_t one, uint32_t texturefracx)
+		{
+			using namespace DrawWall32TModes;
+
+			if (FilterModeT::Mode == (int)FilterModes::Nearest)
+			{
+				int sample_index = ((frac >> FRACBITS) * textureheight) >> FRACBITS;
+				return source[sample_index];
+			}
+			else
+			{
+				unsigned int frac_y0 = (frac >> FRACBITS) * textureheight;
+				unsigned int frac_y1 = ((frac + one) >> FRACBITS) * textureheight;
+				unsigned int y0 = frac_y0 >> FRACBITS;
+				unsigned int y1 = frac_y1 >> FRACBITS;
+
+				unsigned int p00 = source[y0];
+				unsigned int p01 = source[y1];
+				unsigned int p10 = source2[y0];
+				unsigned int p11 = source2[y1];
+
+				unsigned int inv_b = texturefracx;
+				unsigned int inv_a = (frac_y1 >> (FRACBITS - 4)) & 15;
+				unsigned int a = 16 - inv_a;
+				unsigned int b = 16 - inv_b;
+
+				unsigned int sred = (RPART(p00) * (a * b) + RPART(p01) * (inv_a * b) + RPART(p10) * (a * inv_b) + RPART(p11) * (inv_a * inv_b) + 127) >> 8;
+				unsigned int sgreen = (GPART(p00) * (a * b) + GPART(p01) * (inv_a * b) + GPART(p10) * (a * inv_b) + GPART(p11) * (inv_a * inv_b) + 127) >> 8;
+				unsigned int sblue = (BPART(p00) * (a * b) + BPART(p01) * (inv_a * b) + BPART(p10) * (a * inv_b) + BPART(p11) * (inv_a * inv_b) + 127) >> 8;
+				unsigned int salpha = (APART(p00) * (a * b) + APART(p01) * (inv_a * b) + APART(p10) * (a * inv_b) + APART(p11) * (inv_a * inv_b) + 127) >> 8;
+
+				return (salpha << 24) | (sred << 16) | (sgreen << 8) | sblue;
+			}
+		}
+
+		template<typename ShadeModeT>
+		FORCEINLINE static __m256i VECTORCALL Shade(__m256i fgcolor, __m256i mlight, int desaturate, __m256i inv_desaturate, __m256i shade_fade, __m256i shade_light, const DrawerLight *lights, int num_lights, __m128 viewpos_z)
+		{
+			using namespace DrawWall32TModes;
+
+			__m256i material = fgcolor;
+			if (ShadeModeT::Mode == (int)ShadeMode::Simple)
+			{
+				fgcolor = _mm256_srli_epi16(_mm256_mullo_epi16(fgcolor, mlight), 8);
+			}
+			else
+			{
+				__m256i intensity = Pixels4::Intensity(fgcolor, desaturate);
+
+				fgcolor = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(fgcolor, inv_desaturate), intensity), 8);
+				fgcolor = _mm256_mullo_epi16(fgcolor, mlight);
+				fgcolor = _mm256_srli_epi16(_mm256_add_epi16(shade_fade, fgcolor), 8);
+				fgcolor = _mm256_srli_epi16(_mm256_mullo_epi16(fgcolor, shade_light), 8);
+			}
+
+			__m256i lit = _mm256_setzero_si256();
+			for (int i = 0; i != num_lights; i++)
+			{
+				// L.x*L.x + L.y*L.y is precalculated in the x component
+				lit = Pixels4::AddLight(lit, _mm_set1_ps(lights[i].x), _mm_set1_ps(lights[i].z), viewpos_z, _mm_set1_ps(lights[i].y), _mm_set1_ps(lights[i].radius), lights[i].color);
+			}
+			return Pixels4::ApplyLights(material, fgcolor, lit);
+		}
+
+		FORCEINLINE static __m128i VECTORCALL Blend(__m256i fgcolor, __m256i bgcolor, __m128i ifgcolor, uint32_t srcalpha, uint32_t destalpha)
+		{
+			using namespace DrawWall32TModes;
+
+			if (BlendT::Mode == (int)WallBlendModes::Opaque)
+			{
+				return Pixels4::Opaque(fgcolor);
+			}
+			else if (BlendT::Mode == (int)WallBlendModes::Masked)
+			{
+				return Pixels4::Masked(fgcolor, bgcolor);
+			}
+			else
+			{
+				__m256i fgalpha, bgalpha;
+				Pixels4::BlendAlpha(ifgcolor, srcalpha, destalpha, fgalpha, bgalpha);
+
+				if (BlendT::Mode == (int)WallBlendModes::AddClamp)
+					return Pixels4::BlendClamp<Pixels4::BlendOp::Add>(fgcolor, bgcolor, fgalpha, bgalpha);
+				else if (BlendT::Mode == (int)WallBlendModes::SubClamp)
+					return Pixels4::BlendClamp<Pixels4::BlendOp::Sub>(fgcolor, bgcolor, fgalpha, bgalpha);
+				else
+					return Pixels4::BlendClamp<Pixels4::BlendOp::RevSub>(fgcolor, bgcolor, fgalpha, bgalpha);
+			}
+		}
+	};
+
+	typedef DrawWall32T<DrawWall32TModes::OpaqueWall> DrawWall32Command;
+	typedef DrawWall32T<DrawWall32TModes::MaskedWall> DrawWallMasked32Command;
+	typedef DrawWall32T<DrawWall32TModes::AddClampWall> DrawWallAddClamp32Command;
+	typedef DrawWall32T<DrawWall32TModes::SubClampWall> DrawWallSubClamp32Command;
+	typedef DrawWall32T<DrawWall32TModes::RevSubClampWall> DrawWallRevSubClamp32Command;
+}
@@ -29,6 +29,9 @@ struct FRenderer
 	// renders view to a savegame picture
 	virtual void WriteSavePic(player_t *player, FileWriter *file, int width, int height) = 0;
 
+	// renders the view of an actor into an offscreen canvas, without player sprites
+	virtual void RenderViewToCanvas(AActor *camera, DCanvas *canvas) = 0;
+
 	// draws player sprites with hardware acceleration (only useful for software rendering)
 	virtual void DrawRemainingPlayerSprites() = 0;
 
@@ -61,6 +61,8 @@ namespace swrenderer
 		RenderScene *Scene;
 		int X1 = 0;
 		int X2 = MAXWIDTH;
+		int Y1 = 0;
+		int Y2 = MAXHEIGHT;
 		bool MainThread = false;
 
 		std::unique_ptr<RenderMemory> FrameMemory;
@@ -877,8 +877,8 @@ namespace swrenderer
 
 	void RenderOpaquePass::ClearClip()
 	{
-		fillshort(floorclip, viewwidth, viewheight);
-		fillshort(ceilingclip, viewwidth, 0);
+		fillshort(floorclip, viewwidth, MIN(Thread->Y2, viewheight));
+		fillshort(ceilingclip, viewwidth, Thread->Y1);
 	}
 
 	void RenderOpaquePass::AddSprites(sector_t *sec, int lightlevel, WaterFakeSide fakeside, bool foggy, FDynamicColormap *basecolormap)
@@ -67,6 +67,7 @@ EXTERN_CVAR(Int, r_clearbuffer)
 EXTERN_CVAR(Int, r_debug_draw)
 
 CVAR(Int, r_scene_multithreaded, 1, 0);
+CVAR(Bool, r_scene_tiles, false, 0);
 CVAR(Bool, r_models, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 
 bool r_modelscene = false;
@@ -209,14 +210,40 @@ namespace swrenderer
 			StartThreads(numThreads);
 		}
 
+		// Each thread owns either a vertical slice or, with r_scene_tiles, a tile of a grid
+		// that is as close to square tiles as the thread count allows:
+		int columns = numThreads;
+		if (r_scene_tiles)
+		{
+			double bestRatio = DBL_MAX;
+			for (int cols = 1; cols <= numThreads; cols++)
+			{
+				if (numThreads % cols != 0)
+					continue;
+				int rows = numThreads / cols;
+				double tileRatio = (viewwidth / (double)cols) / (viewheight / (double)rows);
+				double ratio = MAX(tileRatio, 1.0 / tileRatio);
+				if (ratio < bestRatio)
+				{
+					bestRatio = ratio;
+					columns = cols;
+				}
+			}
+		}
+		int rows = numThreads / columns;
+
 		// Setup threads:
 		std::unique_lock<std::mutex> start_lock(start_mutex);
 		for (int i = 0; i < numThreads; i++)
 		{
+			int column = i % columns;
+			int row = i / columns;
 			*Threads[i]->Viewport = *MainThread()->Viewport;
 			*Threads[i]->Light = *MainThread()->Light;
-			Threads[i]->X1 = viewwidth * i / numThreads;
-			Threads[i]->X2 = viewwidth * (i + 1) / numThreads;
+			Threads[i]->X1 = viewwidth * column / columns;
+			Threads[i]->X2 = viewwidth * (column + 1) / columns;
+			Threads[i]->Y1 = viewheight * row / rows;
+			Threads[i]->Y2 = viewheight * (row + 1) / rows;
 		}
 		run_id++;
 		FSoftwareTexture::CurrentUpdate = run_id;
@@ -252,6 +279,8 @@ namespace swrenderer
 		// Change main thread back to covering the whole screen for player sprites
 		MainThread()->X1 = 0;
 		MainThread()->X2 = viewwidth;
+		MainThread()->Y1 = 0;
+		MainThread()->Y2 = viewheight;
 	}
 
 	void RenderScene::RenderThreadSlice(RenderThread *thread)
@@ -274,7 +303,8 @@ namespace swrenderer
 		PolyTriangleDrawer::SetViewport(thread->DrawQueue, viewwindowx, viewwindowy, viewwidth, viewheight, thread->Viewport->RenderTarget, DepthStencil.get());
 		PolyTriangleDrawer::SetScissor(thread->DrawQueue, viewwindowx, viewwindowy, viewwidth, viewheight);*/
 
-		// Cull things outside the range seen by this thread
+		// Cull things outside the range seen by this thread. Rows outside its tile are
+		// excluded by the floor and ceiling clip arrays set up by ClearClip.
 		VisibleSegmentRenderer visitor;
 		if (thread->X1 > 0)
 			thread->ClipSegments->Clip(0, thread->X1, true, &visitor);
@@ -297,11 +327,11 @@ namespace swrenderer
 #if 0 // shows the render slice edges
 		if (thread->Viewport->RenderTarget->IsBgra())
 		{
-			uint32_t* left = (uint32_t*)thread->Viewport->GetDest(thread->X1, 0);
-			uint32_t* right = (uint32_t*)thread->Viewport->GetDest(thread->X2 - 1, 0);
+			uint32_t* left = (uint32_t*)thread->Viewport->GetDest(thread->X1, thread->Y1);
+			uint32_t* right = (uint32_t*)thread->Viewport->GetDest(thread->X2 - 1, thread->Y1);
 			int pitch = thread->Viewport->RenderTarget->GetPitch();
 			uint32_t c = MAKEARGB(255, 0, 0, 0);
-			for (int i = 0; i < viewheight; i++)
+			for (int i = thread->Y1; i < thread->Y2; i++)
 			{
 				*left = c;
 				*right = c;
@@ -311,12 +341,12 @@ namespace swrenderer
 		}
 		else
 		{
-			uint8_t* left = (uint8_t*)thread->Viewport->GetDest(thread->X1, 0);
-			uint8_t* right = (uint8_t*)thread->Viewport->GetDest(thread->X2 - 1, 0);
+			uint8_t* left = (uint8_t*)thread->Viewport->GetDest(thread->X1, thread->Y1);
+			uint8_t* right = (uint8_t*)thread->Viewport->GetDest(thread->X2 - 1, thread->Y1);
 			int pitch = thread->Viewport->RenderTarget->GetPitch();
 			int r = 0, g = 0, b = 0;
 			uint8_t c = RGB32k.RGB[(r >> 3)][(g >> 3)][(b >> 3)];
-			for (int i = 0; i < viewheight; i++)
+			for (int i = thread->Y1; i < thread->Y2; i++)
 			{
 				*left = c;
 				*right = c;
@@ -172,8 +172,9 @@ namespace swrenderer
 		// [RH] Initialize the clipping arrays to their largest possible range
 		// instead of using a special "not clipped" value. This eliminates
 		// visual anomalies when looking down and should be faster, too.
-		topclip = 0;
-		botclip = viewheight;
+		// The range is limited to the screen tile drawn by this thread.
+		topclip = thread->Y1;
+		botclip = MIN(thread->Y2, viewheight);
 
 		// killough 3/27/98:
 		// Clip the sprite against deep water and/or fake ceilings.
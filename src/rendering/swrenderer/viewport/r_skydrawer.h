@@ -60,5 +60,7 @@ namespace swrenderer
 		uint32_t solid_bottom;
 		bool fadeSky;
 		RenderViewport *dc_viewport = nullptr;
+
+		friend class SWTruecolorBenchmark;
 	};
 }
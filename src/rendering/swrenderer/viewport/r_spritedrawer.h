@@ -113,5 +113,6 @@ namespace swrenderer
 
 		friend class SWTruecolorDrawers;
 		friend class SWPalDrawers;
+		friend class SWTruecolorBenchmark;
 	};
 }
@@ -1186,6 +1186,22 @@ DEFINE_ACTION_FUNCTION_NATIVE(_Sector, SetXOffset, SetXOffset)
 	 ACTION_RETURN_INT(LineIndex(self));
  }
 
+ static void SetLineFlags(line_t *self, unsigned setflags, unsigned clearflags)
+ {
+	 self->flags = (self->flags & ~clearflags) | setflags;
+	 // The flags decide what blocks sight so cached results may be stale now.
+	 P_InvalidateSightCache();
+ }
+
+ DEFINE_ACTION_FUNCTION_NATIVE(_Line, SetFlags, SetLineFlags)
+ {
+	 PARAM_SELF_STRUCT_PROLOGUE(line_t);
+	 PARAM_UINT(setflags);
+	 PARAM_UINT(clearflags);
+	 SetLineFlags(self, setflags, clearflags);
+	 return 0;
+ }
+
  //===========================================================================
  //
  // side_t exports 